@@ -0,0 +1,86 @@
+// Tests that inserts and replacements of large documents are logged with a compressed 'o' field
+// when oplogEntryCompressionMinObjectSizeBytes is set and the featureCompatibilityVersion is 4.0,
+// and that secondaries and change streams read them transparently. Plain finds on the oplog return
+// the entries in their compressed form.
+(function() {
+    'use strict';
+    load('jstests/replsets/rslib.js');
+
+    const kMinObjectSize = 1024;
+    const replSet = new ReplSetTest({
+        nodes: 2,
+        nodeOptions: {setParameter: {oplogEntryCompressionMinObjectSizeBytes: kMinObjectSize}}
+    });
+    replSet.startSet();
+    replSet.initiate();
+
+    const primary = replSet.getPrimary();
+    const secondary = replSet.getSecondary();
+    const coll = primary.getDB('test').getCollection('oplog_entry_compression');
+    assert.commandWorked(coll.runCommand('create'));
+
+    const changeStream = coll.watch();
+    const largeString = 'x'.repeat(64 * 1024);
+
+    // Small documents are logged as usual.
+    assert.writeOK(coll.insert({_id: 0, payload: 'small'}));
+    let entry = getLatestOp(primary);
+    assert(entry.hasOwnProperty('o'), tojson(entry));
+    assert(!entry.hasOwnProperty('oz'), tojson(entry));
+
+    // Large inserts and replacements are compressed.
+    assert.writeOK(coll.insert({_id: 1, payload: largeString}));
+    entry = getLatestOp(primary);
+    assert(entry.hasOwnProperty('oz'), tojson(entry));
+    assert(!entry.hasOwnProperty('o'), tojson(entry));
+
+    assert.writeOK(coll.update({_id: 1}, {payload: largeString + 'y'}));
+    entry = getLatestOp(primary);
+    assert.eq('u', entry.op, tojson(entry));
+    assert(entry.hasOwnProperty('oz'), tojson(entry));
+
+    // Updates with modifiers are never compressed.
+    assert.writeOK(coll.update({_id: 1}, {$set: {other: largeString}}));
+    entry = getLatestOp(primary);
+    assert(entry.hasOwnProperty('o'), tojson(entry));
+
+    // Secondaries apply the compressed entries and keep them compressed in their own oplog.
+    replSet.awaitReplication();
+    const secondaryDoc = secondary.getDB('test').oplog_entry_compression.findOne({_id: 1});
+    assert.eq(largeString + 'y', secondaryDoc.payload);
+    assert.eq(largeString, secondaryDoc.other);
+    const secondaryEntry = secondary.getDB('local').oplog.rs.findOne(
+        {ns: coll.getFullName(), op: 'i', 'o2': {$exists: false}, 'oz': {$exists: true}});
+    assert.neq(null, secondaryEntry);
+
+    // Change streams report the decompressed documents.
+    assert.soon(() => changeStream.hasNext());
+    assert.eq({_id: 0, payload: 'small'}, changeStream.next().fullDocument);
+    assert.soon(() => changeStream.hasNext());
+    let change = changeStream.next();
+    assert.eq('insert', change.operationType);
+    assert.eq({_id: 1, payload: largeString}, change.fullDocument);
+    assert.soon(() => changeStream.hasNext());
+    change = changeStream.next();
+    assert.eq('replace', change.operationType);
+    assert.eq({_id: 1, payload: largeString + 'y'}, change.fullDocument);
+
+    // Nothing is compressed while the featureCompatibilityVersion is 3.6, since members running an
+    // older binary could not read the entries.
+    assert.commandWorked(primary.adminCommand({setFeatureCompatibilityVersion: '3.6'}));
+    assert.writeOK(coll.insert({_id: 2, payload: largeString}));
+    entry = getLatestOp(primary);
+    assert(entry.hasOwnProperty('o'), tojson(entry));
+    assert(!entry.hasOwnProperty('oz'), tojson(entry));
+    assert.commandWorked(primary.adminCommand({setFeatureCompatibilityVersion: '4.0'}));
+
+    // applyOps accepts entries copied straight from the oplog, as mongorestore --oplogReplay sends.
+    const compressedInsert = primary.getDB('local').oplog.rs.findOne(
+        {ns: coll.getFullName(), op: 'i', 'oz': {$exists: true}});
+    assert.neq(null, compressedInsert);
+    assert.writeOK(coll.remove({_id: 1}));
+    assert.commandWorked(primary.adminCommand({applyOps: [compressedInsert]}));
+    assert.eq({_id: 1, payload: largeString}, coll.findOne({_id: 1}));
+
+    replSet.stopSet();
+})();
@@ -93,6 +93,7 @@ AtomicBool areRefreshRetriesDisabledForTest{false};  // Only true in tests.
 // TODO: Move to ReplicaSetMonitorManager
 ReplicaSetMonitor::ConfigChangeHook asyncConfigChangeHook;
 ReplicaSetMonitor::ConfigChangeHook syncConfigChangeHook;
+ReplicaSetMonitor::HostCostEstimator hostCostEstimator;
 
 //
 // Helpers for stl algorithms
@@ -412,6 +413,11 @@ void ReplicaSetMonitor::setSynchronousConfigChangeHook(ConfigChangeHook hook) {
     syncConfigChangeHook = hook;
 }
 
+void ReplicaSetMonitor::setHostCostEstimator(HostCostEstimator estimator) {
+    invariant(!hostCostEstimator);
+    hostCostEstimator = std::move(estimator);
+}
+
 // TODO move to correct order with non-statics before pushing
 void ReplicaSetMonitor::appendInfo(BSONObjBuilder& bsonObjBuilder) const {
     stdx::lock_guard<stdx::mutex> lk(_state->mutex);
@@ -454,6 +460,7 @@ void ReplicaSetMonitor::cleanup() {
     globalRSMonitorManager.removeAllMonitors();
     asyncConfigChangeHook = ReplicaSetMonitor::ConfigChangeHook();
     syncConfigChangeHook = ReplicaSetMonitor::ConfigChangeHook();
+    hostCostEstimator = ReplicaSetMonitor::HostCostEstimator();
 }
 
 void ReplicaSetMonitor::disableRefreshRetries_forTest() {
@@ -1161,6 +1168,26 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
                 if (ReplicaSetMonitor::useDeterministicHostSelection) {
                     // only in tests
                     return matchingNodes[roundRobin++ % matchingNodes.size()]->host;
+                } else if (hostCostEstimator) {
+                    if (matchingNodes.size() == 1) {
+                        return matchingNodes.front()->host;
+                    }
+
+                    // Pick two at random and take the one estimated to be cheaper. This steers
+                    // load away from busy hosts without herding every caller onto the same one.
+                    const int32_t numNodes = matchingNodes.size();
+                    const int32_t first = rand.nextInt32(numNodes);
+                    int32_t second = rand.nextInt32(numNodes - 1);
+                    if (second >= first) {
+                        ++second;
+                    }
+
+                    const auto firstCost = hostCostEstimator(matchingNodes[first]->host);
+                    const auto secondCost = hostCostEstimator(matchingNodes[second]->host);
+                    if (firstCost >= 0 && secondCost >= 0 && secondCost < firstCost) {
+                        return matchingNodes[second]->host;
+                    }
+                    return matchingNodes[first]->host;
                 } else {
                     // normal case
                     return matchingNodes[rand.nextInt32(matchingNodes.size())]->host;
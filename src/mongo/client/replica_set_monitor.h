@@ -62,6 +62,13 @@ public:
     typedef stdx::function<void(const std::string& setName, const std::string& newConnectionString)>
         ConfigChangeHook;
 
+    /**
+     * Estimates the cost of sending an operation to a host from this process's own view of it,
+     * such as how long its pooled connections are kept busy and how many requests are waiting for
+     * one. Lower is cheaper; a negative value means there is no estimate for the host.
+     */
+    typedef stdx::function<int64_t(const HostAndPort& host)> HostCostEstimator;
+
     /**
      * Initializes local state.
      *
@@ -217,6 +224,18 @@ public:
      */
     static void setSynchronousConfigChangeHook(ConfigChangeHook hook);
 
+    /**
+     * Sets the estimator used to choose among hosts which equally satisfy a read preference and
+     * are within the latency threshold of the nearest one. Without one, such hosts are chosen at
+     * random. Currently only 1 globally, so this asserts if one already exists.
+     *
+     * The estimator is called while holding the ReplicaSetMonitor's mutex, so it must be cheap and
+     * must not call back into the ReplicaSetMonitor.
+     *
+     * The estimator must not be changed while the program has multiple threads.
+     */
+    static void setHostCostEstimator(HostCostEstimator estimator);
+
     /**
      * Permanently stops all monitoring on replica sets and clears all cached information
      * as well. As a consequence, NEVER call this if you have other threads that have a
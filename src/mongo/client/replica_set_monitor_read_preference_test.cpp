@@ -35,6 +35,7 @@
 #include "mongo/client/replica_set_monitor_internal.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -298,6 +299,52 @@ TEST(ReplSetMonitorReadPref, NearestOneLocal) {
     ASSERT(!isPrimarySelected);
 }
 
+TEST(ReplSetMonitorReadPref, SecOnlyPrefersCheaperHost) {
+    ReplicaSetMonitor::setHostCostEstimator([](const HostAndPort& host) -> int64_t {
+        return host.host() == "a" ? 5000 : 1000;
+    });
+    ON_BLOCK_EXIT([] { ReplicaSetMonitor::cleanup(); });
+
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    nodes[0].latencyMicros = 1 * 1000;
+    nodes[2].latencyMicros = 2 * 1000;
+
+    // Both secondaries are within the latency threshold, and with only two candidates the
+    // cheaper one is always chosen.
+    for (int i = 0; i < 10; ++i) {
+        bool isPrimarySelected = true;
+        HostAndPort host =
+            selectNode(nodes, mongo::ReadPreference::SecondaryOnly, tags, 3, &isPrimarySelected);
+
+        ASSERT_EQUALS("c", host.host());
+        ASSERT(!isPrimarySelected);
+    }
+}
+
+TEST(ReplSetMonitorReadPref, NearestOneLocalWithHostCostEstimator) {
+    ReplicaSetMonitor::setHostCostEstimator([](const HostAndPort& host) -> int64_t {
+        return host.host() == "a" ? 5000 : 1000;
+    });
+    ON_BLOCK_EXIT([] { ReplicaSetMonitor::cleanup(); });
+
+    vector<Node> nodes = getThreeMemberWithTags();
+    TagSet tags(getDefaultTagSet());
+
+    nodes[0].latencyMicros = 10 * 1000;
+    nodes[1].latencyMicros = 20 * 1000;
+    nodes[2].latencyMicros = 30 * 1000;
+
+    // Only one node is within the latency threshold, so there is nothing to compare it against.
+    bool isPrimarySelected = false;
+    HostAndPort host =
+        selectNode(nodes, mongo::ReadPreference::Nearest, tags, 3, &isPrimarySelected);
+
+    ASSERT_EQUALS("a", host.host());
+    ASSERT(!isPrimarySelected);
+}
+
 TEST(ReplSetMonitorReadPref, PriOnlyWithTagsNoMatch) {
     vector<Node> nodes = getThreeMemberWithTags();
     TagSet tags(getP2TagSet());
@@ -49,6 +49,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -245,6 +246,11 @@ public:
             }
         }
 
+        // Lookups by _id queue for read tickets apart from scans, so they aren't stuck behind them.
+        if (CanonicalQuery::isSimpleIdQuery(qr->getFilter())) {
+            TicketHolder::setOperationClass(opCtx, TicketHolder::OperationClass::kPointOperation);
+        }
+
         // Acquire locks. If the query is on a view, we release our locks and convert the query
         // request into an aggregation command.
         boost::optional<AutoGetCollectionForReadCommand> ctx;
@@ -33,6 +33,7 @@
 #include "mongo/db/catalog/uuid_catalog.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/oplog_application_checks.h"
+#include "mongo/db/repl/oplog_entry_compression.h"
 
 namespace mongo {
 UUID OplogApplicationChecks::getUUIDFromOplogEntry(const BSONObj& oplogEntry) {
@@ -42,9 +43,16 @@ UUID OplogApplicationChecks::getUUIDFromOplogEntry(const BSONObj& oplogEntry) {
 
 Status OplogApplicationChecks::checkOperationAuthorization(OperationContext* opCtx,
                                                            const std::string& dbname,
-                                                           const BSONObj& oplogEntry,
+                                                           const BSONObj& storedOplogEntry,
                                                            AuthorizationSession* authSession,
                                                            bool alwaysUpsert) {
+    // Operations copied from the oplog may store their 'o' field compressed.
+    auto swOplogEntry = repl::oplog_entry_compression::decompressOplogEntry(storedOplogEntry);
+    if (!swOplogEntry.isOK()) {
+        return swOplogEntry.getStatus();
+    }
+    const BSONObj& oplogEntry = swOplogEntry.getValue();
+
     BSONElement opTypeElem = oplogEntry["op"];
     checkBSONType(BSONType::String, opTypeElem);
     const StringData opType = opTypeElem.checkAndGetStringData();
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/concurrency/flow_control_ticketholder.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+const auto getFlowControlTicketholder =
+    ServiceContext::declareDecoration<std::unique_ptr<FlowControlTicketholder>>();
+
+}  // namespace
+
+FlowControlTicketholder* FlowControlTicketholder::get(ServiceContext* service) {
+    return getFlowControlTicketholder(service).get();
+}
+
+FlowControlTicketholder* FlowControlTicketholder::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+void FlowControlTicketholder::set(ServiceContext* service,
+                                  std::unique_ptr<FlowControlTicketholder> flowControlTicketholder) {
+    getFlowControlTicketholder(service) = std::move(flowControlTicketholder);
+}
+
+void FlowControlTicketholder::refreshTo(int numTickets) {
+    invariant(numTickets >= 0);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _tickets.store(numTickets);
+    _newTickets.notify_all();
+}
+
+bool FlowControlTicketholder::_tryTakeTicket() {
+    auto tickets = _tickets.load();
+    while (tickets > 0) {
+        const auto previous = _tickets.compareAndSwap(tickets, tickets - 1);
+        if (previous == tickets) {
+            return true;
+        }
+        tickets = previous;
+    }
+    return false;
+}
+
+bool FlowControlTicketholder::getTicket(OperationContext* opCtx, Date_t deadline) {
+    if (!_tryTakeTicket()) {
+        _acquireWaitCount.addAndFetch(1);
+        Timer timer;
+        ON_BLOCK_EXIT([&] { _totalTimeAcquiringMicros.addAndFetch(timer.micros()); });
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (!opCtx->waitForConditionOrInterruptUntil(
+                _newTickets, lk, deadline, [this] { return _tryTakeTicket(); })) {
+            return false;
+        }
+    }
+    _acquireCount.addAndFetch(1);
+    return true;
+}
+
+void FlowControlTicketholder::appendStats(BSONObjBuilder* builder) const {
+    builder->append("acquireCount", _acquireCount.load());
+    builder->append("acquireWaitCount", _acquireWaitCount.load());
+    builder->append("timeAcquiringMicros", _totalTimeAcquiringMicros.load());
+}
+
+}  // namespace mongo
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Hands out the tickets replication flow control uses to limit the rate at which a primary accepts
+ * writes. Unlike a TicketHolder, tickets are consumed rather than released: the number of
+ * available tickets is periodically reset with 'refreshTo', so the number of tickets given to each
+ * refresh bounds the number of write operations that can start until the next one.
+ */
+class FlowControlTicketholder {
+    MONGO_DISALLOW_COPYING(FlowControlTicketholder);
+
+public:
+    explicit FlowControlTicketholder(int startTickets) : _tickets(startTickets) {}
+
+    /**
+     * Returns the FlowControlTicketholder for the service, or nullptr if flow control is not in
+     * use.
+     */
+    static FlowControlTicketholder* get(ServiceContext* service);
+    static FlowControlTicketholder* get(OperationContext* opCtx);
+
+    static void set(ServiceContext* service,
+                    std::unique_ptr<FlowControlTicketholder> flowControlTicketholder);
+
+    /**
+     * Sets the number of tickets available until the next refresh and wakes up any operation
+     * waiting for a ticket.
+     */
+    void refreshTo(int numTickets);
+
+    /**
+     * Whether operations should take tickets at all. Only governs callers which check it first;
+     * getTicket() hands out tickets regardless.
+     */
+    bool isEnabled() const {
+        return _enabled.load();
+    }
+
+    void setEnabled(bool enabled) {
+        _enabled.store(enabled);
+    }
+
+    /**
+     * Takes a ticket, blocking until one is available or 'deadline' passes, in which case it
+     * returns false. Throws an AssertionException if 'opCtx' is interrupted while waiting. Only
+     * takes the mutex when no ticket is available.
+     */
+    bool getTicket(OperationContext* opCtx, Date_t deadline = Date_t::max());
+
+    /**
+     * Returns the total number of tickets handed out.
+     */
+    long long getNumAcquisitions() const {
+        return _acquireCount.load();
+    }
+
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    /**
+     * Takes a ticket if one is available.
+     */
+    bool _tryTakeTicket();
+
+    // Guards waiting on _newTickets, so that a refresh can't be missed by an operation about to
+    // wait for one.
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _newTickets;
+
+    // The number of tickets available until the next refresh.
+    AtomicInt32 _tickets;
+
+    AtomicBool _enabled{true};
+
+    AtomicInt64 _acquireCount{0};
+    AtomicInt64 _acquireWaitCount{0};
+    AtomicInt64 _totalTimeAcquiringMicros{0};
+};
+
+}  // namespace mongo
@@ -34,6 +34,7 @@
 
 #include <vector>
 
+#include "mongo/db/concurrency/flow_control_ticketholder.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/service_context.h"
 #include "mongo/platform/compiler.h"
@@ -341,6 +342,17 @@ LockResult LockerImpl<IsForMMAPV1>::_lockGlobalBegin(OperationContext* opCtx,
                                                      Date_t deadline) {
     dassert(isLocked() == (_modeForTicket != MODE_NONE));
     if (_modeForTicket == MODE_NONE) {
+        // Operations that will replicate their writes may be throttled by flow control before
+        // taking the global lock, so that secondaries can keep up with the primary.
+        if (opCtx && mode == MODE_IX && opCtx->writesAreReplicated() && shouldAcquireTicket() &&
+            shouldParticipateInFlowControl()) {
+            auto flowControlTicketholder = FlowControlTicketholder::get(opCtx);
+            if (flowControlTicketholder && flowControlTicketholder->isEnabled() &&
+                !flowControlTicketholder->getTicket(opCtx, deadline)) {
+                return LOCK_TIMEOUT;
+            }
+        }
+
         auto acquireTicketResult = _acquireTicket(opCtx, mode, deadline);
         if (acquireTicketResult != LOCK_OK) {
             return acquireTicketResult;
@@ -385,6 +385,18 @@ public:
         return _shouldAcquireTicket;
     }
 
+    /**
+     * If set to false, this opts out of replication flow control, which may otherwise throttle
+     * the acquisition of the global lock in MODE_IX for operations that replicate their writes.
+     * This should only be used by internal operations whose writes must not be delayed.
+     */
+    void setShouldParticipateInFlowControl(bool newValue) {
+        invariant(!isLocked());
+        _shouldParticipateInFlowControl = newValue;
+    }
+    bool shouldParticipateInFlowControl() const {
+        return _shouldParticipateInFlowControl;
+    }
 
 protected:
     Locker() {}
@@ -400,6 +412,7 @@ protected:
 private:
     bool _shouldConflictWithSecondaryBatchApplication = true;
     bool _shouldAcquireTicket = true;
+    bool _shouldParticipateInFlowControl = true;
 };
 
 /**
@@ -96,6 +96,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database_and_check_version.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
+#include "mongo/db/repl/flow_control.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_consistency_markers_impl.h"
@@ -575,6 +576,13 @@ ExitCode _initAndListen(int listenPort) {
     runner->startup().transitional_ignore();
     serviceContext->setPeriodicRunner(std::move(runner));
 
+    // Set up flow control, which throttles writes on a primary whose secondaries fall behind.
+    if (replSettings.usingReplSets()) {
+        auto replCoord = repl::ReplicationCoordinator::get(serviceContext);
+        repl::FlowControl::set(serviceContext,
+                               stdx::make_unique<repl::FlowControl>(serviceContext, replCoord));
+    }
+
     SessionKiller::set(serviceContext,
                        std::make_shared<SessionKiller>(serviceContext, killSessionsLocal));
 
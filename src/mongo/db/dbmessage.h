@@ -444,8 +444,9 @@ Message makeGetMoreMessage(StringData ns, long long cursorId, int nToReturn, int
  * Order of fields makes DbResponse{funcReturningMessage()} valid.
  */
 struct DbResponse {
-    Message response;       // If empty, nothing will be returned to the client.
-    std::string exhaustNS;  // Namespace of cursor if exhaust mode, else "".
+    Message response;        // If empty, nothing will be returned to the client.
+    std::string exhaustNS;   // Namespace of cursor if exhaust mode, else "".
+    BSONObj nextInvocation;  // Command to run next if streaming an OP_MSG exhaust cursor, else {}.
 };
 
 /**
@@ -52,9 +52,13 @@ const char* ShardFilterStage::kStageType = "SHARDING_FILTER";
 
 ShardFilterStage::ShardFilterStage(OperationContext* opCtx,
                                    ScopedCollectionMetadata metadata,
+                                   bool resultsOwned,
                                    WorkingSet* ws,
                                    PlanStage* child)
-    : PlanStage(kStageType, opCtx), _ws(ws), _metadata(std::move(metadata)) {
+    : PlanStage(kStageType, opCtx),
+      _ws(ws),
+      _metadata(std::move(metadata)),
+      _resultsOwned(resultsOwned) {
     _children.emplace_back(child);
 }
 
@@ -76,8 +80,8 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
         // If we're sharded make sure that we don't return data that is not owned by us,
         // including pending documents from in-progress migrations and orphaned documents from
         // aborted migrations
-        if (_metadata) {
-            ShardKeyPattern shardKeyPattern(_metadata->getKeyPattern());
+        if (_metadata && !_resultsOwned) {
+            const auto& shardKeyPattern = _metadata->getChunkManager()->getShardKeyPattern();
             WorkingSetMember* member = _ws->get(*out);
             WorkingSetMatchableDocument matchable(member);
             BSONObj shardKey = shardKeyPattern.extractShardKeyFromMatchable(matchable);
@@ -65,6 +65,9 @@ namespace mongo {
  *
  * END NOTE FROM GREG
  *
+ * If the caller has established that the query can only match documents in ranges owned by the
+ * shard, there can be no orphans among the results and the stage returns them without checking.
+ *
  * Preconditions: Child must be fetched.  TODO: when covering analysis is in just build doc
  * and check that against shard key.  See SERVER-5022.
  */
@@ -72,6 +75,7 @@ class ShardFilterStage final : public PlanStage {
 public:
     ShardFilterStage(OperationContext* opCtx,
                      ScopedCollectionMetadata metadata,
+                     bool resultsOwned,
                      WorkingSet* ws,
                      PlanStage* child);
     ~ShardFilterStage();
@@ -98,6 +102,9 @@ private:
     // Note: it is important that this is the metadata from the time this stage is constructed.
     // See class comment for details.
     ScopedCollectionMetadata _metadata;
+
+    // Whether all the documents, which the query can match, are known to be owned by this shard
+    const bool _resultsOwned;
 };
 
 }  // namespace mongo
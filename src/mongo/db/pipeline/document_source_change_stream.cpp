@@ -44,6 +44,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/resume_token.h"
 #include "mongo/db/repl/oplog_entry.h"
+#include "mongo/db/repl/oplog_entry_compression.h"
 #include "mongo/db/repl/oplog_entry_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/s/catalog_cache.h"
@@ -398,7 +399,8 @@ intrusive_ptr<DocumentSource> DocumentSourceChangeStream::createTransformationSt
         kStageName.toString()));
 }
 
-Document DocumentSourceChangeStream::Transformation::applyTransformation(const Document& input) {
+Document DocumentSourceChangeStream::Transformation::applyTransformation(
+    const Document& storedInput) {
     // If we're executing a change stream pipeline that was forwarded from mongos, then we expect it
     // to "need merge"---we expect to be executing the shards part of a split pipeline. It is never
     // correct for mongos to pass through the change stream without splitting into into a merging
@@ -415,6 +417,14 @@ Document DocumentSourceChangeStream::Transformation::applyTransformation(const D
         invariant(_expCtx->needsMerge);
     }
 
+    // Inserts and replacements of large documents may be stored in the oplog with a compressed 'o'
+    // field, which has to be expanded before the change can be described.
+    const Document input =
+        storedInput[repl::oplog_entry_compression::kCompressedObjectFieldName].missing()
+        ? storedInput
+        : Document(uassertStatusOK(
+              repl::oplog_entry_compression::decompressOplogEntry(storedInput.toBson())));
+
     MutableDocument doc;
 
     // Extract the fields we need.
@@ -588,6 +598,7 @@ DocumentSource::GetDepsReturn DocumentSourceChangeStream::Transformation::addDep
     deps->fields.insert(repl::OplogEntry::kUuidFieldName.toString());
     deps->fields.insert(repl::OplogEntry::kObjectFieldName.toString());
     deps->fields.insert(repl::OplogEntry::kObject2FieldName.toString());
+    deps->fields.insert(repl::oplog_entry_compression::kCompressedObjectFieldName.toString());
     return DocumentSource::GetDepsReturn::EXHAUSTIVE_ALL;
 }
 
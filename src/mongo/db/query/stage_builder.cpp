@@ -294,11 +294,16 @@ PlanStage* buildStages(OperationContext* opCtx,
             if (nullptr == childStage) {
                 return nullptr;
             }
-            return new ShardFilterStage(
-                opCtx,
-                CollectionShardingState::get(opCtx, collection->ns())->getMetadata(),
-                ws,
-                childStage);
+
+            auto metadata = CollectionShardingState::get(opCtx, collection->ns())->getMetadata();
+
+            // If the shard key bounds of the query are entirely within ranges owned by this shard,
+            // there can be no orphan documents among the results
+            const bool resultsOwned = metadata &&
+                metadata->queryBelongsToMe(
+                    opCtx, cq.getQueryObj(), cq.getQueryRequest().getCollation());
+
+            return new ShardFilterStage(opCtx, std::move(metadata), resultsOwned, ws, childStage);
         }
         case STAGE_KEEP_MUTATIONS: {
             const KeepMutationsNode* km = static_cast<const KeepMutationsNode*>(root);
@@ -48,6 +48,7 @@
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/collation/collation_spec.h"
+#include "mongo/db/repl/oplog_entry_compression.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/rpc/get_status_from_command_result.h"
@@ -119,7 +120,11 @@ Status _applyOps(OperationContext* opCtx,
     const bool haveWrappingWUOW = opCtx->lockState()->inAWriteUnitOfWork();
 
     // Apply each op in the given 'applyOps' command object.
-    for (const auto& opObj : ops) {
+    for (const auto& storedOpObj : ops) {
+        // Operations copied from the oplog may store their 'o' field compressed.
+        const auto opObj =
+            uassertStatusOK(oplog_entry_compression::decompressOplogEntry(storedOpObj));
+
         // Ignore 'n' operations.
         const char* opType = opObj["op"].valuestrsafe();
         if (*opType == 'n')
@@ -0,0 +1,219 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/flow_control.h"
+
+#include <algorithm>
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/concurrency/flow_control_ticketholder.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/periodic_runner.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+// Off by default, since throttling writes trades primary throughput for majority write latency,
+// which only some deployments want.
+MONGO_EXPORT_SERVER_PARAMETER(enableFlowControl, bool, false);
+
+// The majority commit point lag flow control tries to stay under.
+MONGO_EXPORT_SERVER_PARAMETER(flowControlTargetLagSeconds, int, 10);
+
+// The fraction of the target lag above which writes start being throttled.
+MONGO_EXPORT_SERVER_PARAMETER(flowControlThresholdLagPercentage, double, 0.5);
+
+// The lowest rate flow control throttles writes to, so that the primary always makes progress.
+MONGO_EXPORT_SERVER_PARAMETER(flowControlMinTicketsPerSecond, int, 100);
+
+// Control how quickly the rate grows back once the lag drops below the threshold.
+MONGO_EXPORT_SERVER_PARAMETER(flowControlTicketAdderConstant, int, 1000);
+MONGO_EXPORT_SERVER_PARAMETER(flowControlTicketMultiplierConstant, double, 1.05);
+
+// How often the number of tickets is recomputed. The number of tickets is a rate per period.
+const Milliseconds kRefreshPeriod = Seconds(1);
+
+const auto getFlowControl = ServiceContext::declareDecoration<std::unique_ptr<FlowControl>>();
+
+class FlowControlServerStatusSection : public ServerStatusSection {
+public:
+    FlowControlServerStatusSection() : ServerStatusSection("flowControl") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONObjBuilder builder;
+        if (auto flowControl = FlowControl::get(opCtx->getServiceContext())) {
+            flowControl->appendStats(&builder);
+        }
+        return builder.obj();
+    }
+} flowControlServerStatusSection;
+
+}  // namespace
+
+constexpr int FlowControl::kMaxTickets;
+
+FlowControl::FlowControl(ServiceContext* service, ReplicationCoordinator* replCoord)
+    : _service(service), _replCoord(replCoord) {}
+
+FlowControl* FlowControl::get(ServiceContext* service) {
+    return getFlowControl(service).get();
+}
+
+void FlowControl::set(ServiceContext* service, std::unique_ptr<FlowControl> flowControl) {
+    auto flowControlPtr = flowControl.get();
+    getFlowControl(service) = std::move(flowControl);
+    auto ticketholder = stdx::make_unique<FlowControlTicketholder>(kMaxTickets);
+    ticketholder->setEnabled(enableFlowControl.load());
+    FlowControlTicketholder::set(service, std::move(ticketholder));
+
+    if (auto runner = service->getPeriodicRunner()) {
+        runner->scheduleJob(
+            {[flowControlPtr](Client*) { flowControlPtr->_refresh(); }, kRefreshPeriod});
+    }
+}
+
+long long FlowControl::_getLagSeconds() const {
+    if (_replCoord->getReplicationMode() != ReplicationCoordinator::modeReplSet ||
+        !_replCoord->getMemberState().primary()) {
+        return 0;
+    }
+
+    // The commit point is null until a majority of the set has been heard from after startup.
+    const auto lastCommitted = _replCoord->getLastCommittedOpTime();
+    if (lastCommitted.isNull()) {
+        return 0;
+    }
+
+    const auto lastApplied = _replCoord->getMyLastAppliedOpTime();
+    return std::max(0LL,
+                    static_cast<long long>(lastApplied.getTimestamp().getSecs()) -
+                        lastCommitted.getTimestamp().getSecs());
+}
+
+int FlowControl::getNumTickets(long long ticketsUsed) {
+    const auto lagSeconds = _getLagSeconds();
+    const auto lastCommitted = _replCoord->getLastCommittedOpTime();
+    const int targetLagSeconds = flowControlTargetLagSeconds.load();
+    const double thresholdLagSeconds = targetLagSeconds * flowControlThresholdLagPercentage.load();
+    const int minTickets = std::max(1, flowControlMinTicketsPerSecond.load());
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _lastLagSeconds = lagSeconds;
+
+    // Secondaries falling behind still move the commit point. One which does not move at all for
+    // the whole target lag means a majority of the set is unreachable, for example the secondary
+    // of a primary-secondary-arbiter set being down, and no amount of throttling brings it back.
+    if (lastCommitted != _lastCommittedOpTime) {
+        _lastCommittedOpTime = lastCommitted;
+        _commitPointStalledPeriods = 0;
+    } else if (lagSeconds > 0) {
+        ++_commitPointStalledPeriods;
+    }
+    const bool isMajorityUnreachable = _commitPointStalledPeriods >= targetLagSeconds;
+
+    int tickets = kMaxTickets;
+    if (!enableFlowControl.load() || isMajorityUnreachable) {
+        if (_isLagged && isMajorityUnreachable) {
+            log() << "Flow control stopped throttling writes; majority commit point has not moved "
+                  << "for " << _commitPointStalledPeriods << " seconds";
+        }
+        _isLagged = false;
+    } else if (lagSeconds <= thresholdLagSeconds) {
+        _isLagged = false;
+        if (_lastTargetTicketsPermitted < kMaxTickets) {
+            // Grow back towards an unlimited rate rather than releasing every queued writer at
+            // once, which would make the lag spike again.
+            tickets = static_cast<int>(std::min<double>(
+                kMaxTickets,
+                _lastTargetTicketsPermitted * flowControlTicketMultiplierConstant.load() +
+                    flowControlTicketAdderConstant.load()));
+        }
+    } else {
+        if (!_isLagged) {
+            log() << "Flow control is throttling writes; majority commit point lag is "
+                  << lagSeconds << " seconds";
+        }
+        _isLagged = true;
+        ++_isLaggedCount;
+
+        // Start from the rate writes were actually accepted at, since the number of tickets may be
+        // far above what the workload needs, then cut it in proportion to the excess lag.
+        const auto base = std::min<long long>(_lastTargetTicketsPermitted, ticketsUsed);
+        tickets = static_cast<int>(base * thresholdLagSeconds / lagSeconds);
+    }
+
+    _lastTargetTicketsPermitted = std::max(minTickets, tickets);
+    return _lastTargetTicketsPermitted;
+}
+
+void FlowControl::_refresh() {
+    auto ticketholder = FlowControlTicketholder::get(_service);
+    invariant(ticketholder);
+
+    // Writers don't take tickets while flow control is disabled, so the tickets used in a period
+    // it was disabled for say nothing about the rate writes were accepted at.
+    const auto acquisitions = ticketholder->getNumAcquisitions();
+    const auto ticketsUsed =
+        ticketholder->isEnabled() ? acquisitions - _lastAcquisitions : kMaxTickets;
+    _lastAcquisitions = acquisitions;
+
+    ticketholder->setEnabled(enableFlowControl.load());
+    ticketholder->refreshTo(getNumTickets(ticketsUsed));
+}
+
+void FlowControl::appendStats(BSONObjBuilder* builder) const {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        builder->append("enabled", enableFlowControl.load());
+        builder->append("targetRateLimit", _lastTargetTicketsPermitted);
+        builder->append("isLagged", _isLagged);
+        builder->append("isLaggedCount", _isLaggedCount);
+        builder->append("lagSeconds", _lastLagSeconds);
+    }
+
+    if (auto ticketholder = FlowControlTicketholder::get(_service)) {
+        ticketholder->appendStats(builder);
+    }
+}
+
+}  // namespace repl
+}  // namespace mongo
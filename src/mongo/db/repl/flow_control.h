@@ -0,0 +1,123 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class ServiceContext;
+
+namespace repl {
+
+class ReplicationCoordinator;
+
+/**
+ * Flow control keeps the majority commit point of a replica set from falling arbitrarily far
+ * behind the primary. Once per period, the primary compares its last applied optime to the
+ * majority commit point, which the TopologyCoordinator derives from the member data it keeps for
+ * every node, and decides how many write operations may start until the next period. The decision
+ * is enforced by the FlowControlTicketholder, which operations acquire a ticket from before taking
+ * the global lock in MODE_IX. While flow control is disabled, they skip the ticketholder entirely.
+ *
+ * While the lag is below a threshold, the rate is either unlimited or grows back towards it.
+ * Beyond the threshold, the rate is cut in proportion to how far the lag exceeds it, starting from
+ * the number of tickets actually used in the previous period. Writes are not throttled while the
+ * commit point has not moved for the whole target lag, since a majority of the set is then
+ * unreachable rather than behind.
+ */
+class FlowControl {
+    MONGO_DISALLOW_COPYING(FlowControl);
+
+public:
+    // The number of tickets handed out when writes are not being throttled.
+    static constexpr int kMaxTickets = 1000 * 1000 * 1000;
+
+    FlowControl(ServiceContext* service, ReplicationCoordinator* replCoord);
+
+    static FlowControl* get(ServiceContext* service);
+
+    /**
+     * Installs 'flowControl' on the service along with its FlowControlTicketholder, and schedules
+     * the job that refreshes the ticketholder on the service's PeriodicRunner, if it has one.
+     */
+    static void set(ServiceContext* service, std::unique_ptr<FlowControl> flowControl);
+
+    /**
+     * Computes the number of tickets to hand out during the next period. 'ticketsUsed' is the
+     * number of tickets acquired during the period that just ended. Should be called once per
+     * period.
+     */
+    int getNumTickets(long long ticketsUsed);
+
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    /**
+     * Returns how far, in seconds, the majority commit point is behind this node's last applied
+     * optime, or 0 if flow control does not apply to this node.
+     */
+    long long _getLagSeconds() const;
+
+    /**
+     * Recomputes the number of tickets and hands them to the FlowControlTicketholder.
+     */
+    void _refresh();
+
+    ServiceContext* const _service;
+    ReplicationCoordinator* const _replCoord;
+
+    mutable stdx::mutex _mutex;
+
+    // The number of tickets handed out for the current period.
+    int _lastTargetTicketsPermitted = kMaxTickets;
+
+    // The number of tickets the FlowControlTicketholder had handed out at the last refresh.
+    long long _lastAcquisitions = 0;
+
+    // The majority commit point lag observed at the last refresh.
+    long long _lastLagSeconds = 0;
+
+    // The majority commit point at the last refresh, and for how many refreshes it has been lagging
+    // without moving.
+    OpTime _lastCommittedOpTime;
+    int _commitPointStalledPeriods = 0;
+
+    // Whether the last refresh found the lag above the threshold, and how many refreshes did.
+    bool _isLagged = false;
+    long long _isLaggedCount = 0;
+};
+
+}  // namespace repl
+}  // namespace mongo
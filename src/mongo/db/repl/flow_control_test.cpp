@@ -0,0 +1,193 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/flow_control_ticketholder.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/repl/flow_control.h"
+#include "mongo/db/repl/replication_coordinator_mock.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+// Sets a server parameter for the lifetime of the object.
+class ScopedServerParameter {
+public:
+    ScopedServerParameter(StringData name, StringData value) : _parameter(_find(name)) {
+        BSONObjBuilder builder;
+        _parameter->append(nullptr, builder, "value");
+        _original = builder.obj();
+        ASSERT_OK(_parameter->setFromString(value.toString()));
+    }
+
+    ~ScopedServerParameter() {
+        _parameter->set(_original["value"]).transitional_ignore();
+    }
+
+private:
+    static ServerParameter* _find(StringData name) {
+        const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+        auto it = parameters.find(name.toString());
+        invariant(it != parameters.end());
+        return it->second;
+    }
+
+    ServerParameter* _parameter;
+    BSONObj _original;
+};
+
+class FlowControlTest : public unittest::Test {
+private:
+    ScopedServerParameter _enabled{"enableFlowControl", "true"};
+
+protected:
+    void setUp() override {
+        _replCoord = stdx::make_unique<ReplicationCoordinatorMock>(getGlobalServiceContext());
+        ASSERT_OK(_replCoord->setFollowerMode(MemberState::RS_PRIMARY));
+        _flowControl = stdx::make_unique<FlowControl>(getGlobalServiceContext(), _replCoord.get());
+    }
+
+    /**
+     * Makes the majority commit point lag 'lagSeconds' behind the last applied optime.
+     */
+    void setLag(unsigned lagSeconds) {
+        _replCoord->setMyLastAppliedOpTime(OpTime(Timestamp(1000 + lagSeconds, 1), 1));
+        _replCoord->setLastCommittedOpTime(OpTime(Timestamp(1000, 1), 1));
+    }
+
+    std::unique_ptr<ReplicationCoordinatorMock> _replCoord;
+    std::unique_ptr<FlowControl> _flowControl;
+};
+
+TEST_F(FlowControlTest, DoesNotThrottleWhenLagIsBelowThreshold) {
+    setLag(1);
+    ASSERT_EQ(FlowControl::kMaxTickets, _flowControl->getNumTickets(10000));
+}
+
+TEST_F(FlowControlTest, DoesNotThrottleWithoutCommitPoint) {
+    _replCoord->setMyLastAppliedOpTime(OpTime(Timestamp(1000, 1), 1));
+    ASSERT_EQ(FlowControl::kMaxTickets, _flowControl->getNumTickets(10000));
+}
+
+TEST_F(FlowControlTest, DoesNotThrottleOnSecondary) {
+    ASSERT_OK(_replCoord->setFollowerMode(MemberState::RS_SECONDARY));
+    setLag(60);
+    ASSERT_EQ(FlowControl::kMaxTickets, _flowControl->getNumTickets(10000));
+}
+
+TEST_F(FlowControlTest, ThrottlesInProportionToLag) {
+    // With the default target of 10 seconds, writes are throttled above 5 seconds of lag.
+    setLag(20);
+    ASSERT_EQ(2500, _flowControl->getNumTickets(10000));
+
+    // The next cut starts from the number of tickets handed out, not the number used.
+    setLag(10);
+    ASSERT_EQ(1250, _flowControl->getNumTickets(10000));
+}
+
+TEST_F(FlowControlTest, DoesNotThrottleWhenDisabled) {
+    ScopedServerParameter disabled("enableFlowControl", "false");
+    setLag(60);
+    ASSERT_EQ(FlowControl::kMaxTickets, _flowControl->getNumTickets(10000));
+}
+
+TEST_F(FlowControlTest, StopsThrottlingWhileCommitPointDoesNotMove) {
+    setLag(20);
+    ASSERT_EQ(2500, _flowControl->getNumTickets(10000));
+
+    // A commit point which does not move for the whole target lag of 10 seconds means a majority
+    // of the set is unreachable, so throttling stops.
+    for (unsigned i = 1; i < 10; ++i) {
+        setLag(20 + i);
+        ASSERT_LT(_flowControl->getNumTickets(10000), FlowControl::kMaxTickets);
+    }
+    setLag(30);
+    ASSERT_EQ(FlowControl::kMaxTickets, _flowControl->getNumTickets(10000));
+
+    // Once the commit point moves again, the lag is worth throttling for.
+    _replCoord->setLastCommittedOpTime(OpTime(Timestamp(1001, 1), 1));
+    ASSERT_LT(_flowControl->getNumTickets(10000), FlowControl::kMaxTickets);
+}
+
+TEST_F(FlowControlTest, NeverThrottlesBelowMinimumRate) {
+    setLag(60);
+    ASSERT_EQ(100, _flowControl->getNumTickets(0));
+}
+
+TEST_F(FlowControlTest, GrowsRateBackAfterLagRecovers) {
+    setLag(20);
+    ASSERT_EQ(2500, _flowControl->getNumTickets(10000));
+
+    setLag(0);
+    ASSERT_EQ(3625, _flowControl->getNumTickets(2500));
+}
+
+TEST(FlowControlTicketholderTest, TicketsAreConsumedUntilRefresh) {
+    auto client = getGlobalServiceContext()->makeClient("FlowControlTicketholderTest");
+    auto opCtx = client->makeOperationContext();
+
+    FlowControlTicketholder ticketholder(2);
+    ticketholder.getTicket(opCtx.get());
+    ticketholder.getTicket(opCtx.get());
+    ASSERT_EQ(2, ticketholder.getNumAcquisitions());
+
+    // No tickets are left, so the next acquisition waits until the lock deadline of the caller
+    ASSERT_FALSE(ticketholder.getTicket(opCtx.get(), Date_t::now() + Milliseconds(10)));
+
+    // or the deadline of the operation.
+    opCtx->setDeadlineAfterNowBy(Milliseconds(10));
+    ASSERT_THROWS_CODE(
+        ticketholder.getTicket(opCtx.get()), AssertionException, ErrorCodes::ExceededTimeLimit);
+    ASSERT_EQ(2, ticketholder.getNumAcquisitions());
+
+    BSONObjBuilder stats;
+    ticketholder.appendStats(&stats);
+    ASSERT_EQ(2, stats.obj()["acquireWaitCount"].numberLong());
+}
+
+TEST(FlowControlTicketholderTest, RefreshMakesTicketsAvailable) {
+    auto client = getGlobalServiceContext()->makeClient("FlowControlTicketholderTest");
+    auto opCtx = client->makeOperationContext();
+
+    FlowControlTicketholder ticketholder(0);
+    ticketholder.refreshTo(1);
+    ticketholder.getTicket(opCtx.get());
+    ASSERT_EQ(1, ticketholder.getNumAcquisitions());
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -140,6 +140,9 @@ void NoopWriter::stopWritingPeriodicNoops() {
 }
 
 void NoopWriter::_writeNoop(OperationContext* opCtx) {
+    // The noop writes keep the majority commit point moving, so flow control must not delay them.
+    opCtx->lockState()->setShouldParticipateInFlowControl(false);
+
     // Use GlobalLock + lockMMAPV1Flush instead of DBLock to allow return when the lock is not
     // available. It may happen when the primary steps down and a shared global lock is acquired.
     Lock::GlobalLock lock(opCtx, MODE_IX, Date_t::now() + Milliseconds(1));
@@ -76,12 +76,14 @@
 #include "mongo/db/repl/apply_ops.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/dbcheck.h"
+#include "mongo/db/repl/oplog_entry_compression.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/sync_tail.h"
 #include "mongo/db/repl/timestamp_block.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/session_catalog.h"
@@ -134,6 +136,33 @@ Timestamp lastSetTimestamp;
 
 static std::string _oplogCollectionName;
 
+// Inserts and replacements of documents at least this large are logged with a compressed 'o'
+// field. Zero disables compression. Entries are only compressed while the
+// featureCompatibilityVersion is fully upgraded to 4.0, so that every member of the replica set can
+// read them. Note that plain finds on the oplog return compressed entries as they are stored, with
+// an 'oz' field in place of 'o'; see oplog_entry_compression.h.
+AtomicInt32 oplogEntryCompressionMinObjectSizeBytes{0};
+
+class ExportedOplogEntryCompressionMinObjectSizeParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedOplogEntryCompressionMinObjectSizeParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "oplogEntryCompressionMinObjectSizeBytes",
+              &oplogEntryCompressionMinObjectSizeBytes) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "oplogEntryCompressionMinObjectSizeBytes must be greater than or equal "
+                          "to 0");
+        }
+
+        return Status::OK();
+    }
+} exportedOplogEntryCompressionMinObjectSizeParam;
+
 // so we can fail the same way
 void checkOplogInsert(Status result) {
     massert(17322, str::stream() << "write to oplog failed: " << result.toString(), result.isOK());
@@ -184,9 +213,20 @@ public:
     OplogDocWriter(BSONObj frame, BSONObj oField)
         : _frame(std::move(frame)), _oField(std::move(oField)) {}
 
+    /**
+     * Writes 'frame' as the whole document. Used when the frame already holds the compressed form
+     * of the 'o' field.
+     */
+    explicit OplogDocWriter(BSONObj frame) : _frame(std::move(frame)), _hasOField(false) {}
+
     void writeDocument(char* start) const {
         char* buf = start;
 
+        if (!_hasOField) {
+            memcpy(buf, _frame.objdata(), _frame.objsize());
+            return;
+        }
+
         memcpy(buf, _frame.objdata(), _frame.objsize() - 1);  // don't copy final EOO
 
         DataView(buf).write<LittleEndian<int>>(documentSize());
@@ -203,12 +243,16 @@ public:
     }
 
     size_t documentSize() const {
+        if (!_hasOField) {
+            return _frame.objsize();
+        }
         return _frame.objsize() + _oField.objsize() + 1 /* type */ + 2 /* "o" */;
     }
 
 private:
     BSONObj _frame;
     BSONObj _oField;
+    bool _hasOField = true;
 };
 
 }  // namespace
@@ -347,6 +391,17 @@ OplogDocWriter _logOpWriter(OperationContext* opCtx,
     b.appendDate("wall", wallTime);
 
     appendSessionInfo(opCtx, &b, statementId, sessionInfo, oplogLink);
+
+    const int compressionMinObjectSize = oplogEntryCompressionMinObjectSizeBytes.load();
+    if (compressionMinObjectSize > 0 && obj.objsize() >= compressionMinObjectSize &&
+        serverGlobalParams.featureCompatibility.isVersionInitialized() &&
+        serverGlobalParams.featureCompatibility.getVersion() ==
+            ServerGlobalParams::FeatureCompatibility::Version::kFullyUpgradedTo40 &&
+        oplog_entry_compression::canCompressObjectField(opstr, obj) &&
+        oplog_entry_compression::appendCompressedObjectField(obj, &b)) {
+        return OplogDocWriter(b.obj());
+    }
+
     return OplogDocWriter(OplogDocWriter(b.obj(), obj));
 }
 }  // end anon namespace
@@ -1003,6 +1058,17 @@ Status applyOperation_inlock(OperationContext* opCtx,
                              bool alwaysUpsert,
                              OplogApplication::Mode mode,
                              IncrementOpsAppliedStatsFn incrementOpsAppliedStats) {
+    // Entries which reach here without going through OplogEntry, such as those read back from the
+    // oplog during startup recovery or passed to applyOps, may store their 'o' field compressed.
+    if (oplog_entry_compression::hasCompressedObjectField(op)) {
+        auto swDecompressed = oplog_entry_compression::decompressOplogEntry(op);
+        if (!swDecompressed.isOK()) {
+            return swDecompressed.getStatus();
+        }
+        return applyOperation_inlock(
+            opCtx, db, swDecompressed.getValue(), alwaysUpsert, mode, incrementOpsAppliedStats);
+    }
+
     LOG(3) << "applying op: " << redact(op)
            << ", oplog application mode: " << OplogApplication::modeToString(mode);
 
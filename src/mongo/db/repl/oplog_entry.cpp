@@ -33,6 +33,7 @@
 #include "mongo/db/repl/oplog_entry.h"
 
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/repl/oplog_entry_compression.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -184,6 +185,13 @@ OplogEntry::OplogEntry(BSONObj rawInput)
     : raw(std::move(rawInput)), _commandType(OplogEntry::CommandType::kNotCommand) {
     raw = raw.getOwned();
 
+    // Entries with a compressed 'o' field are parsed from their decompressed form, but hold on to
+    // the stored form so that they can be written to the oplog as they were received.
+    if (oplog_entry_compression::hasCompressedObjectField(raw)) {
+        _compressedRaw = std::move(raw);
+        raw = uassertStatusOK(oplog_entry_compression::decompressOplogEntry(_compressedRaw));
+    }
+
     parseProtected(IDLParserErrorContext("OplogEntryBase"), raw);
 
     // Parse command type from 'o' and 'o2' fields.
@@ -286,6 +294,10 @@ OpTime OplogEntry::getOpTime() const {
     return OpTime(getTimestamp(), term);
 }
 
+const BSONObj& OplogEntry::getStoredRaw() const {
+    return _compressedRaw.isEmpty() ? raw : _compressedRaw;
+}
+
 std::string OplogEntry::toString() const {
     return raw.toString();
 }
@@ -138,6 +138,13 @@ public:
      */
     OpTime getOpTime() const;
 
+    /**
+     * Returns the oplog entry in the form in which it is stored in the oplog. This only differs
+     * from 'raw' for entries whose 'o' field is stored compressed, for which 'raw' holds the
+     * decompressed entry.
+     */
+    const BSONObj& getStoredRaw() const;
+
     /**
      * Serializes the oplog entry to a string.
      */
@@ -148,6 +155,9 @@ public:
 
 private:
     CommandType _commandType;
+
+    // The compressed form of the entry, if it was stored with a compressed 'o' field.
+    BSONObj _compressedRaw;
 };
 
 std::ostream& operator<<(std::ostream& s, const OplogEntry& o);
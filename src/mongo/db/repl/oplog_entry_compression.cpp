@@ -0,0 +1,176 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_entry_compression.h"
+
+#include <memory>
+
+#include "mongo/base/data_view.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/db/repl/oplog_entry_gen.h"
+#include "mongo/transport/message_compressor_snappy.h"
+#include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace repl {
+namespace oplog_entry_compression {
+
+namespace {
+
+// Size of the compressorId and uncompressedSize header in front of the compressed document.
+const int kHeaderSize = sizeof(uint8_t) + sizeof(int32_t);
+
+/**
+ * Returns the compressor for 'id'. The compressors are independent from the ones negotiated for
+ * network messages, so that entries can be decoded regardless of the networkMessageCompressors
+ * setting.
+ */
+MessageCompressorBase* getCompressor(MessageCompressorId id) {
+    static SnappyMessageCompressor snappyCompressor;
+    static ZlibMessageCompressor zlibCompressor;
+
+    if (id == snappyCompressor.getId()) {
+        return &snappyCompressor;
+    } else if (id == zlibCompressor.getId()) {
+        return &zlibCompressor;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+const StringData kCompressedObjectFieldName = "oz"_sd;
+
+bool canCompressObjectField(StringData opType, const BSONObj& oField) {
+    if (opType == OpType_serializer(OpTypeEnum::kInsert)) {
+        return true;
+    }
+
+    // Updates with modifiers are usually small and are left uncompressed, so that readers can
+    // still tell them apart from replacements without decompressing.
+    return opType == OpType_serializer(OpTypeEnum::kUpdate) && !oField.isEmpty() &&
+        oField.firstElementFieldName()[0] != '$';
+}
+
+bool appendCompressedObjectField(const BSONObj& oField, BSONObjBuilder* builder) {
+    auto compressor = getCompressor(static_cast<MessageCompressorId>(MessageCompressor::kSnappy));
+    invariant(compressor);
+
+    const size_t inputSize = oField.objsize();
+    const size_t bufferSize = kHeaderSize + compressor->getMaxCompressedSize(inputSize);
+    std::unique_ptr<char[]> buffer(new char[bufferSize]);
+
+    auto compressedSize =
+        compressor->compressData(ConstDataRange(oField.objdata(), inputSize),
+                                 DataRange(buffer.get() + kHeaderSize, bufferSize - kHeaderSize));
+    if (!compressedSize.isOK() || kHeaderSize + compressedSize.getValue() >= inputSize) {
+        return false;
+    }
+
+    DataView(buffer.get()).write<uint8_t>(compressor->getId());
+    DataView(buffer.get() + sizeof(uint8_t)).write<LittleEndian<int32_t>>(inputSize);
+    builder->appendBinData(kCompressedObjectFieldName,
+                           kHeaderSize + compressedSize.getValue(),
+                           BinDataGeneral,
+                           buffer.get());
+    return true;
+}
+
+bool hasCompressedObjectField(const BSONObj& entry) {
+    return entry.hasField(kCompressedObjectFieldName);
+}
+
+StatusWith<BSONObj> decompressOplogEntry(const BSONObj& entry) {
+    BSONElement compressedElem = entry[kCompressedObjectFieldName];
+    if (compressedElem.eoo()) {
+        return entry;
+    }
+
+    if (compressedElem.type() != BinData || compressedElem.binDataType() != BinDataGeneral) {
+        return {ErrorCodes::TypeMismatch,
+                str::stream() << "Expected the '" << kCompressedObjectFieldName
+                              << "' field of an oplog entry to be BinData, found: "
+                              << typeName(compressedElem.type())};
+    }
+
+    int compressedLength = 0;
+    const char* compressedData = compressedElem.binData(compressedLength);
+    if (compressedLength < kHeaderSize) {
+        return {ErrorCodes::BadValue, "Compressed oplog entry is too short"};
+    }
+
+    ConstDataView header(compressedData);
+    auto compressor = getCompressor(header.read<uint8_t>());
+    if (!compressor) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Compressed oplog entry uses an unknown compressor: "
+                              << static_cast<int>(header.read<uint8_t>())};
+    }
+
+    const int32_t uncompressedSize = header.read<LittleEndian<int32_t>>(sizeof(uint8_t));
+    if (uncompressedSize < BSONObj::kMinBSONLength || uncompressedSize > BSONObjMaxInternalSize) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Compressed oplog entry has an invalid uncompressed size: "
+                              << uncompressedSize};
+    }
+
+    auto buffer = SharedBuffer::allocate(uncompressedSize);
+    auto decompressedSize = compressor->decompressData(
+        ConstDataRange(compressedData + kHeaderSize, compressedLength - kHeaderSize),
+        DataRange(buffer.get(), uncompressedSize));
+    if (!decompressedSize.isOK()) {
+        return decompressedSize.getStatus();
+    }
+    if (decompressedSize.getValue() != static_cast<size_t>(uncompressedSize)) {
+        return {ErrorCodes::BadValue,
+                "Decompressed oplog entry size does not match the size in its header"};
+    }
+
+    auto status = validateBSON(buffer.get(), uncompressedSize, BSONVersion::kLatest);
+    if (!status.isOK()) {
+        return status;
+    }
+    BSONObj oField(std::move(buffer));
+
+    BSONObjBuilder builder(entry.objsize() + uncompressedSize);
+    for (auto&& elem : entry) {
+        if (elem.fieldNameStringData() == kCompressedObjectFieldName) {
+            builder.append(OplogEntryBase::kObjectFieldName, oField);
+        } else {
+            builder.append(elem);
+        }
+    }
+    return builder.obj();
+}
+
+}  // namespace oplog_entry_compression
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Oplog entries for inserts and full document replacements may store their 'o' field compressed,
+ * in which case the entry has a binary 'oz' field in place of 'o'. The payload of the 'oz' field
+ * is laid out like the body of an OP_COMPRESSED message:
+ *
+ *     uint8  compressorId      - the MessageCompressorId used to compress the document
+ *     int32  uncompressedSize  - little endian size of the 'o' document
+ *     ...    compressed bytes of the 'o' document
+ *
+ * Entries are forwarded between nodes and written to the oplog of secondaries in their stored
+ * form; they only get decompressed by consumers which need the contents of the 'o' field. Plain
+ * finds on local.oplog.rs return the stored form as well, so tools reading the oplog directly must
+ * call decompressOplogEntry() on entries for which hasCompressedObjectField() is true. Entries are
+ * only ever written compressed while the featureCompatibilityVersion is fully upgraded to 4.0.
+ */
+namespace oplog_entry_compression {
+
+extern const StringData kCompressedObjectFieldName;
+
+/**
+ * Returns true if an oplog entry of type 'opType' may store 'oField' compressed. Only inserts and
+ * full document replacements carry a whole document worth compressing.
+ */
+bool canCompressObjectField(StringData opType, const BSONObj& oField);
+
+/**
+ * Compresses 'oField' with snappy and appends it to 'builder' as the 'oz' field. Returns false and
+ * leaves 'builder' untouched if compressing did not make the document smaller.
+ */
+bool appendCompressedObjectField(const BSONObj& oField, BSONObjBuilder* builder);
+
+/**
+ * Returns true if the oplog entry 'entry' stores its 'o' field compressed.
+ */
+bool hasCompressedObjectField(const BSONObj& entry);
+
+/**
+ * Returns a copy of the oplog entry 'entry' with its 'oz' field replaced by the decompressed 'o'
+ * field, in the same position. Entries which are not compressed are returned unchanged.
+ */
+StatusWith<BSONObj> decompressOplogEntry(const BSONObj& entry);
+
+}  // namespace oplog_entry_compression
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_entry.h"
+#include "mongo/db/repl/oplog_entry_compression.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+using namespace oplog_entry_compression;
+
+BSONObj makeLargeDocument() {
+    return BSON("_id" << 1 << "payload" << std::string(64 * 1024, 'x'));
+}
+
+BSONObj makeCompressedInsert(const BSONObj& doc) {
+    BSONObjBuilder builder;
+    builder.append("ts", Timestamp(1, 1));
+    builder.append("t", 1LL);
+    builder.append("h", 1LL);
+    builder.append("v", 2);
+    builder.append("op", "i");
+    builder.append("ns", "test.coll");
+    ASSERT_TRUE(appendCompressedObjectField(doc, &builder));
+    builder.append("wall", Date_t());
+    return builder.obj();
+}
+
+TEST(OplogEntryCompressionTest, OnlyInsertsAndReplacementsCanBeCompressed) {
+    ASSERT_TRUE(canCompressObjectField("i", BSON("_id" << 1)));
+    ASSERT_TRUE(canCompressObjectField("u", BSON("_id" << 1 << "x" << 2)));
+    ASSERT_FALSE(canCompressObjectField("u", BSON("$set" << BSON("x" << 2))));
+    ASSERT_FALSE(canCompressObjectField("d", BSON("_id" << 1)));
+    ASSERT_FALSE(canCompressObjectField("c", BSON("create"
+                                                  << "coll")));
+}
+
+TEST(OplogEntryCompressionTest, IncompressibleDocumentIsNotAppended) {
+    BSONObjBuilder builder;
+    ASSERT_FALSE(appendCompressedObjectField(BSON("_id" << 1), &builder));
+    ASSERT_BSONOBJ_EQ(BSONObj(), builder.obj());
+}
+
+TEST(OplogEntryCompressionTest, DecompressRestoresObjectFieldInPlace) {
+    const auto doc = makeLargeDocument();
+    const auto compressed = makeCompressedInsert(doc);
+    ASSERT_TRUE(hasCompressedObjectField(compressed));
+    ASSERT_LT(compressed.objsize(), doc.objsize());
+
+    const auto entry = unittest::assertGet(decompressOplogEntry(compressed));
+    ASSERT_FALSE(hasCompressedObjectField(entry));
+    ASSERT_BSONOBJ_EQ(doc, entry.getObjectField("o"));
+
+    // The 'o' field takes the position of the 'oz' field.
+    std::vector<std::string> fieldNames;
+    for (auto&& elem : entry) {
+        fieldNames.push_back(elem.fieldName());
+    }
+    std::vector<std::string> expected{"ts", "t", "h", "v", "op", "ns", "o", "wall"};
+    ASSERT(expected == fieldNames);
+}
+
+TEST(OplogEntryCompressionTest, DecompressLeavesUncompressedEntryUnchanged) {
+    const auto entry = BSON("ts" << Timestamp(1, 1) << "op"
+                                 << "i"
+                                 << "o"
+                                 << BSON("_id" << 1));
+    ASSERT_BSONOBJ_EQ(entry, unittest::assertGet(decompressOplogEntry(entry)));
+}
+
+TEST(OplogEntryCompressionTest, DecompressRejectsCorruptPayload) {
+    ASSERT_EQ(ErrorCodes::TypeMismatch,
+              decompressOplogEntry(BSON(kCompressedObjectFieldName << 1)).getStatus());
+
+    // Too short to hold the header.
+    BSONObjBuilder tooShort;
+    tooShort.appendBinData(kCompressedObjectFieldName, 2, BinDataGeneral, "ab");
+    ASSERT_EQ(ErrorCodes::BadValue, decompressOplogEntry(tooShort.obj()).getStatus());
+
+    // Unknown compressor id.
+    const char unknownCompressor[] = {char(100), 16, 0, 0, 0, 'x'};
+    BSONObjBuilder unknown;
+    unknown.appendBinData(
+        kCompressedObjectFieldName, sizeof(unknownCompressor), BinDataGeneral, unknownCompressor);
+    ASSERT_EQ(ErrorCodes::BadValue, decompressOplogEntry(unknown.obj()).getStatus());
+
+    // Truncated compressed data.
+    const auto compressed = makeCompressedInsert(makeLargeDocument());
+    int length = 0;
+    const char* data = compressed[kCompressedObjectFieldName].binData(length);
+    BSONObjBuilder truncated;
+    truncated.appendBinData(kCompressedObjectFieldName, length / 2, BinDataGeneral, data);
+    ASSERT_NOT_OK(decompressOplogEntry(truncated.obj()).getStatus());
+}
+
+TEST(OplogEntryCompressionTest, OplogEntryParsesCompressedEntryAndKeepsStoredForm) {
+    const auto doc = makeLargeDocument();
+    const auto compressed = makeCompressedInsert(doc);
+
+    OplogEntry entry(compressed);
+    ASSERT_BSONOBJ_EQ(doc, entry.getObject());
+    ASSERT_BSONOBJ_EQ(doc, entry.raw.getObjectField("o"));
+    ASSERT_BSONOBJ_EQ(compressed, entry.getStoredRaw());
+
+    OplogEntry uncompressedEntry(entry.raw);
+    ASSERT_BSONOBJ_EQ(uncompressedEntry.raw, uncompressedEntry.getStoredRaw());
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
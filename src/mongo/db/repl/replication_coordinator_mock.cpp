@@ -413,7 +413,11 @@ bool ReplicationCoordinatorMock::shouldChangeSyncSource(
 }
 
 OpTime ReplicationCoordinatorMock::getLastCommittedOpTime() const {
-    return OpTime();
+    return _lastCommittedOpTime;
+}
+
+void ReplicationCoordinatorMock::setLastCommittedOpTime(const OpTime& opTime) {
+    _lastCommittedOpTime = opTime;
 }
 
 Status ReplicationCoordinatorMock::processReplSetRequestVotes(
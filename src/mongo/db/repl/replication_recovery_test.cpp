@@ -33,6 +33,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/repl/oplog_entry_compression.h"
 #include "mongo/db/repl/oplog_interface_local.h"
 #include "mongo/db/repl/replication_consistency_markers_mock.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
@@ -156,6 +157,28 @@ TimestampedBSONObj _makeOplogEntry(int t) {
             Timestamp(t)};
 }
 
+/**
+ * Generates a document large and repetitive enough to be worth storing compressed in the oplog.
+ */
+BSONObj _makeCompressibleInsertDocument(int t) {
+    return BSON("_id" << t << "a" << std::string(1024, 'a'));
+}
+
+/**
+ * Generates an insert oplog entry which stores its 'o' field compressed.
+ */
+TimestampedBSONObj _makeCompressedOplogEntry(int t) {
+    BSONObjBuilder bob;
+    bob.append("ts", Timestamp(t, t));
+    bob.append("h", t);
+    bob.append("ns", testNs.ns());
+    bob.append("v", 2);
+    bob.append("op", "i");
+    ASSERT_TRUE(oplog_entry_compression::appendCompressedObjectField(
+        _makeCompressibleInsertDocument(t), &bob));
+    return {bob.obj(), Timestamp(t)};
+}
+
 /**
  * Creates collection options suitable for oplog.
  */
@@ -324,6 +347,24 @@ TEST_F(ReplicationRecoveryTest, RecoveryAppliesDocumentsWhenAppliedThroughIsBehi
     ASSERT_EQ(getStorageInterfaceRecovery()->getInitialDataTimestamp(), Timestamp(5, 5));
 }
 
+TEST_F(ReplicationRecoveryTest, RecoveryAppliesCompressedOplogEntries) {
+    ReplicationRecoveryImpl recovery(getStorageInterface(), getConsistencyMarkers());
+    auto opCtx = getOperationContext();
+
+    getConsistencyMarkers()->setAppliedThrough(opCtx, OpTime(Timestamp(1, 1), 1));
+    _setUpOplog(opCtx, getStorageInterface(), {1});
+    for (int ts : {2, 3}) {
+        ASSERT_OK(getStorageInterface()->insertDocument(
+            opCtx, oplogNs, _makeCompressedOplogEntry(ts), OpTime::kUninitializedTerm));
+    }
+
+    recovery.recoverFromOplog(opCtx);
+
+    _assertDocumentsInCollectionEquals(
+        opCtx, testNs, {_makeCompressibleInsertDocument(2), _makeCompressibleInsertDocument(3)});
+    ASSERT_EQ(getConsistencyMarkers()->getAppliedThrough(opCtx), OpTime(Timestamp(3, 3), 1));
+}
+
 TEST_F(ReplicationRecoveryTest, RecoveryAppliesDocumentsWhenAppliedThroughIsBehindAfterTruncation) {
     ReplicationRecoveryImpl recovery(getStorageInterface(), getConsistencyMarkers());
     auto opCtx = getOperationContext();
@@ -92,7 +92,8 @@ Reporter::Reporter(executor::TaskExecutor* executor,
     : _executor(executor),
       _prepareReplSetUpdatePositionCommandFn(prepareReplSetUpdatePositionCommandFn),
       _target(target),
-      _keepAliveInterval(keepAliveInterval) {
+      _keepAliveInterval(keepAliveInterval),
+      _deltaTracker(keepAliveInterval) {
     uassert(ErrorCodes::BadValue, "null task executor", executor);
     uassert(ErrorCodes::BadValue,
             "null function to create replSetUpdatePosition command object",
@@ -205,7 +206,8 @@ StatusWith<BSONObj> Reporter::_prepareCommand() {
         return _status;
     }
 
-    return prepareResult.getValue();
+    // Only send the member positions that changed since the last update the target processed.
+    return _deltaTracker.makeDelta(prepareResult.getValue(), _executor->now());
 }
 
 void Reporter::_sendCommand_inlock(BSONObj commandRequest) {
@@ -252,6 +254,9 @@ void Reporter::_processResponseCallback(
         // Override _status with the one embedded in the command result.
         const auto& commandResult = rcbd.response.data;
         _status = getStatusFromCommandResult(commandResult);
+        if (_status.isOK()) {
+            _deltaTracker.acknowledge();
+        }
 
         // Some error types are OK and should not cause the reporter to stop sending updates to the
         // sync target.
@@ -260,6 +265,8 @@ void Reporter::_processResponseCallback(
             LOG(1) << "Reporter found newer configuration on sync source: " << _target
                    << ". Retrying.";
             _status = Status::OK();
+            // The target will need every member's position under the new configuration.
+            _deltaTracker.reset();
             // Do not resend update command immediately.
             _isWaitingToSendReporter = false;
         } else if (!_status.isOK()) {
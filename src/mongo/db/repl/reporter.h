@@ -32,6 +32,7 @@
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/repl/update_position_delta_tracker.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
@@ -197,6 +198,9 @@ private:
     // Callback handle to the scheduled task for preparing and sending the remote command.
     executor::TaskExecutor::CallbackHandle _prepareAndSendCommandCallbackHandle;
 
+    // Removes from the update command the member positions the target has already acknowledged.
+    UpdatePositionDeltaTracker _deltaTracker;
+
     // Keep alive timeout callback will not run before this time.
     // If this date is Date_t(), the callback is either unscheduled or canceled.
     // Used for testing only.
@@ -647,6 +647,30 @@ TEST_F(ReporterTest,
     assertReporterDone();
 }
 
+TEST_F(ReporterTestNoTriggerAtSetUp, CommandOnlyCarriesPositionsChangedSinceLastAcknowledgedCommand) {
+    posUpdater->updateMap(1, OpTime({3, 0}, 1), OpTime({3, 0}, 1));
+    posUpdater->updateMap(2, OpTime({3, 0}, 1), OpTime({3, 0}, 1));
+
+    ASSERT_OK(reporter->trigger());
+    UpdatePositionArgs fullArgs;
+    ASSERT_OK(fullArgs.initialize(processNetworkResponse(BSON("ok" << 1))));
+    ASSERT_EQUALS(3, std::distance(fullArgs.updatesBegin(), fullArgs.updatesEnd()));
+
+    posUpdater->updateMap(1, OpTime({4, 0}, 1), OpTime({4, 0}, 1));
+
+    ASSERT_OK(reporter->trigger());
+    UpdatePositionArgs deltaArgs;
+    ASSERT_OK(deltaArgs.initialize(processNetworkResponse(BSON("ok" << 1))));
+    ASSERT_EQUALS(1, std::distance(deltaArgs.updatesBegin(), deltaArgs.updatesEnd()));
+    ASSERT_EQUALS(1, deltaArgs.updatesBegin()->memberId);
+    ASSERT_EQUALS(OpTime({4, 0}, 1), deltaArgs.updatesBegin()->appliedOpTime);
+
+    reporter->shutdown();
+
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled, reporter->join());
+    assertReporterDone();
+}
+
 TEST_F(ReporterTest, ShutdownImmediatelyAfterTriggerWhileKeepAliveTimeoutIsScheduledShouldSucceed) {
     processNetworkResponse(BSON("ok" << 1));
 
@@ -32,7 +32,12 @@
 
 #include "mongo/db/repl/rollback_impl.h"
 
+#include <algorithm>
+
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/background.h"
+#include "mongo/db/catalog/uuid_catalog.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
@@ -47,6 +52,7 @@
 #include "mongo/db/s/type_shard_identity.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
@@ -58,6 +64,37 @@ namespace {
 // stable timestamp.
 constexpr bool createRollbackFilesDefault = true;
 MONGO_EXPORT_SERVER_PARAMETER(createRollbackDataFiles, bool, createRollbackFilesDefault);
+
+/**
+ * The maximum number of threads used to correct the record counts of the collections affected by
+ * rollback. It can be overridden using the "rollbackCountFixupThreadCount" server parameter.
+ */
+int rollbackCountFixupThreadCount = 8;
+
+class ExportedRollbackCountFixupThreadCountParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupOnly> {
+public:
+    ExportedRollbackCountFixupThreadCountParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupOnly>(
+              ServerParameterSet::getGlobal(),
+              "rollbackCountFixupThreadCount",
+              &rollbackCountFixupThreadCount) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 256) {
+            return Status(ErrorCodes::BadValue,
+                          "rollbackCountFixupThreadCount must be between 1 and 256");
+        }
+
+        return Status::OK();
+    }
+} exportedRollbackCountFixupThreadCountParam;
+
+// Marks a collection whose number of records must be determined with a collection scan.
+const long long kCollectionScanRequired = -1;
+
+// Used by RollbackImpl instances that are not given a listener.
+RollbackImpl::Listener noopListener;
 }  // namespace
 
 bool RollbackImpl::shouldCreateDataFiles() {
@@ -95,7 +132,7 @@ RollbackImpl::RollbackImpl(OplogInterface* localOplog,
                    storageInterface,
                    replicationProcess,
                    replicationCoordinator,
-                   {}) {}
+                   &noopListener) {}
 
 RollbackImpl::~RollbackImpl() {
     shutdown();
@@ -148,6 +185,14 @@ Status RollbackImpl::runRollback(OperationContext* opCtx) {
         return status;
     }
 
+    // Compute the collection counts to restore once the data has been rolled back. The storage
+    // engine does not roll back collection counts, so this must be done before recovering to the
+    // stable timestamp.
+    status = _findRecordStoreCounts(opCtx);
+    if (!status.isOK()) {
+        return status;
+    }
+
     // Recover to the stable timestamp.
     status = _recoverToStableTimestamp(opCtx);
     if (!status.isOK()) {
@@ -162,6 +207,12 @@ Status RollbackImpl::runRollback(OperationContext* opCtx) {
     }
     _listener->onRecoverFromOplog();
 
+    // Correct the counts of the collections affected by rollback.
+    status = _correctRecordStoreCounts(opCtx);
+    if (!status.isOK()) {
+        return status;
+    }
+
     status = _triggerOpObserver(opCtx);
     if (!status.isOK()) {
         return status;
@@ -347,6 +398,20 @@ Status RollbackImpl::_processRollbackOp(const OplogEntry& oplogEntry) {
                                                 namespacesSW.getValue().end());
     }
 
+    // Keep track of the net change in the number of records of each collection, so that the
+    // collection counts can be corrected once the data has been rolled back.
+    if (auto uuid = oplogEntry.getUuid()) {
+        if (opType == OpTypeEnum::kInsert) {
+            --_countDiffs[*uuid];
+        } else if (opType == OpTypeEnum::kDelete) {
+            ++_countDiffs[*uuid];
+        } else {
+            // Make sure the collection is considered when correcting counts, since it may be
+            // capped or have been truncated.
+            _countDiffs.emplace(*uuid, 0);
+        }
+    }
+
     // If the operation being rolled back has a session id, then we add it to the set of
     // sessions that had operations rolled back.
     OperationSessionInfo opSessionInfo = oplogEntry.getOperationSessionInfo();
@@ -449,6 +514,147 @@ Timestamp RollbackImpl::_findTruncateTimestamp(
     return truncatePointTime.getValue().getTimestamp();
 }
 
+Status RollbackImpl::_findRecordStoreCounts(OperationContext* opCtx) {
+    if (_isInShutdown()) {
+        return Status(ErrorCodes::ShutdownInProgress, "rollback shutting down");
+    }
+
+    const auto& catalog = UUIDCatalog::get(opCtx);
+    for (const auto& uiCount : _countDiffs) {
+        const auto& uuid = uiCount.first;
+        const auto countDiff = uiCount.second;
+
+        // A collection that does not exist now will not exist after rollback either.
+        auto nss = catalog.lookupNSSByUUID(uuid);
+        if (nss.isEmpty()) {
+            LOG(2) << "Not correcting the count of collection " << uuid
+                   << " since it does not exist";
+            continue;
+        }
+
+        AutoGetCollectionForRead autoColl(opCtx, nss);
+        auto collection = autoColl.getCollection();
+        if (!collection) {
+            continue;
+        }
+
+        // Capped collections may have deleted documents without logging them, so their counts
+        // cannot be derived from the rolled back operations.
+        if (collection->isCapped()) {
+            _newCounts[uuid] = kCollectionScanRequired;
+            continue;
+        }
+
+        if (countDiff == 0) {
+            continue;
+        }
+
+        auto oldCount = collection->numRecords(opCtx);
+        auto newCount = oldCount + countDiff;
+        if (newCount < 0) {
+            warning() << "Cannot set count of " << nss.ns() << " (" << uuid << ") to " << newCount
+                      << " after rollback; the collection will be scanned instead";
+            _newCounts[uuid] = kCollectionScanRequired;
+            continue;
+        }
+
+        LOG(2) << "Record count of " << nss.ns() << " (" << uuid << ") will be corrected from "
+               << oldCount << " to " << newCount;
+        _newCounts[uuid] = newCount;
+    }
+
+    return Status::OK();
+}
+
+Status RollbackImpl::_correctRecordStoreCounts(OperationContext* opCtx) {
+    if (_isInShutdown()) {
+        return Status(ErrorCodes::ShutdownInProgress, "rollback shutting down");
+    }
+    if (_newCounts.empty()) {
+        return Status::OK();
+    }
+
+    log() << "Correcting the record counts of " << _newCounts.size() << " collections";
+
+    ThreadPool::Options options;
+    options.threadNamePrefix = "rollbackCountFixup-";
+    options.poolName = "rollbackCountFixupThreadPool";
+    options.maxThreads =
+        std::min(static_cast<size_t>(rollbackCountFixupThreadCount), _newCounts.size());
+    options.onCreateThread = [](const std::string&) {
+        Client::initThreadIfNotAlready();
+        AuthorizationSession::get(cc())->grantInternalAuthorization();
+    };
+    ThreadPool pool(options);
+    pool.startup();
+
+    stdx::mutex statusMutex;
+    Status finalStatus = Status::OK();
+    for (const auto& uiCount : _newCounts) {
+        const auto uuid = uiCount.first;
+        const auto newCount = uiCount.second;
+        auto scheduleStatus = pool.schedule([this, uuid, newCount, &statusMutex, &finalStatus] {
+            auto opCtx = cc().makeOperationContext();
+            Status status = Status::OK();
+            try {
+                status = _correctRecordStoreCount(opCtx.get(), uuid, newCount);
+            } catch (...) {
+                status = exceptionToStatus();
+            }
+            if (!status.isOK()) {
+                stdx::lock_guard<stdx::mutex> lock(statusMutex);
+                if (finalStatus.isOK()) {
+                    finalStatus = status;
+                }
+            }
+        });
+        if (!scheduleStatus.isOK()) {
+            stdx::lock_guard<stdx::mutex> lock(statusMutex);
+            if (finalStatus.isOK()) {
+                finalStatus = scheduleStatus;
+            }
+            break;
+        }
+    }
+
+    pool.waitForIdle();
+    pool.shutdown();
+    pool.join();
+    return finalStatus;
+}
+
+Status RollbackImpl::_correctRecordStoreCount(OperationContext* opCtx,
+                                              const UUID& uuid,
+                                              long long newCount) {
+    // Recovery reloads the catalog, so the namespace must be resolved again.
+    auto nss = UUIDCatalog::get(opCtx).lookupNSSByUUID(uuid);
+    if (nss.isEmpty()) {
+        LOG(2) << "Not correcting the count of collection " << uuid
+               << " since it no longer exists after rollback";
+        return Status::OK();
+    }
+
+    if (newCount == kCollectionScanRequired) {
+        AutoGetCollectionForRead autoColl(opCtx, nss);
+        auto collection = autoColl.getCollection();
+        if (!collection) {
+            return Status::OK();
+        }
+        newCount = 0;
+        auto cursor = collection->getRecordStore()->getCursor(opCtx);
+        while (cursor->next()) {
+            ++newCount;
+        }
+    }
+
+    LOG(2) << "Setting record count of " << nss.ns() << " (" << uuid << ") to " << newCount;
+    auto status = _storageInterface->setCollectionCount(opCtx, nss, newCount);
+    if (status == ErrorCodes::NamespaceNotFound) {
+        return Status::OK();
+    }
+    return status;
+}
+
 Status RollbackImpl::_recoverToStableTimestamp(OperationContext* opCtx) {
     if (_isInShutdown()) {
         return Status(ErrorCodes::ShutdownInProgress, "rollback shutting down");
@@ -35,6 +35,8 @@
 #include "mongo/db/repl/rollback.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/uuid.h"
 
 namespace mongo {
 
@@ -68,15 +70,18 @@ class ReplicationProcess;
  *   2. Find the common point between the local and remote oplogs.
  *       a. Keep track of what is rolled back to provide a summary to the user
  *       b. Write rolled back documents to 'Rollback Files'
+ *       c. Keep track of the net change in the number of records of each collection
  *   3. Increment the Rollback ID (RBID)
  *   4. Write the common point as the 'OplogTruncateAfterPoint'
- *   5. Tell the storage engine to recover to the last stable timestamp
- *   6. Call recovery code
+ *   5. Compute the number of records each affected collection should have after rollback
+ *   6. Tell the storage engine to recover to the last stable timestamp
+ *   7. Call recovery code
  *       a. Truncate the oplog at the common point
  *       b. Apply all oplog entries to the end of oplog.
- *   7. Check the shard identity document for roll back
- *   8. Clear the in-memory transaction table
- *   9. Transition to SECONDARY
+ *   8. Correct the record counts of the affected collections, in parallel
+ *   9. Check the shard identity document for roll back
+ *   10. Clear the in-memory transaction table
+ *   11. Transition to SECONDARY
  *
  * If the node crashes while in rollback and the storage engine has not recovered to the last
  * stable timestamp yet, then rollback will simply restart against the new sync source upon restart.
@@ -217,6 +222,27 @@ private:
      */
     Status _awaitBgIndexCompletion(OperationContext* opCtx);
 
+    /**
+     * Determines the number of records each collection affected by rollback should have once
+     * rollback completes, from its current count and the net effect of the operations being
+     * rolled back. Must be called before recovering to the stable timestamp, since the storage
+     * engine does not roll back collection counts.
+     */
+    Status _findRecordStoreCounts(OperationContext* opCtx);
+
+    /**
+     * Sets the number of records of every collection affected by rollback to the value computed
+     * by '_findRecordStoreCounts'. Collections whose count could not be derived from the rolled
+     * back operations are counted with a collection scan. The collections are corrected in
+     * parallel on a thread pool.
+     */
+    Status _correctRecordStoreCounts(OperationContext* opCtx);
+
+    /**
+     * Corrects the number of records of a single collection. Runs on a thread pool thread.
+     */
+    Status _correctRecordStoreCount(OperationContext* opCtx, const UUID& uuid, long long newCount);
+
     /**
      * Recovers to the stable timestamp while holding the global exclusive lock.
      */
@@ -294,6 +320,15 @@ private:
     // Contains information about the rollback that will be passed along to the rollback OpObserver
     // method.
     OpObserver::RollbackObserverInfo _observerInfo = {};  // (N)
+
+    // The net change in the number of records of each collection, keyed by collection UUID,
+    // caused by the operations being rolled back.
+    stdx::unordered_map<UUID, long long, UUID::Hash> _countDiffs;  // (N)
+
+    // The number of records each collection affected by rollback should have once rollback
+    // completes, keyed by collection UUID. Collections that must be counted with a collection scan
+    // map to a negative value.
+    stdx::unordered_map<UUID, long long, UUID::Hash> _newCounts;  // (N)
 };
 
 }  // namespace repl
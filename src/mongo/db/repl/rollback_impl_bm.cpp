@@ -0,0 +1,202 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_interface_local.h"
+#include "mongo/db/repl/oplog_interface_mock.h"
+#include "mongo/db/repl/rollback_impl.h"
+#include "mongo/db/repl/rollback_test_fixture.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const int kDocsPerCollection = 10 * 1000;
+const int kOpsPerCollection = 10;
+
+/**
+ * Leaves the data in place on 'recoverToStableTimestamp', which the "ephemeralForTest" storage
+ * engine does not support, so that the same rollback can be run on every iteration.
+ */
+class StorageInterfaceRollback : public StorageInterfaceImpl {
+public:
+    Status recoverToStableTimestamp(ServiceContext* serviceCtx) override {
+        return Status::OK();
+    }
+};
+
+BSONObj makeOp(int count, StringData opType, const NamespaceString& nss, const UUID& uuid) {
+    return BSON("ts" << Timestamp(count, count) << "h" << static_cast<long long>(count) << "t"
+                     << 1LL
+                     << "op"
+                     << opType
+                     << "o"
+                     << BSON("_id" << count)
+                     << "ns"
+                     << nss.ns()
+                     << "ui"
+                     << uuid);
+}
+
+/**
+ * Sets up a node with 'numCollections' collections of 'kDocsPerCollection' documents each, and
+ * 'kOpsPerCollection' operations on each of them to roll back. Every other collection is capped,
+ * so that both setting a computed count and counting with a collection scan are measured.
+ */
+class RollbackImplBenchmarkFixture : public RollbackTest {
+public:
+    explicit RollbackImplBenchmarkFixture(int numCollections) : _numCollections(numCollections) {}
+
+    void setUp() override {
+        RollbackTest::setUp();
+        createOplog(_opCtx.get());
+
+        auto commonPoint = std::make_pair(
+            makeOp(1, "n", NamespaceString("test.coll"), UUID::gen()), RecordId(1));
+        _remoteOplog.setOperations({commonPoint});
+        invariantOK(_insertOplogEntry(commonPoint.first));
+
+        int count = 1;
+        for (int i = 0; i < _numCollections; ++i) {
+            NamespaceString nss("test", str::stream() << "coll" << i);
+            CollectionOptions options;
+            options.uuid = UUID::gen();
+            options.capped = i % 2 == 1;
+            options.cappedSize = options.capped ? 1024 * 1024 * 1024 : 0;
+            _createCollectionWithDocuments(nss, options);
+
+            for (int j = 0; j < kOpsPerCollection; ++j) {
+                invariantOK(_insertOplogEntry(
+                    makeOp(++count, options.capped ? "i" : "d", nss, *options.uuid)));
+            }
+        }
+
+        _localOplog = stdx::make_unique<OplogInterfaceLocal>(
+            _opCtx.get(), NamespaceString::kRsOplogNamespace.ns());
+    }
+
+    void tearDown() override {
+        _localOplog = {};
+        RollbackTest::tearDown();
+    }
+
+    /**
+     * Returns a RollbackImpl for the operations set up by 'setUp'. Since the data and the oplog are
+     * left in place, every rollback it runs rolls back the same operations.
+     */
+    std::unique_ptr<RollbackImpl> makeRollback() {
+        return stdx::make_unique<RollbackImpl>(_localOplog.get(),
+                                               &_remoteOplog,
+                                               &_rollbackStorageInterface,
+                                               _replicationProcess.get(),
+                                               _coordinator);
+    }
+
+    OperationContext* getOperationContext() {
+        return _opCtx.get();
+    }
+
+private:
+    void _doTest() override {
+        MONGO_UNREACHABLE;
+    }
+
+    void _createCollectionWithDocuments(const NamespaceString& nss,
+                                        const CollectionOptions& options) {
+        AutoGetOrCreateDb autoDb(_opCtx.get(), nss.db(), MODE_X);
+        WriteUnitOfWork wuow(_opCtx.get());
+        auto coll = autoDb.getDb()->createCollection(_opCtx.get(), nss.ns(), options);
+        invariant(coll);
+        OpDebug* const nullOpDebug = nullptr;
+        for (int i = 0; i < kDocsPerCollection; ++i) {
+            invariantOK(coll->insertDocument(
+                _opCtx.get(), InsertStatement(BSON("_id" << i)), nullOpDebug, false));
+        }
+        wuow.commit();
+    }
+
+    const int _numCollections;
+    StorageInterfaceRollback _rollbackStorageInterface;
+    std::unique_ptr<OplogInterfaceLocal> _localOplog;
+    OplogInterfaceMock _remoteOplog;
+};
+
+void setRollbackCountFixupThreadCount(int threadCount) {
+    const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+    auto it = parameters.find("rollbackCountFixupThreadCount");
+    invariant(it != parameters.end());
+    uassertStatusOK(it->second->setFromString(std::to_string(threadCount)));
+}
+
+/**
+ * Runs a rollback whose operations touch 'state.range(0)' collections, with the collection counts
+ * corrected by up to 'state.range(1)' threads.
+ */
+void BM_RollbackImplCountFixup(benchmark::State& state) {
+    setRollbackCountFixupThreadCount(state.range(1));
+
+    RollbackImplBenchmarkFixture fixture(state.range(0));
+    fixture.setUp();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto rollback = fixture.makeRollback();
+        state.ResumeTiming();
+
+        invariantOK(rollback->runRollback(fixture.getOperationContext()));
+
+        state.PauseTiming();
+        rollback.reset();
+        state.ResumeTiming();
+    }
+
+    fixture.tearDown();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_RollbackImplCountFixup)
+    ->ArgPair(16, 1)
+    ->ArgPair(16, 8)
+    ->ArgPair(128, 1)
+    ->ArgPair(128, 8)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
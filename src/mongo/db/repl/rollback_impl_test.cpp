@@ -28,6 +28,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/oplog_interface_local.h"
 #include "mongo/db/repl/oplog_interface_mock.h"
@@ -83,6 +86,27 @@ public:
         return _currTimestamp;
     }
 
+    /**
+     * Records the new count instead of setting it, since the data is not actually rolled back by
+     * 'recoverToStableTimestamp' in these tests.
+     */
+    Status setCollectionCount(OperationContext* opCtx,
+                              const NamespaceString& nss,
+                              long long newCount) override {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _newCounts[nss] = newCount;
+        return Status::OK();
+    }
+
+    boost::optional<long long> getNewCollectionCount(const NamespaceString& nss) {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        auto it = _newCounts.find(nss);
+        if (it == _newCounts.end()) {
+            return boost::none;
+        }
+        return it->second;
+    }
+
 private:
     mutable stdx::mutex _mutex;
 
@@ -97,6 +121,9 @@ private:
     // A Status value which, if set, will be returned by the 'recoverToStableTimestamp' function, in
     // order to simulate the error case for that function. Defaults to boost::none.
     boost::optional<Status> _recoverToTimestampStatus = boost::none;
+
+    // The collection counts set through 'setCollectionCount'.
+    std::map<NamespaceString, long long> _newCounts;
 };
 
 /**
@@ -394,6 +421,82 @@ TEST_F(RollbackImplTest, RollbackCallsRecoverFromOplog) {
     ASSERT(_recoveredFromOplog);
 }
 
+/**
+ * Creates a collection and inserts 'numDocs' documents into it. Returns the collection UUID.
+ */
+UUID createCollectionWithDocuments(OperationContext* opCtx,
+                                   const NamespaceString& nss,
+                                   CollectionOptions options,
+                                   int numDocs) {
+    options.uuid = UUID::gen();
+    AutoGetOrCreateDb autoDb(opCtx, nss.db(), MODE_X);
+    WriteUnitOfWork wuow(opCtx);
+    auto coll = autoDb.getDb()->createCollection(opCtx, nss.ns(), options);
+    ASSERT(coll);
+    OpDebug* const nullOpDebug = nullptr;
+    for (int i = 0; i < numDocs; ++i) {
+        ASSERT_OK(
+            coll->insertDocument(opCtx, InsertStatement(BSON("_id" << i)), nullOpDebug, false));
+    }
+    wuow.commit();
+    return *options.uuid;
+}
+
+BSONObj makeOpForCollection(int count,
+                            StringData opType,
+                            const NamespaceString& nss,
+                            const UUID& uuid) {
+    return BSON("ts" << Timestamp(count, count) << "h" << static_cast<long long>(count) << "t"
+                     << static_cast<long long>(count)
+                     << "op"
+                     << opType
+                     << "o"
+                     << BSON("_id" << count)
+                     << "ns"
+                     << nss.ns()
+                     << "ui"
+                     << uuid);
+}
+
+TEST_F(RollbackImplTest, RollbackCorrectsCountsOfAffectedCollections) {
+    NamespaceString collNss("test.coll");
+    auto collUuid = createCollectionWithDocuments(_opCtx.get(), collNss, CollectionOptions(), 5);
+
+    NamespaceString cappedNss("test.capped");
+    CollectionOptions cappedOptions;
+    cappedOptions.capped = true;
+    cappedOptions.cappedSize = 4096;
+    auto cappedUuid = createCollectionWithDocuments(_opCtx.get(), cappedNss, cappedOptions, 2);
+
+    auto commonPoint = makeOpAndRecordId(1);
+    _remoteOplog->setOperations({commonPoint});
+    ASSERT_OK(_insertOplogEntry(commonPoint.first));
+    ASSERT_OK(_insertOplogEntry(makeOpForCollection(2, "i", collNss, collUuid)));
+    ASSERT_OK(_insertOplogEntry(makeOpForCollection(3, "i", collNss, collUuid)));
+    ASSERT_OK(_insertOplogEntry(makeOpForCollection(4, "d", collNss, collUuid)));
+    ASSERT_OK(_insertOplogEntry(makeOpForCollection(5, "i", collNss, collUuid)));
+    ASSERT_OK(_insertOplogEntry(makeOpForCollection(6, "i", cappedNss, cappedUuid)));
+
+    ASSERT_OK(_rollback->runRollback(_opCtx.get()));
+
+    // Three inserts and one delete were rolled back.
+    ASSERT_EQUALS(3LL, _storageInterface->getNewCollectionCount(collNss));
+
+    // Capped collections are counted with a collection scan, and the data was not rolled back.
+    ASSERT_EQUALS(2LL, _storageInterface->getNewCollectionCount(cappedNss));
+}
+
+TEST_F(RollbackImplTest, RollbackDoesNotCorrectCountsOfUnknownCollections) {
+    auto commonPoint = makeOpAndRecordId(1);
+    _remoteOplog->setOperations({commonPoint});
+    ASSERT_OK(_insertOplogEntry(commonPoint.first));
+    ASSERT_OK(_insertOplogEntry(makeOp(2)));
+
+    ASSERT_OK(_rollback->runRollback(_opCtx.get()));
+
+    ASSERT_FALSE(_storageInterface->getNewCollectionCount(NamespaceString("test.coll")));
+}
+
 TEST_F(RollbackImplTest, RollbackSkipsRecoverFromOplogWhenShutdownEarly) {
     auto op = makeOpAndRecordId(1);
     _remoteOplog->setOperations({op});
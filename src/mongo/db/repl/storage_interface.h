@@ -326,6 +326,14 @@ public:
     virtual StatusWith<CollectionCount> getCollectionCount(OperationContext* opCtx,
                                                            const NamespaceString& nss) = 0;
 
+    /**
+     * Sets the number of documents in the collection. This does not change the data size recorded
+     * for the collection.
+     */
+    virtual Status setCollectionCount(OperationContext* opCtx,
+                                      const NamespaceString& nss,
+                                      long long newCount) = 0;
+
     /**
      * Returns the UUID of the collection specified by nss, if such a UUID exists.
      */
@@ -992,6 +992,24 @@ StatusWith<StorageInterface::CollectionCount> StorageInterfaceImpl::getCollectio
     return collection->numRecords(opCtx);
 }
 
+Status StorageInterfaceImpl::setCollectionCount(OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               long long newCount) {
+    AutoGetCollection autoColl(opCtx, nss, MODE_X);
+
+    auto collectionResult =
+        getCollection(autoColl, nss, "Unable to set number of documents in collection.");
+    if (!collectionResult.isOK()) {
+        return collectionResult.getStatus();
+    }
+    auto collection = collectionResult.getValue();
+
+    // The data size cannot be corrected along with the count, so keep the cached value.
+    auto rs = collection->getRecordStore();
+    rs->updateStatsAfterRepair(opCtx, newCount, rs->dataSize(opCtx));
+    return Status::OK();
+}
+
 StatusWith<OptionalCollectionUUID> StorageInterfaceImpl::getCollectionUUID(
     OperationContext* opCtx, const NamespaceString& nss) {
     AutoGetCollectionForRead autoColl(opCtx, nss);
@@ -149,6 +149,10 @@ public:
     StatusWith<StorageInterface::CollectionCount> getCollectionCount(
         OperationContext* opCtx, const NamespaceString& nss) override;
 
+    Status setCollectionCount(OperationContext* opCtx,
+                              const NamespaceString& nss,
+                              long long newCount) override;
+
     StatusWith<OptionalCollectionUUID> getCollectionUUID(OperationContext* opCtx,
                                                          const NamespaceString& nss) override;
 
@@ -272,6 +272,12 @@ public:
         return 0;
     }
 
+    Status setCollectionCount(OperationContext* opCtx,
+                              const NamespaceString& nss,
+                              long long newCount) override {
+        return Status{ErrorCodes::IllegalOperation, "setCollectionCount not implemented."};
+    }
+
     StatusWith<OptionalCollectionUUID> getCollectionUUID(OperationContext* opCtx,
                                                          const NamespaceString& nss) override {
         return getCollectionUUIDFn(opCtx, nss);
@@ -288,6 +288,9 @@ std::unique_ptr<ThreadPool> SyncTail::makeWriterPool(int threadCount) {
     options.threadNamePrefix = "repl writer worker ";
     options.poolName = "repl writer worker Pool";
     options.maxThreads = options.minThreads = static_cast<size_t>(threadCount);
+    // Every batch hands each writer thread a task or two and then waits for the pool to go idle,
+    // so the writers are scheduled through the lock-free queue rather than the pool mutex.
+    options.lockFreeQueueCapacity = 4 * static_cast<size_t>(threadCount);
     options.onCreateThread = [](const std::string&) {
         // Only do this once per thread
         if (!Client::getCurrent()) {
@@ -477,8 +480,10 @@ void scheduleWritesToOplog(OperationContext* opCtx,
             for (size_t i = begin; i < end; i++) {
                 // Add as unowned BSON to avoid unnecessary ref-count bumps.
                 // 'ops' will outlive 'docs' so the BSON lifetime will be guaranteed.
-                docs.emplace_back(InsertStatement{
-                    ops[i].raw, ops[i].getOpTime().getTimestamp(), ops[i].getOpTime().getTerm()});
+                // Entries with a compressed 'o' field are written in their compressed form.
+                docs.emplace_back(InsertStatement{ops[i].getStoredRaw(),
+                                                  ops[i].getOpTime().getTimestamp(),
+                                                  ops[i].getOpTime().getTerm()});
             }
 
             fassert(40141,
@@ -515,20 +520,44 @@ void scheduleWritesToOplog(OperationContext* opCtx,
     }
 }
 
+// The maximum number of config.transactions entries a writer thread persists in a single write
+// unit of work at the end of a batch.
+const std::ptrdiff_t kSessionRecordsPerWriteUnitOfWork = 100;
+
 using SessionRecordMap =
     stdx::unordered_map<LogicalSessionId, SessionTxnRecord, LogicalSessionIdHash>;
 
 void scheduleTxnTableUpdates(OperationContext* opCtx,
                              ThreadPool* threadPool,
                              const SessionRecordMap& latestRecords) {
+    // Partition the records by session id, so that each writer thread owns a disjoint set of
+    // transaction table entries and can write them without conflicting with the other writers.
+    const size_t numWriters = threadPool->getStats().numThreads;
+    std::vector<std::vector<const SessionTxnRecord*>> partitions(numWriters);
+    LogicalSessionIdHash lsidHasher;
     for (const auto& it : latestRecords) {
-        auto& record = it.second;
+        partitions[lsidHasher(it.first) % numWriters].push_back(&it.second);
+    }
 
-        invariantOK(threadPool->schedule([&record]() {
+    for (auto&& partition : partitions) {
+        if (partition.empty()) {
+            continue;
+        }
+
+        invariantOK(threadPool->schedule([records = std::move(partition)]() {
             auto opCtx = cc().makeOperationContext();
             ShouldNotConflictWithSecondaryBatchApplicationBlock shouldNotConflictBlock(
                 opCtx->lockState());
-            Session::updateSessionRecordOnSecondary(opCtx.get(), record);
+
+            // Group the writes so that a batch touching many sessions does not pay for a storage
+            // transaction per session, while still bounding the size of each storage transaction.
+            for (auto begin = records.begin(); begin != records.end();) {
+                const auto end = begin +
+                    std::min<std::ptrdiff_t>(kSessionRecordsPerWriteUnitOfWork,
+                                             std::distance(begin, records.end()));
+                Session::updateSessionRecordsOnSecondary(opCtx.get(), {begin, end});
+                begin = end;
+            }
         }));
     }
 }
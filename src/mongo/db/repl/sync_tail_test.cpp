@@ -780,6 +780,50 @@ TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     ASSERT_TRUE(resultNoTxn.isEmpty());
 }
 
+TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTableForManySessions) {
+    // Set up the transactions collection, which can only be done by the primary.
+    ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
+    SessionCatalog::create(_opCtx->getServiceContext());
+    SessionCatalog::get(_opCtx->getServiceContext())->onStepUp(_opCtx.get());
+    ON_BLOCK_EXIT([&] { SessionCatalog::reset_forTest(_opCtx->getServiceContext()); });
+    ASSERT_OK(
+        ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_SECONDARY));
+
+    // Enough sessions that each writer thread has to split its share of the transaction table
+    // updates across several write units of work.
+    const int kNumSessions = 2000;
+    std::vector<LogicalSessionId> lsids;
+    MultiApplier::Operations ops;
+    for (int i = 0; i < kNumSessions; i++) {
+        lsids.push_back(makeLogicalSessionIdForTest());
+        ops.push_back(
+            makeInsertDocumentOplogEntryWithSessionInfoAndStmtId({Timestamp(Seconds(1), i), 1LL},
+                                                                 NamespaceString("test.t"),
+                                                                 BSON("_id" << i),
+                                                                 lsids.back(),
+                                                                 TxnNumber(i),
+                                                                 0));
+    }
+
+    auto writerPool = SyncTail::makeWriterPool();
+    ASSERT_OK(multiApply(_opCtx.get(), writerPool.get(), ops, noopApplyOperationFn));
+
+    DBDirectClient client(_opCtx.get());
+    ASSERT_EQ(static_cast<unsigned long long>(kNumSessions),
+              client.count(NamespaceString::kSessionTransactionsTableNamespace.ns()));
+
+    for (int i = 0; i < kNumSessions; i++) {
+        auto resultDoc =
+            client.findOne(NamespaceString::kSessionTransactionsTableNamespace.ns(),
+                           BSON(SessionTxnRecord::kSessionIdFieldName << lsids[i].toBSON()));
+        ASSERT_TRUE(!resultDoc.isEmpty());
+
+        auto result = SessionTxnRecord::parse(IDLParserErrorContext("resultDoc test"), resultDoc);
+        ASSERT_EQ(result.getTxnNum(), TxnNumber(i));
+        ASSERT_EQ(result.getLastWriteOpTime(), repl::OpTime(Timestamp(Seconds(1), i), 1));
+    }
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
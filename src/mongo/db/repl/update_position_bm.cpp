@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/repl_set_config.h"
+#include "mongo/db/repl/topology_coordinator.h"
+#include "mongo/db/repl/update_position_args.h"
+#include "mongo/db/repl/update_position_delta_tracker.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const int kMaxVotingMembers = 7;
+
+/**
+ * Makes a config with 'numMembers' members, of which at most seven vote and the rest are hidden.
+ */
+ReplSetConfig makeConfig(int numMembers) {
+    BSONArrayBuilder members;
+    for (int i = 0; i < numMembers; ++i) {
+        BSONObjBuilder member(members.subobjStart());
+        member.append("_id", i);
+        member.append("host", str::stream() << "node" << i << ":27017");
+        if (i >= kMaxVotingMembers) {
+            member.append("votes", 0);
+            member.append("priority", 0);
+            member.append("hidden", true);
+        }
+    }
+
+    ReplSetConfig config;
+    uassertStatusOK(config.initialize(BSON("_id"
+                                           << "rs0"
+                                           << "version"
+                                           << 1
+                                           << "protocolVersion"
+                                           << 1
+                                           << "members"
+                                           << members.arr())));
+    uassertStatusOK(config.validate());
+    return config;
+}
+
+/**
+ * Simulates a secondary that all other members sync through reporting its progress to the
+ * primary, one replSetUpdatePosition command per iteration. Every iteration, the secondary applies
+ * one more operation while the members syncing from it keep their positions. Measures preparing
+ * the command on the secondary and processing it on the primary.
+ */
+void runUpdatePosition(benchmark::State& state, bool useDelta) {
+    const int numMembers = state.range(0);
+    const auto config = makeConfig(numMembers);
+    const OpTime startOpTime(Timestamp(100, 1), 1);
+    Date_t now = Date_t::now();
+
+    TopologyCoordinator secondary(TopologyCoordinator::Options{});
+    secondary.updateConfig(config, 1, now);
+    secondary.setFollowerMode(MemberState::RS_SECONDARY);
+    secondary.setMyLastAppliedOpTime(startOpTime, now, false);
+    secondary.setMyLastDurableOpTime(startOpTime, now, false);
+
+    TopologyCoordinator primary(TopologyCoordinator::Options{});
+    primary.updateConfig(config, 0, now);
+    primary.setMyLastAppliedOpTime(startOpTime, now, false);
+    primary.setMyLastDurableOpTime(startOpTime, now, false);
+
+    long long configVersion;
+    for (int i = 0; i < numMembers; ++i) {
+        uassertStatusOK(secondary.setLastOptime(
+            UpdatePositionArgs::UpdateInfo(startOpTime, startOpTime, 1, i), now, &configVersion));
+    }
+
+    UpdatePositionDeltaTracker deltaTracker(Hours(1));
+    unsigned inc = startOpTime.getTimestamp().getInc();
+    size_t bytesSent = 0;
+    for (auto _ : state) {
+        const OpTime opTime(Timestamp(100, ++inc), 1);
+        secondary.setMyLastAppliedOpTime(opTime, now, false);
+        secondary.setMyLastDurableOpTime(opTime, now, false);
+
+        auto command = uassertStatusOK(secondary.prepareReplSetUpdatePositionCommand(OpTime()));
+        if (useDelta) {
+            command = deltaTracker.makeDelta(command, now);
+        }
+        bytesSent += command.objsize();
+
+        UpdatePositionArgs args;
+        uassertStatusOK(args.initialize(command));
+        for (auto update = args.updatesBegin(); update != args.updatesEnd(); ++update) {
+            uassertStatusOK(primary.setLastOptime(*update, now, &configVersion));
+        }
+        if (useDelta) {
+            deltaTracker.acknowledge();
+        }
+    }
+    state.counters["bytesPerCommand"] =
+        benchmark::Counter(static_cast<double>(bytesSent) / state.iterations());
+}
+
+void BM_updatePositionFull(benchmark::State& state) {
+    runUpdatePosition(state, false);
+}
+
+void BM_updatePositionDelta(benchmark::State& state) {
+    runUpdatePosition(state, true);
+}
+
+BENCHMARK(BM_updatePositionFull)->Arg(3)->Arg(7)->Arg(20)->Arg(50);
+BENCHMARK(BM_updatePositionDelta)->Arg(3)->Arg(7)->Arg(20)->Arg(50);
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/update_position_delta_tracker.h"
+
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/repl/update_position_args.h"
+
+namespace mongo {
+namespace repl {
+
+UpdatePositionDeltaTracker::UpdatePositionDeltaTracker(Milliseconds fullUpdateInterval)
+    : _fullUpdateInterval(fullUpdateInterval) {}
+
+BSONObj UpdatePositionDeltaTracker::makeDelta(const BSONObj& fullCommand, Date_t now) {
+    _pending.clear();
+
+    UpdatePositionArgs args;
+    if (!args.initialize(fullCommand).isOK()) {
+        return fullCommand;
+    }
+
+    // The parsed updates are in the same order as the entries of the "optimes" array.
+    std::vector<long long> memberIds;
+    for (auto update = args.updatesBegin(); update != args.updatesEnd(); ++update) {
+        _pending[update->memberId] = {update->appliedOpTime, update->durableOpTime, update->cfgver};
+        memberIds.push_back(update->memberId);
+    }
+
+    if (_acknowledged.empty() || now - _lastFullUpdate >= _fullUpdateInterval) {
+        _lastFullUpdate = now;
+        return fullCommand;
+    }
+
+    BSONObjBuilder cmdBuilder;
+    for (auto&& elem : fullCommand) {
+        if (elem.fieldNameStringData() != UpdatePositionArgs::kUpdateArrayFieldName) {
+            cmdBuilder.append(elem);
+            continue;
+        }
+
+        BSONArrayBuilder arrayBuilder(
+            cmdBuilder.subarrayStart(UpdatePositionArgs::kUpdateArrayFieldName));
+        size_t index = 0;
+        BSONElement firstEntry;
+        for (auto&& entry : elem.Obj()) {
+            const auto memberId = memberIds[index++];
+            if (!firstEntry) {
+                firstEntry = entry;
+            }
+
+            auto acknowledged = _acknowledged.find(memberId);
+            if (acknowledged != _acknowledged.end() && acknowledged->second == _pending[memberId]) {
+                _pending.erase(memberId);
+                continue;
+            }
+            arrayBuilder.append(entry);
+        }
+
+        if (arrayBuilder.arrSize() == 0 && firstEntry) {
+            arrayBuilder.append(firstEntry);
+        }
+        arrayBuilder.done();
+    }
+    return cmdBuilder.obj();
+}
+
+void UpdatePositionDeltaTracker::acknowledge() {
+    for (auto&& pending : _pending) {
+        _acknowledged[pending.first] = pending.second;
+    }
+    _pending.clear();
+}
+
+void UpdatePositionDeltaTracker::reset() {
+    _acknowledged.clear();
+    _pending.clear();
+    _lastFullUpdate = Date_t();
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Keeps track of the member positions a sync source has acknowledged receiving through
+ * replSetUpdatePosition, so that subsequent commands only need to carry the positions that changed
+ * since. In a large replica set most members' positions are unchanged between two consecutive
+ * commands, while a complete command carries an entry for every member.
+ *
+ * The sync source processes each entry independently, so a command carrying a subset of the
+ * entries is understood by every version. Member positions also serve as liveness information for
+ * the members that sync through this node, so every entry is still sent at least once per full
+ * update interval.
+ *
+ * This class is not thread safe.
+ */
+class UpdatePositionDeltaTracker {
+    MONGO_DISALLOW_COPYING(UpdatePositionDeltaTracker);
+
+public:
+    explicit UpdatePositionDeltaTracker(Milliseconds fullUpdateInterval);
+
+    /**
+     * Returns a copy of the replSetUpdatePosition command 'fullCommand' whose "optimes" array only
+     * contains the entries that differ from the positions last acknowledged by the sync source.
+     * All other fields of the command are preserved. The command is returned unchanged if a full
+     * update is due or if it cannot be parsed. At least one entry is always kept, so the sync
+     * source can still detect a config version mismatch.
+     */
+    BSONObj makeDelta(const BSONObj& fullCommand, Date_t now);
+
+    /**
+     * Records that the sync source has processed the command last returned by makeDelta().
+     */
+    void acknowledge();
+
+    /**
+     * Forgets every acknowledged position, so that the next command is complete.
+     */
+    void reset();
+
+private:
+    struct Position {
+        OpTime appliedOpTime;
+        OpTime durableOpTime;
+        long long cfgver;
+
+        bool operator==(const Position& other) const {
+            return appliedOpTime == other.appliedOpTime && durableOpTime == other.durableOpTime &&
+                cfgver == other.cfgver;
+        }
+    };
+
+    const Milliseconds _fullUpdateInterval;
+
+    // Positions the sync source has acknowledged, by member id.
+    stdx::unordered_map<long long, Position> _acknowledged;
+
+    // Positions carried by the command last returned by makeDelta(), by member id.
+    stdx::unordered_map<long long, Position> _pending;
+
+    // When the last complete command was prepared.
+    Date_t _lastFullUpdate;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/update_position_args.h"
+#include "mongo/db/repl/update_position_delta_tracker.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const Milliseconds kFullUpdateInterval = Seconds(5);
+
+/**
+ * Builds a replSetUpdatePosition command with one entry per member, where member 'i' has applied
+ * and durably written through 'positions[i]'.
+ */
+BSONObj makeCommand(const std::vector<int>& positions, long long cfgver = 1) {
+    BSONObjBuilder cmdBuilder;
+    cmdBuilder.append(UpdatePositionArgs::kCommandFieldName, 1);
+    BSONArrayBuilder arrayBuilder(
+        cmdBuilder.subarrayStart(UpdatePositionArgs::kUpdateArrayFieldName));
+    for (size_t i = 0; i < positions.size(); ++i) {
+        OpTime opTime(Timestamp(positions[i], 1), 1);
+        BSONObjBuilder entry(arrayBuilder.subobjStart());
+        opTime.append(&entry, UpdatePositionArgs::kDurableOpTimeFieldName);
+        opTime.append(&entry, UpdatePositionArgs::kAppliedOpTimeFieldName);
+        entry.append(UpdatePositionArgs::kMemberIdFieldName, static_cast<int>(i));
+        entry.append(UpdatePositionArgs::kConfigVersionFieldName, cfgver);
+    }
+    arrayBuilder.done();
+    cmdBuilder.append("$replData", BSON("term" << 1));
+    return cmdBuilder.obj();
+}
+
+std::vector<long long> getMemberIds(const BSONObj& command) {
+    UpdatePositionArgs args;
+    ASSERT_OK(args.initialize(command));
+    std::vector<long long> memberIds;
+    for (auto update = args.updatesBegin(); update != args.updatesEnd(); ++update) {
+        memberIds.push_back(update->memberId);
+    }
+    return memberIds;
+}
+
+TEST(UpdatePositionDeltaTrackerTest, FirstCommandIsComplete) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto command = makeCommand({10, 10, 10});
+    ASSERT_BSONOBJ_EQ(command, tracker.makeDelta(command, Date_t()));
+}
+
+TEST(UpdatePositionDeltaTrackerTest, OmitsAcknowledgedPositions) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto now = Date_t();
+    tracker.makeDelta(makeCommand({10, 10, 10}), now);
+    tracker.acknowledge();
+
+    auto delta = tracker.makeDelta(makeCommand({11, 10, 12}), now + Seconds(1));
+    ASSERT(std::vector<long long>({0, 2}) == getMemberIds(delta));
+
+    // Fields other than the positions are preserved.
+    ASSERT_BSONOBJ_EQ(BSON("term" << 1), delta["$replData"].Obj());
+}
+
+TEST(UpdatePositionDeltaTrackerTest, ResendsPositionsThatWereNotAcknowledged) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto now = Date_t();
+    tracker.makeDelta(makeCommand({10, 10, 10}), now);
+    tracker.acknowledge();
+
+    // The command carrying member 1's new position is never acknowledged.
+    tracker.makeDelta(makeCommand({10, 11, 10}), now + Seconds(1));
+
+    auto delta = tracker.makeDelta(makeCommand({10, 11, 10}), now + Seconds(2));
+    ASSERT(std::vector<long long>({1}) == getMemberIds(delta));
+}
+
+TEST(UpdatePositionDeltaTrackerTest, KeepsOneEntryWhenNothingChanged) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto now = Date_t();
+    tracker.makeDelta(makeCommand({10, 10, 10}), now);
+    tracker.acknowledge();
+
+    auto delta = tracker.makeDelta(makeCommand({10, 10, 10}), now + Seconds(1));
+    ASSERT(std::vector<long long>({0}) == getMemberIds(delta));
+}
+
+TEST(UpdatePositionDeltaTrackerTest, ConfigVersionChangeResendsEveryPosition) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto now = Date_t();
+    tracker.makeDelta(makeCommand({10, 10, 10}), now);
+    tracker.acknowledge();
+
+    auto command = makeCommand({10, 10, 10}, 2);
+    ASSERT_BSONOBJ_EQ(command, tracker.makeDelta(command, now + Seconds(1)));
+}
+
+TEST(UpdatePositionDeltaTrackerTest, SendsCompleteCommandEveryFullUpdateInterval) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto now = Date_t();
+    tracker.makeDelta(makeCommand({10, 10, 10}), now);
+    tracker.acknowledge();
+
+    auto command = makeCommand({10, 10, 10});
+    ASSERT_BSONOBJ_EQ(command, tracker.makeDelta(command, now + kFullUpdateInterval));
+}
+
+TEST(UpdatePositionDeltaTrackerTest, ResetMakesNextCommandComplete) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto now = Date_t();
+    tracker.makeDelta(makeCommand({10, 10, 10}), now);
+    tracker.acknowledge();
+    tracker.reset();
+
+    auto command = makeCommand({10, 10, 10});
+    ASSERT_BSONOBJ_EQ(command, tracker.makeDelta(command, now + Seconds(1)));
+}
+
+TEST(UpdatePositionDeltaTrackerTest, ReturnsUnparseableCommandUnchanged) {
+    UpdatePositionDeltaTracker tracker(kFullUpdateInterval);
+    auto command = BSON(UpdatePositionArgs::kCommandFieldName << 1);
+    ASSERT_BSONOBJ_EQ(command, tracker.makeDelta(command, Date_t()));
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
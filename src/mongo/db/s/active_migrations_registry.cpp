@@ -35,14 +35,19 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/migration_session_id.h"
 #include "mongo/db/s/migration_source_manager.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
 
+// Each donated chunk belongs to a different collection, because a collection can only have one
+// active migration source manager at a time.
+MONGO_EXPORT_SERVER_PARAMETER(maxConcurrentDonateChunks, int, 1);
+
 ActiveMigrationsRegistry::ActiveMigrationsRegistry() = default;
 
 ActiveMigrationsRegistry::~ActiveMigrationsRegistry() {
-    invariant(!_activeMoveChunkState);
+    invariant(_activeMoveChunkStates.empty());
 }
 
 StatusWith<ScopedDonateChunk> ActiveMigrationsRegistry::registerDonateChunk(
@@ -52,17 +57,24 @@ StatusWith<ScopedDonateChunk> ActiveMigrationsRegistry::registerDonateChunk(
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        if (_activeMoveChunkState->args == args) {
-            return {ScopedDonateChunk(nullptr, false, _activeMoveChunkState->notification)};
+    auto it = _activeMoveChunkStates.find(args.getNss());
+    if (it != _activeMoveChunkStates.end()) {
+        if (it->second.args == args) {
+            return {ScopedDonateChunk(nullptr, args.getNss(), false, it->second.notification)};
         }
 
-        return _activeMoveChunkState->constructErrorStatus();
+        return it->second.constructErrorStatus();
+    }
+
+    if (!_activeMoveChunkStates.empty() &&
+        _activeMoveChunkStates.size() >=
+            static_cast<size_t>(std::max(1, maxConcurrentDonateChunks.load()))) {
+        return _activeMoveChunkStates.begin()->second.constructErrorStatus();
     }
 
-    _activeMoveChunkState.emplace(args);
+    it = _activeMoveChunkStates.emplace(args.getNss(), ActiveMoveChunkState(args)).first;
 
-    return {ScopedDonateChunk(this, true, _activeMoveChunkState->notification)};
+    return {ScopedDonateChunk(this, args.getNss(), true, it->second.notification)};
 }
 
 StatusWith<ScopedReceiveChunk> ActiveMigrationsRegistry::registerReceiveChunk(
@@ -72,8 +84,8 @@ StatusWith<ScopedReceiveChunk> ActiveMigrationsRegistry::registerReceiveChunk(
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->constructErrorStatus();
+    if (!_activeMoveChunkStates.empty()) {
+        return _activeMoveChunkStates.begin()->second.constructErrorStatus();
     }
 
     _activeReceiveChunkState.emplace(nss, chunkRange, fromShardId);
@@ -81,46 +93,40 @@ StatusWith<ScopedReceiveChunk> ActiveMigrationsRegistry::registerReceiveChunk(
     return {ScopedReceiveChunk(this)};
 }
 
-boost::optional<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNss() {
+std::vector<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNamespaces() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->args.getNss();
+
+    std::vector<NamespaceString> namespaces;
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        namespaces.push_back(activeMoveChunkState.first);
     }
 
-    return boost::none;
+    return namespaces;
 }
 
-BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContext* opCtx) {
-    boost::optional<NamespaceString> nss;
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-        if (_activeMoveChunkState) {
-            nss = _activeMoveChunkState->args.getNss();
-        }
-    }
-
-    // The state of the MigrationSourceManager could change between taking and releasing the mutex
-    // above and then taking the collection lock here, but that's fine because it isn't important to
-    // return information on a migration that just ended or started. This is just best effort and
+std::vector<BSONObj> ActiveMigrationsRegistry::getActiveMigrationStatusReports(
+    OperationContext* opCtx) {
+    // The state of the MigrationSourceManagers could change between taking and releasing the mutex
+    // here and then taking each collection lock below, but that's fine because it isn't important
+    // to return information on a migration that just ended or started. This is just best effort and
     // desireable for reporting, and then diagnosing, migrations that are stuck.
-    if (nss) {
+    std::vector<BSONObj> reports;
+    for (const auto& nss : getActiveDonateChunkNamespaces()) {
         // Lock the collection so nothing changes while we're getting the migration report.
-        AutoGetCollection autoColl(opCtx, nss.get(), MODE_IS);
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
 
-        auto css = CollectionShardingState::get(opCtx, nss.get());
+        auto css = CollectionShardingState::get(opCtx, nss);
         if (css->getMigrationSourceManager()) {
-            return css->getMigrationSourceManager()->getMigrationStatusReport();
+            reports.push_back(css->getMigrationSourceManager()->getMigrationStatusReport());
         }
     }
 
-    return BSONObj();
+    return reports;
 }
 
-void ActiveMigrationsRegistry::_clearDonateChunk() {
+void ActiveMigrationsRegistry::_clearDonateChunk(const NamespaceString& nss) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    invariant(_activeMoveChunkState);
-    _activeMoveChunkState.reset();
+    invariant(_activeMoveChunkStates.erase(nss));
 }
 
 void ActiveMigrationsRegistry::_clearReceiveChunk() {
@@ -152,9 +158,11 @@ Status ActiveMigrationsRegistry::ActiveReceiveChunkState::constructErrorStatus()
 }
 
 ScopedDonateChunk::ScopedDonateChunk(ActiveMigrationsRegistry* registry,
+                                     NamespaceString nss,
                                      bool shouldExecute,
                                      std::shared_ptr<Notification<Status>> completionNotification)
     : _registry(registry),
+      _nss(std::move(nss)),
       _shouldExecute(shouldExecute),
       _completionNotification(std::move(completionNotification)) {}
 
@@ -162,7 +170,7 @@ ScopedDonateChunk::~ScopedDonateChunk() {
     if (_registry && _shouldExecute) {
         // If this is a newly started migration the caller must always signal on completion
         invariant(*_completionNotification);
-        _registry->_clearDonateChunk();
+        _registry->_clearDonateChunk(_nss);
     }
 }
 
@@ -174,6 +182,7 @@ ScopedDonateChunk& ScopedDonateChunk::operator=(ScopedDonateChunk&& other) {
     if (&other != this) {
         _registry = other._registry;
         other._registry = nullptr;
+        _nss = std::move(other._nss);
         _shouldExecute = other._shouldExecute;
         _completionNotification = std::move(other._completionNotification);
     }
@@ -29,9 +29,13 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <map>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/s/migration_session_id.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/request_types/move_chunk_request.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
@@ -45,9 +49,13 @@ class ScopedReceiveChunk;
 template <typename T>
 class StatusWith;
 
+// Maximum number of chunks of distinct collections which a shard may donate at the same time
+extern AtomicInt32 maxConcurrentDonateChunks;
+
 /**
- * Thread-safe object that keeps track of the active migrations running on a node and limits them
- * to only one per shard. There is only one instance of this object per shard.
+ * Thread-safe object that keeps track of the active migrations running on a node. A shard may
+ * either receive a single chunk or donate chunks of up to 'maxConcurrentDonateChunks' distinct
+ * collections at a time, but never both. There is only one instance of this object per shard.
  */
 class ActiveMigrationsRegistry {
     MONGO_DISALLOW_COPYING(ActiveMigrationsRegistry);
@@ -57,8 +65,9 @@ public:
     ~ActiveMigrationsRegistry();
 
     /**
-     * If there are no migrations running on this shard, registers an active migration with the
-     * specified arguments. Returns a ScopedDonateChunk, which must be signaled by the
+     * If this shard is not receiving a chunk, is not already donating a chunk of the same
+     * collection and is below the limit of concurrent donations, registers an active migration
+     * with the specified arguments. Returns a ScopedDonateChunk, which must be signaled by the
      * caller before it goes out of scope.
      *
      * If there is an active migration already running on this shard and it has the exact same
@@ -81,18 +90,19 @@ public:
                                                         const ShardId& fromShardId);
 
     /**
-     * If a migration has been previously registered through a call to registerDonateChunk, returns
-     * that namespace. Otherwise returns boost::none.
+     * Returns the namespaces of all the migrations, which have been previously registered through
+     * a call to registerDonateChunk and are still active. Returns an empty vector if this shard is
+     * not donating any chunks.
      */
-    boost::optional<NamespaceString> getActiveDonateChunkNss();
+    std::vector<NamespaceString> getActiveDonateChunkNamespaces();
 
     /**
-     * Returns a report on the active migration if there currently is one. Otherwise, returns an
-     * empty BSONObj.
+     * Returns a report on each chunk this shard is currently donating, ordered by namespace. The
+     * result is empty if no chunk is being donated.
      *
-     * Takes an IS lock on the namespace of the active migration, if one is active.
+     * Takes an IS lock on the namespace of each active migration in turn.
      */
-    BSONObj getActiveMigrationStatusReport(OperationContext* opCtx);
+    std::vector<BSONObj> getActiveMigrationStatusReports(OperationContext* opCtx);
 
 private:
     friend class ScopedDonateChunk;
@@ -139,7 +149,7 @@ private:
      * Unregisters a previously registered namespace with an ongoing migration. Must only be called
      * if a previous call to registerDonateChunk has succeeded.
      */
-    void _clearDonateChunk();
+    void _clearDonateChunk(const NamespaceString& nss);
 
     /**
      * Unregisters a previously registered incoming migration. Must only be called if a previous
@@ -150,8 +160,8 @@ private:
     // Protects the state below
     stdx::mutex _mutex;
 
-    // If there is an active moveChunk operation, this field contains the original request
-    boost::optional<ActiveMoveChunkState> _activeMoveChunkState;
+    // Contains the original request of each active moveChunk operation, keyed by namespace
+    std::map<NamespaceString, ActiveMoveChunkState> _activeMoveChunkStates;
 
     // If there is an active chunk receive operation, this field contains the original session id
     boost::optional<ActiveReceiveChunkState> _activeReceiveChunkState;
@@ -167,6 +177,7 @@ class ScopedDonateChunk {
 
 public:
     ScopedDonateChunk(ActiveMigrationsRegistry* registry,
+                      NamespaceString nss,
                       bool shouldExecute,
                       std::shared_ptr<Notification<Status>> completionNotification);
     ~ScopedDonateChunk();
@@ -200,6 +211,9 @@ private:
     // Registry from which to unregister the migration. Not owned.
     ActiveMigrationsRegistry* _registry;
 
+    // Namespace under which the migration is registered
+    NamespaceString _nss;
+
     /**
      * Whether the holder is the first in line for a newly started migration (in which case the
      * destructor must unregister) or the caller is joining on an already-running migration
@@ -35,6 +35,7 @@
 #include "mongo/db/service_context_noop.h"
 #include "mongo/s/request_types/move_chunk_request.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -98,14 +99,16 @@ TEST_F(MoveChunkRegistration, ScopedDonateChunkMoveConstructorAndAssignment) {
 }
 
 TEST_F(MoveChunkRegistration, GetActiveMigrationNamespace) {
-    ASSERT(!_registry.getActiveDonateChunkNss());
+    ASSERT(_registry.getActiveDonateChunkNamespaces().empty());
 
     const NamespaceString nss("TestDB", "TestColl");
 
     auto originalScopedDonateChunk =
         assertGet(_registry.registerDonateChunk(createMoveChunkRequest(nss)));
 
-    ASSERT_EQ(nss.ns(), _registry.getActiveDonateChunkNss()->ns());
+    const auto namespaces = _registry.getActiveDonateChunkNamespaces();
+    ASSERT_EQ(1U, namespaces.size());
+    ASSERT_EQ(nss.ns(), namespaces.front().ns());
 
     // Need to signal the registered migration so the destructor doesn't invariant
     originalScopedDonateChunk.signalComplete(Status::OK());
@@ -123,6 +126,39 @@ TEST_F(MoveChunkRegistration, SecondMigrationReturnsConflictingOperationInProgre
     originalScopedDonateChunk.signalComplete(Status::OK());
 }
 
+TEST_F(MoveChunkRegistration, ConcurrentMigrationsOfDistinctCollections) {
+    const auto originalMaxConcurrentDonateChunks = maxConcurrentDonateChunks.load();
+    maxConcurrentDonateChunks.store(2);
+    ON_BLOCK_EXIT([&] { maxConcurrentDonateChunks.store(originalMaxConcurrentDonateChunks); });
+
+    auto firstScopedDonateChunk = assertGet(_registry.registerDonateChunk(
+        createMoveChunkRequest(NamespaceString("TestDB", "TestColl1"))));
+    ASSERT(firstScopedDonateChunk.mustExecute());
+
+    auto secondScopedDonateChunk = assertGet(_registry.registerDonateChunk(
+        createMoveChunkRequest(NamespaceString("TestDB", "TestColl2"))));
+    ASSERT(secondScopedDonateChunk.mustExecute());
+    ASSERT_EQ(2U, _registry.getActiveDonateChunkNamespaces().size());
+
+    // The limit of concurrent donations has been reached
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry
+                  .registerDonateChunk(
+                      createMoveChunkRequest(NamespaceString("TestDB", "TestColl3")))
+                  .getStatus());
+
+    // A shard, which is donating chunks cannot receive any
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry
+                  .registerReceiveChunk(NamespaceString("TestDB", "TestColl4"),
+                                        ChunkRange(BSON("Key" << -100), BSON("Key" << 100)),
+                                        ShardId("shard0003"))
+                  .getStatus());
+
+    firstScopedDonateChunk.signalComplete(Status::OK());
+    secondScopedDonateChunk.signalComplete(Status::OK());
+}
+
 TEST_F(MoveChunkRegistration, SecondMigrationWithSameArgumentsJoinsFirst) {
     auto originalScopedDonateChunk = assertGet(_registry.registerDonateChunk(
         createMoveChunkRequest(NamespaceString("TestDB", "TestColl"))));
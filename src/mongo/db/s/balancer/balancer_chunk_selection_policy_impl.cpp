@@ -252,7 +252,9 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
     }
 
     MigrateInfoVector candidateChunks;
-    std::set<ShardId> usedShards;
+    MigrationSlots slots = balancerThroughputAwareMigrations.load()
+        ? MigrationSlots::makeThroughputAware(shardStats)
+        : MigrationSlots();
 
     for (const auto& coll : collections) {
         if (coll.getDropped()) {
@@ -267,7 +269,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
         }
 
         auto candidatesStatus = _getMigrateCandidatesForCollection(
-            opCtx, nss, shardStats, aggressiveBalanceHint, &usedShards);
+            opCtx, nss, shardStats, aggressiveBalanceHint, &slots);
         if (candidatesStatus == ErrorCodes::NamespaceNotFound) {
             // Namespace got dropped before we managed to get to it, so just skip it
             continue;
@@ -410,7 +412,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
     const NamespaceString& nss,
     const ShardStatisticsVector& shardStats,
     bool aggressiveBalanceHint,
-    std::set<ShardId>* usedShards) {
+    MigrationSlots* slots) {
     auto routingInfoStatus =
         Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx, nss);
     if (!routingInfoStatus.isOK()) {
@@ -467,7 +469,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
         }
     }
 
-    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, usedShards);
+    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, slots);
 }
 
 }  // namespace mongo
@@ -70,7 +70,7 @@ private:
         const NamespaceString& nss,
         const ShardStatisticsVector& shardStats,
         bool aggressiveBalanceHint,
-        std::set<ShardId>* usedShards);
+        MigrationSlots* slots);
 
     // Source for obtaining cluster statistics. Not owned and must not be destroyed before the
     // policy object is destroyed.
@@ -32,6 +32,9 @@
 
 #include "mongo/db/s/balancer/balancer_policy.h"
 
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
 #include "mongo/util/log.h"
@@ -39,6 +42,11 @@
 
 namespace mongo {
 
+MONGO_EXPORT_SERVER_PARAMETER(balancerThroughputAwareMigrations, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(balancerMigrationBudgetMBPerSec, int, 100);
+MONGO_EXPORT_SERVER_PARAMETER(balancerMigrationBudgetHalvingActiveClients, int, 64);
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxConcurrentDonationsPerShard, int, 1);
+
 using std::map;
 using std::numeric_limits;
 using std::set;
@@ -217,6 +225,111 @@ string DistributionStatus::toString() const {
     return builder.obj().toString();
 }
 
+MigrationSlots::MigrationSlots() = default;
+
+MigrationSlots MigrationSlots::makeThroughputAware(const ShardStatisticsVector& shardStats) {
+    MigrationSlots slots;
+    slots._throughputAware = true;
+    slots._maxDonationsPerShard =
+        static_cast<size_t>(std::max(1, balancerMaxConcurrentDonationsPerShard.load()));
+
+    const uint64_t idleBudgetBytesPerSec =
+        static_cast<uint64_t>(std::max(1, balancerMigrationBudgetMBPerSec.load())) * 1024 * 1024;
+    const uint64_t halvingActiveClients =
+        static_cast<uint64_t>(std::max(1, balancerMigrationBudgetHalvingActiveClients.load()));
+
+    for (const auto& stat : shardStats) {
+        auto& shard = slots._shards[stat.shardId];
+        shard.budgetBytesPerSec = idleBudgetBytesPerSec * halvingActiveClients /
+            (halvingActiveClients + stat.activeClients);
+        shard.donorBytesPerSec = stat.donorMigrationBytesPerSec;
+        shard.recipientBytesPerSec = stat.recipientMigrationBytesPerSec;
+    }
+
+    return slots;
+}
+
+bool MigrationSlots::canDonate(const ShardId& shardId, const NamespaceString& nss) const {
+    auto it = _shards.find(shardId);
+    if (it == _shards.end()) {
+        return true;
+    }
+
+    const auto& shard = it->second;
+    if (shard.excluded || shard.receiving) {
+        return false;
+    }
+
+    if (shard.donatedNamespaces.empty()) {
+        return true;
+    }
+
+    // A collection can only have one active migration on its donor shard
+    if (!_throughputAware || shard.donatedNamespaces.count(nss) ||
+        shard.donatedNamespaces.size() >= _maxDonationsPerShard) {
+        return false;
+    }
+
+    // Without an observed rate, a migration is assumed to use the donor's entire budget
+    const uint64_t nextBytesPerSec =
+        shard.donorBytesPerSec ? shard.donorBytesPerSec : shard.budgetBytesPerSec;
+    return shard.committedBytesPerSec + nextBytesPerSec <= shard.budgetBytesPerSec;
+}
+
+bool MigrationSlots::canReceive(const ShardId& shardId) const {
+    auto it = _shards.find(shardId);
+    if (it == _shards.end()) {
+        return true;
+    }
+
+    const auto& shard = it->second;
+    return !shard.excluded && !shard.receiving && shard.donatedNamespaces.empty();
+}
+
+uint64_t MigrationSlots::expectedBytesPerSec(const ShardId& from, const ShardId& to) const {
+    auto fromIt = _shards.find(from);
+    const uint64_t donorBytesPerSec =
+        (fromIt != _shards.end()) ? fromIt->second.donorBytesPerSec : 0;
+
+    auto toIt = _shards.find(to);
+    const uint64_t recipientBytesPerSec =
+        (toIt != _shards.end()) ? toIt->second.recipientBytesPerSec : 0;
+
+    if (!donorBytesPerSec || !recipientBytesPerSec) {
+        return std::max(donorBytesPerSec, recipientBytesPerSec);
+    }
+
+    return std::min(donorBytesPerSec, recipientBytesPerSec);
+}
+
+void MigrationSlots::add(const NamespaceString& nss, const ShardId& from, const ShardId& to) {
+    invariant(from != to);
+    invariant(canDonate(from, nss));
+    invariant(canReceive(to));
+
+    const uint64_t bytesPerSec = expectedBytesPerSec(from, to);
+
+    auto& donor = _shards[from];
+    donor.donatedNamespaces.insert(nss);
+    donor.committedBytesPerSec += bytesPerSec ? bytesPerSec : donor.budgetBytesPerSec;
+
+    _shards[to].receiving = true;
+}
+
+void MigrationSlots::exclude(const ShardId& shardId) {
+    _shards[shardId].excluded = true;
+}
+
+bool MigrationSlots::isUsed(const ShardId& shardId) const {
+    auto it = _shards.find(shardId);
+    if (it == _shards.end()) {
+        return false;
+    }
+
+    const auto& shard = it->second;
+    return shard.excluded || shard.receiving || !shard.donatedNamespaces.empty();
+}
+
 Status BalancerPolicy::isShardSuitableReceiver(const ClusterStatistics::ShardStatistics& stat,
                                                const string& chunkTag) {
     if (stat.isSizeMaxed()) {
@@ -240,12 +353,14 @@ Status BalancerPolicy::isShardSuitableReceiver(const ClusterStatistics::ShardSta
 ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                      const DistributionStatus& distribution,
                                                      const string& tag,
-                                                     const set<ShardId>& excludedShards) {
+                                                     const ShardId& from,
+                                                     const MigrationSlots& slots) {
     ShardId best;
     unsigned minChunks = numeric_limits<unsigned>::max();
+    uint64_t bestBytesPerSec = 0;
 
     for (const auto& stat : shardStats) {
-        if (excludedShards.count(stat.shardId))
+        if (!slots.canReceive(stat.shardId))
             continue;
 
         auto status = isShardSuitableReceiver(stat, tag);
@@ -254,12 +369,19 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
         }
 
         unsigned myChunks = distribution.numberOfChunksInShard(stat.shardId);
-        if (myChunks >= minChunks) {
+        if (myChunks > minChunks) {
+            continue;
+        }
+
+        const uint64_t myBytesPerSec = slots.expectedBytesPerSec(from, stat.shardId);
+        if (myChunks == minChunks &&
+            (!slots.isThroughputAware() || myBytesPerSec <= bestBytesPerSec)) {
             continue;
         }
 
         best = stat.shardId;
         minChunks = myChunks;
+        bestBytesPerSec = myBytesPerSec;
     }
 
     return best;
@@ -268,12 +390,12 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
 ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
                                                 const string& chunkTag,
-                                                const set<ShardId>& excludedShards) {
+                                                const MigrationSlots& slots) {
     ShardId worst;
     unsigned maxChunks = 0;
 
     for (const auto& stat : shardStats) {
-        if (excludedShards.count(stat.shardId))
+        if (!slots.canDonate(stat.shardId, distribution.nss()))
             continue;
 
         const unsigned shardChunkCount =
@@ -291,7 +413,7 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
 vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
                                             bool shouldAggressivelyBalance,
-                                            std::set<ShardId>* usedShards) {
+                                            MigrationSlots* slots) {
     vector<MigrateInfo> migrations;
 
     // 1) Check for shards, which are in draining mode
@@ -300,7 +422,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
             if (!stat.isDraining)
                 continue;
 
-            if (usedShards->count(stat.shardId))
+            if (!slots->canDonate(stat.shardId, distribution.nss()))
                 continue;
 
             const vector<ChunkType>& chunks = distribution.getChunks(stat.shardId);
@@ -321,8 +443,8 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
 
                 const string tag = distribution.getTagForChunk(chunk);
 
-                const ShardId to =
-                    _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
+                const ShardId to = _getLeastLoadedReceiverShard(
+                    shardStats, distribution, tag, stat.shardId, *slots);
                 if (!to.isValid()) {
                     if (migrations.empty()) {
                         warning() << "Chunk " << redact(chunk.toString())
@@ -333,8 +455,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
 
                 invariant(to != stat.shardId);
                 migrations.emplace_back(to, chunk);
-                invariant(usedShards->insert(stat.shardId).second);
-                invariant(usedShards->insert(to).second);
+                slots->add(distribution.nss(), stat.shardId, to);
                 break;
             }
 
@@ -348,7 +469,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
     // 2) Check for chunks, which are on the wrong shard and must be moved off of it
     if (!distribution.tags().empty()) {
         for (const auto& stat : shardStats) {
-            if (usedShards->count(stat.shardId))
+            if (!slots->canDonate(stat.shardId, distribution.nss()))
                 continue;
 
             const vector<ChunkType>& chunks = distribution.getChunks(stat.shardId);
@@ -368,8 +489,8 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
                     continue;
                 }
 
-                const ShardId to =
-                    _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
+                const ShardId to = _getLeastLoadedReceiverShard(
+                    shardStats, distribution, tag, stat.shardId, *slots);
                 if (!to.isValid()) {
                     if (migrations.empty()) {
                         warning() << "Chunk " << redact(chunk.toString()) << " violates zone "
@@ -380,8 +501,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
 
                 invariant(to != stat.shardId);
                 migrations.emplace_back(to, chunk);
-                invariant(usedShards->insert(stat.shardId).second);
-                invariant(usedShards->insert(to).second);
+                slots->add(distribution.nss(), stat.shardId, to);
                 break;
             }
         }
@@ -430,7 +550,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
                                   idealNumberOfChunksPerShardForTag,
                                   imbalanceThreshold,
                                   &migrations,
-                                  usedShards))
+                                  slots))
             ;
     }
 
@@ -443,8 +563,8 @@ boost::optional<MigrateInfo> BalancerPolicy::balanceSingleChunk(
     const DistributionStatus& distribution) {
     const string tag = distribution.getTagForChunk(chunk);
 
-    ShardId newShardId =
-        _getLeastLoadedReceiverShard(shardStats, distribution, tag, set<ShardId>());
+    ShardId newShardId = _getLeastLoadedReceiverShard(
+        shardStats, distribution, tag, chunk.getShard(), MigrationSlots());
     if (!newShardId.isValid() || newShardId == chunk.getShard()) {
         return boost::optional<MigrateInfo>();
     }
@@ -458,8 +578,8 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
                                         size_t idealNumberOfChunksPerShardForTag,
                                         size_t imbalanceThreshold,
                                         vector<MigrateInfo>* migrations,
-                                        set<ShardId>* usedShards) {
-    const ShardId from = _getMostOverloadedShard(shardStats, distribution, tag, *usedShards);
+                                        MigrationSlots* slots) {
+    const ShardId from = _getMostOverloadedShard(shardStats, distribution, tag, *slots);
     if (!from.isValid())
         return false;
 
@@ -469,7 +589,7 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
     if (max <= idealNumberOfChunksPerShardForTag)
         return false;
 
-    const ShardId to = _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
+    const ShardId to = _getLeastLoadedReceiverShard(shardStats, distribution, tag, from, *slots);
     if (!to.isValid()) {
         if (migrations->empty()) {
             log() << "No available shards to take chunks for zone [" << tag << "]";
@@ -510,8 +630,7 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
         }
 
         migrations->emplace_back(to, chunk);
-        invariant(usedShards->insert(chunk.getShard()).second);
-        invariant(usedShards->insert(to).second);
+        slots->add(distribution.nss(), chunk.getShard(), to);
         return true;
     }
 
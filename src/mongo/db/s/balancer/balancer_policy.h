@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include <vector>
 
@@ -36,11 +37,27 @@
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_id.h"
 
 namespace mongo {
 
+// Whether the balancer schedules concurrent migrations based on the observed migration throughput
+// and load of the shards instead of at most one migration per shard per round
+extern AtomicBool balancerThroughputAwareMigrations;
+
+// The rate at which an idle shard may transfer documents for migrations it donates, in megabytes
+// per second. The budget shrinks as the shard gets busier and is halved once
+// 'balancerMigrationBudgetHalvingActiveClients' client operations are active on it.
+extern AtomicInt32 balancerMigrationBudgetMBPerSec;
+extern AtomicInt32 balancerMigrationBudgetHalvingActiveClients;
+
+// The most chunks a shard may donate at the same time. Must not be set higher than the shards'
+// maxConcurrentDonateChunks, otherwise the excess migrations will fail to start, so both default
+// to 1 and have to be raised together.
+extern AtomicInt32 balancerMaxConcurrentDonationsPerShard;
+
 struct ZoneRange {
     ZoneRange(const BSONObj& a_min, const BSONObj& a_max, const std::string& _zone);
 
@@ -160,6 +177,91 @@ private:
     std::set<std::string> _allTags;
 };
 
+/**
+ * Keeps track of the migrations, which have been selected for each shard during a balancer round,
+ * so that the policy does not select more of them than the shards can take part in concurrently.
+ *
+ * By default every shard takes part in at most one migration per round. In throughput-aware mode a
+ * shard still receives at most one chunk and cannot both donate and receive, but it may donate
+ * chunks of different collections to several recipients as long as the sum of their expected
+ * transfer rates stays within its migration budget.
+ */
+class MigrationSlots {
+public:
+    MigrationSlots();
+
+    /**
+     * Returns slots, which pace the migrations of each shard by its observed migration throughput
+     * and load as reported in 'shardStats' and by the balancer server parameters.
+     */
+    static MigrationSlots makeThroughputAware(const ShardStatisticsVector& shardStats);
+
+    bool isThroughputAware() const {
+        return _throughputAware;
+    }
+
+    /**
+     * Returns whether the specified shard may donate another chunk of the specified collection.
+     */
+    bool canDonate(const ShardId& shardId, const NamespaceString& nss) const;
+
+    /**
+     * Returns whether the specified shard may receive another chunk.
+     */
+    bool canReceive(const ShardId& shardId) const;
+
+    /**
+     * Returns the rate at which a chunk is expected to be transferred between the specified shards
+     * in bytes per second, or zero if neither of them has taken part in a migration before.
+     */
+    uint64_t expectedBytesPerSec(const ShardId& from, const ShardId& to) const;
+
+    /**
+     * Records that a chunk of the specified collection will be migrated between the specified
+     * shards. Must only be called if both canDonate and canReceive return true for them.
+     */
+    void add(const NamespaceString& nss, const ShardId& from, const ShardId& to);
+
+    /**
+     * Prevents the specified shard from taking part in any more migrations.
+     */
+    void exclude(const ShardId& shardId);
+
+    /**
+     * Returns whether any migrations have been selected for the specified shard or if it has been
+     * excluded.
+     */
+    bool isUsed(const ShardId& shardId) const;
+
+private:
+    struct ShardSlots {
+        // The budget of the shard and its observed migration rates, in bytes per second. Only used
+        // in throughput-aware mode.
+        uint64_t budgetBytesPerSec{0};
+        uint64_t donorBytesPerSec{0};
+        uint64_t recipientBytesPerSec{0};
+
+        // Sum of the expected rates of the migrations donated by this shard
+        uint64_t committedBytesPerSec{0};
+
+        // Collections for which this shard is donating a chunk
+        std::set<NamespaceString> donatedNamespaces;
+
+        bool receiving{false};
+        bool excluded{false};
+    };
+
+    // Whether shards may donate more than one chunk at a time
+    bool _throughputAware{false};
+
+    // The most chunks a shard may donate at the same time
+    size_t _maxDonationsPerShard{1};
+
+    // Per-shard accounting. Shards without an entry have not been used yet and, in
+    // throughput-aware mode, have no known migration rates or budget.
+    std::map<ShardId, ShardSlots> _shards;
+};
+
 class BalancerPolicy {
 public:
     /**
@@ -184,14 +286,14 @@ public:
      * The shouldAggressivelyBalance parameter causes the threshold for chunk could disparity
      * between shards to be lowered.
      *
-     * The usedShards parameter is in/out and it contains the set of shards, which have already been
-     * used for migrations. Used so we don't return multiple conflicting migrations for the same
-     * shard.
+     * The slots parameter is in/out and it contains the migrations, which have already been
+     * selected for each shard. Used so we don't return more migrations for a shard than it can
+     * take part in at the same time.
      */
     static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
                                             bool shouldAggressivelyBalance,
-                                            std::set<ShardId>* usedShards);
+                                            MigrationSlots* slots);
 
     /**
      * Using the specified distribution information, returns a suggested better location for the
@@ -204,12 +306,14 @@ public:
 private:
     /**
      * Return the shard with the specified tag, which has the least number of chunks. If the tag is
-     * empty, considers all shards.
+     * empty, considers all shards. In throughput-aware mode ties are broken in favour of the shard
+     * to which chunks are expected to be transferred the fastest from the specified donor.
      */
     static ShardId _getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
                                                 const std::string& tag,
-                                                const std::set<ShardId>& excludedShards);
+                                                const ShardId& from,
+                                                const MigrationSlots& slots);
 
     /**
      * Return the shard which has the least number of chunks with the specified tag. If the tag is
@@ -218,7 +322,7 @@ private:
     static ShardId _getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                            const DistributionStatus& distribution,
                                            const std::string& chunkTag,
-                                           const std::set<ShardId>& excludedShards);
+                                           const MigrationSlots& slots);
 
     /**
      * Selects one chunk for the specified zone (if appropriate) to be moved in order to bring the
@@ -238,7 +342,7 @@ private:
                                    size_t idealNumberOfChunksPerShardForTag,
                                    size_t imbalanceThreshold,
                                    std::vector<MigrateInfo>* migrations,
-                                   std::set<ShardId>* usedShards);
+                                   MigrationSlots* slots);
 };
 
 }  // namespace mongo
@@ -0,0 +1,300 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <map>
+
+#include "mongo/db/keypattern.h"
+#include "mongo/db/s/balancer/balancer_policy.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+/**
+ * Simulates the rebalancing of a 100 shard cluster through rounds of BalancerPolicy::balance. The
+ * simulation models the transfer rates of the shards and feeds back the same migration statistics,
+ * which the shards report through serverStatus, so that the serial and the throughput-aware
+ * policies can be compared on the number of rounds and the time it takes them to balance.
+ */
+namespace mongo {
+namespace {
+
+using ShardStatistics = ClusterStatistics::ShardStatistics;
+
+const int kNumShards = 100;
+const int kNumInitialShards = 10;
+const int kNumCollections = 8;
+const int kChunksPerInitialShard = 20;
+
+const uint64_t kMB = 1024 * 1024;
+const uint64_t kChunkBytes = 32 * kMB;
+
+// Fixed cost of every migration, which does not depend on the transfer rate (metadata refreshes,
+// critical section, commit)
+const double kMigrationOverheadSecs = 1.0;
+
+const size_t kMaxRounds = 1000;
+
+/**
+ * The actual transfer capabilities of a simulated shard. The balancer can only learn about them
+ * through the migration statistics reported by the shard.
+ */
+struct SimulatedShard {
+    // Rate at which a single migration can read from or write to the shard
+    uint64_t perMigrationBytesPerSec{0};
+
+    // Rate, which is shared by all the migrations donated by the shard at the same time
+    uint64_t diskBytesPerSec{0};
+
+    uint64_t activeClients{0};
+
+    // Equivalents of the counters in the shardingStatistics serverStatus section
+    uint64_t bytesClonedOnDonor{0};
+    double donorCloneSecs{0};
+    uint64_t bytesClonedOnRecipient{0};
+    double recipientCloneSecs{0};
+};
+
+struct SimulationResult {
+    size_t rounds{0};
+    size_t migrations{0};
+    double seconds{0};
+};
+
+class RebalanceSimulation {
+public:
+    /**
+     * Creates a cluster to which 90 empty shards have just been added. All the chunks of all the
+     * collections are on the 10 original shards, which also serve the application load.
+     */
+    RebalanceSimulation() {
+        PseudoRandom random(1);
+
+        for (int i = 0; i < kNumShards; i++) {
+            SimulatedShard shard;
+
+            // Some of the shards are considerably slower, for example because of older hardware
+            shard.perMigrationBytesPerSec = (random.nextInt32(4) == 0 ? 8 : 30) * kMB;
+            shard.diskBytesPerSec = 120 * kMB;
+            shard.activeClients = (i < kNumInitialShards) ? 16 : 0;
+
+            _shards.emplace(ShardId(str::stream() << "shard" << i), shard);
+        }
+
+        const KeyPattern shardKeyPattern(BSON("x" << 1));
+        const int64_t totalNumChunks = kNumInitialShards * kChunksPerInitialShard;
+
+        for (int c = 0; c < kNumCollections; c++) {
+            const NamespaceString nss("TestDB", str::stream() << "TestColl" << c);
+
+            ShardToChunksMap& chunkMap = _collections[nss];
+            ChunkVersion chunkVersion(1, 0, OID::gen());
+            int64_t currentChunk = 0;
+
+            for (const auto& shard : _shards) {
+                // Ensure that an entry is created
+                chunkMap[shard.first];
+            }
+
+            for (int i = 0; i < kNumInitialShards; i++) {
+                const ShardId shardId(str::stream() << "shard" << i);
+
+                for (int j = 0; j < kChunksPerInitialShard; j++, currentChunk++) {
+                    ChunkType chunk;
+                    chunk.setNS(nss);
+                    chunk.setMin(currentChunk == 0 ? shardKeyPattern.globalMin()
+                                                   : BSON("x" << currentChunk));
+                    chunk.setMax(currentChunk == totalNumChunks - 1
+                                     ? shardKeyPattern.globalMax()
+                                     : BSON("x" << currentChunk + 1));
+                    chunk.setShard(shardId);
+                    chunk.setVersion(chunkVersion);
+
+                    chunkVersion.incMajor();
+
+                    chunkMap[shardId].push_back(std::move(chunk));
+                }
+            }
+        }
+    }
+
+    /**
+     * Runs balancer rounds until the policy does not select any more migrations. Each round lasts
+     * as long as its slowest migration, because the balancer waits for all of them to complete
+     * before it starts the next one.
+     */
+    SimulationResult run(bool throughputAware) {
+        SimulationResult result;
+
+        while (result.rounds < kMaxRounds) {
+            const auto shardStats = _makeShardStats();
+
+            MigrationSlots slots = throughputAware ? MigrationSlots::makeThroughputAware(shardStats)
+                                                   : MigrationSlots();
+
+            std::vector<MigrateInfo> migrations;
+            for (const auto& coll : _collections) {
+                const auto collMigrations = BalancerPolicy::balance(
+                    shardStats, DistributionStatus(coll.first, coll.second), false, &slots);
+                migrations.insert(migrations.end(), collMigrations.begin(), collMigrations.end());
+            }
+
+            if (migrations.empty()) {
+                break;
+            }
+
+            result.rounds++;
+            result.migrations += migrations.size();
+            result.seconds += _executeRound(migrations);
+        }
+
+        return result;
+    }
+
+    /**
+     * Returns the most chunks of any one collection on any one shard.
+     */
+    size_t maxChunksPerShard() const {
+        size_t maxChunks = 0;
+        for (const auto& coll : _collections) {
+            for (const auto& shardChunks : coll.second) {
+                maxChunks = std::max(maxChunks, shardChunks.second.size());
+            }
+        }
+
+        return maxChunks;
+    }
+
+private:
+    ShardStatisticsVector _makeShardStats() const {
+        ShardStatisticsVector shardStats;
+
+        for (const auto& entry : _shards) {
+            const auto& shard = entry.second;
+
+            ShardStatistics stat(entry.first, 0, 0, false, {}, "");
+            if (shard.donorCloneSecs > 0) {
+                stat.donorMigrationBytesPerSec = shard.bytesClonedOnDonor / shard.donorCloneSecs;
+            }
+            if (shard.recipientCloneSecs > 0) {
+                stat.recipientMigrationBytesPerSec =
+                    shard.bytesClonedOnRecipient / shard.recipientCloneSecs;
+            }
+            stat.activeClients = shard.activeClients;
+
+            shardStats.push_back(std::move(stat));
+        }
+
+        return shardStats;
+    }
+
+    /**
+     * Moves the chunks and updates the migration statistics of the shards. Returns the duration of
+     * the round in seconds.
+     */
+    double _executeRound(const std::vector<MigrateInfo>& migrations) {
+        std::map<ShardId, size_t> numDonations;
+        for (const auto& migration : migrations) {
+            numDonations[migration.from]++;
+        }
+
+        double roundSecs = 0;
+
+        for (const auto& migration : migrations) {
+            auto& donor = _shards[migration.from];
+            auto& recipient = _shards[migration.to];
+
+            const double bytesPerSec =
+                std::min({donor.perMigrationBytesPerSec,
+                          donor.diskBytesPerSec / numDonations[migration.from],
+                          recipient.perMigrationBytesPerSec});
+            const double cloneSecs = kChunkBytes / bytesPerSec;
+
+            donor.bytesClonedOnDonor += kChunkBytes;
+            donor.donorCloneSecs += cloneSecs;
+            recipient.bytesClonedOnRecipient += kChunkBytes;
+            recipient.recipientCloneSecs += cloneSecs;
+
+            roundSecs = std::max(roundSecs, kMigrationOverheadSecs + cloneSecs);
+
+            auto& chunkMap = _collections[migration.nss];
+            auto& fromChunks = chunkMap[migration.from];
+            auto it = std::find_if(fromChunks.begin(), fromChunks.end(), [&](const ChunkType& c) {
+                return SimpleBSONObjComparator::kInstance.evaluate(c.getMin() == migration.minKey);
+            });
+            ASSERT(it != fromChunks.end());
+
+            ChunkType chunk = *it;
+            fromChunks.erase(it);
+            chunk.setShard(migration.to);
+            chunkMap[migration.to].push_back(std::move(chunk));
+        }
+
+        return roundSecs;
+    }
+
+    std::map<ShardId, SimulatedShard> _shards;
+    std::map<NamespaceString, ShardToChunksMap> _collections;
+};
+
+TEST(BalancerPolicySimulation, RebalanceAfterAddingShards) {
+    RebalanceSimulation serialSimulation;
+    const auto serial = serialSimulation.run(false);
+
+    RebalanceSimulation throughputAwareSimulation;
+    const auto throughputAware = throughputAwareSimulation.run(true);
+
+    log() << "Serial rebalance of " << kNumShards << " shards took " << serial.rounds
+          << " rounds, " << serial.migrations << " migrations and " << serial.seconds
+          << " simulated seconds";
+    log() << "Throughput-aware rebalance of " << kNumShards << " shards took "
+          << throughputAware.rounds << " rounds, " << throughputAware.migrations
+          << " migrations and " << throughputAware.seconds << " simulated seconds";
+
+    ASSERT_LT(serial.rounds, kMaxRounds);
+    ASSERT_LT(throughputAware.rounds, kMaxRounds);
+
+    // Both policies leave every shard with no more than one chunk of each collection above the
+    // ideal
+    const size_t idealChunksPerShard =
+        (kNumInitialShards * kChunksPerInitialShard + kNumShards - 1) / kNumShards;
+    ASSERT_LTE(serialSimulation.maxChunksPerShard(), idealChunksPerShard + 1);
+    ASSERT_LTE(throughputAwareSimulation.maxChunksPerShard(), idealChunksPerShard + 1);
+
+    ASSERT_LT(throughputAware.rounds, serial.rounds);
+    ASSERT_LT(throughputAware.seconds, serial.seconds);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -36,6 +36,7 @@
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 namespace {
@@ -113,9 +114,8 @@ std::pair<ShardStatisticsVector, ShardToChunksMap> generateCluster(
 std::vector<MigrateInfo> balanceChunks(const ShardStatisticsVector& shardStats,
                                        const DistributionStatus& distribution,
                                        bool shouldAggressivelyBalance) {
-    std::set<ShardId> usedShards;
-    return BalancerPolicy::balance(
-        shardStats, distribution, shouldAggressivelyBalance, &usedShards);
+    MigrationSlots slots;
+    return BalancerPolicy::balance(shardStats, distribution, shouldAggressivelyBalance, &slots);
 }
 
 TEST(BalancerPolicy, Basic) {
@@ -243,9 +243,10 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseSourceShardsWithMoveNe
          {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
 
     // Here kShardId0 would have been selected as a donor
-    std::set<ShardId> usedShards{kShardId0};
+    MigrationSlots slots;
+    slots.exclude(kShardId0);
     const auto migrations(BalancerPolicy::balance(
-        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &slots));
     ASSERT_EQ(1U, migrations.size());
 
     ASSERT_EQ(kShardId1, migrations[0].from);
@@ -262,9 +263,10 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseSourceShardsWithMoveNo
          {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
 
     // Here kShardId0 would have been selected as a donor
-    std::set<ShardId> usedShards{kShardId0};
+    MigrationSlots slots;
+    slots.exclude(kShardId0);
     const auto migrations(BalancerPolicy::balance(
-        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &slots));
     ASSERT_EQ(0U, migrations.size());
 }
 
@@ -276,9 +278,10 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseDestinationShards) {
          {ShardStatistics(kShardId3, kNoMaxSize, 1, false, emptyTagSet, emptyShardVersion), 1}});
 
     // Here kShardId2 would have been selected as a recipient
-    std::set<ShardId> usedShards{kShardId2};
+    MigrationSlots slots;
+    slots.exclude(kShardId2);
     const auto migrations(BalancerPolicy::balance(
-        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &slots));
     ASSERT_EQ(1U, migrations.size());
 
     ASSERT_EQ(kShardId0, migrations[0].from);
@@ -287,6 +290,98 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseDestinationShards) {
     ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMax(), migrations[0].maxKey);
 }
 
+TEST(BalancerPolicy, ThroughputAwareDonorSendsChunksOfDifferentCollectionsToSeveralRecipients) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    // Well within the default budget of 100MB/s
+    cluster.first[0].donorMigrationBytesPerSec = 20 * 1024 * 1024;
+
+    const NamespaceString otherNamespace("TestDB", "OtherTestColl");
+
+    MigrationSlots slots = MigrationSlots::makeThroughputAware(cluster.first);
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &slots));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+
+    // The same donor is used again for another collection, but not for the same one
+    ASSERT_EQ(0U,
+              BalancerPolicy::balance(
+                  cluster.first, DistributionStatus(kNamespace, cluster.second), false, &slots)
+                  .size());
+
+    const auto otherMigrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(otherNamespace, cluster.second), false, &slots));
+    ASSERT_EQ(1U, otherMigrations.size());
+    ASSERT_EQ(kShardId0, otherMigrations[0].from);
+    ASSERT_NE(migrations[0].to, otherMigrations[0].to);
+
+    // Without throughput awareness the donor can only take part in one migration
+    MigrationSlots serialSlots;
+    ASSERT_EQ(1U,
+              BalancerPolicy::balance(cluster.first,
+                                      DistributionStatus(kNamespace, cluster.second),
+                                      false,
+                                      &serialSlots)
+                  .size());
+    ASSERT_EQ(0U,
+              BalancerPolicy::balance(cluster.first,
+                                      DistributionStatus(otherNamespace, cluster.second),
+                                      false,
+                                      &serialSlots)
+                  .size());
+}
+
+TEST(BalancerPolicy, ThroughputAwareDonorStaysWithinItsBudget) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId4, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId5, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    // Two migrations fit in the default budget of 100MB/s of the idle kShardId0. The budget of the
+    // busy kShardId1 is halved, so it only has room for one.
+    cluster.first[0].donorMigrationBytesPerSec = 40 * 1024 * 1024;
+    cluster.first[1].donorMigrationBytesPerSec = 40 * 1024 * 1024;
+    cluster.first[1].activeClients = balancerMigrationBudgetHalvingActiveClients.load();
+
+    MigrationSlots slots = MigrationSlots::makeThroughputAware(cluster.first);
+
+    std::map<ShardId, size_t> donations;
+    for (int i = 0; i < 4; i++) {
+        const NamespaceString nss("TestDB", str::stream() << "TestColl" << i);
+        for (const auto& migration : BalancerPolicy::balance(
+                 cluster.first, DistributionStatus(nss, cluster.second), false, &slots)) {
+            donations[migration.from]++;
+        }
+    }
+
+    ASSERT_EQ(2U, donations[kShardId0]);
+    ASSERT_EQ(1U, donations[kShardId1]);
+}
+
+TEST(BalancerPolicy, ThroughputAwarePrefersTheFastestRecipient) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    cluster.first[1].recipientMigrationBytesPerSec = 5 * 1024 * 1024;
+    cluster.first[2].recipientMigrationBytesPerSec = 50 * 1024 * 1024;
+
+    MigrationSlots slots = MigrationSlots::makeThroughputAware(cluster.first);
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &slots));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+}
+
 TEST(BalancerPolicy, JumboChunksNotMoved) {
     auto cluster = generateCluster(
         {{ShardStatistics(kShardId0, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 4},
@@ -72,6 +72,10 @@ BSONObj ClusterStatistics::ShardStatistics::toBSON() const {
     }
 
     builder.append("version", mongoVersion);
+    builder.append("donorMigrationBytesPerSec", static_cast<long long>(donorMigrationBytesPerSec));
+    builder.append("recipientMigrationBytesPerSec",
+                   static_cast<long long>(recipientMigrationBytesPerSec));
+    builder.append("activeClients", static_cast<long long>(activeClients));
     return builder.obj();
 }
 
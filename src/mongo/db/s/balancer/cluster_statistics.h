@@ -92,6 +92,16 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // Observed rate at which this shard has transferred documents as the donor and as the
+        // recipient of a migration, in bytes per second. Zero means that the shard has not taken
+        // part in any migrations yet or that the information is not available.
+        uint64_t donorMigrationBytesPerSec{0};
+        uint64_t recipientMigrationBytesPerSec{0};
+
+        // Number of client operations which were active on this shard's primary when the
+        // statistics were collected
+        uint64_t activeClients{0};
     };
 
     virtual ~ClusterStatistics();
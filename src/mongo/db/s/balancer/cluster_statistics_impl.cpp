@@ -46,16 +46,18 @@ namespace mongo {
 namespace {
 
 const char kVersionField[] = "version";
+const char kShardingStatisticsField[] = "shardingStatistics";
+const char kGlobalLockField[] = "globalLock";
+const char kActiveClientsField[] = "activeClients";
+const char kTotalField[] = "total";
 
 /**
- * Executes the serverStatus command against the specified shard and obtains the version of the
- * running MongoD service.
+ * Executes the serverStatus command against the specified shard and returns the response.
  *
- * Returns the MongoD version in strig format or an error. Known error codes are:
+ * Known error codes are:
  *  ShardNotFound if shard by that id is not available on the registry
- *  NoSuchKey if the version could not be retrieved
  */
-StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId shardId) {
+StatusWith<BSONObj> retrieveShardServerStatus(OperationContext* opCtx, ShardId shardId) {
     auto shardRegistry = Grid::get(opCtx)->shardRegistry();
     auto shardStatus = shardRegistry->getShard(opCtx, shardId);
     if (!shardStatus.isOK()) {
@@ -76,15 +78,26 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         return commandResponse.getValue().commandStatus;
     }
 
-    BSONObj serverStatus = std::move(commandResponse.getValue().response);
+    return std::move(commandResponse.getValue().response);
+}
 
-    std::string version;
-    Status status = bsonExtractStringField(serverStatus, kVersionField, &version);
-    if (!status.isOK()) {
-        return status;
+/**
+ * Divides the cumulative number of bytes in the specified field of the shardingStatistics section
+ * by the cumulative time in the specified field. Returns zero if the shard has not reported these
+ * counters or has not spent any time migrating yet.
+ */
+uint64_t extractMigrationBytesPerSec(const BSONObj& shardingStatistics,
+                                     StringData bytesField,
+                                     StringData millisField) {
+    long long bytes = 0;
+    long long millis = 0;
+    if (!bsonExtractIntegerFieldWithDefault(shardingStatistics, bytesField, 0, &bytes).isOK() ||
+        !bsonExtractIntegerFieldWithDefault(shardingStatistics, millisField, 0, &millis).isOK() ||
+        bytes <= 0 || millis <= 0) {
+        return 0;
     }
 
-    return version;
+    return static_cast<uint64_t>(bytes * 1000 / millis);
 }
 
 }  // namespace
@@ -129,15 +142,23 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
         }
 
         std::string mongoDVersion;
+        BSONObj serverStatus;
+
+        auto serverStatusStatus = retrieveShardServerStatus(opCtx, shard.getName());
+        if (serverStatusStatus.isOK()) {
+            serverStatus = std::move(serverStatusStatus.getValue());
 
-        auto mongoDVersionStatus = retrieveShardMongoDVersion(opCtx, shard.getName());
-        if (mongoDVersionStatus.isOK()) {
-            mongoDVersion = std::move(mongoDVersionStatus.getValue());
+            auto versionStatus =
+                bsonExtractStringField(serverStatus, kVersionField, &mongoDVersion);
+            if (!versionStatus.isOK()) {
+                log() << "Unable to obtain shard version for " << shard.getName()
+                      << causedBy(versionStatus);
+            }
         } else {
-            // Since the mongod version is only used for reporting, there is no need to fail the
-            // entire round if it cannot be retrieved, so just leave it empty
+            // Since the server status is only used for reporting and for pacing migrations, there
+            // is no need to fail the entire round if it cannot be retrieved, so just leave it empty
             log() << "Unable to obtain shard version for " << shard.getName()
-                  << causedBy(mongoDVersionStatus.getStatus());
+                  << causedBy(serverStatusStatus.getStatus());
         }
 
         std::set<std::string> shardTags;
@@ -152,6 +173,23 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+
+        // The migration rates are averages over the lifetime of the shard's primary
+        auto& stat = stats.back();
+
+        const BSONObj shardingStatistics = serverStatus.getObjectField(kShardingStatisticsField);
+        stat.donorMigrationBytesPerSec = extractMigrationBytesPerSec(
+            shardingStatistics, "countBytesClonedOnDonor", "totalDonorChunkCloneTimeMillis");
+        stat.recipientMigrationBytesPerSec =
+            extractMigrationBytesPerSec(shardingStatistics,
+                                        "countBytesClonedOnRecipient",
+                                        "totalRecipientChunkCloneTimeMillis");
+
+        const BSONElement activeClients = serverStatus.getObjectField(kGlobalLockField)
+                                              .getObjectField(kActiveClientsField)[kTotalField];
+        if (activeClients.isNumber() && activeClients.safeNumberLong() > 0) {
+            stat.activeClients = activeClients.safeNumberLong();
+        }
     }
 
     return stats;
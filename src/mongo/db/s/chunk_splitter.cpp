@@ -32,8 +32,11 @@
 
 #include "mongo/db/s/chunk_splitter.h"
 
+#include <algorithm>
+
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/query.h"
+#include "mongo/db/catalog_raii.h"
 #include "mongo/db/client.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/namespace_string.h"
@@ -210,6 +213,48 @@ bool isAutoBalanceEnabled(OperationContext* opCtx,
     return collStatus.getValue().value.getAllowBalance();
 }
 
+/**
+ * Returns the split points for the chunk placed using the sample of the keys inserted into it, or
+ * an empty vector if the inserts recorded for the chunk amount to less than 'maxChunkSizeBytes'.
+ * Split points equal to the chunk's min key are not valid and are left out.
+ */
+std::vector<BSONObj> getSampledSplitPoints(OperationContext* opCtx,
+                                           const NamespaceString& nss,
+                                           const Chunk& chunk,
+                                           uint64_t maxChunkSizeBytes) {
+    const auto keySampler = chunk.getKeySampler();
+    if (!keySampler || keySampler->getBytesInserted() < maxChunkSizeBytes) {
+        return {};
+    }
+
+    // The recorded inserts overstate the size of the chunk once documents get deleted, so the
+    // number of split points is capped by the size estimate splitVector starts from, that of the
+    // whole collection, which the chunk cannot exceed
+    long long dataSize;
+    {
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+        const auto collection = autoColl.getCollection();
+        if (!collection) {
+            return {};
+        }
+        dataSize = collection->dataSize(opCtx);
+    }
+    if (dataSize < static_cast<long long>(maxChunkSizeBytes)) {
+        return {};
+    }
+
+    // Same as splitVector, aim for chunks of half the maximum size
+    const uint64_t desiredPieceBytes = maxChunkSizeBytes / 2;
+    auto splitPoints = keySampler->getSplitPoints(desiredPieceBytes, dataSize / desiredPieceBytes);
+    splitPoints.erase(std::remove_if(splitPoints.begin(),
+                                     splitPoints.end(),
+                                     [&](const BSONObj& splitPoint) {
+                                         return splitPoint.woCompare(chunk.getMin()) == 0;
+                                     }),
+                      splitPoints.end());
+    return splitPoints;
+}
+
 const auto getChunkSplitter = ServiceContext::declareDecoration<ChunkSplitter>();
 
 }  // namespace
@@ -318,16 +363,25 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                << " dataWritten since last check: " << dataWritten
                << " maxChunkSizeBytes: " << maxChunkSizeBytes;
 
-        auto splitPoints = uassertStatusOK(splitVector(opCtx.get(),
-                                                       nss,
-                                                       cm->getShardKeyPattern().toBSON(),
-                                                       chunk->getMin(),
-                                                       chunk->getMax(),
-                                                       false,
-                                                       boost::none,
-                                                       boost::none,
-                                                       boost::none,
-                                                       maxChunkSizeBytes));
+        // Once the inserts recorded for the chunk amount to more than its maximum size, the keys
+        // sampled from them are representative of its contents, so the split points can be placed
+        // without scanning the shard key index
+        auto splitPoints = getSampledSplitPoints(opCtx.get(), nss, *chunk, maxChunkSizeBytes);
+        if (splitPoints.size() <= 1) {
+            splitPoints = uassertStatusOK(splitVector(opCtx.get(),
+                                                      nss,
+                                                      cm->getShardKeyPattern().toBSON(),
+                                                      chunk->getMin(),
+                                                      chunk->getMax(),
+                                                      false,
+                                                      boost::none,
+                                                      boost::none,
+                                                      boost::none,
+                                                      maxChunkSizeBytes));
+        } else {
+            LOG(1) << "using " << splitPoints.size()
+                   << " split points sampled from the inserts into " << redact(chunk->toString());
+        }
 
         if (splitPoints.size() <= 1) {
             // No split points means there isn't enough data to split on; 1 split point means we
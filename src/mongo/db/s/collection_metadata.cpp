@@ -108,6 +108,19 @@ Status CollectionMetadata::checkChunkIsValid(const ChunkType& chunk) const {
     return Status::OK();
 }
 
+bool CollectionMetadata::queryBelongsToMe(OperationContext* opCtx,
+                                          const BSONObj& query,
+                                          const BSONObj& collation) const {
+    std::set<ShardId> shardIds;
+    try {
+        _cm->getShardIdsForQuery(opCtx, query, collation, &shardIds);
+    } catch (const DBException&) {
+        return false;
+    }
+
+    return shardIds.size() == 1 && *shardIds.begin() == _thisShardId;
+}
+
 void CollectionMetadata::toBSONBasic(BSONObjBuilder& bb) const {
     _cm->getVersion().addToBSON(bb, "collVersion");
     getShardVersion().addToBSON(bb, "shardVersion");
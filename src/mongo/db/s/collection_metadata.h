@@ -70,6 +70,15 @@ public:
         return _cm->keyBelongsToShard(key, _thisShardId);
     }
 
+    /**
+     * Returns true if the shard key of every document, which can match the given query and
+     * collation, belongs to this chunkset. If the collation is empty, the collection default
+     * collation is used. Returns false if the shard key bounds of the query cannot be determined.
+     */
+    bool queryBelongsToMe(OperationContext* opCtx,
+                          const BSONObj& query,
+                          const BSONObj& collation) const;
+
     /**
      * Given a key 'lookupKey' in the shard key range, get the next chunk which overlaps or is
      * greater than this key.  Returns true if a chunk exists, false otherwise.
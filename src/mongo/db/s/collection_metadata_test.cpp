@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/status.h"
+#include "mongo/db/query/query_test_service_context.h"
 #include "mongo/db/range_arithmetic.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -345,6 +346,25 @@ TEST_F(ThreeChunkWithRangeGapFixture, KeyBelongsToMe) {
     ASSERT(!makeCollectionMetadata()->keyBelongsToMe(BSONObj()));
 }
 
+TEST_F(ThreeChunkWithRangeGapFixture, QueryBelongsToMe) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+    auto metadata(makeCollectionMetadata());
+
+    ASSERT(metadata->queryBelongsToMe(opCtx.get(), BSON("a" << 5), BSONObj()));
+    ASSERT(metadata->queryBelongsToMe(
+        opCtx.get(), BSON("a" << BSON("$gte" << 0 << "$lte" << 19)), BSONObj()));
+    ASSERT(metadata->queryBelongsToMe(opCtx.get(), BSON("a" << BSON("$gt" << 30)), BSONObj()));
+    ASSERT(metadata->queryBelongsToMe(
+        opCtx.get(), BSON("a" << BSON("$in" << BSON_ARRAY(1 << 15 << 35))), BSONObj()));
+
+    ASSERT(!metadata->queryBelongsToMe(opCtx.get(), BSON("a" << 25), BSONObj()));
+    ASSERT(!metadata->queryBelongsToMe(
+        opCtx.get(), BSON("a" << BSON("$gte" << 15 << "$lte" << 35)), BSONObj()));
+    ASSERT(!metadata->queryBelongsToMe(opCtx.get(), BSONObj(), BSONObj()));
+    ASSERT(!metadata->queryBelongsToMe(opCtx.get(), BSON("b" << 5), BSONObj()));
+}
+
 TEST_F(ThreeChunkWithRangeGapFixture, GetNextChunkFromBeginning) {
     ChunkType nextChunk;
     ASSERT(
@@ -42,6 +42,7 @@
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
 #include "mongo/db/s/migration_source_manager.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/s/sharding_statistics.h"
 #include "mongo/db/write_concern.h"
 
 /**
@@ -52,8 +53,8 @@ namespace {
 
 /**
  * Shortcut class to perform the appropriate checks and acquire the cloner associated with the
- * currently active migration. Uses the currently registered migration for this shard and ensures
- * the session ids match.
+ * currently active migration. Looks through the migrations registered for this shard for the one
+ * whose session id matches.
  */
 class AutoGetActiveCloner {
     MONGO_DISALLOW_COPYING(AutoGetActiveCloner);
@@ -62,32 +63,59 @@ public:
     AutoGetActiveCloner(OperationContext* opCtx, const MigrationSessionId& migrationSessionId) {
         ShardingState* const gss = ShardingState::get(opCtx);
 
-        const auto nss = gss->getActiveDonateChunkNss();
-        uassert(ErrorCodes::NotYetInitialized, "No active migrations were found", nss);
+        const auto namespaces = gss->getActiveDonateChunkNamespaces();
+        uassert(ErrorCodes::NotYetInitialized,
+                "No active migrations were found",
+                !namespaces.empty());
+
+        for (const auto& nss : namespaces) {
+            // Once the collection is locked, the migration status cannot change
+            _autoColl.emplace(opCtx, nss, MODE_IS);
+
+            if (!_autoColl->getCollection()) {
+                // The collection of a single active migration must exist, otherwise it is possible
+                // that the session belongs to another one
+                uassert(ErrorCodes::NamespaceNotFound,
+                        str::stream() << "Collection " << nss.ns() << " does not exist",
+                        namespaces.size() > 1);
+                _autoColl.reset();
+                continue;
+            }
 
-        // Once the collection is locked, the migration status cannot change
-        _autoColl.emplace(opCtx, *nss, MODE_IS);
+            auto css = CollectionShardingState::get(opCtx, nss);
+            if (!css->getMigrationSourceManager()) {
+                uassert(ErrorCodes::IllegalOperation,
+                        str::stream() << "No active migrations were found for collection "
+                                      << nss.ns(),
+                        namespaces.size() > 1);
+                _autoColl.reset();
+                continue;
+            }
 
-        uassert(ErrorCodes::NamespaceNotFound,
-                str::stream() << "Collection " << nss->ns() << " does not exist",
-                _autoColl->getCollection());
+            // It is now safe to access the cloner
+            auto chunkCloner = dynamic_cast<MigrationChunkClonerSourceLegacy*>(
+                css->getMigrationSourceManager()->getCloner());
+            invariant(chunkCloner);
 
-        auto css = CollectionShardingState::get(opCtx, *nss);
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "No active migrations were found for collection " << nss->ns(),
-                css->getMigrationSourceManager());
+            // Ensure the session ids are correct
+            if (migrationSessionId.matches(chunkCloner->getSessionId())) {
+                _chunkCloner = chunkCloner;
+                return;
+            }
 
-        // It is now safe to access the cloner
-        _chunkCloner = dynamic_cast<MigrationChunkClonerSourceLegacy*>(
-            css->getMigrationSourceManager()->getCloner());
-        invariant(_chunkCloner);
+            uassert(ErrorCodes::IllegalOperation,
+                    str::stream() << "Requested migration session id "
+                                  << migrationSessionId.toString()
+                                  << " does not match active session id "
+                                  << chunkCloner->getSessionId().toString(),
+                    namespaces.size() > 1);
+            _autoColl.reset();
+        }
 
-        // Ensure the session ids are correct
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "Requested migration session id " << migrationSessionId.toString()
-                              << " does not match active session id "
-                              << _chunkCloner->getSessionId().toString(),
-                migrationSessionId.matches(_chunkCloner->getSessionId()));
+        uasserted(ErrorCodes::IllegalOperation,
+                  str::stream() << "Requested migration session id "
+                                << migrationSessionId.toString()
+                                << " does not match any of the active migrations");
     }
 
     Database* getDb() const {
@@ -110,7 +138,7 @@ private:
     boost::optional<AutoGetCollection> _autoColl;
 
     // Contains the active cloner for the namespace
-    MigrationChunkClonerSourceLegacy* _chunkCloner;
+    MigrationChunkClonerSourceLegacy* _chunkCloner{nullptr};
 };
 
 class InitialCloneCommand : public BasicCommand {
@@ -168,6 +196,7 @@ public:
         }
 
         invariant(arrBuilder);
+        ShardingStatistics::get(opCtx).countBytesClonedOnDonor.addAndFetch(arrBuilder->len());
         result.appendArray("objects", arrBuilder->arr());
 
         return true;
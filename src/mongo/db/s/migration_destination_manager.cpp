@@ -41,6 +41,8 @@
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
@@ -51,19 +53,36 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/move_timing_helper.h"
+#include "mongo/db/s/sharding_statistics.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/chrono.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/producer_consumer_queue.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
 
+// The number of batches of documents which the recipient fetches from the donor ahead of the one it
+// is inserting during the initial clone.
+MONGO_EXPORT_SERVER_PARAMETER(migrationCloneBatchesInFlight, int, 2);
+
+// The most documents inserted together, in a single storage transaction, during the initial clone.
+MONGO_EXPORT_SERVER_PARAMETER(migrationCloneInsertBatchSize, int, 500);
+
+// The socket timeout of the connection on which the initial clone batches are fetched. Interrupting
+// the fetcher does not cancel a request which is already waiting on the donor, so this bounds how
+// long stopping the fetcher can take once the migration is aborted.
+const Seconds kCloneFetcherSocketTimeout(30);
+
 const auto getMigrationDestinationManager =
     ServiceContext::declareDecoration<MigrationDestinationManager>();
 
@@ -133,6 +152,58 @@ bool willOverrideLocalId(OperationContext* opCtx,
     return false;
 }
 
+/**
+ * Inserts the documents in the range ['begin', 'end') cloned from the donor, all in the same
+ * storage transaction so that their index keys are inserted together. Falls back to upserting them
+ * one at a time if any of them is already present.
+ */
+void insertClonedDocuments(OperationContext* opCtx,
+                           const NamespaceString& nss,
+                           const BSONObj& min,
+                           const BSONObj& max,
+                           const BSONObj& shardKeyPattern,
+                           std::vector<InsertStatement>::const_iterator begin,
+                           std::vector<InsertStatement>::const_iterator end) {
+    OldClientWriteContext cx(opCtx, nss.ns());
+
+    for (auto it = begin; it != end; ++it) {
+        BSONObj localDoc;
+        if (willOverrideLocalId(
+                opCtx, nss, min, max, shardKeyPattern, cx.db(), it->doc, &localDoc)) {
+            const std::string errMsg = str::stream()
+                << "cannot migrate chunk, local document " << redact(localDoc)
+                << " has same _id as cloned "
+                << "remote document " << redact(it->doc);
+            warning() << errMsg;
+
+            // Exception will abort migration cleanly
+            uasserted(16976, errMsg);
+        }
+    }
+
+    Collection* const collection = cx.db()->getCollection(opCtx, nss);
+    if (collection) {
+        const Status status = writeConflictRetry(opCtx, "cloneDocuments", nss.ns(), [&] {
+            WriteUnitOfWork wuow(opCtx);
+            Status status = collection->insertDocuments(
+                opCtx, begin, end, nullptr, false /* enforceQuota */, true /* fromMigrate */);
+            if (status.isOK()) {
+                wuow.commit();
+            }
+            return status;
+        });
+
+        if (status.code() != ErrorCodes::DuplicateKey) {
+            uassertStatusOK(status);
+            return;
+        }
+    }
+
+    for (auto it = begin; it != end; ++it) {
+        Helpers::upsert(opCtx, nss.ns(), it->doc, true);
+    }
+}
+
 /**
  * Returns true if the majority of the nodes and the nodes corresponding to the given writeConcern
  * (if not empty) have applied till the specified lastOp.
@@ -386,6 +457,7 @@ Status MigrationDestinationManager::abort(const MigrationSessionId& sessionId) {
     _state = ABORT;
     _stateChangedCV.notify_all();
     _errmsg = "aborted";
+    _interruptCloneFetcher(sl);
 
     return Status::OK();
 }
@@ -395,6 +467,17 @@ void MigrationDestinationManager::abortWithoutSessionIdCheck() {
     _state = ABORT;
     _stateChangedCV.notify_all();
     _errmsg = "aborted without session id check";
+    _interruptCloneFetcher(sl);
+}
+
+void MigrationDestinationManager::_interruptCloneFetcher(WithLock) {
+    if (!_cloneFetcherOpCtx) {
+        return;
+    }
+
+    stdx::lock_guard<Client> clientLock(*_cloneFetcherOpCtx->getClient());
+    _cloneFetcherOpCtx->getServiceContext()->killOperation(_cloneFetcherOpCtx,
+                                                           ErrorCodes::Interrupted);
 }
 
 Status MigrationDestinationManager::startCommit(const MigrationSessionId& sessionId) {
@@ -710,27 +793,113 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
         // 3. Initial bulk clone
         setState(CLONE);
 
+        Timer cloneTimer;
+
         _sessionMigration->start(opCtx->getServiceContext());
 
         const BSONObj migrateCloneRequest = createMigrateCloneRequest(_nss, *_sessionId);
 
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
+        // The batches are fetched from the donor on a separate thread, so that the next ones are
+        // read and transferred by the donor while the current one is being inserted. The empty
+        // batch which marks the end of the initial clone is queued as well. The fetcher has its own
+        // operation, which is interrupted when the migration is aborted or the recipient stops
+        // early, and its own connection, whose socket timeout bounds how long a request in flight
+        // can delay it from noticing.
+        ProducerConsumerQueue<BSONObj> cloneBatches(
+            std::max(1, migrationCloneBatchesInFlight.load()));
+        Status fetchStatus = Status::OK();
+
+        stdx::thread fetcherThread([&] {
+            Client::initThread("chunkCloneFetcher");
+            auto fetcherOpCtx = cc().makeOperationContext();
+            {
+                stdx::lock_guard<stdx::mutex> sl(_mutex);
+                _cloneFetcherOpCtx = fetcherOpCtx.get();
+                if (_state == ABORT) {
+                    _interruptCloneFetcher(sl);
+                }
+            }
+            ON_BLOCK_EXIT([&] {
+                stdx::lock_guard<stdx::mutex> sl(_mutex);
+                _cloneFetcherOpCtx = nullptr;
+            });
+
+            try {
+                ScopedDbConnection fetcherConn(fromShardConnString,
+                                               durationCount<Seconds>(kCloneFetcherSocketTimeout));
+                while (true) {
+                    fetcherOpCtx->checkForInterrupt();
+
+                    // Gets an array of objects to copy, in disk order.
+                    BSONObj res;
+                    if (!fetcherConn->runCommand("admin", migrateCloneRequest, res)) {
+                        fetchStatus = {ErrorCodes::OperationFailed,
+                                       str::stream() << "_migrateClone failed: "
+                                                     << redact(res.toString())};
+                        break;
+                    }
+
+                    const bool lastBatch = res["objects"].Obj().isEmpty();
+                    cloneBatches.push(std::move(res), fetcherOpCtx.get());
+                    if (lastBatch) {
+                        fetcherConn.done();
+                        break;
+                    }
+                }
+            } catch (const DBException& ex) {
+                // The consumer end is closed if the recipient stops before the clone is complete.
+                if (ex.code() != ErrorCodes::ProducerConsumerQueueEndClosed) {
+                    fetchStatus = ex.toStatus();
+                }
+            }
+            cloneBatches.closeProducerEnd();
+        });
+
+        const auto stopFetcherThread = [&] {
+            cloneBatches.closeConsumerEnd();
+            {
+                stdx::lock_guard<stdx::mutex> sl(_mutex);
+                _interruptCloneFetcher(sl);
+            }
+            fetcherThread.join();
+        };
+        auto stopFetcherThreadGuard = MakeGuard(stopFetcherThread);
+
+        const int insertBatchSize = std::max(1, migrationCloneInsertBatchSize.load());
+
         while (true) {
             BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                setStateFail(str::stream() << "_migrateClone failed: " << redact(res.toString()));
+            try {
+                res = cloneBatches.pop(opCtx);
+            } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+                // The fetcher thread only stops without queueing the last batch on error, or when
+                // the migration is aborted.
+                stopFetcherThreadGuard.Dismiss();
+                stopFetcherThread();
                 conn.done();
+                if (getState() == ABORT) {
+                    log() << "Migration aborted while copying documents";
+                    return;
+                }
+                setStateFail(fetchStatus.reason());
                 return;
             }
 
             BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
+            if (arr.isEmpty()) {
+                break;
+            }
+
+            std::vector<InsertStatement> docsToClone;
+            long long batchBytes = 0;
+            for (auto&& elem : arr) {
+                docsToClone.emplace_back(elem.Obj());
+                batchBytes += elem.Obj().objsize();
+            }
 
-            BSONObjIterator i(arr);
-            while (i.more()) {
+            for (auto it = docsToClone.cbegin(); it != docsToClone.cend();) {
                 opCtx->checkForInterrupt();
 
                 if (getState() == ABORT) {
@@ -738,38 +907,9 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                     return;
                 }
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(opCtx, _nss.ns());
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(opCtx,
-                                            _nss,
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            docToClone,
-                                            &localDoc)) {
-                        const std::string errMsg = str::stream()
-                            << "cannot migrate chunk, local document " << redact(localDoc)
-                            << " has same _id as cloned "
-                            << "remote document " << redact(docToClone);
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
-
-                    Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
-                }
-                thisTime++;
-
-                {
-                    stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
-                }
+                const auto end = it +
+                    std::min<ptrdiff_t>(insertBatchSize, std::distance(it, docsToClone.cend()));
+                insertClonedDocuments(opCtx, _nss, min, max, shardKeyPattern, it, end);
 
                 if (writeConcern.shouldWaitForOtherNodes()) {
                     repl::ReplicationCoordinator::StatusAndDuration replStatus =
@@ -784,13 +924,25 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                         massertStatusOK(replStatus.status);
                     }
                 }
+
+                it = end;
             }
 
-            if (thisTime == 0)
-                break;
+            {
+                stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+                _numCloned += docsToClone.size();
+                _clonedBytes += batchBytes;
+            }
         }
 
-        timing.done(3);
+        stopFetcherThreadGuard.Dismiss();
+        stopFetcherThread();
+
+        auto& shardingStats = ShardingStatistics::get(opCtx);
+        shardingStats.countBytesClonedOnRecipient.addAndFetch(_clonedBytes);
+        shardingStats.totalRecipientChunkCloneTimeMillis.addAndFetch(cloneTimer.millis());
+
+        timing.done(3, _numCloned, _clonedBytes);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
 
         if (MONGO_FAIL_POINT(failMigrationLeaveOrphans)) {
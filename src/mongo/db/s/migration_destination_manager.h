@@ -188,6 +188,12 @@ private:
      */
     bool _isActive(WithLock) const;
 
+    /**
+     * Interrupts the operation of the thread fetching the initial clone batches from the donor, if
+     * it is running.
+     */
+    void _interruptCloneFetcher(WithLock);
+
     // Mutex to guard all fields
     mutable stdx::mutex _mutex;
 
@@ -224,6 +230,10 @@ private:
 
     std::unique_ptr<SessionCatalogMigrationDestination> _sessionMigration;
 
+    // The operation of the thread fetching the initial clone batches from the donor, so that it can
+    // be interrupted when the migration is aborted. Only set while the fetcher thread is running.
+    OperationContext* _cloneFetcherOpCtx{nullptr};
+
     // Condition variable, which is signalled every time the state of the migration changes.
     stdx::condition_variable _stateChangedCV;
 };
@@ -72,6 +72,10 @@ MoveTimingHelper::~MoveTimingHelper() {
             _b.append("from", _from.toString());
         }
 
+        if (!_throughputBuilder.asTempObj().isEmpty()) {
+            _b.append("throughput", _throughputBuilder.obj());
+        }
+
         if (_nextStep != _totalNumSteps) {
             _b.append("note", "aborted");
         } else {
@@ -113,4 +117,19 @@ void MoveTimingHelper::done(int step) {
     _t.reset();
 }
 
+void MoveTimingHelper::done(int step, long long numDocs, long long numBytes) {
+    const long long elapsedMillis = _t.millis();
+    done(step);
+
+    const std::string s = str::stream() << "step " << step << " of " << _totalNumSteps;
+
+    BSONObjBuilder stepBuilder(_throughputBuilder.subobjStart(s));
+    stepBuilder.appendNumber("docs", numDocs);
+    stepBuilder.appendNumber("bytes", numBytes);
+    if (elapsedMillis > 0) {
+        stepBuilder.appendNumber("docsPerSec", numDocs * 1000 / elapsedMillis);
+        stepBuilder.appendNumber("bytesPerSec", numBytes * 1000 / elapsedMillis);
+    }
+}
+
 }  // namespace mongo
@@ -54,6 +54,12 @@ public:
 
     void done(int step);
 
+    /**
+     * Same as done(), but also records the number of documents and bytes transferred during the
+     * step and the rate at which they were transferred.
+     */
+    void done(int step, long long numDocs, long long numBytes);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
@@ -68,6 +74,9 @@ private:
 
     int _nextStep;
     BSONObjBuilder _b;
+
+    // The transfer statistics of the steps which reported them, by step
+    BSONObjBuilder _throughputBuilder;
 };
 
 }  // namespace mongo
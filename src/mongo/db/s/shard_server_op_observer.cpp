@@ -155,12 +155,14 @@ bool shouldSplitChunk(OperationContext* opCtx,
 /**
  * If the collection is sharded, finds the chunk that contains the specified document and increments
  * the size tracked for that chunk by the specified amount of data written, in bytes. Returns the
- * number of total bytes on that chunk after the data is written.
+ * number of total bytes on that chunk after the data is written. Inserted documents also have
+ * their shard key sampled, for placing the split points of the chunk.
  */
 void incrementChunkOnInsertOrUpdate(OperationContext* opCtx,
                                     const ChunkManager& chunkManager,
                                     const BSONObj& document,
-                                    long dataWritten) {
+                                    long dataWritten,
+                                    bool isInsert) {
     const auto& shardKeyPattern = chunkManager.getShardKeyPattern();
 
     // Each inserted/updated document should contain the shard key. The only instance in which a
@@ -180,6 +182,9 @@ void incrementChunkOnInsertOrUpdate(OperationContext* opCtx,
     // collations.
     auto chunk = chunkManager.findIntersectingChunkWithSimpleCollation(shardKey);
     chunk->addBytesWritten(dataWritten);
+    if (isInsert) {
+        chunk->sampleKeyInserted(shardKey, dataWritten);
+    }
 
     // If the chunk becomes too large, then we call the ChunkSplitter to schedule a split. Then, we
     // reset the tracking for that chunk to 0.
@@ -221,7 +226,7 @@ void ShardServerOpObserver::onInserts(OperationContext* opCtx,
 
         if (metadata) {
             incrementChunkOnInsertOrUpdate(
-                opCtx, *metadata->getChunkManager(), insertedDoc, insertedDoc.objsize());
+                opCtx, *metadata->getChunkManager(), insertedDoc, insertedDoc.objsize(), true);
         }
     }
 }
@@ -284,7 +289,7 @@ void ShardServerOpObserver::onUpdate(OperationContext* opCtx, const OplogUpdateE
 
     if (metadata) {
         incrementChunkOnInsertOrUpdate(
-            opCtx, *metadata->getChunkManager(), args.updatedDoc, args.updatedDoc.objsize());
+            opCtx, *metadata->getChunkManager(), args.updatedDoc, args.updatedDoc.objsize(), false);
     }
 }
 
@@ -76,12 +76,18 @@ public:
             grid->getBalancerConfiguration()->getMaxChunkSizeBytes();
         result.append("maxChunkSizeInBytes", maxChunkSizeInBytes);
 
-        // Get a migration status report if a migration is active for which this is the source
-        // shard. ShardingState::getActiveMigrationStatusReport will take an IS lock on the
-        // namespace of the active migration if there is one that is active.
-        BSONObj migrationStatus = shardingState->getActiveMigrationStatusReport(opCtx);
-        if (!migrationStatus.isEmpty()) {
-            result.append("migrations", migrationStatus);
+        // Get a status report on each active migration for which this is the source shard.
+        // ShardingState::getActiveMigrationStatusReports will take an IS lock on the namespace of
+        // each active migration. 'migrations' keeps reporting the first of them, as it did when a
+        // shard could only donate one chunk at a time, and 'activeMigrations' lists them all.
+        const auto migrationStatuses = shardingState->getActiveMigrationStatusReports(opCtx);
+        if (!migrationStatuses.empty()) {
+            result.append("migrations", migrationStatuses.front());
+
+            BSONArrayBuilder activeMigrations(result.subarrayStart("activeMigrations"));
+            for (const auto& migrationStatus : migrationStatuses) {
+                activeMigrations.append(migrationStatus);
+            }
         }
 
         return result.obj();
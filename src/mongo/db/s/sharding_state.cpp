@@ -383,12 +383,12 @@ StatusWith<ScopedReceiveChunk> ShardingState::registerReceiveChunk(const Namespa
     return _activeMigrationsRegistry.registerReceiveChunk(nss, chunkRange, fromShardId);
 }
 
-boost::optional<NamespaceString> ShardingState::getActiveDonateChunkNss() {
-    return _activeMigrationsRegistry.getActiveDonateChunkNss();
+std::vector<NamespaceString> ShardingState::getActiveDonateChunkNamespaces() {
+    return _activeMigrationsRegistry.getActiveDonateChunkNamespaces();
 }
 
-BSONObj ShardingState::getActiveMigrationStatusReport(OperationContext* opCtx) {
-    return _activeMigrationsRegistry.getActiveMigrationStatusReport(opCtx);
+std::vector<BSONObj> ShardingState::getActiveMigrationStatusReports(OperationContext* opCtx) {
+    return _activeMigrationsRegistry.getActiveMigrationStatusReports(opCtx);
 }
 
 StatusWith<ScopedMovePrimary> ShardingState::registerMovePrimary(
@@ -164,21 +164,21 @@ public:
                                                         const ShardId& fromShardId);
 
     /**
-     * If a migration has been previously registered through a call to registerDonateChunk returns
-     * that namespace. Otherwise returns boost::none.
+     * Returns the namespaces of all migrations, which have been previously registered through a
+     * call to registerDonateChunk and are still active.
      *
-     * This method can be called without any locks, but once the namespace is fetched it needs to be
+     * This method can be called without any locks, but once a namespace is fetched it needs to be
      * re-checked after acquiring some intent lock on that namespace.
      */
-    boost::optional<NamespaceString> getActiveDonateChunkNss();
+    std::vector<NamespaceString> getActiveDonateChunkNamespaces();
 
     /**
-     * Get a migration status report from the migration registry. If no migration is active, this
-     * returns an empty BSONObj.
+     * Get a status report on each active migration from the migration registry. If no migration is
+     * active, this returns an empty vector.
      *
-     * Takes an IS lock on the namespace of the active migration, if one is active.
+     * Takes an IS lock on the namespace of each active migration in turn.
      */
-    BSONObj getActiveMigrationStatusReport(OperationContext* opCtx);
+    std::vector<BSONObj> getActiveMigrationStatusReports(OperationContext* opCtx);
 
     /**
      * If there are no movePrimary operations running on this shard, registers an active
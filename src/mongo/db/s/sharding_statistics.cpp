@@ -54,6 +54,10 @@ void ShardingStatistics::report(BSONObjBuilder* builder) const {
 
     builder->append("countDonorMoveChunkStarted", countDonorMoveChunkStarted.load());
     builder->append("totalDonorChunkCloneTimeMillis", totalDonorChunkCloneTimeMillis.load());
+    builder->append("countBytesClonedOnDonor", countBytesClonedOnDonor.load());
+    builder->append("countBytesClonedOnRecipient", countBytesClonedOnRecipient.load());
+    builder->append("totalRecipientChunkCloneTimeMillis",
+                    totalRecipientChunkCloneTimeMillis.load());
     builder->append("totalCriticalSectionCommitTimeMillis",
                     totalCriticalSectionCommitTimeMillis.load());
     builder->append("totalCriticalSectionTimeMillis", totalCriticalSectionTimeMillis.load());
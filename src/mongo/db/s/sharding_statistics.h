@@ -56,6 +56,16 @@ struct ShardingStatistics {
     // node, before it was appropriate to enter the critical section
     AtomicInt64 totalDonorChunkCloneTimeMillis{0};
 
+    // Cumulative, always-increasing counter of how many bytes of documents this node returned in
+    // response to _migrateClone requests. Together with totalDonorChunkCloneTimeMillis it gives the
+    // observed migration throughput of this shard as a donor.
+    AtomicInt64 countBytesClonedOnDonor{0};
+
+    // Cumulative, always-increasing counters of how many bytes of documents this node inserted
+    // during the initial clone phase of incoming migrations and how much time that phase took
+    AtomicInt64 countBytesClonedOnRecipient{0};
+    AtomicInt64 totalRecipientChunkCloneTimeMillis{0};
+
     // Cumulative, always-increasing counter of how much time the critical section's commit phase
     // took (this is the period of time when all operations on the collection are blocked, not just
     // the reads)
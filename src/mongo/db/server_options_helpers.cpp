@@ -830,14 +830,16 @@ Status storeServerOptions(const moe::Environment& params) {
 
     if (params.count("net.transportLayer")) {
         serverGlobalParams.transportLayer = params["net.transportLayer"].as<std::string>();
-        if (serverGlobalParams.transportLayer != "asio") {
-            return {ErrorCodes::BadValue, "Unsupported value for transportLayer. Must be \"asio\""};
+        if (serverGlobalParams.transportLayer != "asio" &&
+            serverGlobalParams.transportLayer != "io_uring") {
+            return {ErrorCodes::BadValue,
+                    "Unsupported value for transportLayer. Must be \"asio\" or \"io_uring\""};
         }
     }
 
     if (params.count("net.serviceExecutor")) {
         auto value = params["net.serviceExecutor"].as<std::string>();
-        const auto valid = {"synchronous"_sd, "adaptive"_sd};
+        const auto valid = {"synchronous"_sd, "adaptive"_sd, "perCore"_sd};
         if (std::find(valid.begin(), valid.end(), value) == valid.end()) {
             return {ErrorCodes::BadValue, "Unsupported value for serviceExecutor"};
         }
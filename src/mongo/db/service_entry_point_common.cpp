@@ -789,10 +789,25 @@ void curOpCommandSetup(OperationContext* opCtx, const OpMsgRequest& request) {
     curop->setNS_inlock(nss.ns());
 }
 
+/**
+ * Returns true if 'response' is a successful reply to a cursor-generating command, which leaves
+ * the cursor open.
+ */
+bool isOpenCursorReply(const Message& response) {
+    const auto reply = OpMsg::parse(response).body;
+    if (!getStatusFromCommandResult(reply).isOK()) {
+        return false;
+    }
+
+    const auto cursor = reply["cursor"];
+    return cursor.type() == Object && cursor.Obj()["id"].safeNumberLong() != 0;
+}
+
 DbResponse runCommands(OperationContext* opCtx,
                        const Message& message,
                        const ServiceEntryPointCommon::Hooks& behaviors) {
     auto replyBuilder = rpc::makeReplyBuilder(rpc::protocolForMessage(message));
+    BSONObj exhaustGetMore;
     [&] {
         OpMsgRequest request;
         try {  // Parse.
@@ -814,6 +829,11 @@ DbResponse runCommands(OperationContext* opCtx,
             return;  // From lambda. Don't try executing if parsing failed.
         }
 
+        if (OpMsg::isFlagSet(message, OpMsg::kExhaustSupported) &&
+            request.getCommandName() == "getMore"_sd) {
+            exhaustGetMore = request.body.getOwned();
+        }
+
         try {  // Execute.
             curOpCommandSetup(opCtx, request);
 
@@ -864,8 +884,16 @@ DbResponse runCommands(OperationContext* opCtx,
     auto response = replyBuilder->done();
     CurOp::get(opCtx)->debug().responseLength = response.header().dataLen();
 
-    // TODO exhaust
-    return DbResponse{std::move(response)};
+    // Stream the remaining batches of an exhaust cursor by running the same getMore again as soon
+    // as this reply has been sent, rather than waiting for the client to request each of them.
+    BSONObj nextInvocation;
+    if (!exhaustGetMore.isEmpty() && isOpenCursorReply(response)) {
+        OpMsg::setFlag(&response, OpMsg::kMoreToCome);
+        CurOp::get(opCtx)->debug().exhaust = true;
+        nextInvocation = std::move(exhaustGetMore);
+    }
+
+    return DbResponse{std::move(response), std::string(), std::move(nextInvocation)};
 }
 
 DbResponse receivedQuery(OperationContext* opCtx,
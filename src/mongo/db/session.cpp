@@ -356,21 +356,28 @@ void Session::onMigrateCompletedOnPrimary(OperationContext* opCtx,
 
 void Session::updateSessionRecordOnSecondary(OperationContext* opCtx,
                                              const SessionTxnRecord& sessionTxnRecord) {
+    updateSessionRecordsOnSecondary(opCtx, {&sessionTxnRecord});
+}
+
+void Session::updateSessionRecordsOnSecondary(
+    OperationContext* opCtx, const std::vector<const SessionTxnRecord*>& sessionTxnRecords) {
     invariant(!opCtx->lockState()->isLocked());
 
     writeConflictRetry(
         opCtx, "Update session txn", NamespaceString::kSessionTransactionsTableNamespace.ns(), [&] {
-            UpdateRequest updateRequest(NamespaceString::kSessionTransactionsTableNamespace);
-            updateRequest.setQuery(BSON(SessionTxnRecord::kSessionIdFieldName
-                                        << sessionTxnRecord.getSessionId().toBSON()));
-            updateRequest.setUpdates(sessionTxnRecord.toBSON());
-            updateRequest.setUpsert(true);
-
             repl::UnreplicatedWritesBlock doNotReplicateWrites(opCtx);
 
             Lock::DBLock configDBLock(opCtx, NamespaceString::kConfigDb, MODE_IX);
             WriteUnitOfWork wuow(opCtx);
-            updateSessionEntry(opCtx, updateRequest);
+            for (const auto sessionTxnRecord : sessionTxnRecords) {
+                UpdateRequest updateRequest(NamespaceString::kSessionTransactionsTableNamespace);
+                updateRequest.setQuery(BSON(SessionTxnRecord::kSessionIdFieldName
+                                            << sessionTxnRecord->getSessionId().toBSON()));
+                updateRequest.setUpdates(sessionTxnRecord->toBSON());
+                updateRequest.setUpsert(true);
+
+                updateSessionEntry(opCtx, updateRequest);
+            }
             wuow.commit();
         });
 }
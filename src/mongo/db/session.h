@@ -178,6 +178,16 @@ public:
     static void updateSessionRecordOnSecondary(OperationContext* opCtx,
                                                const SessionTxnRecord& sessionTxnRecord);
 
+    /**
+     * Same as updateSessionRecordOnSecondary, but persists all of the given session transaction
+     * entries in a single write unit of work. The records must all be for distinct session ids.
+     *
+     * In order to avoid the possibility of deadlock, this method must not be called while holding a
+     * lock.
+     */
+    static void updateSessionRecordsOnSecondary(
+        OperationContext* opCtx, const std::vector<const SessionTxnRecord*>& sessionTxnRecords);
+
     /**
      * Marks the session as requiring refresh. Used when the session state has been modified
      * externally, such as through a direct write to the transactions table.
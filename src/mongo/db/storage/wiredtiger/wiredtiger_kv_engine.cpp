@@ -319,6 +319,10 @@ TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
 
+// When true, the numbers of read and write tickets adapt to the load, from a quarter to four
+// times their configured values.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactions, bool, false);
+
 stdx::function<bool(StringData)> initRsOplogBackgroundThreadCallback = [](StringData) -> bool {
     fassertFailed(40358);
 };
@@ -448,6 +452,13 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
         new WiredTigerSizeStorer(_conn, _sizeStorerUri, sizeStorerLoggingEnabled, _readOnly));
     _sizeStorer->fillCache();
 
+    if (wiredTigerAdaptiveConcurrentTransactions) {
+        for (auto holder : {&openReadTransaction, &openWriteTransaction}) {
+            const int maxTickets = holder->outof() * 4;
+            const int minTickets = std::min(std::max(holder->outof() / 4, 5), maxTickets);
+            holder->enableAdaptiveSizing(minTickets, maxTickets, Seconds(1));
+        }
+    }
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
 }
 
@@ -467,6 +478,7 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        openWriteTransaction.appendStats(&bbb);
         bbb.done();
     }
     {
@@ -474,6 +486,7 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        openReadTransaction.appendStats(&bbb);
         bbb.done();
     }
     bb.done();
@@ -152,6 +152,17 @@ public:
      */
     size_t openConnections(const stdx::unique_lock<stdx::mutex>& lk);
 
+    /**
+     * Returns the number of requests waiting for a connection.
+     */
+    size_t queuedRequests(const stdx::unique_lock<stdx::mutex>& lk);
+
+    /**
+     * Returns the moving average of how long connections stay checked out, in microseconds, or -1
+     * if no connection has been returned yet.
+     */
+    int64_t latencyMicros(const stdx::unique_lock<stdx::mutex>& lk);
+
     /**
      * Return true if the tags on the specific pool match the passed in tags
      */
@@ -198,6 +209,18 @@ private:
 
     void spawnConnections(stdx::unique_lock<stdx::mutex>& lk);
 
+    /**
+     * Folds the current demand into the peak seen over the last prewarmWindow.
+     */
+    void updatePeakDemand(const stdx::unique_lock<stdx::mutex>& lk);
+
+    /**
+     * Returns the number of connections to keep open regardless of current demand. This is
+     * minConnections, raised to the recent peak demand when pre-warming is enabled, and never
+     * above maxConnections.
+     */
+    size_t warmConnections(const stdx::unique_lock<stdx::mutex>& lk);
+
     void shutdown();
 
     template <typename OwnershipPoolType>
@@ -229,6 +252,17 @@ private:
 
     size_t _created;
 
+    // When each connection handed out by fulfillRequests() was checked out, used to sample
+    // _latencyMicros as connections come back.
+    stdx::unordered_map<ConnectionInterface*, Date_t> _checkOutTimes;
+    int64_t _latencyMicros = -1;
+
+    // The peak demand seen in the current and in the previous prewarmWindow. Keeping the previous
+    // window means a peak is remembered for between one and two windows.
+    size_t _currentPeakDemand = 0;
+    size_t _previousPeakDemand = 0;
+    Date_t _peakDemandWindowStart;
+
     transport::Session::TagMask _tags = transport::Session::kPending;
 
     /**
@@ -383,6 +417,8 @@ void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
                                      pool->availableConnections(lk),
                                      pool->createdConnections(lk),
                                      pool->refreshingConnections(lk)};
+        hostStats.queued = pool->queuedRequests(lk);
+        hostStats.latencyMicros = pool->latencyMicros(lk);
         stats->updateStatsForHost(_name, host, hostStats);
     }
 }
@@ -449,6 +485,14 @@ size_t ConnectionPool::SpecificPool::openConnections(const stdx::unique_lock<std
     return _checkedOutPool.size() + _readyPool.size() + _processingPool.size();
 }
 
+size_t ConnectionPool::SpecificPool::queuedRequests(const stdx::unique_lock<stdx::mutex>& lk) {
+    return _requests.size();
+}
+
+int64_t ConnectionPool::SpecificPool::latencyMicros(const stdx::unique_lock<stdx::mutex>& lk) {
+    return _latencyMicros;
+}
+
 void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
                                                  Milliseconds timeout,
                                                  stdx::unique_lock<stdx::mutex> lk,
@@ -461,6 +505,7 @@ void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
 
     _requests.push(make_pair(expiration, std::move(cb)));
 
+    updatePeakDemand(lk);
     updateStateInLock();
 
     spawnConnections(lk);
@@ -473,6 +518,20 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
 
     auto conn = takeFromPool(_checkedOutPool, connPtr);
 
+    auto checkOutTime = _checkOutTimes.find(connPtr);
+    if (checkOutTime != _checkOutTimes.end()) {
+        const auto sample =
+            durationCount<Microseconds>(_parent->_factory->now() - checkOutTime->second);
+        _checkOutTimes.erase(checkOutTime);
+
+        // Smoothed the same way as the replica set monitor's ping latency.
+        if (_latencyMicros < 0) {
+            _latencyMicros = sample;
+        } else {
+            _latencyMicros += (sample - _latencyMicros) / 4;
+        }
+    }
+
     updateStateInLock();
 
     // Users are required to call indicateSuccess() or indicateFailure() before allowing
@@ -496,8 +555,8 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
         // If we need to refresh this connection
 
         if (_readyPool.size() + _processingPool.size() + _checkedOutPool.size() >=
-            _parent->_options.minConnections) {
-            // If we already have minConnections, just let the connection lapse
+            warmConnections(lk)) {
+            // If we already have enough connections, just let the connection lapse
             log() << "Ending idle connection to host " << _hostAndPort
                   << " because the pool meets constraints; " << openConnections(lk)
                   << " connections to that host remain open";
@@ -683,6 +742,7 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
 
         // check out the connection
         _checkedOutPool[connPtr] = std::move(conn);
+        _checkOutTimes[connPtr] = _parent->_factory->now();
 
         updateStateInLock();
 
@@ -705,10 +765,10 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
     _inSpawnConnections = true;
     auto guard = MakeGuard([&] { _inSpawnConnections = false; });
 
-    // We want minConnections <= outstanding requests <= maxConnections
+    // We want warmConnections <= outstanding requests <= maxConnections
     auto target = [&] {
         return std::max(
-            _parent->_options.minConnections,
+            warmConnections(lk),
             std::min(_requests.size() + _checkedOutPool.size(), _parent->_options.maxConnections));
     };
 
@@ -763,6 +823,36 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
     }
 }
 
+void ConnectionPool::SpecificPool::updatePeakDemand(const stdx::unique_lock<stdx::mutex>& lk) {
+    const auto window = _parent->_options.prewarmWindow;
+    if (window <= Milliseconds(0))
+        return;
+
+    const auto now = _parent->_factory->now();
+    if (now - _peakDemandWindowStart >= window) {
+        // A window with no requests at all has a peak of zero, not whatever came before it
+        _previousPeakDemand = (now - _peakDemandWindowStart < window * 2) ? _currentPeakDemand : 0;
+        _currentPeakDemand = 0;
+        _peakDemandWindowStart = now;
+    }
+
+    _currentPeakDemand = std::max(_currentPeakDemand, _requests.size() + _checkedOutPool.size());
+}
+
+size_t ConnectionPool::SpecificPool::warmConnections(const stdx::unique_lock<stdx::mutex>& lk) {
+    const auto& options = _parent->_options;
+    if (options.prewarmWindow <= Milliseconds(0))
+        return options.minConnections;
+
+    // Peaks older than two windows have lapsed, even if nothing asked since to rotate them out
+    size_t peak = 0;
+    if (_parent->_factory->now() - _peakDemandWindowStart < options.prewarmWindow * 2) {
+        peak = std::max(_currentPeakDemand, _previousPeakDemand);
+    }
+
+    return std::max(options.minConnections, std::min(peak, options.maxConnections));
+}
+
 // Called every second after hostTimeout until all processing connections reap
 void ConnectionPool::SpecificPool::shutdown() {
     stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
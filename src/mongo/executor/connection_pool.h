@@ -121,6 +121,14 @@ public:
          */
         Milliseconds hostTimeout = kDefaultHostTimeout;
 
+        /**
+         * When non-zero, the pool remembers the most connections demanded of it at once (checked
+         * out plus waiting requests) over roughly this long, and spawns and keeps that many open
+         * rather than growing one connection per request. This keeps a recently busy host warm
+         * across idle refreshes and dropConnections().
+         */
+        Milliseconds prewarmWindow = Milliseconds(0);
+
         /**
          * An egress tag closer manager which will provide global access to this connection pool.
          * The manager set's tags and potentially drops connections that don't match those tags.
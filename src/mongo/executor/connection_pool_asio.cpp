@@ -313,6 +313,11 @@ void ASIOConnection::bindAsyncOp(std::unique_ptr<NetworkInterfaceASIO::AsyncOp>
     _impl = std::move(op);
 }
 
+NetworkInterfaceASIO::AsyncOp& ASIOConnection::asyncOp() {
+    invariant(_impl);
+    return *_impl;
+}
+
 ASIOImpl::ASIOImpl(NetworkInterfaceASIO* impl) : _impl(impl) {}
 
 Date_t ASIOImpl::now() {
@@ -84,6 +84,9 @@ public:
     std::unique_ptr<NetworkInterfaceASIO::AsyncOp> releaseAsyncOp();
     void bindAsyncOp(std::unique_ptr<NetworkInterfaceASIO::AsyncOp> op);
 
+    // The AsyncOp bound to this connection, through which its stream is used.
+    NetworkInterfaceASIO::AsyncOp& asyncOp();
+
     bool isHealthy() override;
 
 private:
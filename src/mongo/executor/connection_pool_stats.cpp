@@ -30,6 +30,8 @@
 
 #include "mongo/executor/connection_pool_stats.h"
 
+#include <algorithm>
+
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/util/map_util.h"
 
@@ -49,6 +51,8 @@ ConnectionStatsPer& ConnectionStatsPer::operator+=(const ConnectionStatsPer& oth
     available += other.available;
     created += other.created;
     refreshing += other.refreshing;
+    queued += other.queued;
+    latencyMicros = std::max(latencyMicros, other.latencyMicros);
 
     return *this;
 }
@@ -90,6 +94,11 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
                 hostInfo.appendNumber("available", hostStats.available);
                 hostInfo.appendNumber("created", hostStats.created);
                 hostInfo.appendNumber("refreshing", hostStats.refreshing);
+                hostInfo.appendNumber("queued", hostStats.queued);
+                if (hostStats.latencyMicros >= 0) {
+                    hostInfo.appendNumber("latencyMicros",
+                                          static_cast<long long>(hostStats.latencyMicros));
+                }
             }
         }
     }
@@ -102,6 +111,11 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
             hostInfo.appendNumber("available", hostStats.available);
             hostInfo.appendNumber("created", hostStats.created);
             hostInfo.appendNumber("refreshing", hostStats.refreshing);
+            hostInfo.appendNumber("queued", hostStats.queued);
+            if (hostStats.latencyMicros >= 0) {
+                hostInfo.appendNumber("latencyMicros",
+                                      static_cast<long long>(hostStats.latencyMicros));
+            }
         }
     }
 }
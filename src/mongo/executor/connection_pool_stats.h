@@ -49,6 +49,13 @@ struct ConnectionStatsPer {
     size_t available = 0u;
     size_t created = 0u;
     size_t refreshing = 0u;
+
+    // Requests waiting for a connection.
+    size_t queued = 0u;
+
+    // Moving average of how long a connection stays checked out, or -1 if not measured. When
+    // aggregated, the highest of the averages is kept.
+    int64_t latencyMicros = -1;
 };
 
 /**
@@ -34,6 +34,7 @@
 #include "mongo/executor/connection_pool_test_fixture.h"
 
 #include "mongo/executor/connection_pool.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
@@ -1366,6 +1367,119 @@ void dropConnectionsByTagTest(ConnectionPool& pool, T& t) {
     ASSERT_EQ(0ul, pool.getNumConnectionsPerHost(hap3));
 }
 
+/**
+ * Verify that a pool with a prewarm window reopens its recent peak after its connections are
+ * dropped, and that the peak lapses once the window passes.
+ */
+TEST_F(ConnectionPoolTest, prewarmWindowRespawnsRecentPeak) {
+    ConnectionPool::Options options;
+    options.minConnections = 0;
+    options.prewarmWindow = Seconds(10);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
+
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    // Check out three connections at once
+    std::vector<ConnectionPool::ConnectionHandle> connections;
+    for (size_t i = 0; i < 3; ++i) {
+        ConnectionImpl::pushSetup(Status::OK());
+        pool.get(HostAndPort(),
+                 Milliseconds(5000),
+                 [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                     ASSERT(swConn.isOK());
+                     connections.push_back(std::move(swConn.getValue()));
+                 });
+    }
+    ASSERT_EQ(3ul, connections.size());
+
+    for (auto& connection : connections) {
+        doneWith(connection);
+    }
+    connections.clear();
+
+    pool.dropConnections(HostAndPort());
+    ASSERT_EQ(0ul, pool.getNumConnectionsPerHost(HostAndPort()));
+
+    // A single request brings back all three
+    bool reachedA = false;
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 reachedA = true;
+                 doneWith(swConn.getValue());
+             });
+    ASSERT_EQ(3ul, ConnectionImpl::setupQueueDepth());
+
+    for (size_t i = 0; i < 3; ++i) {
+        ConnectionImpl::pushSetup(Status::OK());
+    }
+    ASSERT(reachedA);
+    ASSERT_EQ(3ul, pool.getNumConnectionsPerHost(HostAndPort()));
+
+    // Once the peak is two windows old, a request after a drop only opens what it needs
+    PoolImpl::setNow(now + Seconds(25));
+    pool.dropConnections(HostAndPort());
+
+    bool reachedB = false;
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 reachedB = true;
+                 doneWith(swConn.getValue());
+             });
+    ASSERT_EQ(1ul, ConnectionImpl::setupQueueDepth());
+
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT(reachedB);
+    ASSERT_EQ(1ul, pool.getNumConnectionsPerHost(HostAndPort()));
+}
+
+/**
+ * Verify that the pool reports a moving average of how long its connections stay checked out.
+ */
+TEST_F(ConnectionPoolTest, checkOutLatencyIsReported) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool");
+
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    auto getLatencyMicros = [&] {
+        ConnectionPoolStats stats;
+        pool.appendConnectionStats(&stats);
+        return stats.statsByHost[HostAndPort()].latencyMicros;
+    };
+
+    ConnectionPool::ConnectionHandle handle;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 handle = std::move(swConn.getValue());
+             });
+    ASSERT(handle);
+    ASSERT_EQ(-1, getLatencyMicros());
+
+    PoolImpl::setNow(now + Milliseconds(100));
+    doneWith(handle);
+    handle.reset();
+    ASSERT_EQ(100000, getLatencyMicros());
+
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 handle = std::move(swConn.getValue());
+             });
+    ASSERT(handle);
+
+    PoolImpl::setNow(now + Milliseconds(400));
+    doneWith(handle);
+    handle.reset();
+    ASSERT_EQ(150000, getLatencyMicros());
+}
+
 TEST_F(ConnectionPoolTest, DropConnectionsByTag) {
     ConnectionPool::Options options;
     ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
@@ -179,6 +179,7 @@ void NetworkInterfaceASIO::shutdown() {
     for (auto&& worker : _serviceRunners) {
         worker.join();
     }
+    _failMultiplexedCommandsForShutdown();
     LOG(2) << "NetworkInterfaceASIO shutdown successfully";
 }
 
@@ -252,7 +253,8 @@ Status NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cb
                                           RemoteCommandRequest& request,
                                           const RemoteCommandCompletionFn& onFinish) {
     MONGO_ASIO_INVARIANT(onFinish, "Invalid completion function");
-    {
+    const bool multiplexed = _options.maxMultiplexedConnectionsPerHost > 0;
+    if (!multiplexed) {
         stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
         const auto insertResult = _inGetConnection.emplace(cbHandle);
         // We should never see the same CallbackHandle added twice
@@ -272,6 +274,10 @@ Status NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cb
         return statusMetadata;
     }
 
+    if (multiplexed) {
+        return _startMultiplexedCommand(cbHandle, request, onFinish, getConnectionStartTime);
+    }
+
     auto nextStep = [this, getConnectionStartTime, cbHandle, request, onFinish](
         StatusWith<ConnectionPool::ConnectionHandle> swConn) {
 
@@ -423,6 +429,27 @@ Status NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cb
 }
 
 void NetworkInterfaceASIO::cancelCommand(const TaskExecutor::CallbackHandle& cbHandle) {
+    if (_options.maxMultiplexedConnectionsPerHost > 0) {
+        std::shared_ptr<MultiplexedCommand> cmd;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+            auto it = _multiplexedCommands.find(cbHandle);
+            if (it == _multiplexedCommands.end()) {
+                return;
+            }
+            cmd = it->second;
+        }
+
+        // A command in flight stays in flight, as the server will reply to it anyway, but its
+        // reply is dropped when it arrives.
+        _numCanceledOps.fetchAndAdd(1);
+        _strand.post([this, cmd] {
+            _completeMultiplexedCommand(
+                cmd, {ErrorCodes::CallbackCanceled, "Callback canceled", now() - cmd->start});
+        });
+        return;
+    }
+
     stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
 
     // If we found a matching cbHandle in _inGetConnection, then
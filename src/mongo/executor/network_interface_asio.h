@@ -32,6 +32,7 @@
 
 #include <array>
 #include <boost/optional.hpp>
+#include <deque>
 #include <memory>
 #include <string>
 #include <system_error>
@@ -108,6 +109,19 @@ public:
         std::unique_ptr<NetworkConnectionHook> networkConnectionHook;
         std::unique_ptr<AsyncStreamFactoryInterface> streamFactory;
         std::unique_ptr<rpc::EgressMetadataHook> metadataHook;
+
+        // When non-zero, commands to a host are pipelined over at most this many connections
+        // checked out from the connection pool, instead of taking a connection each.
+        size_t maxMultiplexedConnectionsPerHost = 0;
+
+        // The number of commands which may await their replies on one multiplexed connection.
+        // Commands queue up once all the connections to their host are this busy.
+        size_t maxCommandsPerMultiplexedConnection = 16;
+
+        // A multiplexed connection, which received no reply for this long while commands were in
+        // flight on it, is stalled behind a slow command. It takes no further commands and no
+        // longer counts against maxMultiplexedConnectionsPerHost until it receives a reply.
+        Milliseconds multiplexedConnectionStallTimeout = Milliseconds(100);
     };
 
     NetworkInterfaceASIO(Options = Options());
@@ -460,6 +474,130 @@ private:
 
     void _asyncRunCommand(AsyncOp* op, NetworkOpHandler handler);
 
+    struct MultiplexedConnection;
+
+    /**
+     * A command run over a multiplexed connection, rather than by an AsyncOp.
+     */
+    struct MultiplexedCommand {
+        MultiplexedCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                           const RemoteCommandRequest& request,
+                           const RemoteCommandCompletionFn& onFinish,
+                           Date_t start);
+
+        const TaskExecutor::CallbackHandle cbHandle;
+        const RemoteCommandRequest request;
+        const RemoteCommandCompletionFn onFinish;
+        const Date_t start;
+        std::unique_ptr<AsyncTimerInterface> timeoutAlarm;
+
+        // Set, under _multiplexMutex, once the command completed, timed out or was canceled.
+        bool finished = false;
+
+        // Guarded by _multiplexMutex. The connection the command awaits its reply on.
+        std::weak_ptr<MultiplexedConnection> inFlightOn;
+    };
+
+    /**
+     * A connection, checked out from the connection pool, which has several commands in flight
+     * at once. Commands are written one after the other and their replies, which the server sends
+     * in the same order, are matched to them by their responseTo field.
+     *
+     * 'failed' only changes on the strand of the connection's AsyncOp, and the members below
+     * 'receiving' are only touched on that strand.
+     */
+    struct MultiplexedConnection {
+        explicit MultiplexedConnection(ConnectionPool::ConnectionHandle handle);
+
+        AsyncOp& asyncOp();
+
+        ConnectionPool::ConnectionHandle handle;
+        const HostAndPort target;
+
+        // Guarded by _multiplexMutex. 'numCommands' counts the commands assigned to the
+        // connection, including those not yet in flight. 'lastProgress' is when the connection
+        // last received a reply or had its first command put in flight. A connection is
+        // 'retired' once a command in flight on it timed out or was canceled: it takes no further
+        // commands and only waits for the replies of its live commands. 'numPendingPosts' counts
+        // the handlers posted to its strand from elsewhere, which keep it checked out.
+        bool failed = false;
+        bool retired = false;
+        size_t numCommands = 0;
+        stdx::unordered_map<int32_t, std::shared_ptr<MultiplexedCommand>> inFlight;
+        bool receiving = false;
+        Date_t lastProgress;
+        int numPendingPosts = 0;
+
+        std::deque<Message> toSend;
+        bool sending = false;
+        int numPendingIO = 0;
+        MSGHEADER::Value header;
+        Message toRecv;
+    };
+
+    /**
+     * The multiplexed connections to a host, and the commands waiting for room on them.
+     *
+     * While commands are queued behind connections which are neither stalled nor have room, the
+     * stall timer fires once the first of those connections would stall, so that the commands are
+     * dispatched again even if no reply arrives to trigger it.
+     */
+    struct MultiplexedHost {
+        std::vector<std::shared_ptr<MultiplexedConnection>> connections;
+        std::deque<std::shared_ptr<MultiplexedCommand>> queued;
+        size_t numConnecting = 0;
+        std::unique_ptr<AsyncTimerInterface> stallTimer;
+        bool stallTimerArmed = false;
+    };
+
+    using MultiplexedSends = std::vector<
+        std::pair<std::shared_ptr<MultiplexedConnection>, std::shared_ptr<MultiplexedCommand>>>;
+
+    Status _startMultiplexedCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                                    const RemoteCommandRequest& request,
+                                    const RemoteCommandCompletionFn& onFinish,
+                                    Date_t start);
+
+    /**
+     * Assigns the commands queued for 'target' to its connections with room for them, adding
+     * them to 'sends'. Returns true if another connection should be checked out for the rest.
+     */
+    bool _dispatchMultiplexed_inlock(const HostAndPort& target, MultiplexedSends* sends);
+
+    void _armMultiplexedStallTimer_inlock(const HostAndPort& target,
+                                          MultiplexedHost* host,
+                                          Milliseconds delay);
+
+    void _runMultiplexedSends(MultiplexedSends sends, const HostAndPort& target, bool connect);
+    void _getMultiplexedConnection(const HostAndPort& target);
+    void _sendMultiplexed(std::shared_ptr<MultiplexedConnection> conn,
+                          std::shared_ptr<MultiplexedCommand> cmd);
+    void _writeMultiplexed(std::shared_ptr<MultiplexedConnection> conn);
+    void _readMultiplexed(std::shared_ptr<MultiplexedConnection> conn);
+    void _completedMultiplexedReply(std::shared_ptr<MultiplexedConnection> conn);
+    void _failMultiplexedConnection(std::shared_ptr<MultiplexedConnection> conn, Status status);
+
+    /**
+     * Drops the retired connection 'conn' once none of the commands in flight on it still awaits
+     * its reply, rather than wait for replies nobody needs.
+     */
+    void _dropRetiredMultiplexedConnectionIfUnused(std::shared_ptr<MultiplexedConnection> conn);
+
+    /**
+     * Returns the connection to the pool once it has nothing left to do, after it went idle or
+     * failed.
+     */
+    void _releaseMultiplexedConnectionIfDone(std::shared_ptr<MultiplexedConnection> conn);
+
+    void _completeMultiplexedCommand(const std::shared_ptr<MultiplexedCommand>& cmd,
+                                     ResponseStatus resp);
+
+    /**
+     * Completes every multiplexed command which has not finished yet with ShutdownInProgress.
+     * Only called once the IO threads have stopped.
+     */
+    void _failMultiplexedCommandsForShutdown();
+
     std::string _getDiagnosticString_inlock(AsyncOp* currentOp);
 
     // Helpers for debugging crashes
@@ -489,6 +627,11 @@ private:
     stdx::unordered_map<AsyncOp*, std::unique_ptr<AsyncOp>> _inProgress;
     stdx::unordered_set<TaskExecutor::CallbackHandle> _inGetConnection;
 
+    stdx::mutex _multiplexMutex;
+    stdx::unordered_map<HostAndPort, MultiplexedHost> _multiplexedHosts;
+    stdx::unordered_map<TaskExecutor::CallbackHandle, std::shared_ptr<MultiplexedCommand>>
+        _multiplexedCommands;
+
     // Operation counters
     AtomicUInt64 _numCanceledOps;
     AtomicUInt64 _numFailedOps;  // includes timed out ops but does not include canceled ops
@@ -31,6 +31,7 @@
 
 #include "mongo/executor/network_interface_asio.h"
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
@@ -176,6 +177,13 @@ ResponseStatus decodeRPC(Message* received,
     }
 }
 
+Status statusFromNetworkError(const std::error_code& ec) {
+    ErrorCodes::Error errorCode = (ec.category() == mongoErrorCategory())
+        ? ErrorCodes::Error(ec.value())
+        : ErrorCodes::HostUnreachable;
+    return {errorCode, ec.message()};
+}
+
 }  // namespace
 
 NetworkInterfaceASIO::AsyncCommand::AsyncCommand(AsyncConnection* conn,
@@ -501,6 +509,569 @@ void NetworkInterfaceASIO::_runConnectionHook(AsyncOp* op) {
     });
 }
 
+NetworkInterfaceASIO::MultiplexedCommand::MultiplexedCommand(
+    const TaskExecutor::CallbackHandle& cbHandle,
+    const RemoteCommandRequest& request,
+    const RemoteCommandCompletionFn& onFinish,
+    Date_t start)
+    : cbHandle(cbHandle), request(request), onFinish(onFinish), start(start) {}
+
+NetworkInterfaceASIO::MultiplexedConnection::MultiplexedConnection(
+    ConnectionPool::ConnectionHandle handle)
+    : handle(std::move(handle)), target(this->handle->getHostAndPort()) {}
+
+NetworkInterfaceASIO::AsyncOp& NetworkInterfaceASIO::MultiplexedConnection::asyncOp() {
+    return static_cast<connection_pool_asio::ASIOConnection*>(handle.get())->asyncOp();
+}
+
+Status NetworkInterfaceASIO::_startMultiplexedCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                                                      const RemoteCommandRequest& request,
+                                                      const RemoteCommandCompletionFn& onFinish,
+                                                      Date_t start) {
+    auto cmd = std::make_shared<MultiplexedCommand>(cbHandle, request, onFinish, start);
+
+    // Arm the timeout before the command can complete, so that completing it may cancel it.
+    if (request.timeout != RemoteCommandRequest::kNoTimeout) {
+        try {
+            cmd->timeoutAlarm = _timerFactory->make(&_strand, request.timeout);
+        } catch (std::system_error& e) {
+            severe() << "Failed to construct timer for multiplexed command: " << e.what();
+            fassertFailed(50744);
+        }
+
+        std::weak_ptr<MultiplexedCommand> weakCmd = cmd;
+        cmd->timeoutAlarm->asyncWait([this, weakCmd](std::error_code ec) {
+            auto cmd = weakCmd.lock();
+            if (ec || !cmd) {
+                return;
+            }
+
+            LOG(2) << "Request " << cmd->request.id << " timed out, timeout was "
+                   << cmd->request.timeout;
+            _completeMultiplexedCommand(cmd,
+                                        {ErrorCodes::NetworkInterfaceExceededTimeLimit,
+                                         "Operation timed out",
+                                         now() - cmd->start});
+        });
+    }
+
+    MultiplexedSends sends;
+    bool connect;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        const auto insertResult = _multiplexedCommands.emplace(cbHandle, cmd);
+        MONGO_ASIO_INVARIANT(insertResult.second, "Same CallbackHandle added twice");
+
+        _multiplexedHosts[request.target].queued.push_back(cmd);
+        connect = _dispatchMultiplexed_inlock(request.target, &sends);
+    }
+
+    _runMultiplexedSends(std::move(sends), request.target, connect);
+    return Status::OK();
+}
+
+bool NetworkInterfaceASIO::_dispatchMultiplexed_inlock(const HostAndPort& target,
+                                                      MultiplexedSends* sends) {
+    auto& host = _multiplexedHosts[target];
+
+    // Commands on a connection are answered in order, so none goes behind a command which is
+    // holding up its connection. Such a stalled connection leaves room for another one instead.
+    const auto now = this->now();
+    const auto isStalled = [&](const MultiplexedConnection& conn) {
+        return !conn.inFlight.empty() &&
+            now - conn.lastProgress >= _options.multiplexedConnectionStallTimeout;
+    };
+
+    while (!host.queued.empty()) {
+        auto& cmd = host.queued.front();
+        if (cmd->finished) {
+            host.queued.pop_front();
+            continue;
+        }
+
+        // Spread the commands over the connections, so that one slow command holds up as few
+        // others as possible.
+        std::shared_ptr<MultiplexedConnection> leastBusy;
+        for (auto& conn : host.connections) {
+            if (conn->numCommands < _options.maxCommandsPerMultiplexedConnection &&
+                !isStalled(*conn) && (!leastBusy || conn->numCommands < leastBusy->numCommands)) {
+                leastBusy = conn;
+            }
+        }
+        if (!leastBusy) {
+            break;
+        }
+
+        leastBusy->numCommands++;
+        sends->emplace_back(leastBusy, std::move(cmd));
+        host.queued.pop_front();
+    }
+
+    // Commands left queued wait for a reply to make room, or for a connection to stall. The
+    // latter needs no event on the connection, so a timer checks for it.
+    if (!host.queued.empty() && !host.stallTimerArmed) {
+        boost::optional<Date_t> nextStall;
+        for (const auto& conn : host.connections) {
+            if (!conn->inFlight.empty() && !isStalled(*conn)) {
+                const auto stallsAt =
+                    conn->lastProgress + _options.multiplexedConnectionStallTimeout;
+                if (!nextStall || stallsAt < *nextStall) {
+                    nextStall = stallsAt;
+                }
+            }
+        }
+        if (nextStall) {
+            _armMultiplexedStallTimer_inlock(target, &host, *nextStall - now);
+        }
+    }
+
+    const size_t numActive = std::count_if(
+        host.connections.begin(), host.connections.end(), [&](const auto& conn) {
+            return !isStalled(*conn);
+        });
+    if (host.queued.empty() ||
+        numActive + host.numConnecting >= _options.maxMultiplexedConnectionsPerHost) {
+        return false;
+    }
+    host.numConnecting++;
+    return true;
+}
+
+void NetworkInterfaceASIO::_armMultiplexedStallTimer_inlock(const HostAndPort& target,
+                                                            MultiplexedHost* host,
+                                                            Milliseconds delay) {
+    // A new timer each time, since the handler of the last one may still be running. Replacing it
+    // is safe, because the last one has fired by the time stallTimerArmed is cleared.
+    try {
+        host->stallTimer = _timerFactory->make(&_strand, std::max(delay, Milliseconds(1)));
+    } catch (std::system_error& e) {
+        severe() << "Failed to construct timer for multiplexed connections: " << e.what();
+        fassertFailed(50745);
+    }
+    host->stallTimerArmed = true;
+
+    host->stallTimer->asyncWait([this, target](std::error_code ec) {
+        MultiplexedSends sends;
+        bool connect = false;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+            _multiplexedHosts[target].stallTimerArmed = false;
+            if (!ec && !inShutdown()) {
+                connect = _dispatchMultiplexed_inlock(target, &sends);
+            }
+        }
+        _runMultiplexedSends(std::move(sends), target, connect);
+    });
+}
+
+void NetworkInterfaceASIO::_runMultiplexedSends(MultiplexedSends sends,
+                                                const HostAndPort& target,
+                                                bool connect) {
+    for (auto& send : sends) {
+        _sendMultiplexed(std::move(send.first), std::move(send.second));
+    }
+    if (connect) {
+        _getMultiplexedConnection(target);
+    }
+}
+
+void NetworkInterfaceASIO::_getMultiplexedConnection(const HostAndPort& target) {
+    const auto start = now();
+    _connectionPool.get(
+        target,
+        RemoteCommandRequest::kNoTimeout,
+        [this, target, start](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+            std::vector<std::shared_ptr<MultiplexedCommand>> failed;
+            MultiplexedSends sends;
+            bool connect;
+            {
+                stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+                auto& host = _multiplexedHosts[target];
+                host.numConnecting--;
+                if (swConn.isOK()) {
+                    host.connections.push_back(
+                        std::make_shared<MultiplexedConnection>(std::move(swConn.getValue())));
+                } else if (host.connections.empty() && host.numConnecting == 0) {
+                    // Nothing else will pick up the queued commands, so they fail in turn.
+                    failed.assign(host.queued.begin(), host.queued.end());
+                    host.queued.clear();
+                }
+                connect = _dispatchMultiplexed_inlock(target, &sends);
+            }
+
+            if (!swConn.isOK()) {
+                LOG(2) << "Failed to get connection from pool to " << target << ": "
+                       << swConn.getStatus();
+            }
+            for (auto& cmd : failed) {
+                _completeMultiplexedCommand(cmd, {swConn.getStatus(), now() - start});
+            }
+            _runMultiplexedSends(std::move(sends), target, connect);
+        });
+}
+
+void NetworkInterfaceASIO::_sendMultiplexed(std::shared_ptr<MultiplexedConnection> conn,
+                                            std::shared_ptr<MultiplexedCommand> cmd) {
+    // The connection stays checked out while it counts this command, so 'op' outlives the post.
+    auto& op = conn->asyncOp();
+    op.strand().post([this, conn, cmd, &op] {
+        bool dropped;
+        MultiplexedSends sends;
+        bool connect = false;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+            dropped = conn->failed || conn->retired || cmd->finished;
+            if (dropped) {
+                conn->numCommands--;
+                if (!cmd->finished) {
+                    // The connection failed or retired before the command went out, so it waits
+                    // for another.
+                    _multiplexedHosts[conn->target].queued.push_front(cmd);
+                    connect = _dispatchMultiplexed_inlock(conn->target, &sends);
+                }
+            }
+        }
+        if (dropped) {
+            _runMultiplexedSends(std::move(sends), conn->target, connect);
+            return _releaseMultiplexedConnectionIfDone(conn);
+        }
+
+        auto swm = op.connection().getCompressorManager().compressMessage(
+            rpc::messageFromOpMsgRequest(op.operationProtocol(),
+                                         OpMsgRequest::fromDBAndBody(cmd->request.dbname,
+                                                                     cmd->request.cmdObj,
+                                                                     cmd->request.metadata)));
+        if (!swm.isOK()) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+                conn->numCommands--;
+            }
+            _completeMultiplexedCommand(cmd, {swm.getStatus(), now() - cmd->start});
+            return _releaseMultiplexedConnectionIfDone(conn);
+        }
+
+        auto& message = swm.getValue();
+        message.header().setResponseToMsgId(0);
+        message.header().setId(nextMessageId());
+
+        bool startReceiving = false;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+            // A command, which timed out or was canceled meanwhile, must not take up the
+            // connection waiting for a reply nobody needs.
+            dropped = cmd->finished;
+            if (dropped) {
+                conn->numCommands--;
+            } else {
+                if (conn->inFlight.empty()) {
+                    conn->lastProgress = now();
+
+                    // Commands queued meanwhile may have found no connection to arm the stall
+                    // timer for.
+                    auto& host = _multiplexedHosts[conn->target];
+                    if (!host.queued.empty() && !host.stallTimerArmed) {
+                        _armMultiplexedStallTimer_inlock(
+                            conn->target, &host, _options.multiplexedConnectionStallTimeout);
+                    }
+                }
+                conn->inFlight.emplace(message.header().getId(), cmd);
+                cmd->inFlightOn = conn;
+                startReceiving = !conn->receiving;
+                conn->receiving = true;
+            }
+        }
+        if (dropped) {
+            return _releaseMultiplexedConnectionIfDone(conn);
+        }
+
+        conn->toSend.push_back(std::move(message));
+        if (!conn->sending) {
+            _writeMultiplexed(conn);
+        }
+        if (startReceiving) {
+            _readMultiplexed(conn);
+        }
+    });
+}
+
+void NetworkInterfaceASIO::_writeMultiplexed(std::shared_ptr<MultiplexedConnection> conn) {
+    conn->sending = true;
+    conn->numPendingIO++;
+    auto& message = conn->toSend.front();
+    conn->asyncOp().connection().stream().write(
+        asio::buffer(message.buf(), message.size()), [this, conn](std::error_code ec, size_t) {
+            conn->numPendingIO--;
+            conn->toSend.pop_front();
+            if (!ec && !conn->failed && !conn->toSend.empty()) {
+                return _writeMultiplexed(conn);
+            }
+            conn->sending = false;
+            if (ec) {
+                return _failMultiplexedConnection(conn, statusFromNetworkError(ec));
+            }
+            _releaseMultiplexedConnectionIfDone(conn);
+        });
+}
+
+void NetworkInterfaceASIO::_readMultiplexed(std::shared_ptr<MultiplexedConnection> conn) {
+    conn->numPendingIO++;
+    auto& stream = conn->asyncOp().connection().stream();
+    asyncRecvMessageHeader(
+        stream, &conn->header, [this, conn, &stream](std::error_code ec, size_t) {
+            if (ec || conn->failed) {
+                conn->numPendingIO--;
+                return ec ? _failMultiplexedConnection(conn, statusFromNetworkError(ec))
+                          : _releaseMultiplexedConnectionIfDone(conn);
+            }
+            asyncRecvMessageBody(
+                stream, &conn->header, &conn->toRecv, [this, conn](std::error_code ec, size_t) {
+                    conn->numPendingIO--;
+                    if (ec) {
+                        return _failMultiplexedConnection(conn, statusFromNetworkError(ec));
+                    }
+                    _completedMultiplexedReply(conn);
+                });
+        });
+}
+
+void NetworkInterfaceASIO::_completedMultiplexedReply(std::shared_ptr<MultiplexedConnection> conn) {
+    if (conn->failed) {
+        return _releaseMultiplexedConnectionIfDone(conn);
+    }
+
+    const auto responseTo = conn->header.constView().getResponseToMsgId();
+    std::shared_ptr<MultiplexedCommand> cmd;
+    bool keepReceiving = false;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        auto it = conn->inFlight.find(responseTo);
+        if (it != conn->inFlight.end()) {
+            cmd = std::move(it->second);
+            cmd->inFlightOn.reset();
+            conn->inFlight.erase(it);
+            conn->numCommands--;
+            conn->lastProgress = now();
+            keepReceiving = !conn->inFlight.empty();
+            conn->receiving = keepReceiving;
+        }
+    }
+    if (!cmd) {
+        LOG(3) << "got a reply to unknown request " << responseTo << " from " << conn->target;
+        return _failMultiplexedConnection(
+            conn, {ErrorCodes::ProtocolError, "Reply does not match any request in flight"});
+    }
+
+    auto& op = conn->asyncOp();
+    auto received = std::move(conn->toRecv);
+    conn->toRecv.reset();
+    if (received.operation() == dbCompressed) {
+        auto swm = op.connection().getCompressorManager().decompressMessage(received);
+        if (!swm.isOK()) {
+            _completeMultiplexedCommand(cmd, {swm.getStatus(), now() - cmd->start});
+            return _failMultiplexedConnection(conn, swm.getStatus());
+        }
+        received = std::move(swm.getValue());
+    }
+    _completeMultiplexedCommand(cmd,
+                                decodeRPC(&received,
+                                          op.operationProtocol(),
+                                          now() - cmd->start,
+                                          cmd->request.target,
+                                          _metadataHook.get()));
+
+    if (keepReceiving) {
+        _readMultiplexed(conn);
+    }
+    _dropRetiredMultiplexedConnectionIfUnused(conn);
+
+    // Queued commands may now go on this connection, or it may go back to the pool.
+    MultiplexedSends sends;
+    bool connect;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        connect = _dispatchMultiplexed_inlock(conn->target, &sends);
+    }
+    _runMultiplexedSends(std::move(sends), conn->target, connect);
+    _releaseMultiplexedConnectionIfDone(conn);
+}
+
+void NetworkInterfaceASIO::_failMultiplexedConnection(std::shared_ptr<MultiplexedConnection> conn,
+                                                      Status status) {
+    std::vector<std::shared_ptr<MultiplexedCommand>> failed;
+    MultiplexedSends sends;
+    bool connect;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        if (!conn->failed) {
+            conn->failed = true;
+            auto& connections = _multiplexedHosts[conn->target].connections;
+            connections.erase(std::remove(connections.begin(), connections.end(), conn),
+                              connections.end());
+            for (auto& kv : conn->inFlight) {
+                kv.second->inFlightOn.reset();
+                failed.push_back(std::move(kv.second));
+            }
+            // Commands assigned to the connection but not sent yet get requeued when their turn
+            // to be sent comes.
+            conn->numCommands -= conn->inFlight.size();
+            conn->inFlight.clear();
+        }
+        connect = _dispatchMultiplexed_inlock(conn->target, &sends);
+    }
+
+    if (!failed.empty()) {
+        LOG(2) << "Multiplexed connection to " << conn->target << " failed: " << status;
+    }
+    for (auto& cmd : failed) {
+        _completeMultiplexedCommand(cmd, {status, now() - cmd->start});
+    }
+
+    // Cancel whatever is still being read or written, so the connection can be returned.
+    if (conn->handle) {
+        conn->asyncOp().connection().cancel();
+    }
+    _runMultiplexedSends(std::move(sends), conn->target, connect);
+    _releaseMultiplexedConnectionIfDone(conn);
+}
+
+void NetworkInterfaceASIO::_releaseMultiplexedConnectionIfDone(
+    std::shared_ptr<MultiplexedConnection> conn) {
+    if (!conn->handle || conn->sending || conn->numPendingIO > 0) {
+        return;
+    }
+
+    bool failed;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        failed = conn->failed;
+        if (conn->numCommands > 0 || conn->numPendingPosts > 0) {
+            return;
+        }
+        if (!failed && !conn->retired) {
+            auto& host = _multiplexedHosts[conn->target];
+            if (!host.queued.empty()) {
+                return;
+            }
+            host.connections.erase(
+                std::remove(host.connections.begin(), host.connections.end(), conn),
+                host.connections.end());
+        }
+    }
+
+    auto handle = std::move(conn->handle);
+    auto asioConn = static_cast<connection_pool_asio::ASIOConnection*>(handle.get());
+    if (failed) {
+        asioConn->indicateFailure({ErrorCodes::HostUnreachable, "Multiplexed connection failed"});
+    } else {
+        asioConn->indicateUsed();
+        asioConn->indicateSuccess();
+    }
+}
+
+void NetworkInterfaceASIO::_dropRetiredMultiplexedConnectionIfUnused(
+    std::shared_ptr<MultiplexedConnection> conn) {
+    bool unused;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        unused = conn->retired && !conn->failed && !conn->inFlight.empty() &&
+            std::all_of(conn->inFlight.begin(), conn->inFlight.end(), [](const auto& kv) {
+                return kv.second->finished;
+            });
+    }
+    if (unused) {
+        _failMultiplexedConnection(
+            conn,
+            {ErrorCodes::CallbackCanceled, "All commands in flight timed out or were canceled"});
+    }
+}
+
+void NetworkInterfaceASIO::_failMultiplexedCommandsForShutdown() {
+    std::vector<std::shared_ptr<MultiplexedCommand>> pending;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        for (auto& kv : _multiplexedCommands) {
+            // Nothing runs on the connections anymore, so none of them needs retiring.
+            kv.second->inFlightOn.reset();
+            pending.push_back(kv.second);
+        }
+        for (auto& kv : _multiplexedHosts) {
+            kv.second.queued.clear();
+        }
+    }
+
+    for (auto& cmd : pending) {
+        _completeMultiplexedCommand(cmd,
+                                    {ErrorCodes::ShutdownInProgress,
+                                     "NetworkInterfaceASIO shutdown in progress",
+                                     now() - cmd->start});
+    }
+}
+
+void NetworkInterfaceASIO::_completeMultiplexedCommand(
+    const std::shared_ptr<MultiplexedCommand>& cmd, ResponseStatus resp) {
+    std::shared_ptr<MultiplexedConnection> retiredConn;
+    MultiplexedSends sends;
+    bool connect = false;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+        if (cmd->finished) {
+            return;
+        }
+        cmd->finished = true;
+        _multiplexedCommands.erase(cmd->cbHandle);
+
+        // The command timed out or was canceled while in flight. Its reply will still arrive,
+        // after those of the commands ahead of it, so rather than hold its slot until then, the
+        // connection retires and makes room for another.
+        retiredConn = cmd->inFlightOn.lock();
+        if (retiredConn) {
+            cmd->inFlightOn.reset();
+            if (!retiredConn->retired) {
+                retiredConn->retired = true;
+                auto& connections = _multiplexedHosts[retiredConn->target].connections;
+                connections.erase(
+                    std::remove(connections.begin(), connections.end(), retiredConn),
+                    connections.end());
+                connect = _dispatchMultiplexed_inlock(retiredConn->target, &sends);
+            }
+
+            // The command still counts on the connection, which therefore stays checked out
+            // until the post runs.
+            retiredConn->numPendingPosts++;
+        }
+    }
+
+    if (retiredConn) {
+        retiredConn->asyncOp().strand().post([this, retiredConn] {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_multiplexMutex);
+                retiredConn->numPendingPosts--;
+            }
+            _dropRetiredMultiplexedConnectionIfUnused(retiredConn);
+            _releaseMultiplexedConnectionIfDone(retiredConn);
+        });
+        _runMultiplexedSends(std::move(sends), retiredConn->target, connect);
+    }
+
+    if (cmd->timeoutAlarm) {
+        cmd->timeoutAlarm->cancel();
+    }
+
+    if (ErrorCodes::isExceededTimeLimitError(resp.status.code())) {
+        _numTimedOutOps.fetchAndAdd(1);
+    }
+    if (resp.isOK()) {
+        _numSucceededOps.fetchAndAdd(1);
+    } else if (resp.status.code() != ErrorCodes::CallbackCanceled) {
+        _numFailedOps.fetchAndAdd(1);
+    }
+
+    LOG(2) << "Request " << cmd->request.id << " finished with response: "
+           << redact(resp.isOK() ? resp.data.toString() : resp.status.toString());
+    cmd->onFinish(resp);
+    signalWorkAvailable();
+}
+
 
 }  // namespace executor
 }  // namespace mongo
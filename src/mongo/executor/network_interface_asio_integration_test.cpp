@@ -32,8 +32,10 @@
 
 #include <algorithm>
 #include <exception>
+#include <vector>
 
 #include "mongo/client/connection_string.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/executor/network_interface_asio_integration_fixture.h"
 #include "mongo/executor/network_interface_asio_test_utils.h"
 #include "mongo/platform/random.h"
@@ -77,6 +79,111 @@ TEST_F(NetworkInterfaceASIOIntegrationFixture, Timeouts) {
                     Milliseconds(10000000));
 }
 
+// Test that concurrent commands are pipelined over a bounded number of connections.
+TEST_F(NetworkInterfaceASIOIntegrationFixture, MultiplexedCommandsShareConnections) {
+    constexpr std::size_t numOps = 32;
+
+    NetworkInterfaceASIO::Options options;
+    options.maxMultiplexedConnectionsPerHost = 2;
+    options.maxCommandsPerMultiplexedConnection = 16;
+    startNet(std::move(options));
+
+    std::vector<RemoteCommandRequest> requests;
+    std::vector<Deferred<RemoteCommandResponse>> deferreds;
+    requests.reserve(numOps);
+    for (std::size_t i = 0; i < numOps; ++i) {
+        requests.emplace_back(fixture().getServers()[0], "admin", BSON("ping" << 1), nullptr);
+        deferreds.push_back(runCommand(makeCallbackHandle(), requests.back()));
+    }
+
+    for (auto& deferred : deferreds) {
+        auto& resp = deferred.get();
+        ASSERT_OK(resp.status);
+        ASSERT_OK(getStatusFromCommandResult(resp.data));
+    }
+
+    ConnectionPoolStats stats;
+    net().appendConnectionStats(&stats);
+    ASSERT_LTE(stats.totalCreated, 2u);
+}
+
+// Test that a slow command holds up only the commands pipelined behind it before it stalled its
+// connection, and that commands issued afterwards go on another connection.
+TEST_F(NetworkInterfaceASIOIntegrationFixture, MultiplexedSlowCommandDoesNotHoldUpFastCommands) {
+    NetworkInterfaceASIO::Options options;
+    options.maxMultiplexedConnectionsPerHost = 1;
+    options.multiplexedConnectionStallTimeout = Milliseconds(50);
+    startNet(std::move(options));
+
+    RemoteCommandRequest slowRequest{fixture().getServers()[0],
+                                     "admin",
+                                     BSON("sleep" << 1 << "lock"
+                                                  << "none"
+                                                  << "secs"
+                                                  << 3),
+                                     nullptr};
+    auto slow = runCommand(makeCallbackHandle(), slowRequest);
+
+    // The ping shares the connection of the slow command and waits for it.
+    RemoteCommandRequest pipelinedRequest{
+        fixture().getServers()[0], "admin", BSON("ping" << 1), nullptr};
+    auto pipelined = runCommand(makeCallbackHandle(), pipelinedRequest);
+
+    // Once the connection stalled, fast commands no longer wait behind the slow one.
+    sleepmillis(200);
+    assertCommandOK("admin", BSON("ping" << 1), Milliseconds(1000));
+    ASSERT_FALSE(slow.hasCompleted());
+
+    ASSERT_OK(slow.get().status);
+    ASSERT_OK(pipelined.get().status);
+}
+
+// Test that a command queued behind a full connection goes on another one once that connection
+// stalls, without waiting for any reply to arrive.
+TEST_F(NetworkInterfaceASIOIntegrationFixture, MultiplexedQueuedCommandMovesOffStalledConnection) {
+    NetworkInterfaceASIO::Options options;
+    options.maxMultiplexedConnectionsPerHost = 1;
+    options.maxCommandsPerMultiplexedConnection = 1;
+    options.multiplexedConnectionStallTimeout = Milliseconds(50);
+    startNet(std::move(options));
+
+    RemoteCommandRequest slowRequest{fixture().getServers()[0],
+                                     "admin",
+                                     BSON("sleep" << 1 << "lock"
+                                                  << "none"
+                                                  << "secs"
+                                                  << 3),
+                                     nullptr};
+    auto slow = runCommand(makeCallbackHandle(), slowRequest);
+
+    // The ping finds the only connection full and queues until it stalls.
+    assertCommandOK("admin", BSON("ping" << 1), Milliseconds(1000));
+    ASSERT_FALSE(slow.hasCompleted());
+
+    ASSERT_OK(slow.get().status);
+}
+
+// Test that a command timing out while in flight frees its slot on a multiplexed connection,
+// even though the server has not replied to it yet.
+TEST_F(NetworkInterfaceASIOIntegrationFixture, MultiplexedTimeoutFreesConnectionSlot) {
+    NetworkInterfaceASIO::Options options;
+    options.maxMultiplexedConnectionsPerHost = 1;
+    options.maxCommandsPerMultiplexedConnection = 1;
+    options.multiplexedConnectionStallTimeout = Minutes(5);
+    startNet(std::move(options));
+
+    assertCommandFailsOnClient("admin",
+                               BSON("sleep" << 1 << "lock"
+                                            << "none"
+                                            << "secs"
+                                            << 3),
+                               ErrorCodes::NetworkInterfaceExceededTimeLimit,
+                               Milliseconds(100));
+
+    // The ping would otherwise queue until the sleep finished on the server.
+    assertCommandOK("admin", BSON("ping" << 1), Milliseconds(1000));
+}
+
 class StressTestOp {
 public:
     using Fixture = NetworkInterfaceASIOIntegrationFixture;
@@ -52,12 +52,14 @@ std::unique_ptr<NetworkInterface> makeNetworkInterface(std::string instanceName)
     return makeNetworkInterface(std::move(instanceName), nullptr, nullptr);
 }
 
-std::unique_ptr<NetworkInterface> makeNetworkInterface(
+namespace {
+
+std::unique_ptr<NetworkInterface> makeNetworkInterfaceASIO(
+    NetworkInterfaceASIO::Options options,
     std::string instanceName,
     std::unique_ptr<NetworkConnectionHook> hook,
     std::unique_ptr<rpc::EgressMetadataHook> metadataHook,
     ConnectionPool::Options connPoolOptions) {
-    NetworkInterfaceASIO::Options options{};
     options.instanceName = std::move(instanceName);
     options.networkConnectionHook = std::move(hook);
     options.metadataHook = std::move(metadataHook);
@@ -80,5 +82,38 @@ std::unique_ptr<NetworkInterface> makeNetworkInterface(
     return stdx::make_unique<NetworkInterfaceASIO>(std::move(options));
 }
 
+}  // namespace
+
+std::unique_ptr<NetworkInterface> makeNetworkInterface(
+    std::string instanceName,
+    std::unique_ptr<NetworkConnectionHook> hook,
+    std::unique_ptr<rpc::EgressMetadataHook> metadataHook,
+    ConnectionPool::Options connPoolOptions) {
+    return makeNetworkInterfaceASIO(NetworkInterfaceASIO::Options{},
+                                    std::move(instanceName),
+                                    std::move(hook),
+                                    std::move(metadataHook),
+                                    std::move(connPoolOptions));
+}
+
+std::unique_ptr<NetworkInterface> makeMultiplexedNetworkInterface(
+    std::string instanceName,
+    std::unique_ptr<NetworkConnectionHook> hook,
+    std::unique_ptr<rpc::EgressMetadataHook> metadataHook,
+    ConnectionPool::Options connPoolOptions,
+    size_t maxMultiplexedConnectionsPerHost,
+    size_t maxCommandsPerMultiplexedConnection,
+    Milliseconds stallTimeout) {
+    NetworkInterfaceASIO::Options options{};
+    options.maxMultiplexedConnectionsPerHost = maxMultiplexedConnectionsPerHost;
+    options.maxCommandsPerMultiplexedConnection = maxCommandsPerMultiplexedConnection;
+    options.multiplexedConnectionStallTimeout = stallTimeout;
+    return makeNetworkInterfaceASIO(std::move(options),
+                                    std::move(instanceName),
+                                    std::move(hook),
+                                    std::move(metadataHook),
+                                    std::move(connPoolOptions));
+}
+
 }  // namespace executor
 }  // namespace mongo
@@ -58,5 +58,20 @@ std::unique_ptr<NetworkInterface> makeNetworkInterface(
     std::unique_ptr<rpc::EgressMetadataHook> metadataHook,
     ConnectionPool::Options options = ConnectionPool::Options());
 
+/**
+ * Returns a new NetworkInterface with the given connection hook set, which pipelines commands
+ * over at most 'maxMultiplexedConnectionsPerHost' connections to each host, with no more than
+ * 'maxCommandsPerMultiplexedConnection' outstanding on any one of them. A connection, which got
+ * no reply for 'stallTimeout', takes no further commands until it does.
+ */
+std::unique_ptr<NetworkInterface> makeMultiplexedNetworkInterface(
+    std::string instanceName,
+    std::unique_ptr<NetworkConnectionHook> hook,
+    std::unique_ptr<rpc::EgressMetadataHook> metadataHook,
+    ConnectionPool::Options options,
+    size_t maxMultiplexedConnectionsPerHost,
+    size_t maxCommandsPerMultiplexedConnection,
+    Milliseconds stallTimeout);
+
 }  // namespace executor
 }  // namespace mongo
@@ -118,6 +118,32 @@ void AsyncRequestsSender::stopRetrying() {
     _stopRetrying = true;
 }
 
+void AsyncRequestsSender::addRequests(const std::vector<AsyncRequestsSender::Request>& requests) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    const size_t firstNewRemote = _remotes.size();
+    for (const auto& request : requests) {
+        _remotes.emplace_back(request.shardId, request.cmdObj);
+    }
+
+    if (!_stopRetrying) {
+        _scheduleRequests(lk);
+        return;
+    }
+
+    // Once the pending requests have been canceled, nothing new is sent. Fail the new remotes so
+    // that their responses are still returned by next().
+    for (size_t i = firstNewRemote; i < _remotes.size(); ++i) {
+        _remotes[i].swResponse = _interruptStatus.isOK()
+            ? Status(ErrorCodes::CallbackCanceled, "Request was not sent because it was canceled")
+            : _interruptStatus;
+    }
+
+    if (firstNewRemote < _remotes.size() && !*_notification) {
+        _notification->set();
+    }
+}
+
 bool AsyncRequestsSender::done() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     return std::all_of(
@@ -147,24 +173,28 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
 
     // Check if any remote is ready.
     invariant(!_remotes.empty());
-    for (auto& remote : _remotes) {
+    for (size_t i = 0; i < _remotes.size(); ++i) {
+        auto& remote = _remotes[i];
         if (remote.swResponse && !remote.done) {
             remote.done = true;
+            boost::optional<Response> response;
             if (remote.swResponse->isOK()) {
                 invariant(remote.shardHostAndPort);
-                return Response(std::move(remote.shardId),
-                                std::move(remote.swResponse->getValue()),
-                                std::move(*remote.shardHostAndPort));
+                response.emplace(std::move(remote.shardId),
+                                 std::move(remote.swResponse->getValue()),
+                                 std::move(*remote.shardHostAndPort));
             } else {
                 // If _interruptStatus is set, promote CallbackCanceled errors to it.
                 if (!_interruptStatus.isOK() &&
                     ErrorCodes::CallbackCanceled == remote.swResponse->getStatus().code()) {
                     remote.swResponse = _interruptStatus;
                 }
-                return Response(std::move(remote.shardId),
-                                std::move(remote.swResponse->getStatus()),
-                                std::move(remote.shardHostAndPort));
+                response.emplace(std::move(remote.shardId),
+                                 std::move(remote.swResponse->getStatus()),
+                                 std::move(remote.shardHostAndPort));
             }
+            response->requestIndex = i;
+            return response;
         }
     }
     // No remotes were ready.
@@ -116,6 +116,11 @@ public:
         // The exact host on which the remote command was run. Is unset if the shard could not be
         // found or no shard hosts matching the readPreference could be found.
         boost::optional<HostAndPort> shardHostAndPort;
+
+        // The position of the request among all the requests given to the ARS, first those passed
+        // to the constructor and then those passed to each call of addRequests(). Distinguishes
+        // responses from the same shard.
+        size_t requestIndex = 0;
     };
 
     /**
@@ -135,6 +140,16 @@ public:
      */
     ~AsyncRequestsSender();
 
+    /**
+     * Schedules more requests immediately, for example to keep a pipeline of requests to a shard
+     * going while responses for earlier requests are being processed. Their responses are returned
+     * by next() the same way as those of the requests passed to the constructor.
+     *
+     * If the operation was interrupted or the pending requests were canceled, the new requests are
+     * not sent and their responses carry the error instead.
+     */
+    void addRequests(const std::vector<AsyncRequestsSender::Request>& requests);
+
     /**
      * Returns true if responses for all requests have been returned via next().
      */
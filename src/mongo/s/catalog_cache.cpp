@@ -276,7 +276,14 @@ void CatalogCache::invalidateShardedCollection(const NamespaceString& nss) {
         return;
     }
 
-    it->second->collections[nss.ns()].needsRefresh = true;
+    auto& collEntry = it->second->collections[nss.ns()];
+    if (collEntry.refreshCompletionNotification) {
+        // Any number of invalidations during an in-progress refresh coalesce into a single refresh
+        // after it
+        collEntry.needsRefreshAfterCurrent = true;
+    }
+
+    collEntry.needsRefresh = true;
 }
 
 void CatalogCache::purgeDatabase(StringData dbName) {
@@ -405,6 +412,7 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
         } else {
             // Leave needsRefresh to true so that any subsequent get attempts will kick off
             // another round of refresh
+            collEntry.needsRefreshAfterCurrent = false;
             collEntry.refreshCompletionNotification->set(status);
             collEntry.refreshCompletionNotification = nullptr;
         }
@@ -433,6 +441,15 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
         invariant(it != collections.end());
         auto& collEntry = it->second;
 
+        if (collEntry.needsRefreshAfterCurrent) {
+            collEntry.needsRefreshAfterCurrent = false;
+
+            // Keep the refresh notification pending, so that the waiters for the current refresh
+            // also wait for the one, which observes the invalidation
+            _scheduleCollectionRefresh(lg, dbEntry, std::move(newRoutingInfo), nss, 1);
+            return;
+        }
+
         collEntry.needsRefresh = false;
         collEntry.refreshCompletionNotification->set(Status::OK());
         collEntry.refreshCompletionNotification = nullptr;
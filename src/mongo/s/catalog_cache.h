@@ -159,6 +159,11 @@ private:
         // needsRefresh is true)
         std::shared_ptr<Notification<Status>> refreshCompletionNotification;
 
+        // Set if the entry was invalidated while a refresh was in progress, in which case that
+        // refresh might not observe the change which caused the invalidation. Another refresh is
+        // started as soon as the current one completes and its waiters are only notified after it.
+        bool needsRefreshAfterCurrent{false};
+
         // Contains the cached routing information (only available if needsRefresh is false)
         std::shared_ptr<ChunkManager> routingInfo;
     };
@@ -36,6 +36,7 @@
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/catalog_cache_test_fixture.h"
+#include "mongo/s/grid.h"
 
 namespace mongo {
 namespace {
@@ -60,13 +61,18 @@ protected:
         }());
     }
 
-    void expectGetCollection(OID epoch, const ShardKeyPattern& shardKeyPattern) {
+    void expectGetCollection(OID epoch,
+                             const ShardKeyPattern& shardKeyPattern,
+                             boost::optional<UUID> uuid = boost::none) {
         expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
             CollectionType collType;
             collType.setNs(kNss);
             collType.setEpoch(epoch);
             collType.setKeyPattern(shardKeyPattern.toBSON());
             collType.setUnique(false);
+            if (uuid) {
+                collType.setUUID(*uuid);
+            }
 
             return std::vector<BSONObj>{collType.toBSON()};
         }());
@@ -610,5 +616,119 @@ TEST_F(CatalogCacheRefreshTest, IncrementalLoadAfterMoveLastChunk) {
     ASSERT_EQ(version, cm->getVersion({"1"}));
 }
 
+TEST_F(CatalogCacheRefreshTest, IncrementalLoadSkipsCollectionLookupForKnownEpoch) {
+    const OID epoch = OID::gen();
+    const UUID uuid = UUID::gen();
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    ChunkVersion version(1, 0, epoch);
+
+    {
+        auto future = scheduleRoutingInfoRefresh(kNss);
+
+        expectGetDatabase();
+        expectGetCollection(epoch, shardKeyPattern, uuid);
+
+        expectGetCollection(epoch, shardKeyPattern, uuid);
+        expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+            ChunkType chunk1(kNss,
+                             {shardKeyPattern.getKeyPattern().globalMin(),
+                              shardKeyPattern.getKeyPattern().globalMax()},
+                             version,
+                             {"0"});
+            return std::vector<BSONObj>{chunk1.toConfigBSON()};
+        }());
+
+        auto routingInfo = future.timed_get(kFutureTimeout);
+        ASSERT(routingInfo->cm());
+        ASSERT_EQ(version, routingInfo->cm()->getVersion());
+    }
+
+    auto future = scheduleRoutingInfoRefresh(kNss);
+
+    // The collection entry for the epoch is already known, so only the chunks are queried
+    onFindCommand([&](const RemoteCommandRequest& request) {
+        const auto diffQuery =
+            assertGet(QueryRequest::makeFromFindCommand(kNss, request.cmdObj, false));
+        ASSERT_BSONOBJ_EQ(
+            BSON("ns" << kNss.ns() << "lastmod"
+                      << BSON("$gte" << Timestamp(version.majorVersion(), version.minorVersion()))),
+            diffQuery->getFilter());
+
+        version.incMajor();
+        ChunkType chunk1(
+            kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"0"});
+
+        version.incMinor();
+        ChunkType chunk2(
+            kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+
+        return std::vector<BSONObj>{chunk1.toConfigBSON(), chunk2.toConfigBSON()};
+    });
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT(routingInfo->cm());
+    auto cm = routingInfo->cm();
+
+    ASSERT_EQ(2, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+    ASSERT(cm->uuidMatches(uuid));
+}
+
+TEST_F(CatalogCacheRefreshTest, InvalidationDuringRefreshTriggersAnotherRefresh) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(makeChunkManager(kNss, shardKeyPattern, nullptr, true, {}));
+    ASSERT_EQ(1, initialRoutingInfo->numChunks());
+
+    ChunkVersion version = initialRoutingInfo->getVersion();
+
+    auto future = scheduleRoutingInfoRefresh(kNss);
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+
+    // Return set of chunks, which represent a split and invalidate the cache entry before the
+    // refresh completes
+    expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+        Grid::get(serviceContext())->catalogCache()->invalidateShardedCollection(kNss);
+
+        version.incMajor();
+        ChunkType chunk1(
+            kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"0"});
+
+        version.incMinor();
+        ChunkType chunk2(
+            kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+
+        return std::vector<BSONObj>{chunk1.toConfigBSON(), chunk2.toConfigBSON()};
+    }());
+
+    // The refresh which observes the invalidation starts from the result of the previous one
+    expectGetCollection(version.epoch(), shardKeyPattern);
+
+    onFindCommand([&](const RemoteCommandRequest& request) {
+        const auto diffQuery =
+            assertGet(QueryRequest::makeFromFindCommand(kNss, request.cmdObj, false));
+        ASSERT_BSONOBJ_EQ(
+            BSON("ns" << kNss.ns() << "lastmod"
+                      << BSON("$gte" << Timestamp(version.majorVersion(), version.minorVersion()))),
+            diffQuery->getFilter());
+
+        version.incMajor();
+        ChunkType chunk1(
+            kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"1"});
+
+        return std::vector<BSONObj>{chunk1.toConfigBSON()};
+    });
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT(routingInfo->cm());
+    auto cm = routingInfo->cm();
+
+    ASSERT_EQ(2, cm->numChunks());
+    ASSERT_EQ(version, cm->getVersion());
+    ASSERT_EQ(version, cm->getVersion({"1"}));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -34,6 +34,7 @@
 
 #include "mongo/platform/random.h"
 #include "mongo/s/grid.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -66,6 +67,10 @@ Chunk::Chunk(const ChunkType& from)
     invariantOK(from.validate());
 }
 
+Chunk::~Chunk() {
+    delete _keySampler.load();
+}
+
 bool Chunk::containsKey(const BSONObj& shardKey) const {
     return getMin().woCompare(shardKey) <= 0 && shardKey.woCompare(getMax()) < 0;
 }
@@ -94,6 +99,19 @@ bool Chunk::shouldSplit(uint64_t desiredChunkSize, bool minIsInf, bool maxIsInf)
     return _dataWritten >= splitThreshold / kSplitTestFactor;
 }
 
+void Chunk::sampleKeyInserted(const BSONObj& shardKey, uint64_t bytesInserted) {
+    auto sampler = _keySampler.load();
+    if (!sampler) {
+        auto newSampler = stdx::make_unique<ChunkKeySampler>();
+        sampler = _keySampler.compareAndSwap(nullptr, newSampler.get());
+        if (!sampler) {
+            sampler = newSampler.release();
+        }
+    }
+
+    sampler->add(shardKey, bytesInserted);
+}
+
 std::string Chunk::toString() const {
     return str::stream() << ChunkType::shard() << ": " << _shardId << ", " << ChunkType::lastmod()
                          << ": " << _lastmod.toString() << ", " << _range.toString();
@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/chunk_key_sampler.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/shard_id.h"
 
@@ -45,6 +47,7 @@ public:
     static const uint64_t kSplitTestFactor = 5;
 
     explicit Chunk(const ChunkType& from);
+    ~Chunk();
 
     const BSONObj& getMin() const {
         return _range.getMin();
@@ -86,6 +89,20 @@ public:
 
     bool shouldSplit(uint64_t desiredChunkSize, bool minIsInf, bool maxIsInf) const;
 
+    /**
+     * Records the shard key of a document inserted into this chunk in the sample of its keys,
+     * which is allocated on first use. Only the shard, which owns the chunk, records keys.
+     */
+    void sampleKeyInserted(const BSONObj& shardKey, uint64_t bytesInserted);
+
+    /**
+     * Returns the sample of the keys inserted into this chunk or nullptr if none have been
+     * recorded.
+     */
+    const ChunkKeySampler* getKeySampler() const {
+        return _keySampler.load();
+    }
+
     /**
      * Marks this chunk as jumbo. Only moves from false to true once and is used by the balancer.
      */
@@ -104,6 +121,10 @@ private:
 
     // Statistics for the approximate data written to this chunk
     mutable uint64_t _dataWritten;
+
+    // Sample of the keys inserted into this chunk, owned by it. Allocated on the first recorded
+    // insert, so that routers, which do not record any, do not pay for it.
+    AtomicWord<ChunkKeySampler*> _keySampler{nullptr};
 };
 
 }  // namespace mongo
@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_key_sampler.h"
+
+#include <algorithm>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Mixes the bits of 'x' (using the finalizer of SplitMix64), so that consecutive inputs produce
+ * unrelated outputs. Used instead of a shared random number generator, so that writes which are not
+ * sampled do not need to synchronize.
+ */
+uint64_t mixBits(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+}  // namespace
+
+const size_t ChunkKeySampler::kMaxSampleSize;
+
+ChunkKeySampler::ChunkKeySampler() : _seed(mixBits(reinterpret_cast<uintptr_t>(this))) {}
+
+void ChunkKeySampler::add(const BSONObj& shardKey, uint64_t bytesInserted) {
+    _bytesInserted.fetchAndAdd(bytesInserted);
+    const uint64_t insertIndex = _numInserts.fetchAndAdd(1);
+
+    // The first inserts fill the sample. After that, each insert replaces a random sampled key
+    // with probability kMaxSampleSize / (insertIndex + 1), which keeps the sample uniform.
+    uint64_t slot = insertIndex;
+    if (insertIndex >= kMaxSampleSize) {
+        slot = mixBits(_seed ^ insertIndex) % (insertIndex + 1);
+        if (slot >= kMaxSampleSize) {
+            return;
+        }
+    }
+
+    BSONObj ownedKey = shardKey.getOwned();
+
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    if (slot < _sample.size()) {
+        _sample[slot] = std::move(ownedKey);
+    } else {
+        _sample.push_back(std::move(ownedKey));
+    }
+}
+
+std::vector<BSONObj> ChunkKeySampler::getSplitPoints(uint64_t desiredPieceBytes,
+                                                     uint64_t maxSplitPoints) const {
+    invariant(desiredPieceBytes > 0);
+
+    const uint64_t numSplitPoints =
+        std::min(getBytesInserted() / desiredPieceBytes, maxSplitPoints);
+    if (numSplitPoints == 0) {
+        return {};
+    }
+
+    std::vector<BSONObj> sortedSample;
+    {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        sortedSample = _sample;
+    }
+
+    std::sort(sortedSample.begin(),
+              sortedSample.end(),
+              SimpleBSONObjComparator::kInstance.makeLessThan());
+
+    // The split points are the quantiles of the sampled keys, which cut the chunk into equal
+    // pieces. Keys, which are too frequent to be split evenly, produce fewer split points.
+    std::vector<BSONObj> splitPoints;
+    for (uint64_t i = 1; i <= numSplitPoints && !sortedSample.empty(); ++i) {
+        const double quantile = static_cast<double>(i) / (numSplitPoints + 1);
+        const size_t index = std::min(static_cast<size_t>(quantile * sortedSample.size()),
+                                      sortedSample.size() - 1);
+
+        const auto& key = sortedSample[index];
+        if (splitPoints.empty() ||
+            SimpleBSONObjComparator::kInstance.evaluate(splitPoints.back() != key)) {
+            splitPoints.push_back(key);
+        }
+    }
+
+    return splitPoints;
+}
+
+}  // namespace mongo
@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Maintains a uniform random sample of bounded size of the shard keys of the documents inserted
+ * into a chunk (using reservoir sampling), along with the total number of bytes inserted. Once the
+ * sampled inserts amount to more than the size of a chunk, they are representative of its
+ * contents, so the sample can be used to place split points without scanning the shard key index.
+ *
+ * Updates are not recorded, since they do not add data to the chunk, and neither are deletes, so
+ * the bytes inserted only bound the chunk size from above. The number of split points therefore
+ * comes from the caller, with the sample only choosing where they go.
+ *
+ * This class is thread-safe. Only the inserts which get picked for the sample take a mutex.
+ */
+class ChunkKeySampler {
+    MONGO_DISALLOW_COPYING(ChunkKeySampler);
+
+public:
+    // Maximum number of keys kept in the sample
+    static const size_t kMaxSampleSize = 256;
+
+    ChunkKeySampler();
+
+    /**
+     * Records the insert of a document with the specified shard key and size.
+     */
+    void add(const BSONObj& shardKey, uint64_t bytesInserted);
+
+    /**
+     * Returns the total number of bytes of all the inserts recorded so far.
+     */
+    uint64_t getBytesInserted() const {
+        return _bytesInserted.load();
+    }
+
+    /**
+     * Returns the split points, which divide the inserted data into pieces of at most
+     * 'desiredPieceBytes', but no more than 'maxSplitPoints' of them, spread evenly over the
+     * sampled keys. They are in ascending order and without duplicates. Returns an empty vector if
+     * less than 'desiredPieceBytes' has been inserted.
+     */
+    std::vector<BSONObj> getSplitPoints(uint64_t desiredPieceBytes, uint64_t maxSplitPoints) const;
+
+private:
+    // Seed for choosing the sample slots, so that different samplers make different choices
+    const uint64_t _seed;
+
+    // Number of inserts and bytes recorded so far
+    AtomicUInt64 _numInserts{0};
+    AtomicUInt64 _bytesInserted{0};
+
+    // Protects the sample below
+    mutable stdx::mutex _mutex;
+
+    // Owned copies of the sampled shard keys, in no particular order
+    std::vector<BSONObj> _sample;
+};
+
+}  // namespace mongo
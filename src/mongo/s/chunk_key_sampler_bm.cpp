@@ -0,0 +1,94 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/chunk_key_sampler.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+namespace {
+
+const uint64_t kDocumentBytes = 1024;
+const uint64_t kMaxChunkSizeBytes = 64 * 1024 * 1024;
+
+/**
+ * Makes a sampler, which recorded the inserts of 'chunkSizeMB' worth of documents with random keys.
+ */
+std::unique_ptr<ChunkKeySampler> makeSampler(uint64_t chunkSizeMB) {
+    auto sampler = stdx::make_unique<ChunkKeySampler>();
+
+    PseudoRandom random(1);
+    const uint64_t numDocuments = chunkSizeMB * 1024 * 1024 / kDocumentBytes;
+    for (uint64_t i = 0; i < numDocuments; ++i) {
+        sampler->add(BSON("a" << random.nextInt64()), kDocumentBytes);
+    }
+
+    return sampler;
+}
+
+/**
+ * Measures the cost of recording an insert, which is paid by every insert on a shard.
+ */
+void BM_add(benchmark::State& state) {
+    ChunkKeySampler sampler;
+
+    PseudoRandom random(1);
+    std::vector<BSONObj> shardKeys;
+    for (int i = 0; i < 1024; ++i) {
+        shardKeys.push_back(BSON("a" << random.nextInt64()));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        sampler.add(shardKeys[i++ % shardKeys.size()], kDocumentBytes);
+    }
+}
+
+/**
+ * Measures choosing the split points of a chunk of the given size in MB, which with splitVector
+ * requires scanning the shard key index over the whole chunk and so grows with its size.
+ */
+void BM_getSplitPoints(benchmark::State& state) {
+    const auto sampler = makeSampler(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sampler->getSplitPoints(
+            kMaxChunkSizeBytes / 2, state.range(0) * 1024 * 1024 / (kMaxChunkSizeBytes / 2)));
+    }
+}
+
+BENCHMARK(BM_add);
+BENCHMARK(BM_getSplitPoints)->Arg(64)->Arg(1024);
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/s/chunk_key_sampler.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(ChunkKeySampler, NoSplitPointsBeforeEnoughDataIsWritten) {
+    ChunkKeySampler sampler;
+    ASSERT(sampler.getSplitPoints(1000, 10).empty());
+
+    for (int i = 0; i < 99; ++i) {
+        sampler.add(BSON("a" << i), 10);
+    }
+
+    ASSERT_EQ(990UL, sampler.getBytesInserted());
+    ASSERT(sampler.getSplitPoints(1000, 10).empty());
+
+    sampler.add(BSON("a" << 99), 10);
+    ASSERT_EQ(1UL, sampler.getSplitPoints(1000, 10).size());
+}
+
+TEST(ChunkKeySampler, SplitPointsFollowKeyDistribution) {
+    ChunkKeySampler sampler;
+
+    const int kNumKeys = 100000;
+    for (int i = 0; i < kNumKeys; ++i) {
+        // Write the keys out of order, so that the sample is not biased by the order of writes
+        sampler.add(BSON("a" << (i * 7919) % kNumKeys), 100);
+    }
+
+    ASSERT_EQ(static_cast<uint64_t>(kNumKeys) * 100, sampler.getBytesInserted());
+
+    // Pieces of a bit more than a quarter of the data inserted need 3 split points
+    const auto splitPoints =
+        sampler.getSplitPoints(static_cast<uint64_t>(kNumKeys) * 100 / 4 + 1, 10);
+    ASSERT_EQ(3UL, splitPoints.size());
+
+    for (size_t i = 0; i < splitPoints.size(); ++i) {
+        const int expected = static_cast<int>((i + 1) * kNumKeys / 4);
+        const int actual = splitPoints[i]["a"].numberInt();
+        ASSERT_LT(std::abs(actual - expected), kNumKeys / 10) << "split point " << actual;
+
+        if (i > 0) {
+            ASSERT_LT(splitPoints[i - 1]["a"].numberInt(), actual);
+        }
+    }
+}
+
+TEST(ChunkKeySampler, FrequentKeyProducesSingleSplitPoint) {
+    ChunkKeySampler sampler;
+
+    for (int i = 0; i < 10000; ++i) {
+        sampler.add(BSON("a" << 5), 100);
+    }
+
+    const auto splitPoints = sampler.getSplitPoints(10000, 100);
+    ASSERT_EQ(1UL, splitPoints.size());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 5), splitPoints.front());
+}
+
+TEST(ChunkKeySampler, SplitPointsAreCappedAndSpreadEvenly) {
+    ChunkKeySampler sampler;
+
+    const int kNumKeys = 100000;
+    for (int i = 0; i < kNumKeys; ++i) {
+        sampler.add(BSON("a" << (i * 7919) % kNumKeys), 100);
+    }
+
+    // The inserts alone would call for 9 split points, but the chunk only holds enough data for
+    // one, which then goes in the middle rather than after the first tenth
+    const auto splitPoints = sampler.getSplitPoints(static_cast<uint64_t>(kNumKeys) * 100 / 10, 1);
+    ASSERT_EQ(1UL, splitPoints.size());
+    ASSERT_LT(std::abs(splitPoints.front()["a"].numberInt() - kNumKeys / 2), kNumKeys / 10);
+}
+
+}  // namespace
+}  // namespace mongo
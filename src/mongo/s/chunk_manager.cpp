@@ -66,6 +66,20 @@ std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering orde
     return {ks.getBuffer(), ks.getSize()};
 }
 
+/**
+ * Returns the first entry in "chunkMap" whose max KeyString sorts after "keyString", which is the
+ * chunk containing the key "keyString" was built from.
+ */
+ChunkMap::const_iterator chunkMapUpperBound(const ChunkMap& chunkMap,
+                                            const std::string& keyString) {
+    return std::upper_bound(chunkMap.cbegin(),
+                            chunkMap.cend(),
+                            keyString,
+                            [](const std::string& ks, const ChunkMap::value_type& entry) {
+                                return ks < entry.first;
+                            });
+}
+
 }  // namespace
 
 ChunkManager::ChunkManager(NamespaceString nss,
@@ -100,7 +114,7 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardK
         }
     }
 
-    const auto it = _chunkMap.upper_bound(_extractKeyString(shardKey));
+    const auto it = _chunkMapUpperBound(shardKey);
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
             it != _chunkMap.end() && it->second->containsKey(shardKey));
@@ -214,8 +228,7 @@ bool ChunkManager::rangeOverlapsShard(const ChunkRange& range, const ShardId& sh
 
 ChunkManager::ConstRangeOfChunks ChunkManager::getNextChunkOnShard(const BSONObj& shardKey,
                                                                    const ShardId& shardId) const {
-    for (auto it = _chunkMap.upper_bound(_extractKeyString(shardKey)); it != _chunkMap.end();
-         ++it) {
+    for (auto it = _chunkMapUpperBound(shardKey); it != _chunkMap.end(); ++it) {
         const auto& chunk = it->second;
         if (chunk->getShardId() == shardId) {
             const auto begin = it;
@@ -482,6 +495,10 @@ std::string ChunkManager::_extractKeyString(const BSONObj& shardKeyValue) const
     return extractKeyStringInternal(shardKeyValue, _shardKeyOrdering);
 }
 
+ChunkMap::const_iterator ChunkManager::_chunkMapUpperBound(const BSONObj& key) const {
+    return chunkMapUpperBound(_chunkMap, _extractKeyString(key));
+}
+
 ChunkManager::ChunkRangeMap::const_iterator ChunkManager::_rangeMapUpperBound(
     const BSONObj& key) const {
 
@@ -554,7 +571,13 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
-    auto chunkMap = _chunkMap;
+
+    // The changed chunks which survive being overlapped by changes that come after them, keyed by
+    // the KeyString of their max
+    std::map<std::string, std::shared_ptr<Chunk>> updatedChunks;
+
+    // Ranges of positions in the existing chunk map, which are overlapped by some changed chunk
+    std::vector<std::pair<size_t, size_t>> overlappedRanges;
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -573,19 +596,19 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         const auto chunkMinKeyString = _extractKeyString(chunk.getMin());
         const auto chunkMaxKeyString = _extractKeyString(chunk.getMax());
 
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunkMinKeyString);
+        // The first chunk with a max key that is > min implies that the chunk overlaps min and the
+        // first chunk with a max key that is > max implies that the next chunk cannot overlap max.
+        // All chunks in between overlap the chunk we got from the persistent store and are erased,
+        // both from the existing chunk map and from the changes applied so far.
+        overlappedRanges.emplace_back(
+            chunkMapUpperBound(_chunkMap, chunkMinKeyString) - _chunkMap.cbegin(),
+            chunkMapUpperBound(_chunkMap, chunkMaxKeyString) - _chunkMap.cbegin());
 
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunkMaxKeyString);
-
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
+        updatedChunks.erase(updatedChunks.upper_bound(chunkMinKeyString),
+                            updatedChunks.upper_bound(chunkMaxKeyString));
 
         // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunkMaxKeyString, std::make_shared<Chunk>(chunk)));
+        updatedChunks.emplace(chunkMaxKeyString, std::make_shared<Chunk>(chunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -599,6 +622,34 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         return shared_from_this();
     }
 
+    std::vector<bool> isOverlapped(_chunkMap.size(), false);
+    for (const auto& range : overlappedRanges) {
+        std::fill(isOverlapped.begin() + range.first, isOverlapped.begin() + range.second, true);
+    }
+
+    // Merge the chunks which were not overlapped with the changed chunks in a single pass. The
+    // existing chunks are shared with this chunk manager, which is left unmodified.
+    ChunkMap chunkMap;
+    chunkMap.reserve(_chunkMap.size() + updatedChunks.size());
+
+    auto updatedIt = updatedChunks.begin();
+    for (size_t i = 0; i < _chunkMap.size(); ++i) {
+        if (isOverlapped[i])
+            continue;
+
+        const auto& existingEntry = _chunkMap[i];
+        for (; updatedIt != updatedChunks.end() && updatedIt->first < existingEntry.first;
+             ++updatedIt) {
+            chunkMap.emplace_back(updatedIt->first, std::move(updatedIt->second));
+        }
+
+        chunkMap.push_back(existingEntry);
+    }
+
+    for (; updatedIt != updatedChunks.end(); ++updatedIt) {
+        chunkMap.emplace_back(updatedIt->first, std::move(updatedIt->second));
+    }
+
     return std::shared_ptr<ChunkManager>(
         new ChunkManager(_nss,
                          _uuid,
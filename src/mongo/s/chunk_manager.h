@@ -48,8 +48,10 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkMap = std::map<std::string, std::shared_ptr<Chunk>>;
+// Contiguous array of entries describing each chunk, sorted by the KeyString encoding of the chunk's
+// max, which is also stored in the entry. Lookups are binary searches over the array and updates
+// build a new array, so an instance is never modified once it is published in a ChunkManager.
+using ChunkMap = std::vector<std::pair<std::string, std::shared_ptr<Chunk>>>;
 
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
@@ -79,7 +81,7 @@ public:
         bool operator!=(const ConstChunkIterator& other) const {
             return !(*this == other);
         }
-        const ChunkMap::mapped_type& operator*() const {
+        const ChunkMap::value_type::second_type& operator*() const {
             return _iter->second;
         }
 
@@ -312,6 +314,8 @@ private:
 
     std::string _extractKeyString(const BSONObj& shardKeyValue) const;
 
+    ChunkMap::const_iterator _chunkMapUpperBound(const BSONObj& key) const;
+
     ChunkRangeMap::const_iterator _rangeMapUpperBound(const BSONObj& key) const;
 
     std::pair<ChunkRangeMap::const_iterator, ChunkRangeMap::const_iterator> _overlappingRanges(
@@ -487,5 +487,72 @@ TEST_F(ChunkManagerQueryTest, SimpleCollationNumbersMultiShard) {
         {ShardId("0")});
 }
 
+TEST_F(ChunkManagerQueryTest, MakeUpdatedMergesChangedChunksWithExistingOnes) {
+    const OID epoch = OID::gen();
+    const KeyPattern shardKeyPattern(BSON("a" << 1));
+
+    ChunkVersion version(1, 0, epoch);
+    std::vector<ChunkType> chunks;
+    chunks.emplace_back(kNss,
+                        ChunkRange{shardKeyPattern.globalMin(), BSON("a" << 10)},
+                        version,
+                        ShardId("0"));
+    version.incMinor();
+    chunks.emplace_back(kNss, ChunkRange{BSON("a" << 10), BSON("a" << 20)}, version, ShardId("0"));
+    version.incMinor();
+    chunks.emplace_back(kNss,
+                        ChunkRange{BSON("a" << 20), shardKeyPattern.globalMax()},
+                        version,
+                        ShardId("0"));
+
+    auto chunkManager =
+        ChunkManager::makeNew(kNss, boost::none, shardKeyPattern, nullptr, false, epoch, chunks);
+    ASSERT_EQ(3, chunkManager->numChunks());
+
+    // Split the middle chunk, then move its upper half and finally merge the upper half back with
+    // the chunk after it
+    std::vector<ChunkType> changedChunks;
+    version.incMajor();
+    changedChunks.emplace_back(
+        kNss, ChunkRange{BSON("a" << 10), BSON("a" << 15)}, version, ShardId("0"));
+    version.incMinor();
+    changedChunks.emplace_back(
+        kNss, ChunkRange{BSON("a" << 15), BSON("a" << 20)}, version, ShardId("0"));
+    version.incMajor();
+    changedChunks.emplace_back(
+        kNss, ChunkRange{BSON("a" << 15), BSON("a" << 20)}, version, ShardId("1"));
+    version.incMinor();
+    changedChunks.emplace_back(kNss,
+                               ChunkRange{BSON("a" << 15), shardKeyPattern.globalMax()},
+                               version,
+                               ShardId("1"));
+
+    auto updatedChunkManager = chunkManager->makeUpdated(changedChunks);
+    ASSERT_EQ(version, updatedChunkManager->getVersion());
+    ASSERT_EQ(3, updatedChunkManager->numChunks());
+
+    std::vector<std::shared_ptr<Chunk>> updatedChunks;
+    for (const auto& chunk : updatedChunkManager->chunks()) {
+        updatedChunks.push_back(chunk);
+    }
+
+    ASSERT_BSONOBJ_EQ(BSON("a" << 10), updatedChunks[0]->getMax());
+    ASSERT_EQ(ShardId("0"), updatedChunks[0]->getShardId());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 15), updatedChunks[1]->getMax());
+    ASSERT_EQ(ShardId("0"), updatedChunks[1]->getShardId());
+    ASSERT_BSONOBJ_EQ(shardKeyPattern.globalMax(), updatedChunks[2]->getMax());
+    ASSERT_EQ(ShardId("1"), updatedChunks[2]->getShardId());
+
+    ASSERT_EQ(ShardId("1"),
+              updatedChunkManager->findIntersectingChunkWithSimpleCollation(BSON("a" << 17))
+                  ->getShardId());
+
+    // The original routing table is left untouched
+    ASSERT_EQ(3, chunkManager->numChunks());
+    ASSERT_EQ(ShardId("0"),
+              chunkManager->findIntersectingChunkWithSimpleCollation(BSON("a" << 17))
+                  ->getShardId());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/chunk_manager.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test", "foo");
+const int kNumShards = 4;
+const int kChunkWidth = 10;
+
+ShardId shardIdForChunk(int chunkIndex) {
+    return ShardId(str::stream() << "shard" << (chunkIndex % kNumShards));
+}
+
+/**
+ * Makes the chunks for a collection sharded on {a: 1}, where chunk 'i' covers the values
+ * [i * kChunkWidth, (i + 1) * kChunkWidth) and the chunks are distributed round-robin across the
+ * shards.
+ */
+std::vector<ChunkType> makeChunks(int numChunks, const OID& epoch) {
+    const KeyPattern shardKeyPattern(BSON("a" << 1));
+
+    std::vector<ChunkType> chunks;
+    chunks.reserve(numChunks);
+
+    ChunkVersion version(1, 0, epoch);
+    for (int i = 0; i < numChunks; ++i) {
+        const auto min = (i == 0) ? shardKeyPattern.globalMin() : BSON("a" << i * kChunkWidth);
+        const auto max = (i == numChunks - 1) ? shardKeyPattern.globalMax()
+                                              : BSON("a" << (i + 1) * kChunkWidth);
+        chunks.emplace_back(kNss, ChunkRange{min, max}, version, shardIdForChunk(i));
+        version.incMinor();
+    }
+
+    return chunks;
+}
+
+std::shared_ptr<ChunkManager> makeChunkManager(int numChunks) {
+    const OID epoch = OID::gen();
+    return ChunkManager::makeNew(kNss,
+                                 boost::none,
+                                 KeyPattern(BSON("a" << 1)),
+                                 nullptr,
+                                 false,
+                                 epoch,
+                                 makeChunks(numChunks, epoch));
+}
+
+/**
+ * Measures targeting a single document, which is what every routed write does.
+ */
+void BM_findIntersectingChunk(benchmark::State& state) {
+    const int numChunks = state.range(0);
+    const auto chunkManager = makeChunkManager(numChunks);
+
+    PseudoRandom random(1);
+    std::vector<BSONObj> shardKeys;
+    for (int i = 0; i < 1024; ++i) {
+        shardKeys.push_back(BSON("a" << random.nextInt32(numChunks * kChunkWidth)));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(chunkManager->findIntersectingChunkWithSimpleCollation(
+            shardKeys[i++ % shardKeys.size()]));
+    }
+}
+
+/**
+ * Measures targeting a range of keys, which spans a handful of chunks.
+ */
+void BM_getShardIdsForRange(benchmark::State& state) {
+    const int numChunks = state.range(0);
+    const auto chunkManager = makeChunkManager(numChunks);
+
+    PseudoRandom random(1);
+    std::vector<std::pair<BSONObj, BSONObj>> ranges;
+    for (int i = 0; i < 1024; ++i) {
+        const int min = random.nextInt32(numChunks * kChunkWidth);
+        ranges.emplace_back(BSON("a" << min), BSON("a" << min + 3 * kChunkWidth));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& range = ranges[i++ % ranges.size()];
+        std::set<ShardId> shardIds;
+        chunkManager->getShardIdsForRange(range.first, range.second, &shardIds);
+        benchmark::DoNotOptimize(shardIds);
+    }
+}
+
+/**
+ * Measures building the routing table from scratch, as happens on the first refresh of a
+ * collection or after its epoch changes.
+ */
+void BM_makeNew(benchmark::State& state) {
+    const int numChunks = state.range(0);
+    const OID epoch = OID::gen();
+    const auto chunks = makeChunks(numChunks, epoch);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ChunkManager::makeNew(
+            kNss, boost::none, KeyPattern(BSON("a" << 1)), nullptr, false, epoch, chunks));
+    }
+}
+
+/**
+ * Measures an incremental refresh, which applies the split of a chunk in the middle of the key
+ * space.
+ */
+void BM_makeUpdated(benchmark::State& state) {
+    const int numChunks = state.range(0);
+    const auto chunkManager = makeChunkManager(numChunks);
+
+    const int splitChunk = numChunks / 2;
+    const int splitChunkMin = splitChunk * kChunkWidth;
+    const auto shardId = shardIdForChunk(splitChunk);
+
+    ChunkVersion version = chunkManager->getVersion();
+    version.incMajor();
+
+    std::vector<ChunkType> changedChunks;
+    changedChunks.emplace_back(
+        kNss,
+        ChunkRange{BSON("a" << splitChunkMin), BSON("a" << splitChunkMin + kChunkWidth / 2)},
+        version,
+        shardId);
+    version.incMinor();
+    changedChunks.emplace_back(kNss,
+                               ChunkRange{BSON("a" << splitChunkMin + kChunkWidth / 2),
+                                          BSON("a" << splitChunkMin + kChunkWidth)},
+                               version,
+                               shardId);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(chunkManager->makeUpdated(changedChunks));
+    }
+}
+
+BENCHMARK(BM_findIntersectingChunk)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(500000);
+BENCHMARK(BM_getShardIdsForRange)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(500000);
+BENCHMARK(BM_makeNew)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(500000);
+BENCHMARK(BM_makeUpdated)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(500000);
+
+}  // namespace
+}  // namespace mongo
@@ -48,6 +48,7 @@
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find_common.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/views/resolved_view.h"
 #include "mongo/db/views/view.h"
 #include "mongo/executor/task_executor_pool.h"
@@ -57,6 +58,7 @@
 #include "mongo/s/commands/cluster_commands_helpers.h"
 #include "mongo/s/commands/pipeline_s.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/cluster_aggregation_results_cache.h"
 #include "mongo/s/query/cluster_client_cursor_impl.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
@@ -199,10 +201,21 @@ std::set<ShardId> getTargetedShards(OperationContext* opCtx,
     return {routingInfo.primaryId()};
 }
 
+/**
+ * Returns true if the merging half of a split pipeline runs on mongos.
+ */
+bool mergesOnMongos(const Pipeline& pipelineForMerging) {
+    // If the merge pipeline MUST run on mongoS, then ignore the
+    // internalQueryProhibitMergingOnMongoS parameter.
+    return pipelineForMerging.requiredToRunOnMongos() ||
+        (!internalQueryProhibitMergingOnMongoS.load() && pipelineForMerging.canRunOnMongos());
+}
+
 BSONObj createCommandForTargetedShards(
     const AggregationRequest& request,
     const BSONObj originalCmdObj,
-    const std::unique_ptr<Pipeline, PipelineDeleter>& pipelineForTargetedShards) {
+    const std::unique_ptr<Pipeline, PipelineDeleter>& pipelineForTargetedShards,
+    bool cacheResults) {
     // Create the command for the shards.
     MutableDocument targetedCmd(request.serializeToCommandObj());
     targetedCmd[AggregationRequest::kFromMongosName] = Value(true);
@@ -214,8 +227,12 @@ BSONObj createCommandForTargetedShards(
 
         if (pipelineForTargetedShards->isSplitForShards()) {
             targetedCmd[AggregationRequest::kNeedsMergeName] = Value(true);
+
+            // Only results, which the shards return entirely in the first batch, can be cached
+            const long long batchSize =
+                cacheResults ? ClusterAggregationResultsCache::kMaxDocumentsPerShard : 0;
             targetedCmd[AggregationRequest::kCursorName] =
-                Value(DOC(AggregationRequest::kBatchSizeName << 0));
+                Value(DOC(AggregationRequest::kBatchSizeName << batchSize));
         }
     }
 
@@ -265,13 +282,20 @@ std::vector<ClusterClientCursorParams::RemoteCursor> establishShardCursors(
     const BSONObj& cmdObj,
     const ReadPreferenceSetting& readPref,
     const BSONObj& shardQuery,
-    const BSONObj& collation) {
+    const BSONObj& collation,
+    bool cacheResults) {
     LOG(1) << "Dispatching command " << redact(cmdObj) << " to establish cursors on shards";
 
     std::set<ShardId> shardIds =
         getTargetedShards(opCtx, nss, litePipe, *routingInfo, shardQuery, collation);
     std::vector<std::pair<ShardId, BSONObj>> requests;
 
+    auto const resultsCache = ClusterAggregationResultsCache::get(opCtx);
+    const Date_t now = opCtx->getServiceContext()->getFastClockSource()->now();
+
+    // The shards whose results are cached are not sent the command
+    std::vector<ClusterClientCursorParams::RemoteCursor> cachedCursors;
+
     if (mustRunOnAllShards(nss, *routingInfo, litePipe)) {
         // The pipeline contains a stage which must be run on all shards. Skip versioning and
         // enqueue the raw command objects.
@@ -282,8 +306,20 @@ std::vector<ClusterClientCursorParams::RemoteCursor> establishShardCursors(
         // The collection is sharded. Use the routing table to decide which shards to target
         // based on the query and collation, and build versioned requests for them.
         for (auto& shardId : shardIds) {
-            auto versionedCmdObj =
-                appendShardVersion(cmdObj, routingInfo->cm()->getVersion(shardId));
+            const auto shardVersion = routingInfo->cm()->getVersion(shardId);
+
+            if (cacheResults) {
+                if (auto cachedResults =
+                        resultsCache->lookup(nss, cmdObj, shardId, shardVersion, now)) {
+                    cachedCursors.emplace_back(
+                        shardId,
+                        cachedResults->hostAndPort,
+                        CursorResponse(nss, CursorId(0), cachedResults->documents));
+                    continue;
+                }
+            }
+
+            auto versionedCmdObj = appendShardVersion(cmdObj, shardVersion);
             requests.emplace_back(std::move(shardId), std::move(versionedCmdObj));
         }
     } else {
@@ -309,13 +345,34 @@ std::vector<ClusterClientCursorParams::RemoteCursor> establishShardCursors(
     // attempting to continue in the event that a recreated namespace is a view, we do not handle
     // ErrorCodes::CommandOnShardedViewNotSupportedOnMongod here.
     try {
-        return establishCursors(opCtx,
-                                Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
-                                nss,
-                                readPref,
-                                requests,
-                                false /* do not allow partial results */);
+        auto cursors = requests.empty()
+            ? std::vector<ClusterClientCursorParams::RemoteCursor>()
+            : establishCursors(opCtx,
+                               Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                               nss,
+                               readPref,
+                               requests,
+                               false /* do not allow partial results */);
+
+        if (cacheResults) {
+            for (const auto& cursor : cursors) {
+                if (cursor.cursorResponse.getCursorId() != 0) {
+                    continue;
+                }
+
+                resultsCache->insert(nss,
+                                     cmdObj,
+                                     cursor.shardId,
+                                     routingInfo->cm()->getVersion(cursor.shardId),
+                                     cursor.hostAndPort,
+                                     cursor.cursorResponse.getBatch(),
+                                     now);
+            }
+
+            std::move(cachedCursors.begin(), cachedCursors.end(), std::back_inserter(cursors));
+        }
 
+        return cursors;
     } catch (const ExceptionForCat<ErrorCategory::StaleShardingError>&) {
         // If any shard returned a stale shardVersion error, invalidate the routing table cache.
         // This will cause the cache to be refreshed the next time it is accessed.
@@ -424,9 +481,20 @@ DispatchShardPipelineResults dispatchShardPipeline(
             pipelineForTargetedShards->unsplitFromSharded(std::move(pipelineForMerging));
         }
 
+        // The results of the shards part of the pipeline can be cached if they are merged on
+        // mongos and the aggregation does not need to observe any particular point in time
+        const bool cacheResults = ClusterAggregationResultsCache::isEnabled() &&
+            !expCtx->explain && expCtx->tailableMode == TailableMode::kNormal &&
+            executionNsRoutingInfo.cm() &&
+            !mustRunOnAllShards(executionNss, executionNsRoutingInfo, liteParsedPipeline) &&
+            pipelineForTargetedShards->isSplitForShards() && mergesOnMongos(*pipelineForMerging) &&
+            !opCtx->getTxnNumber() &&
+            !repl::ReadConcernArgs::get(opCtx).getArgsAfterClusterTime() &&
+            !repl::ReadConcernArgs::get(opCtx).getArgsAtClusterTime();
+
         // Generate the command object for the targeted shards.
-        targetedCommand =
-            createCommandForTargetedShards(aggRequest, originalCmdObj, pipelineForTargetedShards);
+        targetedCommand = createCommandForTargetedShards(
+            aggRequest, originalCmdObj, pipelineForTargetedShards, cacheResults);
 
         // Refresh the shard registry if we're targeting all shards.  We need the shard registry
         // to be at least as current as the logical time used when creating the command for
@@ -471,7 +539,8 @@ DispatchShardPipelineResults dispatchShardPipeline(
                                                 targetedCommand,
                                                 ReadPreferenceSetting::get(opCtx),
                                                 shardQuery,
-                                                aggRequest.getCollation());
+                                                aggRequest.getCollation(),
+                                                cacheResults);
             }
         } catch (const ExceptionForCat<ErrorCategory::StaleShardingError>& ex) {
             LOG(1) << "got stale shardVersion error " << redact(ex) << " while dispatching "
@@ -805,10 +874,8 @@ Status ClusterAggregate::runAggregate(OperationContext* opCtx,
     auto mergingPipeline = std::move(dispatchResults.pipelineForMerging);
     invariant(mergingPipeline);
 
-    // First, check whether we can merge on the mongoS. If the merge pipeline MUST run on mongoS,
-    // then ignore the internalQueryProhibitMergingOnMongoS parameter.
-    if (mergingPipeline->requiredToRunOnMongos() ||
-        (!internalQueryProhibitMergingOnMongoS.load() && mergingPipeline->canRunOnMongos())) {
+    // First, check whether we can merge on the mongoS.
+    if (mergesOnMongos(*mergingPipeline)) {
         // Register the new mongoS cursor, and retrieve the initial batch of results.
         auto cursorResponse =
             establishMergingMongosCursor(opCtx,
@@ -887,7 +954,7 @@ Status ClusterAggregate::aggPassthrough(OperationContext* opCtx,
     // Format the command for the shard. This adds the 'fromMongos' field, wraps the command as an
     // explain if necessary, and rewrites the result into a format safe to forward to shards.
     cmdObj = CommandHelpers::filterCommandRequestForPassthrough(
-        createCommandForTargetedShards(aggRequest, cmdObj, nullptr));
+        createCommandForTargetedShards(aggRequest, cmdObj, nullptr, false));
 
     auto cmdResponse = uassertStatusOK(shard->runCommandWithFixedRetryAttempts(
         opCtx,
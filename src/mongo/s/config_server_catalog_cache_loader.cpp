@@ -30,6 +30,8 @@
 
 #include "mongo/s/config_server_catalog_cache_loader.h"
 
+#include <algorithm>
+
 #include "mongo/db/client.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
@@ -85,41 +87,26 @@ QueryAndSort createConfigDiffQuery(const NamespaceString& nss, ChunkVersion coll
 }
 
 /**
- * Blocking method, which returns the chunks which changed since the specified version.
+ * Blocking method, which returns the chunks of the collection, which changed since the specified
+ * version, sorted by ascending version.
  */
-CollectionAndChangedChunks getChangedChunks(OperationContext* opCtx,
-                                            const NamespaceString& nss,
-                                            ChunkVersion sinceVersion) {
-    const auto catalogClient = Grid::get(opCtx)->catalogClient();
-
-    // Decide whether to do a full or partial load based on the state of the collection
-    const auto coll = uassertStatusOK(catalogClient->getCollection(opCtx, nss)).value;
-    uassert(ErrorCodes::NamespaceNotFound,
-            str::stream() << "Collection " << nss.ns() << " is dropped.",
-            !coll.getDropped());
-
-    // If the collection's epoch has changed, do a full refresh
-    const ChunkVersion startingCollectionVersion = (sinceVersion.epoch() == coll.getEpoch())
-        ? sinceVersion
-        : ChunkVersion(0, 0, coll.getEpoch());
-
-    // Diff tracker should *always* find at least one chunk if collection exists
-    const auto diffQuery = createConfigDiffQuery(nss, startingCollectionVersion);
+std::vector<ChunkType> getChangedChunksSince(OperationContext* opCtx,
+                                             const NamespaceString& nss,
+                                             ChunkVersion sinceVersion) {
+    const auto diffQuery = createConfigDiffQuery(nss, sinceVersion);
 
-    // Query the chunks which have changed
     repl::OpTime opTime;
-    const std::vector<ChunkType> changedChunks = uassertStatusOK(
+    return uassertStatusOK(
         Grid::get(opCtx)->catalogClient()->getChunks(opCtx,
                                                      diffQuery.query,
                                                      diffQuery.sort,
                                                      boost::none,
                                                      &opTime,
                                                      repl::ReadConcernLevel::kMajorityReadConcern));
+}
 
-    uassert(ErrorCodes::ConflictingOperationInProgress,
-            "No chunks were found for the collection",
-            !changedChunks.empty());
-
+CollectionAndChangedChunks makeCollectionAndChangedChunks(const CollectionType& coll,
+                                                          std::vector<ChunkType> changedChunks) {
     return CollectionAndChangedChunks(coll.getUUID(),
                                       coll.getEpoch(),
                                       coll.getKeyPattern().toBSON(),
@@ -168,12 +155,12 @@ std::shared_ptr<Notification<void>> ConfigServerCatalogCacheLoader::getChunksSin
 
     auto notify = std::make_shared<Notification<void>>();
 
-    uassertStatusOK(_threadPool.schedule([ nss, version, notify, callbackFn ]() noexcept {
+    uassertStatusOK(_threadPool.schedule([ this, nss, version, notify, callbackFn ]() noexcept {
         auto opCtx = Client::getCurrent()->makeOperationContext();
 
         auto swCollAndChunks = [&]() -> StatusWith<CollectionAndChangedChunks> {
             try {
-                return getChangedChunks(opCtx.get(), nss, version);
+                return _getChangedChunks(opCtx.get(), nss, version);
             } catch (const DBException& ex) {
                 return ex.toStatus();
             }
@@ -186,4 +173,66 @@ std::shared_ptr<Notification<void>> ConfigServerCatalogCacheLoader::getChunksSin
     return notify;
 }
 
+CollectionAndChangedChunks ConfigServerCatalogCacheLoader::_getChangedChunks(
+    OperationContext* opCtx, const NamespaceString& nss, ChunkVersion sinceVersion) {
+    // Incremental refreshes of a collection epoch whose entry has already been read only need the
+    // changed chunks, because the rest of the collection entry cannot change without the epoch
+    // changing as well
+    const auto knownColl = [&]() -> boost::optional<CollectionType> {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        auto it = _collectionEntries.find(nss);
+        if (it == _collectionEntries.end() || !sinceVersion.isSet() ||
+            it->second.getEpoch() != sinceVersion.epoch()) {
+            return boost::none;
+        }
+        return it->second;
+    }();
+
+    if (knownColl) {
+        auto changedChunks = getChangedChunksSince(opCtx, nss, sinceVersion);
+
+        // If no chunks were found or some of them belong to a different epoch, the collection has
+        // been dropped or recreated, so the collection entry needs to be read again
+        const bool epochMatches = std::all_of(
+            changedChunks.begin(), changedChunks.end(), [&](const ChunkType& chunk) {
+                return chunk.getVersion().epoch() == sinceVersion.epoch();
+            });
+        if (!changedChunks.empty() && epochMatches) {
+            return makeCollectionAndChangedChunks(*knownColl, std::move(changedChunks));
+        }
+    }
+
+    const auto catalogClient = Grid::get(opCtx)->catalogClient();
+
+    // Decide whether to do a full or partial load based on the state of the collection
+    const auto coll = uassertStatusOK(catalogClient->getCollection(opCtx, nss)).value;
+
+    {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        if (coll.getDropped() || !coll.getUUID()) {
+            _collectionEntries.erase(nss);
+        } else {
+            _collectionEntries[nss] = coll;
+        }
+    }
+
+    uassert(ErrorCodes::NamespaceNotFound,
+            str::stream() << "Collection " << nss.ns() << " is dropped.",
+            !coll.getDropped());
+
+    // If the collection's epoch has changed, do a full refresh
+    const ChunkVersion startingCollectionVersion = (sinceVersion.epoch() == coll.getEpoch())
+        ? sinceVersion
+        : ChunkVersion(0, 0, coll.getEpoch());
+
+    // Diff tracker should *always* find at least one chunk if collection exists
+    auto changedChunks = getChangedChunksSince(opCtx, nss, startingCollectionVersion);
+
+    uassert(ErrorCodes::ConflictingOperationInProgress,
+            "No chunks were found for the collection",
+            !changedChunks.empty());
+
+    return makeCollectionAndChangedChunks(coll, std::move(changedChunks));
+}
+
 }  // namespace mongo
@@ -28,7 +28,10 @@
 
 #pragma once
 
+#include <map>
+
 #include "mongo/s/catalog_cache_loader.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
@@ -54,8 +57,26 @@ public:
         override;
 
 private:
+    /**
+     * Blocking method, which returns the chunks which changed since the specified version.
+     *
+     * If the collection entry for the epoch of 'sinceVersion' has been read by a previous call,
+     * only queries the chunks. Otherwise, or if the chunks show that the collection has been
+     * dropped or recreated since, reads the collection entry first.
+     */
+    CollectionAndChangedChunks _getChangedChunks(OperationContext* opCtx,
+                                                 const NamespaceString& nss,
+                                                 ChunkVersion sinceVersion);
+
     // Thread pool to be used to perform metadata load
     ThreadPool _threadPool;
+
+    // Protects the state below
+    stdx::mutex _mutex;
+
+    // The last collection entry read for each namespace. Only entries which have a UUID are kept,
+    // so that entries written before the UUID was assigned on upgrade are read again.
+    std::map<NamespaceString, CollectionType> _collectionEntries;
 };
 
 }  // namespace mongo
@@ -38,6 +38,8 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/util/assert_util.h"
@@ -48,11 +50,17 @@ namespace mongo {
 constexpr StringData AsyncResultsMerger::kSortKeyField;
 const BSONObj AsyncResultsMerger::kWholeSortKeySortPattern = BSON(kSortKeyField << 1);
 
+MONGO_EXPORT_SERVER_PARAMETER(asyncResultsMergerMaxReadAheadBatches, int, 3);
+MONGO_EXPORT_SERVER_PARAMETER(asyncResultsMergerReadAheadBufferBytes, int, 16 * 1024 * 1024);
+
 namespace {
 
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// The largest multiple of the requested batchSize that a getMore asks for as the cursor ages.
+const long long kMaxBatchSizeGrowthFactor = 16;
+
 /**
  * Returns the sort key out of the $sortKey metadata field in 'obj'. This object is of the form
  * {'': 'firstSortKey', '': 'secondSortKey', ...}.
@@ -78,6 +86,35 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+// An Ordering, and so a KeyString, can describe at most this many fields of a sort pattern.
+const int kMaxSortKeyOrderingFields = 32;
+
+/**
+ * Returns the Ordering to encode sort keys as KeyStrings with, or boost::none if the sort pattern
+ * has too many fields to encode them.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const BSONObj& sortKeyPattern) {
+    if (sortKeyPattern.nFields() > kMaxSortKeyOrderingFields) {
+        return boost::none;
+    }
+    return Ordering::make(sortKeyPattern);
+}
+
+/**
+ * Returns the comparator for the keys of the merge tree. KeyStrings compare as binary, while sort
+ * keys which can't be encoded as KeyStrings are kept as BSON and compared with compareSortKeys().
+ */
+LoserTree::Comparator makeMergeTreeComparator(const boost::optional<Ordering>& sortKeyOrdering,
+                                              BSONObj sortKeyPattern) {
+    if (sortKeyOrdering) {
+        return LoserTree::Comparator();
+    }
+
+    return [sortKeyPattern](const std::string& lhs, const std::string& rhs) {
+        return compareSortKeys(BSONObj(lhs.data()), BSONObj(rhs.data()), sortKeyPattern);
+    };
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -86,7 +123,9 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
     : _opCtx(opCtx),
       _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort, _params->compareWholeSortKey)) {
+      _sortKeyOrdering(makeSortKeyOrdering(_params->sort)),
+      _mergeTree(_params->remotes.size(),
+                 makeMergeTreeComparator(_sortKeyOrdering, _params->sort)) {
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort,
@@ -169,6 +208,7 @@ void AsyncResultsMerger::addNewShardCursors(
                               remote.cursorResponse.getNSS(),
                               remote.cursorResponse.getCursorId());
     }
+    _mergeTree.addLeaves(newCursors.size());
 }
 
 bool AsyncResultsMerger::_ready(WithLock lk) {
@@ -211,11 +251,11 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock) {
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
+    auto smallestRemote = _mergeTree.top();
     auto smallestResult = _remotes[smallestRemote].docBuffer.front();
     auto keyWeWantToReturn =
         extractSortKey(*smallestResult.getResult(), _params->compareWholeSortKey);
@@ -268,41 +308,36 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return hasSort ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_params->tailableMode != TailableMode::kTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
 
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _popFromBuffer(lk, smallestRemote);
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
-    }
+    // Re-populate the merge tree with the next result from 'smallestRemote', if it has a next
+    // result.
+    _updateMergeTree(lk, smallestRemote);
 
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popFromBuffer(lk, _gettingFromRemote);
 
             if (_params->tailableMode == TailableMode::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -325,6 +360,60 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
+ClusterQueryResult AsyncResultsMerger::_popFromBuffer(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+    ++remote.consumedSinceLastResponse;
+
+    if (front.getResult()) {
+        remote.bufferedBytes -= front.getResult()->objsize();
+        _bufferedBytes -= front.getResult()->objsize();
+    }
+
+    if (_shouldReadAhead(lk, remoteIndex)) {
+        remote.status = _askForNextBatch(lk, remoteIndex);
+    }
+
+    return front;
+}
+
+bool AsyncResultsMerger::_shouldReadAhead(WithLock, size_t remoteIndex) const {
+    const auto& remote = _remotes[remoteIndex];
+
+    // Batches from tailable cursors are passed through to the client as they are received.
+    if (_params->tailableMode != TailableMode::kNormal || _lifecycleState != kAlive) {
+        return false;
+    }
+
+    if (!remote.hasNext() || remote.exhausted() || remote.cbHandle.isValid() ||
+        !remote.status.isOK()) {
+        return false;
+    }
+
+    const long long maxReadAheadBatches = asyncResultsMergerMaxReadAheadBatches.load();
+    if (maxReadAheadBatches <= 1 ||
+        _bufferedBytes >= asyncResultsMergerReadAheadBufferBytes.load()) {
+        return false;
+    }
+
+    const auto sinceLastResponse =
+        durationCount<Microseconds>(_executor->now() - remote.lastResponseAt);
+    if (sinceLastResponse <= 0) {
+        return false;
+    }
+
+    // The number of documents the caller is expected to consume from this remote while waiting
+    // for its next batch, at the rate it has consumed them since the last one arrived.
+    const long long expectedConsumption = remote.consumedSinceLastResponse *
+        durationCount<Microseconds>(remote.lastRoundTripTime) / sinceLastResponse;
+
+    const long long lowWaterMark =
+        std::min(expectedConsumption, (maxReadAheadBatches - 1) * remote.lastBatchSize);
+    return static_cast<long long>(remote.docBuffer.size()) <= lowWaterMark;
+}
+
 Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
 
@@ -337,6 +426,14 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     auto adjustedBatchSize = _params->batchSize;
     if (_params->batchSize && *_params->batchSize > remote.fetchedCount) {
         adjustedBatchSize = *_params->batchSize - remote.fetchedCount;
+    } else if (_params->batchSize && _params->tailableMode == TailableMode::kNormal) {
+        // Once the remote has returned a full batch, double the batchSize of every getMore up to a
+        // limit, so that long running cursors such as large exports need fewer round trips.
+        remote.grownBatchSize = (remote.grownBatchSize
+                                     ? std::min(*remote.grownBatchSize * 2,
+                                                *_params->batchSize * kMaxBatchSizeGrowthFactor)
+                                     : *_params->batchSize);
+        adjustedBatchSize = remote.grownBatchSize;
     }
 
     BSONObj cmdObj = GetMoreRequest(remote.cursorNss,
@@ -361,6 +458,7 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    remote.requestScheduledAt = _executor->now();
     return Status::OK();
 }
 
@@ -389,6 +487,7 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
     }
 
     // Schedule remote work on hosts for which we need more results.
+    const auto now = _executor->now();
     for (size_t i = 0; i < _remotes.size(); ++i) {
         auto& remote = _remotes[i];
 
@@ -396,6 +495,10 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
             return remote.status;
         }
 
+        if (!remote.hasNext() && !remote.exhausted() && !remote.waitingSince) {
+            remote.waitingSince = now;
+        }
+
         if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
             // If this remote is not exhausted and there is no outstanding request for it, schedule
             // work to retrieve the next batch.
@@ -502,6 +605,13 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
     } catch (DBException const& e) {
         _remotes[remoteIndex].status = e.toStatus();
     }
+
+    auto& remote = _remotes[remoteIndex];
+    if (remote.waitingSince && (remote.hasNext() || remote.exhausted() || !remote.status.isOK())) {
+        remote.idleWaitTime += _executor->now() - *remote.waitingSince;
+        remote.waitingSince = boost::none;
+    }
+
     _signalCurrentEventIfReady(lk);  // Wake up anyone waiting on '_currentEvent'.
 }
 
@@ -524,14 +634,15 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
     auto& remote = _remotes[remoteIndex];
     remote.status = std::move(status);
     // Unreachable host errors are swallowed if the 'allowPartialResults' option is set. We
-    // remove the unreachable host entirely from consideration by marking it as exhausted.
+    // remove the unreachable host from consideration by marking it as exhausted. Results it had
+    // already returned, which may still be buffered when the failed batch was a read ahead, are
+    // still valid and get merged as usual; a sorted merge drops the host once they are consumed.
     if (_params->isAllowPartialResults) {
         remote.status = Status::OK();
-
-        // Clear the results buffer and cursor id.
-        std::queue<ClusterQueryResult> emptyBuffer;
-        std::swap(remote.docBuffer, emptyBuffer);
         remote.cursorId = 0;
+        if (!_params->sort.isEmpty()) {
+            _updateMergeTree(lk, remoteIndex);
+        }
     }
 }
 
@@ -539,6 +650,7 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
                                               CbResponse const& response,
                                               size_t remoteIndex) {
     auto& remote = _remotes[remoteIndex];
+    remote.lastRoundTripTime = _executor->now() - remote.requestScheduledAt;
     if (!response.isOK()) {
         _cleanUpFailedBatch(lk, response.status, remoteIndex);
         return;
@@ -580,6 +692,9 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     updateRemoteMetadata(&remote, response);
+
+    // The sort key of the first buffered document only changes if the buffer was empty.
+    const bool wasEmpty = remote.docBuffer.empty();
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (!_params->sort.isEmpty()) {
@@ -603,17 +718,45 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
 
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
+        remote.bufferedBytes += obj.objsize();
+        _bufferedBytes += obj.objsize();
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
-    if (!_params->sort.isEmpty() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+    remote.lastBatchSize = response.getBatch().size();
+    remote.lastResponseAt = _executor->now();
+    remote.consumedSinceLastResponse = 0;
+
+    // If we're doing a sorted merge, then we have to make sure to put this remote into the
+    // merge tree.
+    if (!_params->sort.isEmpty() && wasEmpty && !response.getBatch().empty()) {
+        _updateMergeTree(lk, remoteIndex);
     }
     return true;
 }
 
+void AsyncResultsMerger::_updateMergeTree(WithLock, size_t remoteIndex) {
+    const auto& remote = _remotes[remoteIndex];
+    if (remote.docBuffer.empty()) {
+        _mergeTree.clearKey(remoteIndex);
+        return;
+    }
+
+    const auto sortKeyObj =
+        extractSortKey(*remote.docBuffer.front().getResult(), _params->compareWholeSortKey);
+    if (!_sortKeyOrdering) {
+        // The merge tree compares these with compareSortKeys()
+        _mergeTree.setKey(remoteIndex, std::string(sortKeyObj.objdata(), sortKeyObj.objsize()));
+        return;
+    }
+
+    // The KeyString encoding of the sort key orders the same way as comparing the sort keys with
+    // compareSortKeys(), so each sort key is encoded once instead of being compared as BSON
+    // whenever it is matched against the sort key of another remote.
+    const KeyString sortKey(KeyString::Version::V1, sortKeyObj, *_sortKeyOrdering);
+    _mergeTree.setKey(remoteIndex, std::string(sortKey.getBuffer(), sortKey.getSize()));
+}
+
 void AsyncResultsMerger::_signalCurrentEventIfReady(WithLock lk) {
     if (_ready(lk) && _currentEvent.isValid()) {
         // To prevent ourselves from signalling the event twice, we set '_currentEvent' as
@@ -716,17 +859,25 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
     return cursorId == 0;
 }
 
-//
-// AsyncResultsMerger::MergingComparator
-//
+std::vector<GenericCursorRemote> AsyncResultsMerger::getRemoteStats() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+    const auto now = _executor->now();
+    std::vector<GenericCursorRemote> stats;
+    for (const auto& remote : _remotes) {
+        auto idleWaitTime = remote.idleWaitTime;
+        if (remote.waitingSince) {
+            idleWaitTime += now - *remote.waitingSince;
+        }
 
-    return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
-                           extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
+        stats.emplace_back();
+        auto& remoteStats = stats.back();
+        remoteStats.setHost(remote.shardHostAndPort.toString());
+        remoteStats.setBufferedDocs(remote.docBuffer.size());
+        remoteStats.setBufferedBytes(remote.bufferedBytes);
+        remoteStats.setIdleWaitMicros(durationCount<Microseconds>(idleWaitTime));
+    }
+    return stats;
 }
 
 void AsyncResultsMerger::blockingKill(OperationContext* opCtx) {
@@ -35,10 +35,14 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
+#include "mongo/db/generic_cursor.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/s/query/cluster_query_result.h"
+#include "mongo/s/query/loser_tree.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
@@ -48,6 +52,14 @@ namespace mongo {
 
 class CursorResponse;
 
+// The most batches that the AsyncResultsMerger keeps buffered or requested per remote when reading
+// ahead, counting the one in flight. 1 disables reading ahead.
+extern AtomicInt32 asyncResultsMergerMaxReadAheadBatches;
+
+// The most bytes of documents that the AsyncResultsMerger of a single cursor keeps buffered across
+// all of its remotes before it stops reading ahead.
+extern AtomicInt32 asyncResultsMergerReadAheadBufferBytes;
+
 /**
  * Given a set of cursorIds across one or more shards, the AsyncResultsMerger calls getMore on the
  * cursors to present a single sorted or unsorted stream of documents.
@@ -88,7 +100,7 @@ public:
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
      * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * buffered results into _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      *
@@ -221,6 +233,12 @@ public:
      */
     void blockingKill(OperationContext*);
 
+    /**
+     * Returns the number of buffered documents, their size and the time spent waiting for results
+     * for each of the remotes.
+     */
+    std::vector<GenericCursorRemote> getRemoteStats();
+
 private:
     /**
      * We instantiate one of these per remote host. It contains the buffer of results we've
@@ -279,26 +297,33 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
-    };
 
-    class MergingComparator {
-    public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes,
-                          const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
+        // The batchSize of the last getMore which asked for a full batch. Grows with every getMore
+        // once the remote has returned a full batch, so long running cursors need fewer round
+        // trips.
+        boost::optional<long long> grownBatchSize;
+
+        // The total size in bytes of the documents in 'docBuffer'.
+        long long bufferedBytes = 0;
+
+        // The number of documents in the last batch received from this remote.
+        long long lastBatchSize = 0;
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        // When the pending request to this remote was scheduled, and how long the last request
+        // took to get a response.
+        Date_t requestScheduledAt;
+        Milliseconds lastRoundTripTime{0};
 
-    private:
-        const std::vector<RemoteCursorData>& _remotes;
+        // The number of documents returned from this remote since its last response arrived, at
+        // 'lastResponseAt'. Used to estimate how fast the caller consumes the remote's results.
+        long long consumedSinceLastResponse = 0;
+        Date_t lastResponseAt;
 
-        const BSONObj& _sort;
+        // Set while the caller waits for results and this remote has none buffered.
+        boost::optional<Date_t> waitingSince;
 
-        // When '_compareWholeSortKey' is true, $sortKey is a scalar value, rather than an object.
-        // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
-        // be {$sortKey: 1}.
-        const bool _compareWholeSortKey;
+        // The total time the caller has waited for results with none buffered for this remote.
+        Microseconds idleWaitTime{0};
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -375,6 +400,12 @@ private:
      */
     bool _addBatchToBuffer(WithLock, size_t remoteIndex, const CursorResponse& response);
 
+    /**
+     * Sets the key of the remote at 'remoteIndex' in _mergeTree to the KeyString encoding of the
+     * sort key of the first document in its buffer, or clears it if the buffer is empty.
+     */
+    void _updateMergeTree(WithLock, size_t remoteIndex);
+
     /**
      * If there is a valid unsignaled event that has been requested via nextEvent() and there are
      * buffered results that are ready to return, signals that event.
@@ -389,6 +420,24 @@ private:
      */
     bool _haveOutstandingBatchRequests(WithLock);
 
+    /**
+     * Removes and returns the first document buffered for the remote at 'remoteIndex', and reads
+     * ahead from that remote if it is running low on buffered documents.
+     */
+    ClusterQueryResult _popFromBuffer(WithLock, size_t remoteIndex);
+
+    /**
+     * Returns true if the next batch from the remote at 'remoteIndex' should be requested before
+     * the caller has consumed all of the remote's buffered documents.
+     *
+     * The remote is read ahead of the caller once it has fewer documents buffered than the caller
+     * is expected to consume during a round trip to it, estimated from the rate at which the caller
+     * consumed the remote's documents since its last response. This is bounded by
+     * asyncResultsMergerMaxReadAheadBatches batches per remote and by
+     * asyncResultsMergerReadAheadBufferBytes bytes buffered across all the remotes.
+     */
+    bool _shouldReadAhead(WithLock, size_t remoteIndex) const;
+
     /**
      * Schedules a killCursors command to be run on all remote hosts that have open cursors.
      */
@@ -409,14 +458,23 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // The sort order of the sort keys, used to encode them as KeyStrings. Used only if there is a
+    // sort, and not set if the sort pattern has too many fields for an Ordering.
+    const boost::optional<Ordering> _sortKeyOrdering;
+
+    // Merges the remotes by the KeyString encoding of the sort key of the first document in their
+    // buffers, or by the BSON sort key if there is no _sortKeyOrdering. The top of this tree is
+    // the index into '_remotes' for the remote host that has the next document to return,
+    // according to the sort order. Used only if there is a sort.
+    LoserTree _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
 
+    // The total size in bytes of the documents buffered for all the remotes.
+    long long _bufferedBytes = 0;
+
     Status _status = Status::OK();
 
     executor::TaskExecutor::EventHandle _currentEvent;
@@ -44,6 +44,7 @@
 #include "mongo/s/sharding_router_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -213,6 +214,11 @@ protected:
         net->exitNetwork();
     }
 
+    void advanceClock(Milliseconds duration) {
+        NetworkInterfaceMock::InNetworkGuard guard(network());
+        guard->runUntil(guard->now() + duration);
+    }
+
     void blackHoleNextRequest() {
         executor::NetworkInterfaceMock* net = network();
         net->enterNetwork();
@@ -613,6 +619,56 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortKeyWithMoreFieldsThanAnOrderingCanDescribe) {
+    // Sort on 33 fields, the last of them descending, which tells the documents apart.
+    const int kNumSortFields = 33;
+    BSONObjBuilder sortBuilder;
+    for (int i = 0; i < kNumSortFields; ++i) {
+        sortBuilder.append(str::stream() << "f" << i, i == kNumSortFields - 1 ? -1 : 1);
+    }
+    BSONObj findCmd = BSON("find"
+                           << "testcoll"
+                           << "sort"
+                           << sortBuilder.obj());
+
+    auto makeResult = [&](int lastField) {
+        BSONObjBuilder sortKeyBuilder;
+        for (int i = 0; i < kNumSortFields - 1; ++i) {
+            sortKeyBuilder.append("", 0);
+        }
+        sortKeyBuilder.append("", lastField);
+        return BSON("$sortKey" << sortKeyBuilder.obj());
+    };
+
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
+    cursors.emplace_back(kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {makeResult(8), makeResult(2)};
+    responses.emplace_back(_nss, CursorId(0), batch1);
+    std::vector<BSONObj> batch2 = {makeResult(9), makeResult(5)};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    // ARM returns all results in sorted order.
+    for (int lastField : {9, 8, 5, 2}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(makeResult(lastField),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
@@ -1272,6 +1328,131 @@ TEST_F(AsyncResultsMergerTest, GetMoreBatchSizes) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, GetMoreBatchSizeGrowsOnceAFullBatchHasBeenReturned) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd, 2);
+
+    int nextId = 0;
+    const std::vector<long long> expectedBatchSizes = {2, 2, 4, 8};
+    for (size_t i = 0; i < expectedBatchSizes.size(); ++i) {
+        ASSERT_FALSE(arm->ready());
+        auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+        auto request =
+            GetMoreRequest::parseFromBSON("anydbname", getNthPendingRequest(0).cmdObj);
+        ASSERT_OK(request.getStatus());
+        ASSERT_EQ(expectedBatchSizes[i], *request.getValue().batchSize);
+
+        // Every batch is full, and the last one closes the cursor.
+        std::vector<BSONObj> batch;
+        for (long long j = 0; j < expectedBatchSizes[i]; ++j) {
+            batch.push_back(BSON("_id" << nextId++));
+        }
+        const bool lastBatch = i + 1 == expectedBatchSizes.size();
+        std::vector<CursorResponse> responses;
+        responses.emplace_back(_nss, CursorId(lastBatch ? 0 : 1), batch);
+        scheduleNetworkResponses(std::move(responses),
+                                 CursorResponse::ResponseType::SubsequentResponse);
+        executor()->waitForEvent(readyEvent);
+
+        for (const auto& obj : batch) {
+            ASSERT_TRUE(arm->ready());
+            ASSERT_BSONOBJ_EQ(obj, *unittest::assertGet(arm->nextReady()).getResult());
+        }
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadsAheadOfConsumerOnceRoundTripTimeIsKnown) {
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
+    makeCursorFromExistingCursors(std::move(cursors));
+
+    // The first getMore takes 10ms to get a response, which the ARM spends waiting.
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    advanceClock(Milliseconds(10));
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}"), fromjson("{_id: 4}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    auto stats = arm->getRemoteStats();
+    ASSERT_EQ(1U, stats.size());
+    ASSERT_EQ(kTestShardHosts[0].toString(), stats[0].getHost());
+    ASSERT_EQ(4LL, stats[0].getBufferedDocs());
+    ASSERT_EQ(4LL * batch1[0].objsize(), stats[0].getBufferedBytes());
+    ASSERT_EQ(10000LL, stats[0].getIdleWaitMicros());
+
+    // The first result is consumed 1ms after the batch arrived, so the other three will be consumed
+    // before another batch could arrive. The next batch is requested right away.
+    advanceClock(Milliseconds(1));
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 5}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    stats = arm->getRemoteStats();
+    ASSERT_EQ(4LL, stats[0].getBufferedDocs());
+    ASSERT_EQ(10000LL, stats[0].getIdleWaitMicros());
+
+    for (int id = 2; id <= 5; ++id) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << id), *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, DoesNotReadAheadBeyondBufferBudget) {
+    const auto oldBufferBytes = asyncResultsMergerReadAheadBufferBytes.load();
+    asyncResultsMergerReadAheadBufferBytes.store(1);
+    ON_BLOCK_EXIT([&] { asyncResultsMergerReadAheadBufferBytes.store(oldBufferBytes); });
+
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
+    makeCursorFromExistingCursors(std::move(cursors));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    advanceClock(Milliseconds(10));
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    // The buffered results already exceed the budget, so the next batch is not requested until the
+    // buffer is drained.
+    advanceClock(Milliseconds(1));
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    responses.clear();
+    responses.emplace_back(_nss, CursorId(0), std::vector<BSONObj>{});
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, AllowPartialResults) {
     BSONObj findCmd = fromjson("{find: 'testcoll', allowPartialResults: true}");
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
@@ -1339,6 +1520,48 @@ TEST_F(AsyncResultsMergerTest, AllowPartialResults) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedAllowPartialResultsKeepsBufferedResultsOfFailedRemote) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}, allowPartialResults: true}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
+    cursors.emplace_back(kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 2, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    advanceClock(Milliseconds(10));
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1, $sortKey: {'': 1}}"),
+                                   fromjson("{_id: 3, $sortKey: {'': 3}}"),
+                                   fromjson("{_id: 5, $sortKey: {'': 5}}"),
+                                   fromjson("{_id: 7, $sortKey: {'': 7}}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 2, $sortKey: {'': 2}}"),
+                                   fromjson("{_id: 4, $sortKey: {'': 4}}"),
+                                   fromjson("{_id: 6, $sortKey: {'': 6}}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    // Consuming the first result makes the ARM read ahead on the first shard, which then fails
+    // while three of its results are still buffered.
+    advanceClock(Milliseconds(1));
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1, $sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+    scheduleErrorResponse({ErrorCodes::HostUnreachable, "host unreachable"});
+
+    // The results buffered from the failed shard are still merged in order.
+    for (int id = 2; id <= 7; ++id) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << id << "$sortKey" << BSON("" << id)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, AllowPartialResultsSingleNode) {
     BSONObj findCmd = fromjson("{find: 'testcoll', allowPartialResults: true}");
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
@@ -0,0 +1,184 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/cluster_aggregation_results_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/s/query/cluster_query_knobs.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const auto getClusterAggregationResultsCache =
+    ServiceContext::declareDecoration<ClusterAggregationResultsCache>();
+
+}  // namespace
+
+const long long ClusterAggregationResultsCache::kMaxDocumentsPerShard;
+
+ClusterAggregationResultsCache* ClusterAggregationResultsCache::get(
+    ServiceContext* serviceContext) {
+    return &getClusterAggregationResultsCache(serviceContext);
+}
+
+ClusterAggregationResultsCache* ClusterAggregationResultsCache::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+bool ClusterAggregationResultsCache::isEnabled() {
+    return internalQueryAggResultsCacheExpireMillis.load() > 0;
+}
+
+std::shared_ptr<const ClusterAggregationResultsCache::CachedResults>
+ClusterAggregationResultsCache::lookup(const NamespaceString& nss,
+                                       const BSONObj& cmdObj,
+                                       const ShardId& shardId,
+                                       const ChunkVersion& shardVersion,
+                                       Date_t now) {
+    const auto key = _makeKey(nss, cmdObj, shardId, shardVersion);
+
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    auto it = _entriesByKey.find(key);
+    if (it == _entriesByKey.end()) {
+        _misses.addAndFetch(1);
+        return nullptr;
+    }
+
+    if (it->second->expiration <= now) {
+        _remove(lg, it->second);
+        _misses.addAndFetch(1);
+        return nullptr;
+    }
+
+    // Mark the entry as the most recently used
+    _entryList.splice(_entryList.begin(), _entryList, it->second);
+
+    _hits.addAndFetch(1);
+    return it->second->results;
+}
+
+void ClusterAggregationResultsCache::insert(const NamespaceString& nss,
+                                            const BSONObj& cmdObj,
+                                            const ShardId& shardId,
+                                            const ChunkVersion& shardVersion,
+                                            const HostAndPort& hostAndPort,
+                                            const std::vector<BSONObj>& documents,
+                                            Date_t now) {
+    const auto expireMillis = internalQueryAggResultsCacheExpireMillis.load();
+    if (expireMillis <= 0) {
+        return;
+    }
+
+    auto key = _makeKey(nss, cmdObj, shardId, shardVersion);
+
+    auto results = std::make_shared<CachedResults>();
+    results->hostAndPort = hostAndPort;
+    results->documents.reserve(documents.size());
+
+    size_t sizeBytes = key.size() + sizeof(Entry) + sizeof(CachedResults);
+    for (const auto& doc : documents) {
+        results->documents.push_back(doc.getOwned());
+        sizeBytes += doc.objsize() + sizeof(BSONObj);
+    }
+
+    const size_t maxSizeBytes = internalQueryAggResultsCacheMaxSizeBytes.load();
+    if (sizeBytes > maxSizeBytes) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    auto it = _entriesByKey.find(key);
+    if (it != _entriesByKey.end()) {
+        _remove(lg, it->second);
+    }
+
+    // Evict the least recently used entries until the new one fits
+    while (!_entryList.empty() && _totalSizeBytes + sizeBytes > maxSizeBytes) {
+        _remove(lg, std::prev(_entryList.end()));
+        _evictions.addAndFetch(1);
+    }
+
+    _entryList.push_front(
+        Entry{key, now + Milliseconds(expireMillis), sizeBytes, std::move(results)});
+    _entriesByKey.emplace(std::move(key), _entryList.begin());
+    _totalSizeBytes += sizeBytes;
+
+    _insertions.addAndFetch(1);
+}
+
+void ClusterAggregationResultsCache::clear() {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    _entriesByKey.clear();
+    _entryList.clear();
+    _totalSizeBytes = 0;
+}
+
+void ClusterAggregationResultsCache::report(BSONObjBuilder* builder) const {
+    BSONObjBuilder cacheStatsBuilder(builder->subobjStart("aggregationResultsCache"));
+
+    size_t numEntries;
+    size_t totalSizeBytes;
+    {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        numEntries = _entryList.size();
+        totalSizeBytes = _totalSizeBytes;
+    }
+
+    cacheStatsBuilder.append("numEntries", static_cast<long long>(numEntries));
+    cacheStatsBuilder.append("totalSizeBytes", static_cast<long long>(totalSizeBytes));
+    cacheStatsBuilder.append("hits", _hits.load());
+    cacheStatsBuilder.append("misses", _misses.load());
+    cacheStatsBuilder.append("insertions", _insertions.load());
+    cacheStatsBuilder.append("evictions", _evictions.load());
+
+    cacheStatsBuilder.doneFast();
+}
+
+std::string ClusterAggregationResultsCache::_makeKey(const NamespaceString& nss,
+                                                     const BSONObj& cmdObj,
+                                                     const ShardId& shardId,
+                                                     const ChunkVersion& shardVersion) {
+    // The command is compared in its binary form, which is not ambiguous unlike its string form
+    return str::stream() << nss.ns() << '\0' << shardId << '\0' << shardVersion.toString() << '\0'
+                         << std::string(cmdObj.objdata(), cmdObj.objsize());
+}
+
+void ClusterAggregationResultsCache::_remove(WithLock, EntryList::iterator it) {
+    _totalSizeBytes -= it->sizeBytes;
+    _entriesByKey.erase(it->key);
+    _entryList.erase(it);
+}
+
+}  // namespace mongo
@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/s/shard_id.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Opt-in cache on mongos of the results, which the shards returned for the shards part of split
+ * aggregation pipelines, which merge on mongos. Identical aggregations reuse the cached results of
+ * a shard instead of running the pipeline on it again.
+ *
+ * Entries are keyed by the namespace, the command sent to the shards, the shard and the shard
+ * version of the collection on it, so that chunk migrations, splits and drops make them unusable.
+ * Since writes do not change the shard version, entries also expire after a configurable amount of
+ * time, which bounds how stale the results of cached aggregations can be. The total size of the
+ * entries is bounded and the least recently used ones are evicted first.
+ *
+ * This class is thread-safe.
+ */
+class ClusterAggregationResultsCache {
+    MONGO_DISALLOW_COPYING(ClusterAggregationResultsCache);
+
+public:
+    // Only results, which a shard returned entirely in the first batch of its cursor, are cached.
+    // Aggregations, whose results are cached, request first batches of this size from the shards.
+    static const long long kMaxDocumentsPerShard = 1000;
+
+    /**
+     * The results of the shards part of a pipeline on a single shard.
+     */
+    struct CachedResults {
+        // The host, which produced the results
+        HostAndPort hostAndPort;
+
+        // Owned copies of the documents returned by the shard
+        std::vector<BSONObj> documents;
+    };
+
+    ClusterAggregationResultsCache() = default;
+
+    static ClusterAggregationResultsCache* get(ServiceContext* serviceContext);
+    static ClusterAggregationResultsCache* get(OperationContext* opCtx);
+
+    /**
+     * Returns whether caching is enabled through the internalQueryAggResultsCacheExpireMillis
+     * server parameter.
+     */
+    static bool isEnabled();
+
+    /**
+     * Returns the results which the specified shard returned for 'cmdObj' at 'shardVersion', or
+     * nullptr if none are cached or they expired before 'now'.
+     */
+    std::shared_ptr<const CachedResults> lookup(const NamespaceString& nss,
+                                                const BSONObj& cmdObj,
+                                                const ShardId& shardId,
+                                                const ChunkVersion& shardVersion,
+                                                Date_t now);
+
+    /**
+     * Caches the documents, which the specified host of the shard returned for 'cmdObj' at
+     * 'shardVersion'. Does nothing if caching is disabled or the documents alone exceed the maximum
+     * size of the cache.
+     */
+    void insert(const NamespaceString& nss,
+                const BSONObj& cmdObj,
+                const ShardId& shardId,
+                const ChunkVersion& shardVersion,
+                const HostAndPort& hostAndPort,
+                const std::vector<BSONObj>& documents,
+                Date_t now);
+
+    /**
+     * Removes all the entries.
+     */
+    void clear();
+
+    /**
+     * Reports the accumulated statistics and memory usage for serverStatus.
+     */
+    void report(BSONObjBuilder* builder) const;
+
+private:
+    struct Entry {
+        std::string key;
+
+        Date_t expiration;
+
+        // Approximate memory used by the entry
+        size_t sizeBytes;
+
+        std::shared_ptr<const CachedResults> results;
+    };
+
+    // Ordered from the most to the least recently used
+    using EntryList = std::list<Entry>;
+
+    static std::string _makeKey(const NamespaceString& nss,
+                                const BSONObj& cmdObj,
+                                const ShardId& shardId,
+                                const ChunkVersion& shardVersion);
+
+    /**
+     * Removes the specified entry.
+     */
+    void _remove(WithLock, EntryList::iterator it);
+
+    // Protects the state below
+    mutable stdx::mutex _mutex;
+
+    EntryList _entryList;
+
+    stdx::unordered_map<std::string, EntryList::iterator> _entriesByKey;
+
+    size_t _totalSizeBytes{0};
+
+    // Statistics
+    AtomicInt64 _hits{0};
+    AtomicInt64 _misses{0};
+    AtomicInt64 _insertions{0};
+    AtomicInt64 _evictions{0};
+};
+
+}  // namespace mongo
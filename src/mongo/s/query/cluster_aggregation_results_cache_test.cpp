@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/cluster_aggregation_results_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/oid.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/s/query/cluster_query_knobs.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const ShardId kShardId("TestShard");
+const HostAndPort kHostAndPort("TestHost", 12345);
+
+class ClusterAggregationResultsCacheTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _originalExpireMillis = internalQueryAggResultsCacheExpireMillis.load();
+        _originalMaxSizeBytes = internalQueryAggResultsCacheMaxSizeBytes.load();
+        internalQueryAggResultsCacheExpireMillis.store(1000);
+    }
+
+    void tearDown() override {
+        internalQueryAggResultsCacheExpireMillis.store(_originalExpireMillis);
+        internalQueryAggResultsCacheMaxSizeBytes.store(_originalMaxSizeBytes);
+    }
+
+    ClusterAggregationResultsCache cache;
+    const ChunkVersion version{1, 0, OID::gen()};
+    const Date_t now = Date_t::fromMillisSinceEpoch(1000000);
+
+private:
+    int _originalExpireMillis;
+    int _originalMaxSizeBytes;
+};
+
+BSONObj makeCmd(int n) {
+    return BSON("aggregate" << kNss.coll() << "pipeline"
+                            << BSON_ARRAY(BSON("$match" << BSON("x" << n))));
+}
+
+TEST_F(ClusterAggregationResultsCacheTest, LookupReturnsInsertedResults) {
+    ASSERT(!cache.lookup(kNss, makeCmd(1), kShardId, version, now));
+
+    cache.insert(kNss, makeCmd(1), kShardId, version, kHostAndPort, {BSON("x" << 1)}, now);
+
+    auto results = cache.lookup(kNss, makeCmd(1), kShardId, version, now);
+    ASSERT(results);
+    ASSERT_EQ(kHostAndPort, results->hostAndPort);
+    ASSERT_EQ(1U, results->documents.size());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 1), results->documents[0]);
+
+    ASSERT(!cache.lookup(kNss, makeCmd(2), kShardId, version, now));
+    ASSERT(!cache.lookup(kNss, makeCmd(1), ShardId("OtherShard"), version, now));
+}
+
+TEST_F(ClusterAggregationResultsCacheTest, ChangedShardVersionMisses) {
+    cache.insert(kNss, makeCmd(1), kShardId, version, kHostAndPort, {BSON("x" << 1)}, now);
+
+    ChunkVersion newVersion(version.majorVersion(), version.minorVersion() + 1, version.epoch());
+    ASSERT(!cache.lookup(kNss, makeCmd(1), kShardId, newVersion, now));
+    ASSERT(cache.lookup(kNss, makeCmd(1), kShardId, version, now));
+}
+
+TEST_F(ClusterAggregationResultsCacheTest, EntriesExpire) {
+    cache.insert(kNss, makeCmd(1), kShardId, version, kHostAndPort, {BSON("x" << 1)}, now);
+
+    ASSERT(cache.lookup(kNss, makeCmd(1), kShardId, version, now + Milliseconds(999)));
+    ASSERT(!cache.lookup(kNss, makeCmd(1), kShardId, version, now + Milliseconds(1000)));
+}
+
+TEST_F(ClusterAggregationResultsCacheTest, NothingIsCachedWhenDisabled) {
+    internalQueryAggResultsCacheExpireMillis.store(0);
+    ASSERT_FALSE(ClusterAggregationResultsCache::isEnabled());
+
+    cache.insert(kNss, makeCmd(1), kShardId, version, kHostAndPort, {BSON("x" << 1)}, now);
+    ASSERT(!cache.lookup(kNss, makeCmd(1), kShardId, version, now));
+}
+
+TEST_F(ClusterAggregationResultsCacheTest, EvictsLeastRecentlyUsed) {
+    internalQueryAggResultsCacheMaxSizeBytes.store(1500);
+
+    const std::vector<BSONObj> documents{BSON("s" << std::string(300, 'a'))};
+
+    cache.insert(kNss, makeCmd(1), kShardId, version, kHostAndPort, documents, now);
+    cache.insert(kNss, makeCmd(2), kShardId, version, kHostAndPort, documents, now);
+
+    // Each entry takes about 600 bytes, so only two fit. Make the first one the most recently used.
+    ASSERT(cache.lookup(kNss, makeCmd(1), kShardId, version, now));
+
+    cache.insert(kNss, makeCmd(3), kShardId, version, kHostAndPort, documents, now);
+
+    ASSERT(cache.lookup(kNss, makeCmd(1), kShardId, version, now));
+    ASSERT(!cache.lookup(kNss, makeCmd(2), kShardId, version, now));
+    ASSERT(cache.lookup(kNss, makeCmd(3), kShardId, version, now));
+
+    BSONObjBuilder builder;
+    cache.report(&builder);
+    const auto stats = builder.obj()["aggregationResultsCache"].Obj();
+    ASSERT_EQ(2, stats["numEntries"].numberLong());
+    ASSERT_EQ(1, stats["evictions"].numberLong());
+    ASSERT_LTE(stats["totalSizeBytes"].numberLong(), 1500);
+}
+
+TEST_F(ClusterAggregationResultsCacheTest, ResultsLargerThanTheCacheAreNotCached) {
+    internalQueryAggResultsCacheMaxSizeBytes.store(256);
+
+    cache.insert(kNss,
+                 makeCmd(1),
+                 kShardId,
+                 version,
+                 kHostAndPort,
+                 {BSON("s" << std::string(300, 'a'))},
+                 now);
+    ASSERT(!cache.lookup(kNss, makeCmd(1), kShardId, version, now));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -125,6 +125,11 @@ public:
      */
     virtual bool remotesExhausted() = 0;
 
+    /**
+     * Returns the buffering state of each of the remote cursors underlying this cursor.
+     */
+    virtual std::vector<GenericCursorRemote> getRemoteStats() = 0;
+
     /**
      * Sets the maxTimeMS value that the cursor should forward with any internally issued getMore
      * requests.
@@ -158,6 +158,10 @@ bool ClusterClientCursorImpl::remotesExhausted() {
     return _root->remotesExhausted();
 }
 
+std::vector<GenericCursorRemote> ClusterClientCursorImpl::getRemoteStats() {
+    return _root->getRemoteStats();
+}
+
 Status ClusterClientCursorImpl::setAwaitDataTimeout(Milliseconds awaitDataTimeout) {
     return _root->setAwaitDataTimeout(awaitDataTimeout);
 }
@@ -109,6 +109,8 @@ public:
 
     bool remotesExhausted() final;
 
+    std::vector<GenericCursorRemote> getRemoteStats() final;
+
     Status setAwaitDataTimeout(Milliseconds awaitDataTimeout) final;
 
     boost::optional<LogicalSessionId> getLsid() const final;
@@ -95,6 +95,10 @@ void ClusterClientCursorMock::markRemotesNotExhausted() {
     _remotesExhausted = false;
 }
 
+std::vector<GenericCursorRemote> ClusterClientCursorMock::getRemoteStats() {
+    return {};
+}
+
 void ClusterClientCursorMock::queueError(Status status) {
     _resultsQueue.push({status});
 }
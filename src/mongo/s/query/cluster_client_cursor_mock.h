@@ -85,6 +85,8 @@ public:
 
     void markRemotesNotExhausted();
 
+    std::vector<GenericCursorRemote> getRemoteStats() final;
+
     /**
      * Queues an error response.
      */
@@ -561,6 +561,12 @@ std::vector<GenericCursor> ClusterCursorManager::getAllCursors() const {
             gc.setId(cursorIdEntryPair.first);
             gc.setNs(nsContainerPair.first);
             gc.setLsid(entry.getLsid());
+
+            // The remotes of a cursor in use by an operation are only reported once it is
+            // returned, since the operation may be changing them.
+            if (auto cursor = entry.peekCursor()) {
+                gc.setRemotes(cursor->getRemoteStats());
+            }
         }
     }
 
@@ -540,6 +540,14 @@ private:
             return _operationUsingCursor;
         }
 
+        /**
+         * Returns the cursor owned by this CursorEntry without releasing it, or nullptr if the
+         * cursor is checked out by an operation.
+         */
+        ClusterClientCursor* peekCursor() const {
+            return _cursor.get();
+        }
+
         /**
          * Indicate that the cursor is no longer in use by an operation. Once this is called,
          * another operation may check the cursor out.
@@ -36,5 +36,7 @@ namespace mongo {
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryAlwaysMergeOnPrimaryShard, bool, false);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitMergingOnMongoS, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryAggResultsCacheExpireMillis, int, 0);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryAggResultsCacheMaxSizeBytes, int, 64 * 1024 * 1024);
 
 }  // namespace mongo
@@ -45,4 +45,14 @@ extern AtomicBool internalQueryAlwaysMergeOnPrimaryShard;
 // of merging on mongoS will always do so.
 extern AtomicBool internalQueryProhibitMergingOnMongoS;
 
+// If greater than zero on mongos, the results which the shards return for the shards part of
+// aggregations, which merge on mongos, are cached for this many milliseconds and reused by
+// identical aggregations for as long as the shard version of the collection does not change.
+// Writes do not change the shard version, so this bounds how stale the results of such
+// aggregations can be. Zero by default, which disables the cache.
+extern AtomicInt32 internalQueryAggResultsCacheExpireMillis;
+
+// The maximum total size in bytes of the results cached by mongos for aggregations.
+extern AtomicInt32 internalQueryAggResultsCacheMaxSizeBytes;
+
 }  // namespace mongo
@@ -71,6 +71,10 @@ bool DocumentSourceRouterAdapter::remotesExhausted() {
     return _child->remotesExhausted();
 }
 
+std::vector<GenericCursorRemote> DocumentSourceRouterAdapter::getRemoteStats() {
+    return _child->getRemoteStats();
+}
+
 DocumentSourceRouterAdapter::DocumentSourceRouterAdapter(
     const boost::intrusive_ptr<ExpressionContext>& expCtx,
     std::unique_ptr<RouterExecStage> childStage)
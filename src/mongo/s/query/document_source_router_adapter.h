@@ -59,6 +59,7 @@ public:
     void detachFromOperationContext() final;
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain) const final;
     bool remotesExhausted();
+    std::vector<GenericCursorRemote> getRemoteStats();
 
     void setExecContext(RouterExecStage::ExecContext execContext) {
         _execContext = execContext;
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/loser_tree.h"
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+LoserTree::LoserTree(size_t numLeaves, Comparator comparator)
+    : _comparator(std::move(comparator)) {
+    addLeaves(numLeaves);
+}
+
+size_t LoserTree::top() {
+    invariant(!empty());
+
+    if (_needsRebuild) {
+        _rebuild();
+    }
+
+    return _losers[0];
+}
+
+void LoserTree::setKey(size_t leaf, std::string key) {
+    invariant(leaf < size());
+
+    if (!_hasKey[leaf]) {
+        _hasKey[leaf] = true;
+        ++_numKeys;
+    }
+    _keys[leaf] = std::move(key);
+
+    _onKeyChanged(leaf);
+}
+
+void LoserTree::clearKey(size_t leaf) {
+    invariant(leaf < size());
+
+    if (!_hasKey[leaf]) {
+        return;
+    }
+    _hasKey[leaf] = false;
+    --_numKeys;
+    _keys[leaf].clear();
+
+    _onKeyChanged(leaf);
+}
+
+void LoserTree::addLeaves(size_t numLeaves) {
+    const size_t newSize = size() + numLeaves;
+    _keys.resize(newSize);
+    _hasKey.resize(newSize, false);
+    _losers.resize(newSize);
+    _winners.resize(newSize);
+
+    // The shape of the tree depends on the number of leaves
+    _needsRebuild = true;
+}
+
+bool LoserTree::_beats(size_t lhs, size_t rhs) const {
+    if (!_hasKey[lhs] || !_hasKey[rhs]) {
+        return _hasKey[lhs] || (!_hasKey[rhs] && lhs < rhs);
+    }
+
+    const int cmp =
+        _comparator ? _comparator(_keys[lhs], _keys[rhs]) : _keys[lhs].compare(_keys[rhs]);
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
+}
+
+void LoserTree::_replay(size_t leaf) {
+    size_t winner = leaf;
+    for (size_t node = (size() + leaf) / 2; node > 0; node /= 2) {
+        if (_beats(_losers[node], winner)) {
+            std::swap(_losers[node], winner);
+        }
+    }
+    _losers[0] = winner;
+}
+
+void LoserTree::_rebuild() {
+    const size_t numLeaves = size();
+    const auto winnerAt = [&](size_t node) {
+        return node >= numLeaves ? node - numLeaves : _winners[node];
+    };
+
+    for (size_t node = numLeaves - 1; node > 0; --node) {
+        size_t winner = winnerAt(2 * node);
+        size_t loser = winnerAt(2 * node + 1);
+        if (_beats(loser, winner)) {
+            std::swap(winner, loser);
+        }
+        _winners[node] = winner;
+        _losers[node] = loser;
+    }
+    _losers[0] = numLeaves > 1 ? _winners[1] : 0;
+
+    _needsRebuild = false;
+}
+
+void LoserTree::_onKeyChanged(size_t leaf) {
+    // Whatever the new key of the winner, the leaves it beat on its way to the root are the winners
+    // of the sibling subtrees, so replaying its path is enough. A change to any other leaf may
+    // affect matches it is not part of anymore.
+    if (!_needsRebuild && leaf == _losers[0]) {
+        _replay(leaf);
+    } else {
+        _needsRebuild = true;
+    }
+}
+
+}  // namespace mongo
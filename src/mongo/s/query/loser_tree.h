@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/stdx/functional.h"
+
+namespace mongo {
+
+/**
+ * A tournament tree of losers for merging a number of sorted streams by binary keys, such as
+ * KeyStrings, which order the same way as memcmp does, or by keys which a Comparator orders. Every
+ * leaf corresponds to one stream and
+ * holds the key of that stream's next item, or no key if the stream has no next item for now. The
+ * winner is the leaf with the smallest key, the one with the lowest index if several keys are
+ * equal.
+ *
+ * Each internal node stores the leaf which lost the match played at that node, so replacing the
+ * key of the winner costs one comparison per level of the tree and only touches the nodes on the
+ * winner's path to the root. Any other change requires the matches to be replayed from scratch,
+ * which is deferred until the winner is needed again.
+ *
+ * Not thread safe.
+ */
+class LoserTree {
+public:
+    /**
+     * Returns a negative number, zero or a positive number if 'lhs' orders before, the same as or
+     * after 'rhs'.
+     */
+    using Comparator = stdx::function<int(const std::string& lhs, const std::string& rhs)>;
+
+    /**
+     * Keys are compared as binary unless a 'comparator' is given.
+     */
+    explicit LoserTree(size_t numLeaves, Comparator comparator = Comparator());
+
+    /**
+     * Returns the number of leaves in the tree.
+     */
+    size_t size() const {
+        return _keys.size();
+    }
+
+    /**
+     * Returns true if no leaf has a key.
+     */
+    bool empty() const {
+        return _numKeys == 0;
+    }
+
+    /**
+     * Returns the leaf with the smallest key. Invalid to call if empty().
+     */
+    size_t top();
+
+    /**
+     * Sets the key of 'leaf', replacing any key it had.
+     */
+    void setKey(size_t leaf, std::string key);
+
+    /**
+     * Removes the key of 'leaf', if it has one.
+     */
+    void clearKey(size_t leaf);
+
+    /**
+     * Adds 'numLeaves' leaves without keys after the existing ones.
+     */
+    void addLeaves(size_t numLeaves);
+
+private:
+    /**
+     * Returns true if 'lhs' wins the match against 'rhs'.
+     */
+    bool _beats(size_t lhs, size_t rhs) const;
+
+    /**
+     * Replays the matches on the path from 'leaf' to the root. Only valid if 'leaf' is the winner.
+     */
+    void _replay(size_t leaf);
+
+    /**
+     * Replays all the matches of the tree.
+     */
+    void _rebuild();
+
+    /**
+     * Called after the key of 'leaf' has changed.
+     */
+    void _onKeyChanged(size_t leaf);
+
+    const Comparator _comparator;
+
+    // The key of each leaf, which is only meaningful if the leaf has a key
+    std::vector<std::string> _keys;
+    std::vector<char> _hasKey;
+    size_t _numKeys = 0;
+
+    // Internal nodes are numbered from 1, the root, to size() - 1 and the children of node 'i' are
+    // nodes 2 * i and 2 * i + 1. Node size() + i is leaf 'i'. Element 0 holds the overall winner.
+    std::vector<size_t> _losers;
+
+    // Scratch space for the winners of the internal nodes while rebuilding
+    std::vector<size_t> _winners;
+
+    // Set when a change to a leaf other than the winner requires replaying all the matches
+    bool _needsRebuild = true;
+};
+
+}  // namespace mongo
@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <queue>
+#include <random>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/s/query/loser_tree.h"
+
+namespace mongo {
+namespace {
+
+const int kDocsPerStream = 1000;
+const BSONObj kSortPattern = BSON("a" << 1 << "b" << -1);
+
+/**
+ * Generates 'numStreams' streams of sort keys of the form {'': <int>, '': <string>}, each sorted
+ * according to kSortPattern, as the $sortKey fields returned by the shards would be.
+ */
+std::vector<std::vector<BSONObj>> makeStreams(size_t numStreams) {
+    std::mt19937 gen(numStreams);
+    std::vector<std::vector<BSONObj>> streams(numStreams);
+    for (auto& stream : streams) {
+        int a = 0;
+        for (int i = 0; i < kDocsPerStream; ++i) {
+            a += gen() % 4;
+            stream.push_back(BSON("" << a << ""
+                                     << "value" + std::to_string(gen() % 100000)));
+        }
+        std::sort(stream.begin(), stream.end(), [](const BSONObj& lhs, const BSONObj& rhs) {
+            return lhs.woCompare(rhs, kSortPattern, false) < 0;
+        });
+    }
+    return streams;
+}
+
+// Merges the streams the way AsyncResultsMerger used to, with a binary heap which compares the
+// sort keys as BSON.
+void BM_mergeBSONHeap(benchmark::State& state) {
+    const auto streams = makeStreams(state.range(0));
+
+    for (auto keepRunning : state) {
+        std::vector<size_t> positions(streams.size(), 0);
+        const auto greater = [&](size_t lhs, size_t rhs) {
+            return streams[lhs][positions[lhs]].woCompare(
+                       streams[rhs][positions[rhs]], kSortPattern, false) > 0;
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+        for (size_t i = 0; i < streams.size(); ++i) {
+            heap.push(i);
+        }
+
+        while (!heap.empty()) {
+            const size_t smallest = heap.top();
+            heap.pop();
+            benchmark::DoNotOptimize(streams[smallest][positions[smallest]]);
+            if (++positions[smallest] < streams[smallest].size()) {
+                heap.push(smallest);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * streams.size() * kDocsPerStream);
+}
+
+// Merges the streams with a loser tree over the KeyString encoding of the sort keys, including the
+// cost of encoding each sort key once.
+void BM_mergeKeyStringLoserTree(benchmark::State& state) {
+    const auto streams = makeStreams(state.range(0));
+    const Ordering ordering = Ordering::make(kSortPattern);
+    const auto encode = [&](const BSONObj& sortKey) {
+        const KeyString ks(KeyString::Version::V1, sortKey, ordering);
+        return std::string(ks.getBuffer(), ks.getSize());
+    };
+
+    for (auto keepRunning : state) {
+        std::vector<size_t> positions(streams.size(), 0);
+        LoserTree tree(streams.size());
+        for (size_t i = 0; i < streams.size(); ++i) {
+            tree.setKey(i, encode(streams[i][0]));
+        }
+
+        while (!tree.empty()) {
+            const size_t smallest = tree.top();
+            benchmark::DoNotOptimize(streams[smallest][positions[smallest]]);
+            if (++positions[smallest] < streams[smallest].size()) {
+                tree.setKey(smallest, encode(streams[smallest][positions[smallest]]));
+            } else {
+                tree.clearKey(smallest);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * streams.size() * kDocsPerStream);
+}
+
+BENCHMARK(BM_mergeBSONHeap)->RangeMultiplier(2)->Range(8, 256);
+BENCHMARK(BM_mergeKeyStringLoserTree)->RangeMultiplier(2)->Range(8, 256);
+
+}  // namespace
+}  // namespace mongo
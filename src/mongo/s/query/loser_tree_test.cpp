@@ -0,0 +1,172 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/loser_tree.h"
+
+#include <algorithm>
+#include <random>
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(LoserTreeTest, EmptyUntilAKeyIsSet) {
+    LoserTree tree(3);
+    ASSERT(tree.empty());
+
+    tree.setKey(1, "b");
+    ASSERT_FALSE(tree.empty());
+    ASSERT_EQ(1U, tree.top());
+
+    tree.clearKey(1);
+    ASSERT(tree.empty());
+}
+
+TEST(LoserTreeTest, SingleLeaf) {
+    LoserTree tree(1);
+    tree.setKey(0, "a");
+    ASSERT_EQ(0U, tree.top());
+    tree.setKey(0, "b");
+    ASSERT_EQ(0U, tree.top());
+    tree.clearKey(0);
+    ASSERT(tree.empty());
+}
+
+TEST(LoserTreeTest, TopIsSmallestKey) {
+    LoserTree tree(5);
+    tree.setKey(0, "d");
+    tree.setKey(1, "b");
+    tree.setKey(2, "e");
+    tree.setKey(4, "c");
+    ASSERT_EQ(1U, tree.top());
+
+    tree.setKey(1, "f");
+    ASSERT_EQ(4U, tree.top());
+
+    tree.clearKey(4);
+    ASSERT_EQ(0U, tree.top());
+
+    tree.setKey(3, "a");
+    ASSERT_EQ(3U, tree.top());
+}
+
+TEST(LoserTreeTest, EqualKeysAreOrderedByLeaf) {
+    LoserTree tree(4);
+    tree.setKey(3, "a");
+    tree.setKey(1, "a");
+    tree.setKey(2, "a");
+    ASSERT_EQ(1U, tree.top());
+
+    tree.clearKey(1);
+    ASSERT_EQ(2U, tree.top());
+
+    tree.setKey(2, "b");
+    ASSERT_EQ(3U, tree.top());
+}
+
+TEST(LoserTreeTest, KeysAreComparedAsBinary) {
+    LoserTree tree(2);
+    tree.setKey(0, std::string("a\xff", 2));
+    tree.setKey(1, std::string("a\x00\x01", 3));
+    ASSERT_EQ(1U, tree.top());
+
+    tree.setKey(1, std::string("a\xff\x00", 3));
+    ASSERT_EQ(0U, tree.top());
+}
+
+TEST(LoserTreeTest, KeysAreComparedByTheComparator) {
+    LoserTree tree(3, [](const std::string& lhs, const std::string& rhs) {
+        return rhs.compare(lhs);
+    });
+    tree.setKey(0, "b");
+    tree.setKey(1, "c");
+    tree.setKey(2, "a");
+    ASSERT_EQ(1U, tree.top());
+
+    tree.setKey(1, "a");
+    ASSERT_EQ(0U, tree.top());
+}
+
+TEST(LoserTreeTest, AddedLeavesTakePartInTheMerge) {
+    LoserTree tree(2);
+    tree.setKey(0, "c");
+    tree.setKey(1, "d");
+    ASSERT_EQ(0U, tree.top());
+
+    tree.addLeaves(3);
+    ASSERT_EQ(5U, tree.size());
+    ASSERT_EQ(0U, tree.top());
+
+    tree.setKey(4, "a");
+    ASSERT_EQ(4U, tree.top());
+}
+
+TEST(LoserTreeTest, MergesSortedStreams) {
+    std::mt19937 gen(1);
+
+    for (size_t numStreams : {1, 2, 3, 7, 8, 13, 64}) {
+        std::vector<std::vector<std::string>> streams(numStreams);
+        std::vector<std::string> expected;
+        for (auto& stream : streams) {
+            const size_t length = gen() % 20;
+            for (size_t i = 0; i < length; ++i) {
+                stream.push_back(std::to_string(gen() % 1000));
+            }
+            std::sort(stream.begin(), stream.end());
+            expected.insert(expected.end(), stream.begin(), stream.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        LoserTree tree(numStreams);
+        std::vector<size_t> positions(numStreams, 0);
+        for (size_t i = 0; i < numStreams; ++i) {
+            if (!streams[i].empty()) {
+                tree.setKey(i, streams[i][0]);
+            }
+        }
+
+        std::vector<std::string> merged;
+        while (!tree.empty()) {
+            const size_t leaf = tree.top();
+            merged.push_back(streams[leaf][positions[leaf]]);
+            if (++positions[leaf] < streams[leaf].size()) {
+                tree.setKey(leaf, streams[leaf][positions[leaf]]);
+            } else {
+                tree.clearKey(leaf);
+            }
+        }
+
+        ASSERT(expected == merged);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -30,9 +30,11 @@
 
 #include <boost/optional.hpp>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/db/generic_cursor.h"
 #include "mongo/s/query/cluster_query_result.h"
 #include "mongo/util/time_support.h"
 
@@ -96,6 +98,14 @@ public:
         return _child->remotesExhausted();
     }
 
+    /**
+     * Returns the buffering state of each of the remote cursors whose results are merged by this
+     * stage or its descendants.
+     */
+    virtual std::vector<GenericCursorRemote> getRemoteStats() {
+        return _child ? _child->getRemoteStats() : std::vector<GenericCursorRemote>{};
+    }
+
     /**
      * Sets the maxTimeMS value that the cursor should forward with any internally issued getMore
      * requests.
@@ -102,6 +102,10 @@ bool RouterStageMerge::remotesExhausted() {
     return _arm.remotesExhausted();
 }
 
+std::vector<GenericCursorRemote> RouterStageMerge::getRemoteStats() {
+    return _arm.getRemoteStats();
+}
+
 Status RouterStageMerge::doSetAwaitDataTimeout(Milliseconds awaitDataTimeout) {
     return _arm.setAwaitDataTimeout(awaitDataTimeout);
 }
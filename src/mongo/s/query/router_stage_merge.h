@@ -57,6 +57,8 @@ public:
 
     bool remotesExhausted() final;
 
+    std::vector<GenericCursorRemote> getRemoteStats() final;
+
     /**
      * Adds the cursors in 'newShards' to those being merged by the ARM.
      */
@@ -88,6 +88,11 @@ bool RouterStagePipeline::remotesExhausted() {
     return _mongosOnlyPipeline || _routerAdapter->remotesExhausted();
 }
 
+std::vector<GenericCursorRemote> RouterStagePipeline::getRemoteStats() {
+    return _mongosOnlyPipeline ? std::vector<GenericCursorRemote>{}
+                               : _routerAdapter->getRemoteStats();
+}
+
 Status RouterStagePipeline::doSetAwaitDataTimeout(Milliseconds awaitDataTimeout) {
     return _routerAdapter->setAwaitDataTimeout(awaitDataTimeout);
 }
@@ -51,6 +51,8 @@ public:
 
     bool remotesExhausted() final;
 
+    std::vector<GenericCursorRemote> getRemoteStats() final;
+
 protected:
     Status doSetAwaitDataTimeout(Milliseconds awaitDataTimeout) final;
 
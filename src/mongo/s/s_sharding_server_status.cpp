@@ -34,6 +34,7 @@
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/cluster_aggregation_results_cache.h"
 
 namespace mongo {
 namespace {
@@ -82,6 +83,7 @@ public:
 
         BSONObjBuilder result;
         catalogCache->report(&result);
+        ClusterAggregationResultsCache::get(opCtx)->report(&result);
         return result.obj();
     }
 
@@ -30,7 +30,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/optional.hpp>
+#include <memory>
 
 #include "mongo/base/init.h"
 #include "mongo/base/initializer.h"
@@ -59,11 +61,13 @@
 #include "mongo/db/logical_time_validator.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/session_killer.h"
 #include "mongo/db/startup_warnings_common.h"
 #include "mongo/db/wire_version.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/rpc/metadata/egress_metadata_hook_list.h"
@@ -90,6 +94,7 @@
 #include "mongo/s/version_mongos.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/transport/transport_layer_manager.h"
 #include "mongo/util/admin_access.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
@@ -134,8 +139,61 @@ const ntservice::NtServiceDefaultStrings defaultServiceStrings = {
 
 constexpr auto kSignKeysRetryInterval = Seconds{1};
 
+// When true, replica set hosts which equally satisfy a read preference are chosen between by how
+// loaded this mongos's connection pools to them are, rather than at random. The load signal is how
+// long connections stay checked out, which long-running getMores on tailable cursors inflate.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(loadBalanceReadsByConnectionPoolLoad, bool, false);
+
+// How often the egress connection pool stats behind the host cost estimates are gathered.
+constexpr auto kHostCostRefreshInterval = Seconds{1};
+
 boost::optional<ShardingUptimeReporter> shardingUptimeReporter;
 
+using HostCostTable = stdx::unordered_map<HostAndPort, int64_t>;
+
+// Replaced wholesale by refreshEgressHostCosts and only ever read through std::atomic_load, so that
+// host selection never waits on the connection pools.
+std::shared_ptr<const HostCostTable> hostCosts;
+
+/**
+ * Rebuilds the host cost table from the sharding executors' connection pools. The cost of a host
+ * is the moving average of how long a connection to it stays checked out, scaled up by the
+ * requests waiting for one. Hosts without a measured latency have no estimate.
+ */
+void refreshEgressHostCosts(Client* client) {
+    auto executorPool = Grid::get(client->getServiceContext())->getExecutorPool();
+    if (!executorPool) {
+        return;
+    }
+
+    executor::ConnectionPoolStats stats;
+    executorPool->appendConnectionStats(&stats);
+
+    auto costs = std::make_shared<HostCostTable>();
+    for (const auto& entry : stats.statsByHost) {
+        const auto& hostStats = entry.second;
+        if (hostStats.latencyMicros < 0) {
+            continue;
+        }
+
+        const int64_t busy = std::max<size_t>(hostStats.inUse, 1);
+        (*costs)[entry.first] =
+            hostStats.latencyMicros * (busy + static_cast<int64_t>(hostStats.queued)) / busy;
+    }
+
+    std::atomic_store(&hostCosts, std::shared_ptr<const HostCostTable>(std::move(costs)));
+}
+
+int64_t estimateEgressHostCost(const HostAndPort& host) {
+    const auto costs = std::atomic_load(&hostCosts);
+    if (!costs) {
+        return -1;
+    }
+
+    auto it = costs->find(host);
+    return it == costs->end() ? -1 : it->second;
+}
+
 Status waitForSigningKeys(OperationContext* opCtx) {
     auto const shardRegistry = Grid::get(opCtx)->shardRegistry();
 
@@ -376,6 +434,9 @@ ExitCode runMongosServer(ServiceContext* serviceContext) {
         &ShardRegistry::replicaSetChangeConfigServerUpdateHook);
     ReplicaSetMonitor::setSynchronousConfigChangeHook(
         &ShardRegistry::replicaSetChangeShardRegistryUpdateHook);
+    if (loadBalanceReadsByConnectionPoolLoad) {
+        ReplicaSetMonitor::setHostCostEstimator(&estimateEgressHostCost);
+    }
 
     // Mongos connection pools already takes care of authenticating new connections so the
     // replica set connection shouldn't need to.
@@ -434,6 +495,9 @@ ExitCode runMongosServer(ServiceContext* serviceContext) {
     // Set up the periodic runner for background job execution
     auto runner = makePeriodicRunner();
     runner->startup().transitional_ignore();
+    if (loadBalanceReadsByConnectionPoolLoad) {
+        runner->scheduleJob({&refreshEgressHostCosts, kHostCostRefreshInterval});
+    }
     serviceContext->setPeriodicRunner(std::move(runner));
 
     SessionKiller::set(serviceContext,
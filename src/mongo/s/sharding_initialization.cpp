@@ -32,6 +32,7 @@
 
 #include "mongo/s/sharding_initialization.h"
 
+#include <algorithm>
 #include <string>
 
 #include "mongo/base/status.h"
@@ -98,6 +99,21 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolRefreshTimeoutMS,
                                       int,
                                       ConnectionPool::kDefaultRefreshTimeout.count());
 
+// When non-zero, each pool keeps as many connections open as it recently had in use at once,
+// so that a burst right after a failover or a dropped pool doesn't have to establish them all.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolPrewarmWindowMS, int, 0);
+
+// When non-zero, commands on the sharding task executors are pipelined over at most this many
+// connections to each host rather than each taking a pooled connection of its own.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorMultiplexedConnectionsPerHost, int, 0);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorMaxCommandsPerMultiplexedConnection,
+                                      int,
+                                      16);
+
+// A multiplexed connection, which received no reply for this long, is held up by a slow command
+// and takes no further commands until it gets one.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorMultiplexedStallTimeoutMS, int, 100);
+
 namespace {
 
 using executor::NetworkInterface;
@@ -120,6 +136,27 @@ std::unique_ptr<ShardingCatalogClient> makeCatalogClient(ServiceContext* service
     return stdx::make_unique<ShardingCatalogClientImpl>(std::move(distLockManager));
 }
 
+std::unique_ptr<NetworkInterface> makeShardingNetworkInterface(
+    std::string instanceName,
+    rpc::ShardingEgressMetadataHookBuilder metadataHookBuilder,
+    ConnectionPool::Options connPoolOptions) {
+    if (ShardingTaskExecutorMultiplexedConnectionsPerHost <= 0) {
+        return executor::makeNetworkInterface(std::move(instanceName),
+                                              stdx::make_unique<ShardingNetworkConnectionHook>(),
+                                              metadataHookBuilder(),
+                                              std::move(connPoolOptions));
+    }
+
+    return executor::makeMultiplexedNetworkInterface(
+        std::move(instanceName),
+        stdx::make_unique<ShardingNetworkConnectionHook>(),
+        metadataHookBuilder(),
+        std::move(connPoolOptions),
+        ShardingTaskExecutorMultiplexedConnectionsPerHost,
+        std::max(ShardingTaskExecutorMaxCommandsPerMultiplexedConnection, 1),
+        Milliseconds(ShardingTaskExecutorMultiplexedStallTimeoutMS));
+}
+
 std::unique_ptr<TaskExecutorPool> makeShardingTaskExecutorPool(
     std::unique_ptr<NetworkInterface> fixedNet,
     rpc::ShardingEgressMetadataHookBuilder metadataHookBuilder,
@@ -130,10 +167,9 @@ std::unique_ptr<TaskExecutorPool> makeShardingTaskExecutorPool(
     const auto poolSize = taskExecutorPoolSize.value_or(TaskExecutorPool::getSuggestedPoolSize());
 
     for (size_t i = 0; i < poolSize; ++i) {
-        auto exec = makeShardingTaskExecutor(executor::makeNetworkInterface(
+        auto exec = makeShardingTaskExecutor(makeShardingNetworkInterface(
             "NetworkInterfaceASIO-TaskExecutorPool-" + std::to_string(i),
-            stdx::make_unique<ShardingNetworkConnectionHook>(),
-            metadataHookBuilder(),
+            metadataHookBuilder,
             connPoolOptions));
 
         executors.emplace_back(std::move(exec));
@@ -193,6 +229,7 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
     connPoolOptions.minConnections = ShardingTaskExecutorPoolMinSize;
     connPoolOptions.refreshRequirement = Milliseconds(ShardingTaskExecutorPoolRefreshRequirementMS);
     connPoolOptions.refreshTimeout = Milliseconds(ShardingTaskExecutorPoolRefreshTimeoutMS);
+    connPoolOptions.prewarmWindow = Milliseconds(ShardingTaskExecutorPoolPrewarmWindowMS);
 
     if (connPoolOptions.refreshRequirement <= connPoolOptions.refreshTimeout) {
         auto newRefreshTimeout = connPoolOptions.refreshRequirement - Milliseconds(1);
@@ -218,11 +255,8 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
         connPoolOptions.hostTimeout = newHostTimeout;
     }
 
-    auto network =
-        executor::makeNetworkInterface("NetworkInterfaceASIO-ShardRegistry",
-                                       stdx::make_unique<ShardingNetworkConnectionHook>(),
-                                       hookBuilder(),
-                                       connPoolOptions);
+    auto network = makeShardingNetworkInterface(
+        "NetworkInterfaceASIO-ShardRegistry", hookBuilder, connPoolOptions);
     auto networkPtr = network.get();
     auto executorPool = makeShardingTaskExecutorPool(
         std::move(network), hookBuilder, connPoolOptions, taskExecutorPoolSize);
@@ -32,12 +32,15 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <deque>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/s/async_requests_sender.h"
 #include "mongo/s/client/shard_registry.h"
@@ -47,6 +50,10 @@
 #include "mongo/util/log.h"
 
 namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(enableStreamingBatchWrites, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(maxOutstandingWriteBatchesPerShard, int, 2);
+
 namespace {
 
 const ReadPreferenceSetting kPrimaryOnlyReadPreference(ReadPreference::PrimaryOnly);
@@ -77,6 +84,340 @@ void noteStaleResponses(const std::vector<ShardError>& staleErrors, NSTargeter*
 // applies when no writes are occurring and metadata is not changing on reload.
 const int kMaxRoundsWithoutProgress(5);
 
+/**
+ * Builds the command to send to a shard for a child batch.
+ */
+BSONObj buildShardRequest(OperationContext* opCtx,
+                          const BatchWriteOp& batchOp,
+                          const TargetedWriteBatch& batch) {
+    const auto shardBatchRequest(batchOp.buildBatchRequest(batch));
+
+    BSONObjBuilder requestBuilder;
+    shardBatchRequest.serialize(&requestBuilder);
+
+    {
+        OperationSessionInfo sessionInfo;
+
+        if (opCtx->getLogicalSessionId()) {
+            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
+        }
+
+        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
+        sessionInfo.serialize(&requestBuilder);
+    }
+
+    return requestBuilder.obj();
+}
+
+/**
+ * Records the response of a shard to a child batch in the batch op.
+ *
+ * Returns true if the shard reported that the routing information used to target the batch is
+ * stale, in which case the targeter has been told to refresh.
+ */
+bool noteResponse(NSTargeter& targeter,
+                  BatchWriteOp& batchOp,
+                  const TargetedWriteBatch& batch,
+                  AsyncRequestsSender::Response response,
+                  BatchWriteExecStats* stats) {
+    // First check if we were able to target a shard host.
+    if (!response.shardHostAndPort) {
+        invariant(!response.swResponse.isOK());
+
+        // Record a resolve failure
+        batchOp.noteBatchError(batch, errorFromStatus(response.swResponse.getStatus()));
+
+        // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel and
+        // retarget the batch
+        LOG(4) << "Unable to send write batch to " << batch.getEndpoint().shardName
+               << causedBy(response.swResponse.getStatus());
+        return false;
+    }
+
+    const auto shardHost(std::move(*response.shardHostAndPort));
+
+    // Then check if we successfully got a response.
+    Status responseStatus = response.swResponse.getStatus();
+    BatchedCommandResponse batchedCommandResponse;
+    if (responseStatus.isOK()) {
+        std::string errMsg;
+        if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data, &errMsg) ||
+            !batchedCommandResponse.isValid(&errMsg)) {
+            responseStatus = {ErrorCodes::FailedToParse, errMsg};
+        }
+    }
+
+    if (!responseStatus.isOK()) {
+        // Error occurred dispatching, note it
+        const Status status = responseStatus.withContext(str::stream()
+                                                         << "Write results unavailable from "
+                                                         << shardHost);
+
+        batchOp.noteBatchError(batch, errorFromStatus(status));
+
+        LOG(4) << "Unable to receive write results from " << shardHost << causedBy(redact(status));
+        return false;
+    }
+
+    bool isStale = false;
+
+    TrackedErrors trackedErrors;
+    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
+    trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
+
+    LOG(4) << "Write results received from " << shardHost.toString() << ": "
+           << redact(batchedCommandResponse.toString());
+
+    // Dispatch was ok, note response
+    batchOp.noteBatchResponse(batch, batchedCommandResponse, &trackedErrors);
+
+    // Note if anything was stale
+    const auto& staleErrors = trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+    if (!staleErrors.empty()) {
+        noteStaleResponses(staleErrors, &targeter);
+        ++stats->numStaleBatches;
+        isStale = true;
+    }
+
+    const auto& cannotImplicitlyCreateErrors =
+        trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
+    if (!cannotImplicitlyCreateErrors.empty()) {
+        // This forces the chunk manager to reload so we can attach the correct version on retry
+        // and make sure we route to the correct shard.
+        targeter.noteCouldNotTarget();
+        isStale = true;
+    }
+
+    // Remember that we successfully wrote to this shard
+    // NOTE: This will record lastOps for shards where we actually didn't update or delete any
+    // documents, which preserves old behavior but is conservative
+    stats->noteWriteAt(shardHost,
+                       batchedCommandResponse.isLastOpSet() ? batchedCommandResponse.getLastOp()
+                                                            : repl::OpTime(),
+                       batchedCommandResponse.isElectionIdSet()
+                           ? batchedCommandResponse.getElectionId()
+                           : OID());
+
+    return isStale;
+}
+
+/**
+ * Targets the next write ops of the batch op and sends the resulting child batches, at most one per
+ * shard at a time, until all of them have been answered.
+ */
+Status targetAndSendBatches(OperationContext* opCtx,
+                            NSTargeter& targeter,
+                            const BatchedCommandRequest& clientRequest,
+                            bool recordTargetErrors,
+                            BatchWriteOp& batchOp,
+                            BatchWriteExecStats* stats) {
+    OwnedPointerMap<ShardId, TargetedWriteBatch> childBatchesOwned;
+    std::map<ShardId, TargetedWriteBatch*>& childBatches = childBatchesOwned.mutableMap();
+
+    Status targetStatus = batchOp.targetBatch(targeter, recordTargetErrors, &childBatches);
+    if (!targetStatus.isOK()) {
+        dassert(childBatches.size() == 0u);
+        return targetStatus;
+    }
+
+    //
+    // Send all child batches
+    //
+
+    const size_t numToSend = childBatches.size();
+    size_t numSent = 0;
+
+    while (numSent != numToSend) {
+        // Collect batches out on the network, mapped by endpoint
+        OwnedShardBatchMap ownedPendingBatches;
+        OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+
+        //
+        // Construct the requests.
+        //
+
+        std::vector<AsyncRequestsSender::Request> requests;
+
+        // Get as many batches as we can at once
+        for (auto& childBatch : childBatches) {
+            TargetedWriteBatch* const nextBatch = childBatch.second;
+
+            // If the batch is nullptr, we sent it previously, so skip
+            if (!nextBatch)
+                continue;
+
+            // If we already have a batch for this shard, wait until the next time
+            const auto& targetShardId = nextBatch->getEndpoint().shardName;
+
+            if (pendingBatches.count(targetShardId))
+                continue;
+
+            const auto request = buildShardRequest(opCtx, batchOp, *nextBatch);
+
+            LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
+
+            requests.emplace_back(targetShardId, request);
+
+            // Indicate we're done by setting the batch to nullptr. We'll only get duplicate
+            // hostEndpoints if we have broadcast and non-broadcast endpoints for the same host, so
+            // this should be pretty efficient without moving stuff around.
+            childBatch.second = nullptr;
+
+            // Recv-side is responsible for cleaning up the nextBatch when used
+            pendingBatches.emplace(targetShardId, nextBatch);
+        }
+
+        AsyncRequestsSender ars(opCtx,
+                                Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                                clientRequest.getTargetingNS().db().toString(),
+                                requests,
+                                kPrimaryOnlyReadPreference,
+                                opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
+                                                      : Shard::RetryPolicy::kNoRetry);
+        numSent += pendingBatches.size();
+
+        //
+        // Receive the responses.
+        //
+
+        while (!ars.done()) {
+            // Block until a response is available.
+            auto response = ars.next();
+
+            // Get the TargetedWriteBatch to find where to put the response
+            dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
+            TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
+
+            noteResponse(targeter, batchOp, *batch, std::move(response), stats);
+        }
+    }
+
+    return Status::OK();
+}
+
+/**
+ * Targets all the remaining write ops of an unordered batch op at once and streams the resulting
+ * child batches to the shards. Every shard has its own queue of child batches with up to
+ * 'maxOutstandingWriteBatchesPerShard' of them on the network, so that a slow shard does not hold
+ * back the others.
+ *
+ * When a shard reports stale routing information, only that shard's queued child batches are
+ * taken back. If refreshing the targeter changes the routing information, the affected write ops
+ * are retargeted right away while the other shards keep going. Otherwise they are left for the next
+ * round, which accounts for whether progress is being made.
+ */
+Status targetAndStreamBatches(OperationContext* opCtx,
+                              NSTargeter& targeter,
+                              const BatchedCommandRequest& clientRequest,
+                              bool recordTargetErrors,
+                              BatchWriteOp& batchOp,
+                              BatchWriteExecStats* stats) {
+    // Child batches which have not been sent yet, in the order they must be sent to each shard
+    std::map<ShardId, std::deque<std::unique_ptr<TargetedWriteBatch>>> queuedBatches;
+
+    // Number of child batches on the network for each shard
+    std::map<ShardId, int> numOutstanding;
+
+    // Child batches which have been sent, indexed by the position of their request in the ARS
+    std::vector<std::unique_ptr<TargetedWriteBatch>> sentBatches;
+
+    const auto targetReadyOps = [&](bool recordErrors) {
+        std::map<ShardId, std::vector<TargetedWriteBatch*>> targetedBatches;
+        Status targetStatus = batchOp.targetAllBatches(targeter, recordErrors, &targetedBatches);
+
+        for (const auto& shardBatches : targetedBatches) {
+            auto& queue = queuedBatches[shardBatches.first];
+            for (const auto batch : shardBatches.second) {
+                queue.emplace_back(batch);
+            }
+        }
+
+        return targetStatus;
+    };
+
+    const auto dequeueRequests = [&] {
+        const int maxOutstanding = std::max(1, maxOutstandingWriteBatchesPerShard.load());
+
+        std::vector<AsyncRequestsSender::Request> requests;
+        for (auto& shardQueue : queuedBatches) {
+            const auto& targetShardId = shardQueue.first;
+            auto& queue = shardQueue.second;
+            auto& outstanding = numOutstanding[targetShardId];
+
+            while (!queue.empty() && outstanding < maxOutstanding) {
+                const auto request = buildShardRequest(opCtx, batchOp, *queue.front());
+
+                LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
+
+                requests.emplace_back(targetShardId, request);
+                sentBatches.push_back(std::move(queue.front()));
+                queue.pop_front();
+                ++outstanding;
+            }
+        }
+
+        return requests;
+    };
+
+    Status targetStatus = targetReadyOps(recordTargetErrors);
+    if (!targetStatus.isOK()) {
+        return targetStatus;
+    }
+
+    const auto requests = dequeueRequests();
+    if (requests.empty()) {
+        // Every write op had a targeting error recorded
+        return Status::OK();
+    }
+
+    AsyncRequestsSender ars(opCtx,
+                            Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                            clientRequest.getTargetingNS().db().toString(),
+                            requests,
+                            kPrimaryOnlyReadPreference,
+                            opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
+                                                  : Shard::RetryPolicy::kNoRetry);
+
+    while (!ars.done()) {
+        // Block until a response is available.
+        auto response = ars.next();
+
+        invariant(response.requestIndex < sentBatches.size());
+        const auto batch = std::move(sentBatches[response.requestIndex]);
+        const auto targetShardId = batch->getEndpoint().shardName;
+        --numOutstanding[targetShardId];
+
+        if (noteResponse(targeter, batchOp, *batch, std::move(response), stats)) {
+            // The batches still queued for this shard were targeted using the same stale routing
+            // information, so take them back
+            auto& queue = queuedBatches[targetShardId];
+            for (const auto& queuedBatch : queue) {
+                batchOp.noteBatchNotSent(*queuedBatch);
+            }
+            queue.clear();
+
+            bool targeterChanged = false;
+            Status refreshStatus = targeter.refreshIfNeeded(opCtx, &targeterChanged);
+            if (!refreshStatus.isOK()) {
+                warning() << "could not refresh targeter" << causedBy(refreshStatus.reason());
+            }
+
+            // The routing information is now at least as recent as when the client sent the
+            // batch, so targeting errors can be recorded definitively
+            if (targeterChanged) {
+                targetReadyOps(true).transitional_ignore();
+            }
+        }
+
+        const auto moreRequests = dequeueRequests();
+        if (!moreRequests.empty()) {
+            ars.addRequests(moreRequests);
+        }
+    }
+
+    return Status::OK();
+}
+
 }  // namespace
 
 void BatchWriteExec::executeBatch(OperationContext* opCtx,
@@ -91,6 +432,12 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
 
     BatchWriteOp batchOp(opCtx, clientRequest);
 
+    // Only unordered inserts are streamed, since each of their write ops targets a single shard and
+    // so can be retargeted independently of the writes sent to other shards
+    const bool streamBatches = enableStreamingBatchWrites.load() &&
+        clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+        !clientRequest.getWriteCommandBase().getOrdered();
+
     // Current batch status
     bool refreshedTargeter = false;
     int rounds = 0;
@@ -122,190 +469,19 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         //    exactly when the metadata changed.
         //
 
-        OwnedPointerMap<ShardId, TargetedWriteBatch> childBatchesOwned;
-        std::map<ShardId, TargetedWriteBatch*>& childBatches = childBatchesOwned.mutableMap();
-
         // If we've already had a targeting error, we've refreshed the metadata once and can
         // record target errors definitively.
         bool recordTargetErrors = refreshedTargeter;
-        Status targetStatus = batchOp.targetBatch(targeter, recordTargetErrors, &childBatches);
+        Status targetStatus = streamBatches
+            ? targetAndStreamBatches(
+                  opCtx, targeter, clientRequest, recordTargetErrors, batchOp, stats)
+            : targetAndSendBatches(
+                  opCtx, targeter, clientRequest, recordTargetErrors, batchOp, stats);
         if (!targetStatus.isOK()) {
             // Don't do anything until a targeter refresh
             targeter.noteCouldNotTarget();
             refreshedTargeter = true;
             ++stats->numTargetErrors;
-            dassert(childBatches.size() == 0u);
-        }
-
-        //
-        // Send all child batches
-        //
-
-        const size_t numToSend = childBatches.size();
-        size_t numSent = 0;
-
-        while (numSent != numToSend) {
-            // Collect batches out on the network, mapped by endpoint
-            OwnedShardBatchMap ownedPendingBatches;
-            OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
-
-            //
-            // Construct the requests.
-            //
-
-            std::vector<AsyncRequestsSender::Request> requests;
-
-            // Get as many batches as we can at once
-            for (auto& childBatch : childBatches) {
-                TargetedWriteBatch* const nextBatch = childBatch.second;
-
-                // If the batch is nullptr, we sent it previously, so skip
-                if (!nextBatch)
-                    continue;
-
-                // If we already have a batch for this shard, wait until the next time
-                const auto& targetShardId = nextBatch->getEndpoint().shardName;
-
-                if (pendingBatches.count(targetShardId))
-                    continue;
-
-                const auto request = [&] {
-                    const auto shardBatchRequest(batchOp.buildBatchRequest(*nextBatch));
-
-                    BSONObjBuilder requestBuilder;
-                    shardBatchRequest.serialize(&requestBuilder);
-
-                    {
-                        OperationSessionInfo sessionInfo;
-
-                        if (opCtx->getLogicalSessionId()) {
-                            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
-                        }
-
-                        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
-                        sessionInfo.serialize(&requestBuilder);
-                    }
-
-                    return requestBuilder.obj();
-                }();
-
-                LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
-
-                requests.emplace_back(targetShardId, request);
-
-                // Indicate we're done by setting the batch to nullptr. We'll only get duplicate
-                // hostEndpoints if we have broadcast and non-broadcast endpoints for the same host,
-                // so this should be pretty efficient without moving stuff around.
-                childBatch.second = nullptr;
-
-                // Recv-side is responsible for cleaning up the nextBatch when used
-                pendingBatches.emplace(targetShardId, nextBatch);
-            }
-
-            AsyncRequestsSender ars(opCtx,
-                                    Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
-                                    clientRequest.getTargetingNS().db().toString(),
-                                    requests,
-                                    kPrimaryOnlyReadPreference,
-                                    opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
-                                                          : Shard::RetryPolicy::kNoRetry);
-            numSent += pendingBatches.size();
-
-            //
-            // Receive the responses.
-            //
-
-            while (!ars.done()) {
-                // Block until a response is available.
-                auto response = ars.next();
-
-                // Get the TargetedWriteBatch to find where to put the response
-                dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
-                TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
-
-                // First check if we were able to target a shard host.
-                if (!response.shardHostAndPort) {
-                    invariant(!response.swResponse.isOK());
-
-                    // Record a resolve failure
-                    batchOp.noteBatchError(*batch,
-                                           errorFromStatus(response.swResponse.getStatus()));
-
-                    // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
-                    // and retarget the batch
-                    LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
-                           << causedBy(response.swResponse.getStatus());
-
-                    // We're done with this batch. Clean up when we can't resolve a host.
-                    auto it = childBatches.find(batch->getEndpoint().shardName);
-                    invariant(it != childBatches.end());
-                    delete it->second;
-                    it->second = nullptr;
-                    continue;
-                }
-
-                const auto shardHost(std::move(*response.shardHostAndPort));
-
-                // Then check if we successfully got a response.
-                Status responseStatus = response.swResponse.getStatus();
-                BatchedCommandResponse batchedCommandResponse;
-                if (responseStatus.isOK()) {
-                    std::string errMsg;
-                    if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
-                                                          &errMsg) ||
-                        !batchedCommandResponse.isValid(&errMsg)) {
-                        responseStatus = {ErrorCodes::FailedToParse, errMsg};
-                    }
-                }
-
-                if (responseStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
-                    trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
-
-                    LOG(4) << "Write results received from " << shardHost.toString() << ": "
-                           << redact(batchedCommandResponse.toString());
-
-                    // Dispatch was ok, note response
-                    batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
-
-                    // Note if anything was stale
-                    const auto& staleErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
-                    if (!staleErrors.empty()) {
-                        noteStaleResponses(staleErrors, &targeter);
-                        ++stats->numStaleBatches;
-                    }
-
-                    const auto& cannotImplicitlyCreateErrors =
-                        trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
-                    if (!cannotImplicitlyCreateErrors.empty()) {
-                        // This forces the chunk manager to reload so we can attach the correct
-                        // version on retry and make sure we route to the correct shard.
-                        targeter.noteCouldNotTarget();
-                    }
-
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    stats->noteWriteAt(shardHost,
-                                       batchedCommandResponse.isLastOpSet()
-                                           ? batchedCommandResponse.getLastOp()
-                                           : repl::OpTime(),
-                                       batchedCommandResponse.isElectionIdSet()
-                                           ? batchedCommandResponse.getElectionId()
-                                           : OID());
-                } else {
-                    // Error occurred dispatching, note it
-                    const Status status = responseStatus.withContext(
-                        str::stream() << "Write results unavailable from " << shardHost);
-
-                    batchOp.noteBatchError(*batch, errorFromStatus(status));
-
-                    LOG(4) << "Unable to receive write results from " << shardHost
-                           << causedBy(redact(status));
-                }
-            }
         }
 
         ++rounds;
@@ -34,6 +34,7 @@
 #include "mongo/bson/timestamp.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/db/repl/optime.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/ns_targeter.h"
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/s/write_ops/batched_command_response.h"
@@ -43,6 +44,12 @@ namespace mongo {
 class BatchWriteExecStats;
 class OperationContext;
 
+// If set to true, the child batches of unordered insert batches are streamed to each shard, with
+// up to 'maxOutstandingWriteBatchesPerShard' of them outstanding per shard, instead of being sent
+// in rounds where every shard waits for the slowest one. False by default.
+extern AtomicBool enableStreamingBatchWrites;
+extern AtomicInt32 maxOutstandingWriteBatchesPerShard;
+
 /**
  * The BatchWriteExec is able to execute client batch write requests, resulting in a batch
  * response to send back to the client.
@@ -555,5 +555,135 @@ TEST_F(BatchWriteExecTest, NonRetryableErrorTxnNumber) {
     future.timed_get(kFutureTimeout);
 }
 
+//
+// Tests for streaming the child batches of unordered inserts
+//
+
+class BatchWriteExecStreamingTest : public BatchWriteExecTest {
+public:
+    void setUp() override {
+        BatchWriteExecTest::setUp();
+        enableStreamingBatchWrites.store(true);
+    }
+
+    void tearDown() override {
+        enableStreamingBatchWrites.store(false);
+        maxOutstandingWriteBatchesPerShard.store(2);
+        BatchWriteExecTest::tearDown();
+    }
+};
+
+TEST_F(BatchWriteExecStreamingTest, MultiOpLargeUnorderedIsSentInOneRound) {
+    const int kNumDocsToInsert = 100'000;
+    const std::string kDocValue(200, 'x');
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+        ASSERT_EQUALS(stats.numRounds, 1);
+    });
+
+    expectInsertsReturnSuccess(docsToInsert.begin(), docsToInsert.begin() + 66576);
+    expectInsertsReturnSuccess(docsToInsert.begin() + 66576, docsToInsert.end());
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(BatchWriteExecStreamingTest, StaleOp) {
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments({BSON("x" << 1)});
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+        ASSERT(response.getOk());
+        ASSERT_EQ(1LL, response.getN());
+
+        ASSERT_EQUALS(1, stats.numStaleBatches);
+        ASSERT_EQUALS(2, stats.numRounds);
+    });
+
+    const std::vector<BSONObj> expected{BSON("x" << 1)};
+
+    expectInsertsReturnStaleVersionErrors(expected);
+    expectInsertsReturnSuccess(expected);
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(BatchWriteExecStreamingTest, StaleOpTakesBackQueuedBatchesOfTheShard) {
+    maxOutstandingWriteBatchesPerShard.store(1);
+
+    // Only one of these documents fits in a child batch, so each is queued in its own batch
+    const std::string kDocValue(BSONObjMaxUserSize / 2, 'x');
+    const std::vector<BSONObj> docsToInsert{BSON("x" << 1 << "data" << kDocValue),
+                                            BSON("x" << 2 << "data" << kDocValue),
+                                            BSON("x" << 3 << "data" << kDocValue)};
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+        ASSERT(response.getOk());
+        ASSERT_EQ(3LL, response.getN());
+
+        ASSERT_EQUALS(1, stats.numStaleBatches);
+        ASSERT_EQUALS(2, stats.numRounds);
+    });
+
+    // The queued batches for the documents after the stale one are not sent in the first round
+    expectInsertsReturnStaleVersionErrors({docsToInsert[0]});
+
+    for (const auto& doc : docsToInsert) {
+        expectInsertsReturnSuccess(std::vector<BSONObj>{doc});
+    }
+
+    future.timed_get(kFutureTimeout);
+}
+
 }  // namespace
 }  // namespace mongo
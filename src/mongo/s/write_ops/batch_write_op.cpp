@@ -106,6 +106,23 @@ bool isNewBatchRequired(const std::vector<TargetedWrite*>& writes,
     return false;
 }
 
+/**
+ * Helper to determine whether adding a write of the given size would make a targeted batch too big.
+ */
+bool wouldMakeBatchTooBig(const TargetedWriteBatch& batch, int writeSizeBytes) {
+    if (batch.getNumOps() >= write_ops::kMaxWriteBatchSize) {
+        // Too many items in batch
+        return true;
+    }
+
+    if (batch.getEstimatedSizeBytes() + writeSizeBytes > BSONObjMaxUserSize) {
+        // Batch would be too big
+        return true;
+    }
+
+    return false;
+}
+
 /**
  * Helper to determine whether a number of targeted writes require a new targeted batch.
  */
@@ -119,15 +136,7 @@ bool wouldMakeBatchesTooBig(const std::vector<TargetedWrite*>& writes,
             continue;
         }
 
-        const auto& batch = it->second;
-
-        if (batch->getNumOps() >= write_ops::kMaxWriteBatchSize) {
-            // Too many items in batch
-            return true;
-        }
-
-        if (batch->getEstimatedSizeBytes() + writeSizeBytes > BSONObjMaxUserSize) {
-            // Batch would be too big
+        if (wouldMakeBatchTooBig(*it->second, writeSizeBytes)) {
             return true;
         }
     }
@@ -198,6 +207,37 @@ BatchWriteOp::~BatchWriteOp() {
 Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
                                  bool recordTargetErrors,
                                  std::map<ShardId, TargetedWriteBatch*>* targetedBatches) {
+    std::vector<TargetedWriteBatch*> batches;
+    Status targetStatus = _targetWriteOps(targeter, recordTargetErrors, false, &batches);
+
+    for (const auto batch : batches) {
+        invariant(targetedBatches->find(batch->getEndpoint().shardName) == targetedBatches->end());
+        targetedBatches->emplace(batch->getEndpoint().shardName, batch);
+    }
+
+    return targetStatus;
+}
+
+Status BatchWriteOp::targetAllBatches(
+    const NSTargeter& targeter,
+    bool recordTargetErrors,
+    std::map<ShardId, std::vector<TargetedWriteBatch*>>* targetedBatches) {
+    invariant(!_clientRequest.getWriteCommandBase().getOrdered());
+
+    std::vector<TargetedWriteBatch*> batches;
+    Status targetStatus = _targetWriteOps(targeter, recordTargetErrors, true, &batches);
+
+    for (const auto batch : batches) {
+        (*targetedBatches)[batch->getEndpoint().shardName].push_back(batch);
+    }
+
+    return targetStatus;
+}
+
+Status BatchWriteOp::_targetWriteOps(const NSTargeter& targeter,
+                                     bool recordTargetErrors,
+                                     bool startNewBatchesWhenFull,
+                                     std::vector<TargetedWriteBatch*>* targetedBatches) {
     //
     // Targeting of unordered batches is fairly simple - each remaining write op is targeted,
     // and each of those targeted writes are grouped into a batch for a particular shard
@@ -235,6 +275,10 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     TargetedBatchMap batchMap;
 
+    // Batches which reached their maximum size while targeting an unordered batch, in the order in
+    // which they were filled
+    std::vector<TargetedWriteBatch*> fullBatches;
+
     int numTargetErrors = 0;
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
@@ -262,7 +306,10 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
             if (!recordTargetErrors) {
                 // Cancel current batch state with an error
-                _cancelBatches(targetError, std::move(batchMap));
+                for (const auto& entry : batchMap) {
+                    fullBatches.push_back(entry.second);
+                }
+                _cancelBatches(targetError, std::move(fullBatches));
                 return targetStatus;
             } else if (!ordered || batchMap.empty()) {
                 // Record an error for this batch
@@ -304,8 +351,21 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
         if (wouldMakeBatchesTooBig(writes, writeSizeBytes, batchMap)) {
             invariant(!batchMap.empty());
-            writeOp.cancelWrites(nullptr);
-            break;
+
+            if (!startNewBatchesWhenFull) {
+                writeOp.cancelWrites(nullptr);
+                break;
+            }
+
+            // Set the full batches aside, so that the writes start new batches for their endpoints
+            for (const auto write : writes) {
+                TargetedBatchMap::iterator batchIt = batchMap.find(&write->endpoint);
+                if (batchIt != batchMap.end() &&
+                    wouldMakeBatchTooBig(*batchIt->second, writeSizeBytes)) {
+                    fullBatches.push_back(batchIt->second);
+                    batchMap.erase(batchIt);
+                }
+            }
         }
 
         //
@@ -336,12 +396,15 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
     }
 
     //
-    // Send back our targeted batches
+    // Send back our targeted batches, the full ones first so that the batches for each endpoint
+    // are returned in the order in which they were filled
     //
 
     for (TargetedBatchMap::iterator it = batchMap.begin(); it != batchMap.end(); ++it) {
-        TargetedWriteBatch* batch = it->second;
+        fullBatches.push_back(it->second);
+    }
 
+    for (const auto batch : fullBatches) {
         if (batch->getWrites().empty())
             continue;
 
@@ -349,8 +412,7 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         _targeted.insert(batch);
 
         // Send the handle back to caller
-        invariant(targetedBatches->find(batch->getEndpoint().shardName) == targetedBatches->end());
-        targetedBatches->emplace(batch->getEndpoint().shardName, batch);
+        targetedBatches->push_back(batch);
     }
 
     return Status::OK();
@@ -590,6 +652,19 @@ void BatchWriteOp::noteBatchError(const TargetedWriteBatch& targetedBatch,
     noteBatchResponse(targetedBatch, emulatedResponse, nullptr);
 }
 
+void BatchWriteOp::noteBatchNotSent(const TargetedWriteBatch& targetedBatch) {
+    // Stop tracking targeted batch
+    _targeted.erase(&targetedBatch);
+
+    for (const auto write : targetedBatch.getWrites()) {
+        WriteOp& writeOp = _writeOps[write->writeOpRef.first];
+
+        // Cancelling resets all the targeted writes of the op, so it must not have any others
+        invariant(writeOp.getNumTargeted() == 1u);
+        writeOp.cancelWrites(nullptr);
+    }
+}
+
 void BatchWriteOp::abortBatch(const WriteErrorDetail& error) {
     dassert(!isFinished());
     dassert(numWriteOpsIn(WriteOpState_Pending) == 0);
@@ -751,28 +826,16 @@ void BatchWriteOp::_incBatchStats(const BatchedCommandResponse& response) {
 }
 
 void BatchWriteOp::_cancelBatches(const WriteErrorDetail& why,
-                                  TargetedBatchMap&& batchMapToCancel) {
-    TargetedBatchMap batchMap(batchMapToCancel);
-
+                                  std::vector<TargetedWriteBatch*>&& batchesToCancel) {
     // Collect all the writeOps that are currently targeted
-    for (TargetedBatchMap::iterator it = batchMap.begin(); it != batchMap.end();) {
-        TargetedWriteBatch* batch = it->second;
-        const vector<TargetedWrite*>& writes = batch->getWrites();
-
-        for (vector<TargetedWrite*>::const_iterator writeIt = writes.begin();
-             writeIt != writes.end();
-             ++writeIt) {
-            TargetedWrite* write = *writeIt;
-
+    for (const auto batch : batchesToCancel) {
+        for (const auto write : batch->getWrites()) {
             // NOTE: We may repeatedly cancel a write op here, but that's fast and we want to cancel
-            // before erasing the TargetedWrite* (which owns the cancelled targeting info) for
+            // before deleting the TargetedWrite* (which owns the cancelled targeting info) for
             // reporting reasons.
             _writeOps[write->writeOpRef.first].cancelWrites(&why);
         }
 
-        // Note that we need to *erase* first, *then* delete, since the map keys are ptrs from
-        // the values
-        batchMap.erase(it++);
         delete batch;
     }
 }
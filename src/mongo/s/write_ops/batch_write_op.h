@@ -141,6 +141,19 @@ public:
                        bool recordTargetErrors,
                        std::map<ShardId, TargetedWriteBatch*>* targetedBatches);
 
+    /**
+     * Targets all of the remaining write ops of an unordered batch op at once. Unlike targetBatch,
+     * targeting does not stop when the batch for an endpoint reaches the maximum size of a write
+     * command. Further batches are started for that endpoint instead, so each shard gets a queue of
+     * batches, which are meant to be sent in the returned order.
+     *
+     * Targeting errors are handled the same way as by targetBatch. Returned TargetedWriteBatches are
+     * owned by the caller.
+     */
+    Status targetAllBatches(const NSTargeter& targeter,
+                            bool recordTargetErrors,
+                            std::map<ShardId, std::vector<TargetedWriteBatch*>>* targetedBatches);
+
     /**
      * Fills a BatchCommandRequest from a TargetedWriteBatch for this BatchWriteOp.
      */
@@ -164,6 +177,13 @@ public:
      */
     void noteBatchError(const TargetedWriteBatch& targetedBatch, const WriteErrorDetail& error);
 
+    /**
+     * Returns the write ops of a TargetedWriteBatch, which will not be sent after all, to the ready
+     * state so that they get targeted again. Only valid for batches whose write ops were each
+     * targeted to a single endpoint, such as inserts.
+     */
+    void noteBatchNotSent(const TargetedWriteBatch& targetedBatch);
+
     /**
      * Aborts any further writes in the batch with the provided error.  There must be no pending
      * ops awaiting results when a batch is aborted.
@@ -189,15 +209,26 @@ public:
     int numWriteOpsIn(WriteOpState state) const;
 
 private:
+    /**
+     * Implements targetBatch and targetAllBatches. If 'startNewBatchesWhenFull' is true, an
+     * endpoint whose batch is full gets a new batch instead of targeting stopping. The batches for
+     * each endpoint are returned in the order in which they were filled.
+     */
+    Status _targetWriteOps(const NSTargeter& targeter,
+                           bool recordTargetErrors,
+                           bool startNewBatchesWhenFull,
+                           std::vector<TargetedWriteBatch*>* targetedBatches);
+
     /**
      * Maintains the batch execution statistics when a response is received.
      */
     void _incBatchStats(const BatchedCommandResponse& response);
 
     /**
-     * Helper function to cancel all the write ops of targeted batches in a map.
+     * Helper function to cancel all the write ops of a set of targeted batches and delete them.
      */
-    void _cancelBatches(const WriteErrorDetail& why, TargetedBatchMap&& batchMapToCancel);
+    void _cancelBatches(const WriteErrorDetail& why,
+                        std::vector<TargetedWriteBatch*>&& batchesToCancel);
 
     OperationContext* const _opCtx;
 
@@ -1543,5 +1543,65 @@ TEST_F(BatchWriteOpLimitTests, OneBigOneSmall) {
     ASSERT(batchOp.isFinished());
 }
 
+// Unordered inserts which don't fit in one batch are all targeted at once as a queue of batches
+TEST_F(BatchWriteOpLimitTests, TargetAllBatchesQueuesFullBatches) {
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpoint(ShardId("shard"), ChunkVersion::IGNORED());
+    MockNSTargeter targeter;
+    initTargeterFullRange(nss, endpoint, &targeter);
+
+    // Only one of these documents fits in a batch
+    const std::string bigString(BSONObjMaxUserSize / 2, 'x');
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase wcb;
+            wcb.setOrdered(false);
+            return wcb;
+        }());
+        insertOp.setDocuments({BSON("x" << 1 << "data" << bigString),
+                               BSON("x" << 2 << "data" << bigString),
+                               BSON("x" << 3 << "data" << bigString)});
+        return insertOp;
+    }());
+
+    BatchWriteOp batchOp(operationContext(), request);
+
+    std::map<ShardId, std::vector<TargetedWriteBatch*>> targeted;
+    ASSERT_OK(batchOp.targetAllBatches(targeter, false, &targeted));
+    ASSERT_EQUALS(targeted.size(), 1u);
+
+    OwnedPointerVector<TargetedWriteBatch> batchesOwned;
+    batchesOwned.mutableVector() = targeted[endpoint.shardName];
+
+    const auto& batches = batchesOwned.vector();
+    ASSERT_EQUALS(batches.size(), 3u);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQUALS(batches[i]->getWrites().size(), 1u);
+        ASSERT_EQUALS(batches[i]->getWrites().front()->writeOpRef.first, i);
+    }
+
+    BatchedCommandResponse response;
+    buildResponse(1, &response);
+
+    // The last batch is not sent, so its write gets targeted again
+    batchOp.noteBatchResponse(*batches[0], response, NULL);
+    batchOp.noteBatchResponse(*batches[1], response, NULL);
+    batchOp.noteBatchNotSent(*batches[2]);
+    ASSERT(!batchOp.isFinished());
+
+    targeted.clear();
+    ASSERT_OK(batchOp.targetAllBatches(targeter, false, &targeted));
+    ASSERT_EQUALS(targeted.size(), 1u);
+    ASSERT_EQUALS(targeted[endpoint.shardName].size(), 1u);
+
+    std::unique_ptr<TargetedWriteBatch> retargetedBatch(targeted[endpoint.shardName].front());
+    ASSERT_EQUALS(retargetedBatch->getWrites().front()->writeOpRef.first, 2);
+
+    batchOp.noteBatchResponse(*retargetedBatch, response, NULL);
+    ASSERT(batchOp.isFinished());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compression_policy.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+namespace {
+
+// When set, each outgoing message picks its compressor and level with a
+// MessageCompressionPolicy instead of always using the first negotiated compressor.
+MONGO_EXPORT_SERVER_PARAMETER(adaptiveMessageCompression, bool, false);
+
+// Messages smaller than this are sent uncompressed when adaptiveMessageCompression is set.
+MONGO_EXPORT_SERVER_PARAMETER(adaptiveMessageCompressionMinBytes, int, 1024);
+
+// The bandwidth, in megabytes per second, that adaptive compression assumes for every link.
+MONGO_EXPORT_SERVER_PARAMETER(adaptiveMessageCompressionLinkMBps, int, 125);
+
+const std::vector<int>& levelsFor(MessageCompressorId id) {
+    static const std::vector<int> kDefaultOnly{0};
+    static const std::vector<int> kZlibLevels{1, 6};
+    static const std::vector<int> kZstdLevels{1, 3, 9};
+    static const std::vector<int> kZstdDictionaryLevels{1, 3};
+
+    switch (static_cast<MessageCompressor>(id)) {
+        case MessageCompressor::kZlib:
+            return kZlibLevels;
+        case MessageCompressor::kZstd:
+            return kZstdLevels;
+        case MessageCompressor::kZstdDictionary:
+            return kZstdDictionaryLevels;
+        default:
+            return kDefaultOnly;
+    }
+}
+
+// Starting estimates of compression ratio and throughput (in bytes per microsecond, i.e. MB/s) for
+// typical BSON, before a connection has observed any of its own.
+std::pair<double, double> priorFor(MessageCompressorId id, int level) {
+    switch (static_cast<MessageCompressor>(id)) {
+        case MessageCompressor::kNoop:
+            return {1.0, 10000.0};
+        case MessageCompressor::kSnappy:
+            return {0.5, 400.0};
+        case MessageCompressor::kZlib:
+            return level <= 1 ? std::make_pair(0.4, 80.0) : std::make_pair(0.35, 25.0);
+        case MessageCompressor::kZstd:
+            if (level <= 1)
+                return {0.38, 350.0};
+            return level <= 3 ? std::make_pair(0.35, 200.0) : std::make_pair(0.31, 50.0);
+        case MessageCompressor::kZstdDictionary:
+            return level <= 1 ? std::make_pair(0.3, 350.0) : std::make_pair(0.27, 200.0);
+        default:
+            return {0.5, 100.0};
+    }
+}
+
+}  // namespace
+
+bool MessageCompressionPolicy::isEnabled() {
+    return adaptiveMessageCompression.load();
+}
+
+boost::optional<MessageCompressionPolicy::Choice> MessageCompressionPolicy::choose(
+    size_t size, const std::vector<MessageCompressorBase*>& compressors) {
+    if (size < static_cast<size_t>(std::max(adaptiveMessageCompressionMinBytes.load(), 0)))
+        return boost::none;
+
+    const auto sizeClass = _sizeClass(size);
+    const double linkBytesPerMicro = std::max(adaptiveMessageCompressionLinkMBps.load(), 1);
+    const bool explore = (++_messages % kExploreInterval) == 0;
+
+    boost::optional<Choice> best;
+    double bestCost = size / linkBytesPerMicro;
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (auto compressor : compressors) {
+        for (int level : levelsFor(compressor->getId())) {
+            Choice candidate{compressor, level};
+            const auto& estimate = _estimate(candidate, sizeClass);
+            if (explore) {
+                if (estimate.lastUsed < oldest) {
+                    oldest = estimate.lastUsed;
+                    best = candidate;
+                }
+                continue;
+            }
+
+            double cost = size / estimate.bytesPerMicro + size * estimate.ratio / linkBytesPerMicro;
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = candidate;
+            }
+        }
+    }
+
+    if (best)
+        _estimate(*best, sizeClass).lastUsed = _messages;
+    return best;
+}
+
+void MessageCompressionPolicy::observe(const Choice& choice,
+                                       size_t size,
+                                       size_t compressedSize,
+                                       Microseconds elapsed) {
+    if (size == 0)
+        return;
+
+    auto& estimate = _estimate(choice, _sizeClass(size));
+    const double ratio = static_cast<double>(compressedSize) / size;
+    const double bytesPerMicro =
+        size / static_cast<double>(std::max<long long>(durationCount<Microseconds>(elapsed), 1));
+
+    estimate.ratio += (ratio - estimate.ratio) / 8;
+    estimate.bytesPerMicro += (bytesPerMicro - estimate.bytesPerMicro) / 8;
+}
+
+size_t MessageCompressionPolicy::_sizeClass(size_t size) {
+    if (size < 16 * 1024)
+        return 0;
+    return size < 256 * 1024 ? 1 : 2;
+}
+
+MessageCompressionPolicy::Estimate& MessageCompressionPolicy::_estimate(const Choice& choice,
+                                                                        size_t sizeClass) {
+    const Key key{choice.compressor->getId(), choice.level};
+    auto it = _estimates.find(key);
+    if (it == _estimates.end()) {
+        const auto prior = priorFor(key.first, key.second);
+        std::array<Estimate, kNumSizeClasses> estimates;
+        estimates.fill(Estimate{prior.first, prior.second});
+        it = _estimates.emplace(key, estimates).first;
+    }
+    return it->second[sizeClass];
+}
+
+}  // namespace mongo
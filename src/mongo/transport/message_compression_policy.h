@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "mongo/transport/message_compressor_base.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/*
+ * Chooses, for each outgoing message, which of a connection's negotiated compressors to use and
+ * at what level, or whether to send the message uncompressed.
+ *
+ * Every choice is scored by the time it is expected to take to compress a message and put the
+ * result on the wire,
+ *
+ *     size / compressionThroughput + size * compressionRatio / linkBandwidth,
+ *
+ * against size / linkBandwidth for sending the message as is. The link bandwidth comes from the
+ * adaptiveMessageCompressionLinkMBps server parameter. Ratios and throughputs start from rough
+ * priors for each algorithm and level and follow moving averages of what the connection actually
+ * observes, kept separately for small, medium and large messages. Every kExploreInterval
+ * messages the least recently used choice is tried instead of the cheapest one, so that its
+ * estimates do not go stale.
+ *
+ * Like the MessageCompressorManager that owns it, a policy belongs to a single connection and is
+ * not thread-safe.
+ */
+class MessageCompressionPolicy {
+public:
+    struct Choice {
+        MessageCompressorBase* compressor;
+        int level;
+    };
+
+    // One message in this many is compressed with the least recently used choice.
+    static constexpr uint64_t kExploreInterval = 64;
+
+    /*
+     * Returns true if the adaptiveMessageCompression server parameter is set.
+     */
+    static bool isEnabled();
+
+    /*
+     * Returns how to compress a message of 'size' bytes with one of 'compressors', or boost::none
+     * if it should be sent uncompressed.
+     */
+    boost::optional<Choice> choose(size_t size,
+                                   const std::vector<MessageCompressorBase*>& compressors);
+
+    /*
+     * Records that compressing a message of 'size' bytes as 'choice' produced 'compressedSize'
+     * bytes in 'elapsed'.
+     */
+    void observe(const Choice& choice, size_t size, size_t compressedSize, Microseconds elapsed);
+
+private:
+    static constexpr size_t kNumSizeClasses = 3;
+
+    struct Estimate {
+        double ratio;
+        double bytesPerMicro;
+        uint64_t lastUsed = 0;
+    };
+
+    using Key = std::pair<MessageCompressorId, int>;
+
+    static size_t _sizeClass(size_t size);
+
+    Estimate& _estimate(const Choice& choice, size_t sizeClass);
+
+    std::map<Key, std::array<Estimate, kNumSizeClasses>> _estimates;
+    uint64_t _messages = 0;
+};
+
+}  // namespace mongo
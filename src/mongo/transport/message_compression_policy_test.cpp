@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compression_policy.h"
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/message_compressor_snappy.h"
+#include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// Sets a server parameter for the lifetime of the object.
+class ScopedServerParameter {
+public:
+    ScopedServerParameter(StringData name, StringData value) : _parameter(_find(name)) {
+        BSONObjBuilder builder;
+        _parameter->append(nullptr, builder, "value");
+        _original = builder.obj();
+        ASSERT_OK(_parameter->setFromString(value.toString()));
+    }
+
+    ~ScopedServerParameter() {
+        _parameter->set(_original["value"]).transitional_ignore();
+    }
+
+private:
+    static ServerParameter* _find(StringData name) {
+        const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+        auto it = parameters.find(name.toString());
+        invariant(it != parameters.end());
+        return it->second;
+    }
+
+    ServerParameter* _parameter;
+    BSONObj _original;
+};
+
+class MessageCompressionPolicyTest : public unittest::Test {
+private:
+    ScopedServerParameter _enabled{"adaptiveMessageCompression", "true"};
+
+protected:
+    SnappyMessageCompressor snappy;
+    ZlibMessageCompressor zlib;
+    std::vector<MessageCompressorBase*> compressors{&snappy, &zlib};
+    MessageCompressionPolicy policy;
+};
+
+const size_t kMessageSize = 64 * 1024;
+
+TEST_F(MessageCompressionPolicyTest, SmallMessagesAreSentUncompressed) {
+    ScopedServerParameter minBytes("adaptiveMessageCompressionMinBytes", "4096");
+    ASSERT_FALSE(policy.choose(4095, compressors));
+    ASSERT_TRUE(policy.choose(4096, compressors));
+}
+
+TEST_F(MessageCompressionPolicyTest, FastLinkSendsUncompressed) {
+    ScopedServerParameter link("adaptiveMessageCompressionLinkMBps", "100000");
+    ASSERT_FALSE(policy.choose(kMessageSize, compressors));
+}
+
+TEST_F(MessageCompressionPolicyTest, TypicalLinkPrefersFastCompressor) {
+    auto choice = policy.choose(kMessageSize, compressors);
+    ASSERT_TRUE(choice);
+    ASSERT_EQ(choice->compressor, &snappy);
+}
+
+TEST_F(MessageCompressionPolicyTest, SlowLinkPrefersSmallerOutput) {
+    ScopedServerParameter link("adaptiveMessageCompressionLinkMBps", "1");
+    auto choice = policy.choose(kMessageSize, compressors);
+    ASSERT_TRUE(choice);
+    ASSERT_EQ(choice->compressor, &zlib);
+    ASSERT_EQ(choice->level, 6);
+}
+
+TEST_F(MessageCompressionPolicyTest, ObservationsOverridePriors) {
+    // zlib at level 1 turns out to be both fast and very effective on this connection's data.
+    MessageCompressionPolicy::Choice zlibFast{&zlib, 1};
+    for (int i = 0; i < 32; ++i) {
+        policy.observe(zlibFast, kMessageSize, kMessageSize / 20, Microseconds(100));
+    }
+
+    auto choice = policy.choose(kMessageSize, compressors);
+    ASSERT_TRUE(choice);
+    ASSERT_EQ(choice->compressor, &zlib);
+    ASSERT_EQ(choice->level, 1);
+
+    // Observations of large messages say nothing about small ones.
+    choice = policy.choose(2048, compressors);
+    ASSERT_TRUE(choice);
+    ASSERT_EQ(choice->compressor, &snappy);
+}
+
+TEST_F(MessageCompressionPolicyTest, PeriodicallyExploresOtherChoices) {
+    for (uint64_t i = 1; i < MessageCompressionPolicy::kExploreInterval; ++i) {
+        auto choice = policy.choose(kMessageSize, compressors);
+        ASSERT_TRUE(choice);
+        ASSERT_EQ(choice->compressor, &snappy);
+    }
+
+    auto choice = policy.choose(kMessageSize, compressors);
+    ASSERT_TRUE(choice);
+    ASSERT_EQ(choice->compressor, &zlib);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -40,6 +40,8 @@ enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
+    kZstd = 3,
+    kZstdDictionary = 4,
     kExtended = 255,
 };
 
@@ -79,6 +81,16 @@ public:
      */
     virtual StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) = 0;
 
+    /*
+     * Like compressData, but at the given compression level. Compressors that don't have levels
+     * ignore it.
+     */
+    virtual StatusWith<std::size_t> compressDataAtLevel(ConstDataRange input,
+                                                        DataRange output,
+                                                        int level) {
+        return compressData(input, output);
+    }
+
     /*
      * This method decompresses the data in the input ConstDataRange into the output DataRange.
      * It returns the number of bytes actually decompressed into the output range, or an error
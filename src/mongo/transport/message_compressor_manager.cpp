@@ -40,6 +40,7 @@
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -93,7 +94,17 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     const Message& msg, const MessageCompressorId* compressorId) {
 
     MessageCompressorBase* compressor = nullptr;
-    if (compressorId) {
+    boost::optional<MessageCompressionPolicy::Choice> choice;
+    if (!_negotiated.empty() && MessageCompressionPolicy::isEnabled()) {
+        // Every negotiated compressor was offered by the peer, so the policy is free to pick any
+        // of them regardless of which one compressed the message being replied to.
+        choice = _policy.choose(msg.dataSize(), _negotiated);
+        if (!choice) {
+            LOG(3) << "Sending message of " << msg.dataSize() << " bytes uncompressed";
+            return {msg};
+        }
+        compressor = choice->compressor;
+    } else if (compressorId) {
         compressor = _registry->getCompressor(*compressorId);
         invariant(compressor);
     } else if (!_negotiated.empty()) {
@@ -129,12 +140,17 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
-    auto sws = compressor->compressData(input, output);
+    Timer timer;
+    auto sws = choice ? compressor->compressDataAtLevel(input, output, choice->level)
+                      : compressor->compressData(input, output);
 
     if (!sws.isOK())
         return sws.getStatus();
 
     auto realCompressedSize = sws.getValue();
+    if (choice) {
+        _policy.observe(*choice, input.length(), realCompressedSize, timer.elapsed());
+    }
     outMessage.setLen(realCompressedSize + CompressionHeader::size() + MsgData::MsgDataHeaderSize);
 
     return {Message(outputMessageBuffer)};
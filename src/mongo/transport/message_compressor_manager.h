@@ -30,6 +30,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
+#include "mongo/transport/message_compression_policy.h"
 #include "mongo/transport/message_compressor_base.h"
 #include "mongo/transport/session.h"
 
@@ -95,6 +96,10 @@ public:
      * given identifier. It is intended that this value echo back a value returned as the out
      * parameter value for compressorId from a call to decompressMessage.
      *
+     * If the adaptiveMessageCompression server parameter is set, the compressor and level are
+     * instead chosen among the negotiated compressors by a MessageCompressionPolicy, which may
+     * also decide to return the input message uncompressed.
+     *
      * If _negotiated is empty (meaning compression was not negotiated or is not supported), then
      * it will return a ref-count bumped copy of the input message.
      *
@@ -128,6 +133,7 @@ public:
 private:
     std::vector<MessageCompressorBase*> _negotiated;
     MessageCompressorRegistry* _registry;
+    MessageCompressionPolicy _policy;
 };
 
 }  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/transport/message_compressor_zstd.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
@@ -241,6 +242,30 @@ TEST(ZlibMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
 }
 
+TEST(ZstdMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZstdMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, DictionaryFidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage,
+                  uassertStatusOK(ZstdMessageCompressor::makeWithDictionary(
+                      std::string(1024, 'a') + "bcdefgh")));
+}
+
+TEST(ZstdMessageCompressor, RejectsCorruptDictionary) {
+    // The magic number of a trained dictionary, followed by tables zstd can't make sense of.
+    std::string dictionary("\x37\xa4\x30\xec", 4);
+    dictionary.append(60, '\xff');
+    ASSERT_EQ(ZstdMessageCompressor::makeWithDictionary(std::move(dictionary)).getStatus(),
+              ErrorCodes::BadValue);
+}
+
+TEST(ZstdMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZstdMessageCompressor>());
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
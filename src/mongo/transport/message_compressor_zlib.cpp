@@ -47,12 +47,18 @@ std::size_t ZlibMessageCompressor::getMaxCompressedSize(size_t inputSize) {
 
 StatusWith<std::size_t> ZlibMessageCompressor::compressData(ConstDataRange input,
                                                             DataRange output) {
+    return compressDataAtLevel(input, output, Z_DEFAULT_COMPRESSION);
+}
+
+StatusWith<std::size_t> ZlibMessageCompressor::compressDataAtLevel(ConstDataRange input,
+                                                                   DataRange output,
+                                                                   int level) {
     size_t outLength = output.length();
     int ret = ::compress2(const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data())),
                           reinterpret_cast<uLongf*>(&outLength),
                           reinterpret_cast<const Bytef*>(input.data()),
                           input.length(),
-                          Z_DEFAULT_COMPRESSION);
+                          level);
 
     if (ret != Z_OK) {
         return Status{ErrorCodes::BadValue, "Could not compress input"};
@@ -37,6 +37,10 @@ public:
 
     StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
 
+    StatusWith<std::size_t> compressDataAtLevel(ConstDataRange input,
+                                                DataRange output,
+                                                int level) override;
+
     StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
 };
 
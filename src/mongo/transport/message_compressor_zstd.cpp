@@ -0,0 +1,270 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd.h"
+
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include "mongo/base/init.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+#include <zstd.h>
+
+namespace mongo {
+namespace {
+
+// Path to a dictionary trained with `zstd --train` on representative messages. When set, the
+// "zstd-dictionary" compressor is registered alongside "zstd".
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(zstdMessageCompressionDictionaryPath, std::string, "");
+
+struct CCtxDeleter {
+    void operator()(ZSTD_CCtx* cctx) const {
+        ZSTD_freeCCtx(cctx);
+    }
+};
+
+struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* dctx) const {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+// Compressors are shared by every connection, so each thread keeps its own zstd contexts rather
+// than allocating them for every message.
+ZSTD_CCtx* getThreadCompressionContext() {
+    static thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx;
+    if (!cctx) {
+        cctx.reset(ZSTD_createCCtx());
+    }
+    return cctx.get();
+}
+
+ZSTD_DCtx* getThreadDecompressionContext() {
+    static thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx;
+    if (!dctx) {
+        dctx.reset(ZSTD_createDCtx());
+    }
+    return dctx.get();
+}
+
+}  // namespace
+
+/*
+ * The digested forms of a dictionary. zstd bakes the compression level into a digested compression
+ * dictionary, so beyond the default level one is made the first time each level is asked for.
+ */
+class ZstdMessageCompressor::Dictionary {
+public:
+    explicit Dictionary(std::string raw)
+        : _raw(std::move(raw)), _ddict(ZSTD_createDDict(_raw.data(), _raw.size())) {
+        _cdicts[kDefaultLevel] = ZSTD_createCDict(_raw.data(), _raw.size(), kDefaultLevel);
+    }
+
+    ~Dictionary() {
+        for (auto&& entry : _cdicts) {
+            ZSTD_freeCDict(entry.second);
+        }
+        ZSTD_freeDDict(_ddict);
+    }
+
+    const ZSTD_CDict* forCompression(int level) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto& cdict = _cdicts[level];
+        if (!cdict) {
+            cdict = ZSTD_createCDict(_raw.data(), _raw.size(), level);
+        }
+        return cdict;
+    }
+
+    const ZSTD_DDict* forDecompression() const {
+        return _ddict;
+    }
+
+    /**
+     * Returns whether zstd could digest the dictionary. It can't when the dictionary has the header
+     * of a trained dictionary but its tables are corrupt, or when it runs out of memory.
+     */
+    bool isValid() const {
+        return _ddict && _cdicts.at(kDefaultLevel);
+    }
+
+private:
+    const std::string _raw;
+    ZSTD_DDict* const _ddict;
+
+    stdx::mutex _mutex;
+    std::map<int, ZSTD_CDict*> _cdicts;
+};
+
+ZstdMessageCompressor::ZstdMessageCompressor() : MessageCompressorBase(MessageCompressor::kZstd) {}
+
+ZstdMessageCompressor::ZstdMessageCompressor(std::unique_ptr<Dictionary> dictionary)
+    : MessageCompressorBase(MessageCompressor::kZstdDictionary),
+      _dictionary(std::move(dictionary)) {}
+
+ZstdMessageCompressor::~ZstdMessageCompressor() = default;
+
+StatusWith<std::unique_ptr<ZstdMessageCompressor>> ZstdMessageCompressor::makeWithDictionary(
+    std::string dictionary) {
+    auto digested = stdx::make_unique<Dictionary>(std::move(dictionary));
+    if (!digested->isValid()) {
+        return Status(ErrorCodes::BadValue, "Could not load the zstd dictionary");
+    }
+    return std::unique_ptr<ZstdMessageCompressor>(new ZstdMessageCompressor(std::move(digested)));
+}
+
+std::size_t ZstdMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize);
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::compressData(ConstDataRange input,
+                                                            DataRange output) {
+    return compressDataAtLevel(input, output, kDefaultLevel);
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::compressDataAtLevel(ConstDataRange input,
+                                                                   DataRange output,
+                                                                   int level) {
+    auto cctx = getThreadCompressionContext();
+    if (!cctx) {
+        return Status{ErrorCodes::ExceededMemoryLimit, "Could not allocate a zstd context"};
+    }
+
+    size_t ret;
+    if (_dictionary) {
+        auto cdict = _dictionary->forCompression(level);
+        if (!cdict) {
+            return Status{ErrorCodes::BadValue, "Could not load the zstd dictionary"};
+        }
+        ret = ZSTD_compress_usingCDict(cctx,
+                                       const_cast<char*>(output.data()),
+                                       output.length(),
+                                       input.data(),
+                                       input.length(),
+                                       cdict);
+    } else {
+        ret = ZSTD_compressCCtx(cctx,
+                                const_cast<char*>(output.data()),
+                                output.length(),
+                                input.data(),
+                                input.length(),
+                                level);
+    }
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: " << ZSTD_getErrorName(ret)};
+    }
+    counterHitCompress(input.length(), ret);
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::decompressData(ConstDataRange input,
+                                                              DataRange output) {
+    auto dctx = getThreadDecompressionContext();
+    if (!dctx) {
+        return Status{ErrorCodes::ExceededMemoryLimit, "Could not allocate a zstd context"};
+    }
+
+    size_t ret;
+    if (_dictionary) {
+        ret = ZSTD_decompress_usingDDict(dctx,
+                                         const_cast<char*>(output.data()),
+                                         output.length(),
+                                         input.data(),
+                                         input.length(),
+                                         _dictionary->forDecompression());
+    } else {
+        ret = ZSTD_decompressDCtx(dctx,
+                                  const_cast<char*>(output.data()),
+                                  output.length(),
+                                  input.data(),
+                                  input.length());
+    }
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Compressed message was invalid or corrupted: "
+                                    << ZSTD_getErrorName(ret)};
+    }
+
+    counterHitDecompress(input.length(), ret);
+    return {ret};
+}
+
+
+MONGO_INITIALIZER_GENERAL(ZstdMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(stdx::make_unique<ZstdMessageCompressor>());
+
+    if (zstdMessageCompressionDictionaryPath.empty()) {
+        return Status::OK();
+    }
+
+    std::ifstream file(zstdMessageCompressionDictionaryPath, std::ios::in | std::ios::binary);
+    if (!file) {
+        return Status(ErrorCodes::FileNotOpen,
+                      str::stream() << "Could not open zstd dictionary "
+                                    << zstdMessageCompressionDictionaryPath);
+    }
+
+    std::string dictionary{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (dictionary.empty()) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "zstd dictionary " << zstdMessageCompressionDictionaryPath
+                                    << " is empty");
+    }
+
+    const auto dictionaryId = ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+    auto swCompressor = ZstdMessageCompressor::makeWithDictionary(std::move(dictionary));
+    if (!swCompressor.isOK()) {
+        return Status(swCompressor.getStatus().code(),
+                      str::stream() << "zstd dictionary " << zstdMessageCompressionDictionaryPath
+                                    << " is invalid: " << swCompressor.getStatus().reason());
+    }
+
+    log() << "Loaded zstd message compression dictionary " << dictionaryId << " from "
+          << zstdMessageCompressionDictionaryPath;
+    compressorRegistry.registerImplementation(std::move(swCompressor.getValue()));
+    return Status::OK();
+}
+}  // namespace mongo
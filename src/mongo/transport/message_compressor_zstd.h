@@ -0,0 +1,79 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mongo/transport/message_compressor_base.h"
+
+namespace mongo {
+
+/*
+ * Compresses messages with zstd.
+ *
+ * Constructed with a pre-trained dictionary, it registers as the "zstd-dictionary" compressor
+ * instead and compresses and decompresses every message against that dictionary, which gives much
+ * better ratios on small, repetitive messages. Every peer that negotiates "zstd-dictionary" must
+ * be configured with the same dictionary.
+ */
+class ZstdMessageCompressor final : public MessageCompressorBase {
+public:
+    // The level compressData uses, which is also zstd's own default.
+    static constexpr int kDefaultLevel = 3;
+
+    ZstdMessageCompressor();
+    ~ZstdMessageCompressor();
+
+    /**
+     * Returns a "zstd-dictionary" compressor for the pre-trained 'dictionary', or an error if zstd
+     * can't load it.
+     */
+    static StatusWith<std::unique_ptr<ZstdMessageCompressor>> makeWithDictionary(
+        std::string dictionary);
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> compressDataAtLevel(ConstDataRange input,
+                                                DataRange output,
+                                                int level) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+private:
+    class Dictionary;
+
+    explicit ZstdMessageCompressor(std::unique_ptr<Dictionary> dictionary);
+
+    const std::unique_ptr<Dictionary> _dictionary;
+};
+
+}  // namespace mongo
@@ -0,0 +1,551 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_per_core.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/transport/thread_idle_callback.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// The number of reactors of the executor. If the value is -1 (the default), then it will be set
+// to the number of available cores.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(perCoreServiceExecutorReactors, int, -1);
+
+// Idle reactors steal tasks from the queues of their peers, which hold at least this many tasks.
+// A value of 0 disables stealing.
+MONGO_EXPORT_SERVER_PARAMETER(perCoreServiceExecutorStealThreshold, int, 2);
+
+// Tasks scheduled with MayRecurse may be called recursively if the recursion depth is below this
+// value.
+MONGO_EXPORT_SERVER_PARAMETER(perCoreServiceExecutorRecursionLimit, int, 8);
+
+// A reactor, all of whose threads are running tasks, none of which finished for this long, gets a
+// helper thread started to run its other connections.
+MONGO_EXPORT_SERVER_PARAMETER(perCoreServiceExecutorStuckThreadTimeoutMillis, int, 250);
+
+// The longest a reactor without work sleeps before checking whether it can steal
+const auto kIdleWaitTime = Milliseconds(100);
+
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kThreadsInUse = "threadsInUse"_sd;
+constexpr auto kHelpersStarted = "helpersStarted"_sd;
+constexpr auto kReactors = "reactors"_sd;
+constexpr auto kQueueDepth = "queueDepth"_sd;
+constexpr auto kTasksExecuted = "tasksExecuted"_sd;
+constexpr auto kTasksStolen = "tasksStolen"_sd;
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "perCore"_sd;
+
+struct ServerParameterOptions : public ServiceExecutorPerCore::Options {
+    int stealThreshold() const final {
+        return perCoreServiceExecutorStealThreshold.load();
+    }
+
+    int recursionLimit() const final {
+        return perCoreServiceExecutorRecursionLimit.load();
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return Milliseconds{perCoreServiceExecutorStuckThreadTimeoutMillis.load()};
+    }
+};
+
+Milliseconds ticksToMillis(TickSource::Tick ticks, TickSource* tickSource) {
+    invariant(tickSource->getTicksPerSecond() >= 1000);
+    return Milliseconds{ticks / (tickSource->getTicksPerSecond() / 1000)};
+}
+
+/**
+ * Pins the current thread to the index'th of the cores it may run on, modulo their number.
+ */
+void pinThreadToCore(size_t index) {
+#ifdef __linux__
+    cpu_set_t available;
+    CPU_ZERO(&available);
+    if (sched_getaffinity(0, sizeof(available), &available) != 0) {
+        LOG(1) << "Unable to get the cores available to reactor " << index << ": "
+               << errnoWithDescription();
+        return;
+    }
+
+    const int numAvailable = CPU_COUNT(&available);
+    if (numAvailable == 0) {
+        return;
+    }
+
+    int remaining = index % numAvailable;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &available) || remaining-- > 0) {
+            continue;
+        }
+
+        cpu_set_t pinned;
+        CPU_ZERO(&pinned);
+        CPU_SET(cpu, &pinned);
+        const int err = pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned);
+        if (err != 0) {
+            LOG(1) << "Unable to pin reactor " << index << " to core " << cpu << ": "
+                   << errnoWithDescription(err);
+        }
+        return;
+    }
+#endif
+}
+
+}  // namespace
+
+thread_local ServiceExecutorPerCore::Reactor* ServiceExecutorPerCore::_localReactor = nullptr;
+thread_local int ServiceExecutorPerCore::_localRecursionDepth = 0;
+thread_local int64_t ServiceExecutorPerCore::_localThreadIdleCounter = 0;
+
+int ServiceExecutorPerCore::Reactor::push(Task task) {
+    int depth;
+    {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        queue.push_back(std::move(task));
+        depth = queueDepth.addAndFetch(1);
+    }
+
+    // The reactor marks itself sleeping before checking its queue a last time, so either it sees
+    // the new task or it is woken up here
+    if (sleeping.load() > 0) {
+        wakeUp();
+    }
+    return depth;
+}
+
+bool ServiceExecutorPerCore::Reactor::pop(Task* task) {
+    if (queueDepth.load() == 0) {
+        return false;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(mutex);
+    if (queue.empty()) {
+        return false;
+    }
+
+    *task = std::move(queue.front());
+    queue.pop_front();
+    queueDepth.subtractAndFetch(1);
+    return true;
+}
+
+void ServiceExecutorPerCore::Reactor::wakeUp() {
+    ioContext->post([] {});
+}
+
+bool ServiceExecutorPerCore::Reactor::retireHelper() {
+    auto running = threadsRunning.load();
+    while (threadsInUse.load() < running - 1) {
+        const auto observed = threadsRunning.compareAndSwap(running, running - 1);
+        if (observed == running) {
+            return true;
+        }
+        running = observed;
+    }
+    return false;
+}
+
+int ServiceExecutorPerCore::configuredNumReactors() {
+    int value = perCoreServiceExecutorReactors;
+    if (value <= 0) {
+        ProcessInfo pi;
+        value = pi.getNumAvailableCores().value_or(pi.getNumCores());
+        value = std::max(value, 1);
+        perCoreServiceExecutorReactors = value;
+        log() << "No reactor count configured for executor. Using number of cores: " << value;
+    }
+    return value;
+}
+
+ServiceExecutorPerCore::ServiceExecutorPerCore(
+    ServiceContext* ctx, std::vector<std::shared_ptr<asio::io_context>> ioContexts)
+    : ServiceExecutorPerCore(
+          ctx, std::move(ioContexts), stdx::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorPerCore::ServiceExecutorPerCore(
+    ServiceContext* ctx,
+    std::vector<std::shared_ptr<asio::io_context>> ioContexts,
+    std::unique_ptr<Options> config)
+    : _config(std::move(config)), _tickSource(ctx->getTickSource()) {
+    invariant(!ioContexts.empty());
+    for (auto& ioContext : ioContexts) {
+        _reactors.emplace_back(stdx::make_unique<Reactor>(_reactors.size(), std::move(ioContext)));
+    }
+}
+
+ServiceExecutorPerCore::~ServiceExecutorPerCore() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorPerCore::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    for (auto& reactor : _reactors) {
+        reactor->lastProgressTick.store(_tickSource->getTicks());
+        auto status = _startReactorThread(reactor.get(), false);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    _controllerThread = stdx::thread(&ServiceExecutorPerCore::_controllerThreadRoutine, this);
+    return Status::OK();
+}
+
+Status ServiceExecutorPerCore::_startReactorThread(Reactor* reactor, bool isHelper) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_shutdownMutex);
+        ++_numRunningThreads;
+    }
+    reactor->threadsRunning.addAndFetch(1);
+
+    auto status = launchServiceWorkerThread(
+        [this, reactor, isHelper] { _reactorThreadRoutine(reactor, isHelper); });
+    if (!status.isOK()) {
+        reactor->threadsRunning.subtractAndFetch(1);
+        stdx::lock_guard<stdx::mutex> lk(_shutdownMutex);
+        if (--_numRunningThreads == 0) {
+            _shutdownCondition.notify_all();
+        }
+    }
+    return status;
+}
+
+Status ServiceExecutorPerCore::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_shutdownMutex);
+        _controllerCondition.notify_one();
+    }
+    if (_controllerThread.joinable()) {
+        _controllerThread.join();
+    }
+
+    for (auto& reactor : _reactors) {
+        reactor->ioContext->stop();
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_shutdownMutex);
+    bool result = _shutdownCondition.wait_for(
+        lk, timeout.toSystemDuration(), [this] { return _numRunningThreads == 0; });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "per-core executor couldn't shutdown all reactor threads within time limit.");
+}
+
+Status ServiceExecutorPerCore::schedule(Task task,
+                                        ScheduleFlags flags,
+                                        ServiceExecutorTaskName taskName) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    _totalQueued.addAndFetch(1);
+
+    // Tasks scheduled from a reactor thread belong to a connection the reactor is running, keep
+    // them on it
+    auto reactor = _currentReactor();
+    if (reactor) {
+        if ((flags & kMayYieldBeforeSchedule) && (_localThreadIdleCounter++ & 0xf) == 0) {
+            markThreadIdle();
+        }
+
+        if ((flags & kMayRecurse) && (_localRecursionDepth < _config->recursionLimit())) {
+            _runTask(reactor, task);
+            return Status::OK();
+        }
+    } else {
+        reactor = _pickReactor();
+    }
+
+    const auto depth = reactor->push(std::move(task));
+
+    const auto stealThreshold = _config->stealThreshold();
+    if (stealThreshold > 0 && depth >= stealThreshold) {
+        _wakeUpThief(reactor);
+    }
+
+    return Status::OK();
+}
+
+void ServiceExecutorPerCore::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+
+    long long totalExecuted = 0;
+    long long totalStolen = 0;
+    long long helpersStarted = 0;
+    int threadsRunning = 0;
+    for (const auto& reactor : _reactors) {
+        totalExecuted += reactor->tasksExecuted.load();
+        totalStolen += reactor->tasksStolen.load();
+        helpersStarted += reactor->helpersStarted.load();
+        threadsRunning += reactor->threadsRunning.load();
+    }
+
+    section << kExecutorLabel << kExecutorName       //
+            << kTotalQueued << _totalQueued.load()   //
+            << kTotalExecuted << totalExecuted       //
+            << kTotalStolen << totalStolen           //
+            << kHelpersStarted << helpersStarted     //
+            << kThreadsRunning << threadsRunning;
+
+    BSONArrayBuilder reactors(section.subarrayStart(kReactors));
+    for (const auto& reactor : _reactors) {
+        BSONObjBuilder reactorSection(reactors.subobjStart());
+        reactorSection << kQueueDepth << reactor->queueDepth.load()         //
+                       << kTasksExecuted << reactor->tasksExecuted.load()  //
+                       << kTasksStolen << reactor->tasksStolen.load()      //
+                       << kThreadsRunning << reactor->threadsRunning.load()  //
+                       << kThreadsInUse << reactor->threadsInUse.load();
+        reactorSection.doneFast();
+    }
+    reactors.doneFast();
+
+    section.doneFast();
+}
+
+void ServiceExecutorPerCore::_reactorThreadRoutine(Reactor* reactor, bool isHelper) {
+    _localReactor = reactor;
+    {
+        std::string threadName = str::stream() << "reactor-" << reactor->index
+                                               << (isHelper ? "-helper" : "");
+        setThreadName(threadName);
+    }
+
+    // Helpers run while the pinned thread of the reactor is blocked, leave them to the scheduler
+    if (isHelper) {
+        log() << "Started new helper thread for database reactor " << reactor->index;
+    } else {
+        pinThreadToCore(reactor->index);
+        log() << "Started new database reactor thread " << reactor->index;
+    }
+
+    bool retired = false;
+    const auto guard = MakeGuard([this, reactor, &retired] {
+        if (!retired) {
+            reactor->threadsRunning.subtractAndFetch(1);
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_shutdownMutex);
+        if (--_numRunningThreads == 0) {
+            _shutdownCondition.notify_all();
+        }
+    });
+
+    auto& ioContext = *reactor->ioContext;
+    asio::io_context::work work(ioContext);
+
+    Task task;
+    while (_isRunning.load()) {
+        try {
+            // Run the network completions first, they produce the tasks of their connections
+            ioContext.poll();
+
+            if (reactor->pop(&task) || _steal(reactor, &task)) {
+                _runTask(reactor, task);
+                task = nullptr;
+                continue;
+            }
+
+            // Announce that the reactor is about to sleep before checking its queue a last time,
+            // so that tasks pushed concurrently either are seen here or wake it up
+            size_t handlersRun = 1;
+            {
+                reactor->sleeping.addAndFetch(1);
+                const auto sleepingGuard =
+                    MakeGuard([reactor] { reactor->sleeping.subtractAndFetch(1); });
+                if (reactor->queueDepth.load() == 0) {
+                    handlersRun = ioContext.run_one_for(kIdleWaitTime.toSystemDuration());
+                }
+            }
+
+            // A helper, which stayed idle, is no longer needed once another thread of its
+            // reactor is idle too
+            if (isHelper && handlersRun == 0 && reactor->retireHelper()) {
+                retired = true;
+                LOG(1) << "Retiring helper thread of database reactor " << reactor->index;
+                return;
+            }
+        } catch (...) {
+            // The reactor is pinned to its core, so rather than replacing the thread like the
+            // adaptive executor does, keep running its loop
+            log() << "Exception escaped reactor thread " << reactor->index << ": "
+                  << exceptionToStatus();
+            task = nullptr;
+        }
+    }
+}
+
+void ServiceExecutorPerCore::_controllerThreadRoutine() {
+    setThreadName("reactor-controller"_sd);
+
+    stdx::unique_lock<stdx::mutex> lk(_shutdownMutex);
+    while (_isRunning.load()) {
+        const auto stuckThreadTimeout = _config->stuckThreadTimeout();
+        _controllerCondition.wait_for(
+            lk, stuckThreadTimeout.toSystemDuration(), [this] { return !_isRunning.load(); });
+        if (!_isRunning.load()) {
+            break;
+        }
+
+        lk.unlock();
+        for (auto& reactor : _reactors) {
+            // If all the threads of the reactor are running tasks and none of them finished one
+            // within the timeout, then they are blocked and the other connections of the reactor
+            // need another thread to make progress
+            if (reactor->threadsInUse.load() < reactor->threadsRunning.load()) {
+                continue;
+            }
+
+            const auto now = _tickSource->getTicks();
+            const auto sinceLastProgress =
+                ticksToMillis(now - reactor->lastProgressTick.load(), _tickSource);
+            if (sinceLastProgress < stuckThreadTimeout) {
+                continue;
+            }
+
+            log() << "Detected blocked threads of database reactor " << reactor->index
+                  << ", starting new thread to unblock it";
+
+            // Give the helper a full timeout to make progress before starting another one
+            reactor->lastProgressTick.store(now);
+            auto status = _startReactorThread(reactor.get(), true);
+            if (status.isOK()) {
+                reactor->helpersStarted.addAndFetch(1);
+            } else {
+                log() << "Unable to start helper thread for database reactor " << reactor->index
+                      << ": " << status;
+            }
+        }
+        lk.lock();
+    }
+}
+
+void ServiceExecutorPerCore::_runTask(Reactor* reactor, const Task& task) {
+    // Only the outermost task occupies the thread, recursive ones run within it
+    const bool isOutermost = (_localRecursionDepth++ == 0);
+    if (isOutermost) {
+        reactor->threadsInUse.addAndFetch(1);
+    }
+    const auto guard = MakeGuard([this, reactor, isOutermost] {
+        --_localRecursionDepth;
+        if (isOutermost) {
+            reactor->lastProgressTick.store(_tickSource->getTicks());
+            reactor->threadsInUse.subtractAndFetch(1);
+        }
+    });
+
+    task();
+    reactor->tasksExecuted.addAndFetch(1);
+}
+
+bool ServiceExecutorPerCore::_steal(Reactor* thief, Task* task) {
+    const auto stealThreshold = _config->stealThreshold();
+    if (stealThreshold <= 0) {
+        return false;
+    }
+
+    Reactor* victim = nullptr;
+    int victimDepth = stealThreshold - 1;
+    for (auto& reactor : _reactors) {
+        const auto depth = reactor->queueDepth.load();
+        if (reactor.get() != thief && depth > victimDepth) {
+            victim = reactor.get();
+            victimDepth = depth;
+        }
+    }
+
+    if (!victim || !victim->pop(task)) {
+        return false;
+    }
+
+    thief->tasksStolen.addAndFetch(1);
+    return true;
+}
+
+void ServiceExecutorPerCore::_wakeUpThief(Reactor* reactor) {
+    for (auto& peer : _reactors) {
+        if (peer.get() != reactor && peer->sleeping.load() > 0) {
+            peer->wakeUp();
+            return;
+        }
+    }
+}
+
+ServiceExecutorPerCore::Reactor* ServiceExecutorPerCore::_currentReactor() const {
+    auto reactor = _localReactor;
+    if (reactor && reactor->index < _reactors.size() &&
+        _reactors[reactor->index].get() == reactor) {
+        return reactor;
+    }
+    return nullptr;
+}
+
+ServiceExecutorPerCore::Reactor* ServiceExecutorPerCore::_pickReactor() {
+    // Of two consecutive reactors in round robin order pick the one with the shorter queue
+    const auto next = _nextReactor.fetchAndAdd(1);
+    auto first = _reactors[next % _reactors.size()].get();
+    auto second = _reactors[(next + 1) % _reactors.size()].get();
+    return second->queueDepth.load() < first->queueDepth.load() ? second : first;
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,228 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_task_names.h"
+#include "mongo/util/tick_source.h"
+
+namespace asio {
+class io_context;
+}  // namespace asio
+
+namespace mongo {
+namespace transport {
+
+/**
+ * An ASIO-based ServiceExecutor, which runs a fixed number of reactors, each of which is a worker
+ * thread pinned to one core running its own io_context and task queue.
+ *
+ * The transport layer spreads the sockets of new connections over the io_contexts of the
+ * reactors, so the network completions of a connection always run on the same reactor. Tasks
+ * scheduled from a reactor thread are queued on that reactor, which keeps all the
+ * ServiceStateMachine steps of a connection on one core for cache and NUMA locality.
+ *
+ * A reactor, which has neither network completions nor tasks to run, steals the oldest task of
+ * the peer with the deepest queue, if that queue holds at least the configured steal threshold.
+ * Reactors whose queue reaches the threshold wake up a sleeping peer to do so.
+ *
+ * Tasks run inline on the reactor threads, so a task blocking on a lock, a write concern or an
+ * awaitData cursor blocks all the other connections of its reactor. Like the adaptive executor, a
+ * controller thread therefore checks every stuckThreadTimeout() whether all the threads of a
+ * reactor are running tasks, none of which finished within that time. If so, it starts a helper
+ * thread, which runs the network completions and tasks of that reactor, until the reactor has
+ * another idle thread again.
+ */
+class ServiceExecutorPerCore final : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+
+        // The minimum depth of the task queue of a reactor for its peers to steal from it.
+        virtual int stealThreshold() const = 0;
+
+        // The maximum allowable depth of recursion for tasks scheduled with the MayRecurse flag
+        // before stack unwinding is forced.
+        virtual int recursionLimit() const = 0;
+
+        // The time after which a reactor, all of whose threads are running tasks, none of which
+        // finished, is considered stuck and gets a helper thread started.
+        virtual Milliseconds stuckThreadTimeout() const = 0;
+    };
+
+    /**
+     * Returns the number of reactors configured through the perCoreServiceExecutorReactors server
+     * parameter, which the transport layer must create io_contexts for.
+     */
+    static int configuredNumReactors();
+
+    /**
+     * Creates an executor running one reactor for each of 'ioContexts'.
+     */
+    ServiceExecutorPerCore(ServiceContext* ctx,
+                           std::vector<std::shared_ptr<asio::io_context>> ioContexts);
+    ServiceExecutorPerCore(ServiceContext* ctx,
+                           std::vector<std::shared_ptr<asio::io_context>> ioContexts,
+                           std::unique_ptr<Options> config);
+
+    ~ServiceExecutorPerCore();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags, ServiceExecutorTaskName taskName) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+private:
+    struct Reactor {
+        Reactor(size_t index, std::shared_ptr<asio::io_context> ioContext)
+            : index(index), ioContext(std::move(ioContext)) {}
+
+        /**
+         * Queues 'task' and returns the resulting depth of the queue.
+         */
+        int push(Task task);
+
+        /**
+         * Returns false if the queue is empty.
+         */
+        bool pop(Task* task);
+
+        /**
+         * Wakes the reactor up if it is waiting for network completions.
+         */
+        void wakeUp();
+
+        /**
+         * Returns true and accounts for the exit of the calling helper thread if another thread of
+         * the reactor is idle.
+         */
+        bool retireHelper();
+
+        const size_t index;
+        const std::shared_ptr<asio::io_context> ioContext;
+
+        stdx::mutex mutex;
+        std::deque<Task> queue;
+
+        AtomicWord<int> queueDepth{0};
+        AtomicWord<int> sleeping{0};
+
+        // The threads running the reactor and how many of them are running a task
+        AtomicWord<int> threadsRunning{0};
+        AtomicWord<int> threadsInUse{0};
+
+        // The tick at which a thread of the reactor last finished a task
+        AtomicWord<long long> lastProgressTick{0};
+
+        // Statistics
+        AtomicWord<long long> tasksExecuted{0};
+        AtomicWord<long long> tasksStolen{0};
+        AtomicWord<long long> helpersStarted{0};
+    };
+
+    /**
+     * Starts a thread running 'reactor', which is the pinned thread of the reactor or, if
+     * 'isHelper' is true, a helper started while the reactor is stuck.
+     */
+    Status _startReactorThread(Reactor* reactor, bool isHelper);
+
+    void _reactorThreadRoutine(Reactor* reactor, bool isHelper);
+
+    /**
+     * Starts a helper thread for each reactor, which is stuck for longer than
+     * stuckThreadTimeout(), until the executor is shut down.
+     */
+    void _controllerThreadRoutine();
+
+    /**
+     * Runs 'task' on the current reactor thread, accounting for the recursion depth.
+     */
+    void _runTask(Reactor* reactor, const Task& task);
+
+    /**
+     * Steals a task from the peer of 'thief' with the deepest queue if it holds at least
+     * stealThreshold() tasks.
+     */
+    bool _steal(Reactor* thief, Task* task);
+
+    /**
+     * Wakes up one sleeping peer of 'reactor' to steal from it.
+     */
+    void _wakeUpThief(Reactor* reactor);
+
+    /**
+     * Returns the reactor of this executor, which the current thread runs, or nullptr.
+     */
+    Reactor* _currentReactor() const;
+
+    /**
+     * Returns the reactor to queue tasks on, which are scheduled from a thread, which is not a
+     * reactor thread.
+     */
+    Reactor* _pickReactor();
+
+    std::unique_ptr<Options> _config;
+    TickSource* const _tickSource;
+
+    std::vector<std::unique_ptr<Reactor>> _reactors;
+    AtomicWord<unsigned> _nextReactor{0};
+
+    AtomicWord<bool> _isRunning{false};
+
+    mutable stdx::mutex _shutdownMutex;
+    stdx::condition_variable _shutdownCondition;
+    stdx::condition_variable _controllerCondition;
+    int _numRunningThreads = 0;
+
+    stdx::thread _controllerThread;
+
+    static thread_local Reactor* _localReactor;
+    static thread_local int _localRecursionDepth;
+    static thread_local int64_t _localThreadIdleCounter;
+
+    // These counters are only used for reporting in serverStatus.
+    AtomicWord<long long> _totalQueued{0};
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -34,6 +34,7 @@
 
 #include "mongo/db/service_context_noop.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_per_core.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/unittest/unittest.h"
@@ -94,6 +95,44 @@ protected:
     std::shared_ptr<asio::io_context> asioIOCtx;
 };
 
+struct PerCoreTestOptions : public ServiceExecutorPerCore::Options {
+    int stealThreshold() const final {
+        return stealThresholdValue;
+    }
+
+    int recursionLimit() const final {
+        return 0;
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return stuckThreadTimeoutValue;
+    }
+
+    int stealThresholdValue = 1;
+    Milliseconds stuckThreadTimeoutValue = Seconds{60};
+};
+
+class ServiceExecutorPerCoreFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = stdx::make_unique<ServiceContextNoop>();
+        setGlobalServiceContext(std::move(scOwned));
+
+        std::vector<std::shared_ptr<asio::io_context>> ioContexts;
+        for (int i = 0; i < 2; ++i) {
+            ioContexts.push_back(std::make_shared<asio::io_context>());
+        }
+
+        auto configOwned = stdx::make_unique<PerCoreTestOptions>();
+        executorConfig = configOwned.get();
+        executor = stdx::make_unique<ServiceExecutorPerCore>(
+            getGlobalServiceContext(), ioContexts, std::move(configOwned));
+    }
+
+    PerCoreTestOptions* executorConfig;
+    std::unique_ptr<ServiceExecutorPerCore> executor;
+};
+
 class ServiceExecutorSynchronousFixture : public unittest::Test {
 protected:
     void setUp() override {
@@ -136,6 +175,100 @@ TEST_F(ServiceExecutorAdaptiveFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorPerCoreFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorPerCoreFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorPerCoreFixture, IdleReactorStealsQueuedTasks) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    constexpr int kNumQueuedTasks = 4;
+    stdx::condition_variable cond;
+    stdx::mutex mutex;
+    int tasksRun = 0;
+    const auto allTasksRun = [&] { return tasksRun == kNumQueuedTasks; };
+
+    // Tasks scheduled from a reactor thread stay on its queue, so while the blocking task runs
+    // only the other reactor can run them
+    auto blockingTask = [&] {
+        for (int i = 0; i < kNumQueuedTasks; ++i) {
+            ASSERT_OK(executor->schedule(
+                [&] {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    ++tasksRun;
+                    cond.notify_all();
+                },
+                ServiceExecutor::kEmptyFlags,
+                ServiceExecutorTaskName::kSSMProcessMessage));
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait_for(lk, Seconds{10}.toSystemDuration(), allTasksRun);
+    };
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(executor->schedule(std::move(blockingTask),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMStartSession));
+    ASSERT_TRUE(cond.wait_for(lk, Seconds{10}.toSystemDuration(), allTasksRun));
+    lk.unlock();
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    auto stats = bob.obj()["serviceExecutorTaskStats"].Obj();
+    ASSERT_EQ(stats["totalStolen"].numberLong(), kNumQueuedTasks);
+    ASSERT_EQ(stats["reactors"].Array().size(), 2UL);
+}
+
+TEST_F(ServiceExecutorPerCoreFixture, StuckReactorStartsHelperThread) {
+    executorConfig->stealThresholdValue = 0;
+    executorConfig->stuckThreadTimeoutValue = Milliseconds{10};
+
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    stdx::condition_variable cond;
+    stdx::mutex mutex;
+    bool unblocked = false;
+
+    // The blocking task waits for a task queued on its own reactor, which nothing but a helper
+    // thread can run while stealing is disabled
+    auto blockingTask = [&] {
+        ASSERT_OK(executor->schedule(
+            [&] {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                unblocked = true;
+                cond.notify_all();
+            },
+            ServiceExecutor::kEmptyFlags,
+            ServiceExecutorTaskName::kSSMProcessMessage));
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait_for(lk, Seconds{10}.toSystemDuration(), [&] { return unblocked; });
+    };
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(executor->schedule(std::move(blockingTask),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMStartSession));
+    ASSERT_TRUE(cond.wait_for(lk, Seconds{10}.toSystemDuration(), [&] { return unblocked; }));
+    lk.unlock();
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    auto stats = bob.obj()["serviceExecutorTaskStats"].Obj();
+    ASSERT_EQ(stats["totalStolen"].numberLong(), 0);
+    ASSERT_GTE(stats["helpersStarted"].numberLong(), 1);
+}
+
 TEST_F(ServiceExecutorSynchronousFixture, BasicTaskRuns) {
     ASSERT_OK(executor->start());
     auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
@@ -49,6 +49,7 @@
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/op_msg.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/quick_exit.h"
 
@@ -87,6 +88,21 @@ bool setExhaustMessage(Message* m, const DbResponse& dbresponse) {
     return true;
 }
 
+// Set up the next request of an OP_MSG exhaust cursor, which runs without the client sending it
+void setOpMsgExhaustMessage(Message* m, const DbResponse& dbresponse) {
+    MsgData::View header = dbresponse.response.header();
+    invariant(!dbresponse.nextInvocation.isEmpty());
+
+    OpMsgBuilder builder;
+    builder.setBody(dbresponse.nextInvocation);
+    auto next = builder.finish();
+    next.header().setId(header.getId());
+    next.header().setResponseToMsgId(header.getResponseToMsgId());
+    OpMsg::setFlag(&next, OpMsg::kExhaustSupported);
+
+    *m = std::move(next);
+}
+
 }  // namespace
 
 using transport::ServiceExecutor;
@@ -389,7 +405,11 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         toSink.header().setResponseToMsgId(_inMessage.header().getId());
 
         // If this is an exhaust cursor, don't source more Messages
-        if (dbresponse.exhaustNS.size() > 0 && setExhaustMessage(&_inMessage, dbresponse)) {
+        if (!dbresponse.nextInvocation.isEmpty()) {
+            setOpMsgExhaustMessage(&_inMessage, dbresponse);
+            _inExhaust = true;
+        } else if (dbresponse.exhaustNS.size() > 0 &&
+                   setExhaustMessage(&_inMessage, dbresponse)) {
             _inExhaust = true;
         } else {
             _inExhaust = false;
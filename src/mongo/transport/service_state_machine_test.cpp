@@ -67,6 +67,7 @@ public:
     DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
         log() << "In handleRequest";
         _ranHandler = true;
+        _ranExhaustRequest = OpMsg::isFlagSet(request, OpMsg::kExhaustSupported);
         ASSERT_TRUE(haveClient());
 
         auto req = OpMsgRequest::parse(request);
@@ -79,7 +80,14 @@ public:
         if (_uassertInHandler)
             uassert(40469, "Synthetic uassert failure", false);
 
-        return DbResponse{builder.finish()};
+        auto reply = builder.finish();
+        if (_exhaustReplies > 0) {
+            --_exhaustReplies;
+            OpMsg::setFlag(&reply, OpMsg::kMoreToCome);
+            return DbResponse{std::move(reply), std::string(), req.body.getOwned()};
+        }
+
+        return DbResponse{std::move(reply)};
     }
 
     void endAllSessions(transport::Session::TagMask tags) override {}
@@ -100,15 +108,25 @@ public:
         _uassertInHandler = true;
     }
 
+    void setExhaustReplies(int replies) {
+        _exhaustReplies = replies;
+    }
+
     bool ranHandler() {
         bool ret = _ranHandler;
         _ranHandler = false;
         return ret;
     }
 
+    bool ranExhaustRequest() const {
+        return _ranExhaustRequest;
+    }
+
 private:
     bool _uassertInHandler = false;
     bool _ranHandler = false;
+    bool _ranExhaustRequest = false;
+    int _exhaustReplies = 0;
 };
 
 using namespace transport;
@@ -339,6 +357,20 @@ TEST_F(ServiceStateMachineFixture, TestOkaySimpleCommand) {
     checkPingOk();
 }
 
+TEST_F(ServiceStateMachineFixture, TestOpMsgExhaustRunsNextInvocation) {
+    _sep->setExhaustReplies(1);
+
+    // The reply streams more results, so the command runs again instead of sourcing a request.
+    runPingTest(State::Process, State::Process);
+    ASSERT_TRUE(OpMsg::isFlagSet(_tl->getLastSunk(), OpMsg::kMoreToCome));
+    ASSERT_FALSE(_sep->ranExhaustRequest());
+
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Source);
+    ASSERT_TRUE(_sep->ranExhaustRequest());
+    checkPingOk();
+}
+
 TEST_F(ServiceStateMachineFixture, TestThrowHandling) {
     _sep->setUassertInHandler();
 
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <array>
 #include <utility>
 
 #include "mongo/base/system_error.h"
@@ -35,6 +36,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/transport/asio_utils.h"
 #include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/net/message_buffer_pool.h"
 #include "mongo/util/net/sock.h"
 #ifdef MONGO_CONFIG_SSL
 #include "mongo/util/net/ssl_manager.h"
@@ -187,6 +189,8 @@ protected:
         }
 
         _sslSocket.emplace(std::move(_socket), *_tl->_egressSSLContext);
+        getSSLManager()->resumeSession(_sslSocket->native_handle(), target.toString());
+
         auto doHandshake = [&] {
             if (_blockingMode == Sync) {
                 std::error_code ec;
@@ -301,17 +305,18 @@ private:
     Future<Message> sourceMessageImpl() {
         static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
 
-        auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
-        auto ptr = headerBuffer.get();
-        return read(asio::buffer(ptr, kHeaderSize))
-            .then([ headerBuffer = std::move(headerBuffer), this ](size_t size) mutable {
-                if (checkForHTTPRequest(asio::buffer(headerBuffer.get(), size))) {
+        // Only one message is sourced at a time, so the header is received into a buffer of the
+        // session. A pooled buffer is taken once the length of the message is known.
+        return read(asio::buffer(_headerBuffer))
+            .then([this](size_t size) {
+                if (checkForHTTPRequest(asio::buffer(_headerBuffer.data(), size))) {
                     return sendHTTPResponse();
                 }
 
                 invariant(size == kHeaderSize);
 
-                const auto msgLen = size_t(MSGHEADER::View(headerBuffer.get()).getMessageLength());
+                const auto msgLen =
+                    size_t(MSGHEADER::View(_headerBuffer.data()).getMessageLength());
                 if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
                     StringBuilder sb;
                     sb << "recv(): message msgLen " << msgLen << " is invalid. "
@@ -322,15 +327,15 @@ private:
                     return Future<Message>::makeReady(Status(ErrorCodes::ProtocolError, str));
                 }
 
+                auto buffer = MessageBufferPool::get()->allocate(msgLen);
+                memcpy(buffer.get(), _headerBuffer.data(), kHeaderSize);
+
                 if (msgLen == size) {
                     // This probably isn't a real case since all (current) messages have bodies.
                     networkCounter.hitPhysicalIn(msgLen);
-                    return Future<Message>::makeReady(Message(std::move(headerBuffer)));
+                    return Future<Message>::makeReady(Message(std::move(buffer)));
                 }
 
-                auto buffer = SharedBuffer::allocate(msgLen);
-                memcpy(buffer.get(), headerBuffer.get(), kHeaderSize);
-
                 MsgData::View msgView(buffer.get());
                 return read(asio::buffer(msgView.data(), msgView.dataLen()))
                     .then([ buffer = std::move(buffer), msgLen, this ](size_t size) mutable {
@@ -550,6 +555,7 @@ private:
     boost::optional<Milliseconds> _socketTimeout;
 
     GenericSocket _socket;
+    std::array<char, sizeof(MSGHEADER::Value)> _headerBuffer;
 #ifdef MONGO_CONFIG_SSL
     boost::optional<asio::ssl::stream<decltype(_socket)>> _sslSocket;
     bool _ranHandshake = false;
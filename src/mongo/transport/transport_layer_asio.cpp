@@ -80,6 +80,10 @@ TransportLayerASIO::TransportLayerASIO(const TransportLayerASIO::Options& opts,
 #endif
       _sep(sep),
       _listenerOptions(opts) {
+    _workerIOContexts.push_back(_workerIOContext);
+    while (_workerIOContexts.size() < _listenerOptions.numWorkerIOContexts) {
+        _workerIOContexts.push_back(std::make_shared<asio::io_context>());
+    }
 }
 
 TransportLayerASIO::~TransportLayerASIO() = default;
@@ -442,7 +446,9 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
         _acceptConnection(acceptor);
     };
 
-    acceptor.async_accept(*_workerIOContext, std::move(acceptCb));
+    auto& workerIOContext =
+        *_workerIOContexts[_nextWorkerIOContext.fetchAndAdd(1) % _workerIOContexts.size()];
+    acceptor.async_accept(workerIOContext, std::move(acceptCb));
 }
 
 #ifdef MONGO_CONFIG_SSL
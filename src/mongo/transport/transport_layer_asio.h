@@ -30,6 +30,7 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status_with.h"
 #include "mongo/config.h"
@@ -99,6 +100,8 @@ public:
         Mode transportMode = Mode::kSynchronous;  // whether accepted sockets should be put into
                                                   // non-blocking mode after they're accepted
         size_t maxConns = DEFAULT_MAX_CONN;       // maximum number of active connections
+        size_t numWorkerIOContexts = 1;           // number of IO contexts accepted sockets are
+                                                  // spread over in round robin order
     };
 
     TransportLayerASIO(const Options& opts, ServiceEntryPoint* sep);
@@ -120,6 +123,14 @@ public:
 
     const std::shared_ptr<asio::io_context>& getIOContext();
 
+    /**
+     * Returns all the IO contexts accepted sockets are registered with, the first of which is the
+     * one returned by getIOContext().
+     */
+    const std::vector<std::shared_ptr<asio::io_context>>& getWorkerIOContexts() const {
+        return _workerIOContexts;
+    }
+
     int listenerPort() const {
         return _listenerPort;
     }
@@ -167,7 +178,13 @@ private:
     // the io_context), so that we destroy any existing acceptors or
     // other io_service associated state before we drop the refcount
     // on the io_context, which may destroy it.
+    //
+    // If the Options ask for more than one worker IO context, accepted sockets are spread over
+    // _workerIOContexts, whose first element is _workerIOContext, so that every thread of a
+    // per-core ServiceExecutor runs the networking of its own connections.
     std::shared_ptr<asio::io_context> _workerIOContext;
+    std::vector<std::shared_ptr<asio::io_context>> _workerIOContexts;
+    AtomicWord<unsigned> _nextWorkerIOContext{0};
     std::unique_ptr<asio::io_context> _acceptorIOContext;
 
 #ifdef MONGO_CONFIG_SSL
@@ -0,0 +1,1230 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include <asio.hpp>
+
+#include "mongo/config.h"
+
+#ifdef MONGO_CONFIG_HAVE_LINUX_IO_URING
+#include <boost/algorithm/string.hpp>
+#include <deque>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mongo/db/server_options.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_buffer_pool.h"
+#include "mongo/util/net/sock.h"
+#endif
+
+namespace mongo {
+namespace transport {
+
+#ifdef MONGO_CONFIG_HAVE_LINUX_IO_URING
+
+namespace {
+
+// Older C libraries do not define the io_uring system call numbers, which are the same on all the
+// architectures mongod supports
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+constexpr unsigned kSubmissionQueueEntries = 4096;
+constexpr unsigned kCompletionQueueEntries = 65536;
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return ::syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+}
+
+int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned numArgs) {
+    return ::syscall(__NR_io_uring_register, fd, opcode, arg, numArgs);
+}
+
+Status errnoStatus(StringData operation, int err) {
+    return {ErrorCodes::InternalError,
+            str::stream() << operation << " failed: " << errnoWithDescription(err)};
+}
+
+/**
+ * Converts the errno value of a failed socket operation into a Status the same way as
+ * errorCodeToStatus() does for ASIO errors.
+ */
+Status socketErrorToStatus(int err) {
+    if (err == EAGAIN || err == EWOULDBLOCK) {
+        return {ErrorCodes::NetworkTimeout, "Socket operation timed out"};
+    } else if (err == ECONNRESET || err == ENETRESET || err == EPIPE) {
+        return {ErrorCodes::HostUnreachable, "Connection was closed"};
+    }
+
+    return {ErrorCodes::SocketException, errnoWithDescription(err)};
+}
+
+const Status kConnectionClosedStatus(ErrorCodes::HostUnreachable, "Connection was closed");
+
+bool isHTTPRequest(const char* header) {
+    return StringData(header, 4) == "GET "_sd;
+}
+
+StatusWith<size_t> checkMessageLength(const char* header) {
+    const auto msgLen = size_t(MSGHEADER::ConstView(header).getMessageLength());
+    if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+        StringBuilder sb;
+        sb << "recv(): message msgLen " << msgLen << " is invalid. "
+           << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+        const auto str = sb.str();
+        LOG(0) << str;
+
+        return Status(ErrorCodes::ProtocolError, str);
+    }
+
+    return msgLen;
+}
+
+}  // namespace
+
+/**
+ * Owns an io_uring instance and its memory mapped submission and completion queues.
+ *
+ * The submission queue must be accessed under a mutex by the caller, as must be the completion
+ * queue, but they may be accessed concurrently with each other.
+ */
+class TransportLayerIoUring::Ring {
+    MONGO_DISALLOW_COPYING(Ring);
+
+public:
+    Ring() = default;
+
+    ~Ring() {
+        if (_sqes) {
+            ::munmap(_sqes, _sqesSize);
+        }
+        if (_cqRing && _cqRing != _sqRing) {
+            ::munmap(_cqRing, _cqRingSize);
+        }
+        if (_sqRing) {
+            ::munmap(_sqRing, _sqRingSize);
+        }
+        if (_fd >= 0) {
+            ::close(_fd);
+        }
+    }
+
+    Status init(unsigned entries, unsigned cqEntries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = cqEntries;
+
+        _fd = ioUringSetup(entries, &params);
+        if (_fd < 0) {
+            return errnoStatus("io_uring_setup", errno);
+        }
+
+        _features = params.features;
+
+        _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        // Newer kernels map both rings with a single mapping
+        const bool singleMmap = _features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) {
+            _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+        }
+
+        _sqRing = _map(_sqRingSize, IORING_OFF_SQ_RING);
+        if (!_sqRing) {
+            return errnoStatus("mmap", errno);
+        }
+
+        _cqRing = singleMmap ? _sqRing : _map(_cqRingSize, IORING_OFF_CQ_RING);
+        if (!_cqRing) {
+            return errnoStatus("mmap", errno);
+        }
+
+        _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        _sqes = static_cast<io_uring_sqe*>(_map(_sqesSize, IORING_OFF_SQES));
+        if (!_sqes) {
+            return errnoStatus("mmap", errno);
+        }
+
+        auto sq = static_cast<char*>(_sqRing);
+        _sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        _sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        _sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        _sqEntries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+        _sqFlags = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+
+        // Submission queue entries are always used in order, so the indirection array is static
+        auto sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < _sqEntries; ++i) {
+            sqArray[i] = i;
+        }
+        _sqeTail = *_sqTail;
+
+        auto cq = static_cast<char*>(_cqRing);
+        _cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        _cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        _cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        return Status::OK();
+    }
+
+    unsigned features() const {
+        return _features;
+    }
+
+    /**
+     * Returns whether the kernel supports all the operations used by the transport layer.
+     */
+    bool supportsOperations() const {
+        constexpr unsigned kNumProbeOps = 256;
+
+        const size_t probeSize = sizeof(io_uring_probe) + kNumProbeOps * sizeof(io_uring_probe_op);
+        std::unique_ptr<char[]> probeBuffer(new char[probeSize]());
+        auto probe = reinterpret_cast<io_uring_probe*>(probeBuffer.get());
+
+        if (ioUringRegister(_fd, IORING_REGISTER_PROBE, probe, kNumProbeOps) < 0) {
+            return false;
+        }
+
+        const auto requiredOps = {
+            IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_READ_FIXED};
+        for (unsigned op : requiredOps) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    Status registerBuffer(void* base, size_t length) {
+        iovec iov{base, length};
+        if (ioUringRegister(_fd, IORING_REGISTER_BUFFERS, &iov, 1) < 0) {
+            return errnoStatus("io_uring_register", errno);
+        }
+        return Status::OK();
+    }
+
+    Status registerEventFd(int eventFd) {
+        if (ioUringRegister(_fd, IORING_REGISTER_EVENTFD, &eventFd, 1) < 0) {
+            return errnoStatus("io_uring_register", errno);
+        }
+        return Status::OK();
+    }
+
+    /**
+     * Copies 'sqe' to the submission queue, or to the overflow list if the queue is full.
+     */
+    void push(const io_uring_sqe& sqe) {
+        if (_overflow.empty() && _tryPush(sqe)) {
+            return;
+        }
+        _overflow.push_back(sqe);
+    }
+
+    /**
+     * Hands the queued entries to the kernel. Entries which do not fit in the submission queue
+     * are handed to the kernel as it consumes the ones before them.
+     */
+    Status submit() {
+        while (true) {
+            while (!_overflow.empty() && _tryPush(_overflow.front())) {
+                _overflow.pop_front();
+            }
+
+            __atomic_store_n(_sqTail, _sqeTail, __ATOMIC_RELEASE);
+            const unsigned toSubmit = _sqeTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+
+            unsigned flags = 0;
+#ifdef IORING_SQ_CQ_OVERFLOW
+            // Completions which did not fit into the completion queue are only moved to it when
+            // the kernel is entered asking for events
+            if (__atomic_load_n(_sqFlags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+                flags |= IORING_ENTER_GETEVENTS;
+            }
+#endif
+            if (!toSubmit && !flags) {
+                return Status::OK();
+            }
+
+            int submitted;
+            do {
+                submitted = ioUringEnter(_fd, toSubmit, 0, flags);
+            } while (submitted < 0 && errno == EINTR);
+
+            if (submitted < 0) {
+                // The kernel cannot accept more submissions until completions are reaped, the
+                // remaining entries are submitted after the next ones are processed
+                if (errno == EAGAIN || errno == EBUSY) {
+                    return Status::OK();
+                }
+                return errnoStatus("io_uring_enter", errno);
+            }
+
+            if (_overflow.empty() || !submitted) {
+                return Status::OK();
+            }
+        }
+    }
+
+    /**
+     * Calls 'func' with the user data and result of every posted completion and consumes them.
+     */
+    template <typename Func>
+    void reap(Func&& func) {
+        unsigned head = *_cqHead;
+        const unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const auto& cqe = _cqes[head & _cqMask];
+            func(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    void* _map(size_t size, off_t offset) {
+        auto ptr =
+            ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    bool _tryPush(const io_uring_sqe& sqe) {
+        const unsigned head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+        if (_sqeTail - head >= _sqEntries) {
+            return false;
+        }
+        _sqes[_sqeTail & _sqMask] = sqe;
+        ++_sqeTail;
+        return true;
+    }
+
+    int _fd = -1;
+    unsigned _features = 0;
+
+    void* _sqRing = nullptr;
+    size_t _sqRingSize = 0;
+    void* _cqRing = nullptr;
+    size_t _cqRingSize = 0;
+    io_uring_sqe* _sqes = nullptr;
+    size_t _sqesSize = 0;
+
+    unsigned* _sqHead = nullptr;
+    unsigned* _sqTail = nullptr;
+    unsigned* _sqFlags = nullptr;
+    unsigned _sqMask = 0;
+    unsigned _sqEntries = 0;
+
+    // The tail of the submission queue including the entries not yet published to the kernel
+    unsigned _sqeTail = 0;
+
+    // Entries queued while the submission queue was full
+    std::deque<io_uring_sqe> _overflow;
+
+    unsigned* _cqHead = nullptr;
+    unsigned* _cqTail = nullptr;
+    unsigned _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+};
+
+/**
+ * A listening socket, which always has an accept submitted to the ring while the transport layer
+ * is running.
+ */
+class TransportLayerIoUring::AcceptOperation final : public Operation {
+    MONGO_DISALLOW_COPYING(AcceptOperation);
+
+public:
+    AcceptOperation(TransportLayerIoUring* tl, SockAddr addr, int fd)
+        : _tl(tl), _addr(std::move(addr)), _fd(fd) {}
+
+    ~AcceptOperation() {
+        ::close(_fd);
+    }
+
+    const SockAddr& addr() const {
+        return _addr;
+    }
+
+    int fd() const {
+        return _fd;
+    }
+
+    void submit() {
+        _tl->_enqueue(this, [&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->fd = _fd;
+            sqe->accept_flags = SOCK_CLOEXEC;
+        });
+    }
+
+    void onCompletion(int result) override;
+
+private:
+    TransportLayerIoUring* const _tl;
+    const SockAddr _addr;
+    const int _fd;
+};
+
+class TransportLayerIoUring::IoUringSession final : public Session {
+    MONGO_DISALLOW_COPYING(IoUringSession);
+
+public:
+    IoUringSession(TransportLayerIoUring* tl, int fd)
+        : _tl(tl), _fd(fd), _headerIndex(tl->_acquireHeaderBuffer()) {
+        sockaddr_storage addr;
+        socklen_t addrLen = sizeof(addr);
+        if (::getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) == 0) {
+            SockAddr localAddr(addr, addrLen);
+            const auto family = localAddr.getType();
+            if (family == AF_INET || family == AF_INET6) {
+                const int on = 1;
+                ::setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                ::setsockopt(_fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+                setSocketKeepAliveParams(_fd);
+            }
+            _local = HostAndPort(localAddr);
+        }
+
+        addrLen = sizeof(addr);
+        if (::getpeername(_fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) == 0) {
+            _remote = HostAndPort(SockAddr(addr, addrLen));
+        } else {
+            LOG(3) << "Unable to get remote endpoint address: " << errnoWithDescription();
+        }
+    }
+
+    ~IoUringSession() {
+        end();
+        ::close(_fd);
+        if (_headerIndex >= 0) {
+            _tl->_releaseHeaderBuffer(_headerIndex);
+        }
+    }
+
+    TransportLayer* getTransportLayer() const override {
+        return _tl;
+    }
+
+    const HostAndPort& remote() const override {
+        return _remote;
+    }
+
+    const HostAndPort& local() const override {
+        return _local;
+    }
+
+    void end() override {
+        // Shutting the socket down fails the operations submitted for it, the descriptor is only
+        // closed once none can reference it anymore
+        if (!_ended.swap(true)) {
+            if (::shutdown(_fd, SHUT_RDWR) != 0 && errno != ENOTCONN) {
+                error() << "Error shutting down socket: " << errnoWithDescription();
+            }
+        }
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        _applyTimeout();
+
+        char header[kHeaderSize];
+        auto status = _recvAll(header, kHeaderSize);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        if (isHTTPRequest(header)) {
+            return _sendHTTPResponse();
+        }
+
+        auto swMsgLen = checkMessageLength(header);
+        if (!swMsgLen.isOK()) {
+            return swMsgLen.getStatus();
+        }
+        const auto msgLen = swMsgLen.getValue();
+
+        auto buffer = MessageBufferPool::get()->allocate(msgLen);
+        memcpy(buffer.get(), header, kHeaderSize);
+        status = _recvAll(buffer.get() + kHeaderSize, msgLen - kHeaderSize);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        networkCounter.hitPhysicalIn(msgLen);
+        return Message(std::move(buffer));
+    }
+
+    Future<Message> asyncSourceMessage() override {
+        // Socket timeouts only affect synchronous calls
+        invariant(!_configuredTimeout);
+
+        _sourcePromise.emplace();
+        auto future = _sourcePromise->getFuture();
+
+        _inHeaderBytes = 0;
+        _recvHeader();
+        return future;
+    }
+
+    Status sinkMessage(Message message) override {
+        _applyTimeout();
+
+        auto status = _sendAll(message.buf(), message.size());
+        if (status.isOK()) {
+            networkCounter.hitPhysicalOut(message.size());
+        }
+        return status;
+    }
+
+    Future<void> asyncSinkMessage(Message message) override {
+        invariant(!_configuredTimeout);
+
+        _sinkPromise.emplace();
+        auto future = _sinkPromise->getFuture();
+
+        // Keep the buffer alive until the message is sent
+        _outMessage = std::move(message);
+        _outBytes = 0;
+        _send();
+        return future;
+    }
+
+    void setTimeout(boost::optional<Milliseconds> timeout) override {
+        invariant(!timeout || timeout->count() > 0);
+        _configuredTimeout = timeout;
+    }
+
+    bool isConnected() override {
+        if (_ended.load()) {
+            return false;
+        }
+
+        pollfd pollFd{_fd, POLLIN, 0};
+        int ret;
+        do {
+            ret = ::poll(&pollFd, 1, 0);
+        } while (ret < 0 && errno == EINTR);
+
+        if (ret < 0) {
+            warning() << "Failed to poll socket for connectivity check: " << errnoWithDescription();
+            return false;
+        } else if (ret == 0) {
+            return true;
+        }
+
+        if (pollFd.revents & POLLIN) {
+            char testByte;
+            const auto size = ::recv(_fd, &testByte, sizeof(testByte), MSG_PEEK | MSG_DONTWAIT);
+            if (size == sizeof(testByte)) {
+                return true;
+            } else if (size == -1) {
+                warning() << "Failed to check socket connectivity: " << errnoWithDescription();
+            }
+            // If size == 0 then we got disconnected and we should return false.
+        }
+
+        return false;
+    }
+
+private:
+    /**
+     * An operation of this session, which keeps the session alive while it is submitted.
+     */
+    class SessionOperation final : public Operation {
+    public:
+        using Callback = void (IoUringSession::*)(int);
+
+        SessionOperation(IoUringSession* session, Callback callback)
+            : _session(session), _callback(callback) {}
+
+        void onCompletion(int result) override {
+            // The callback may submit the operation again, which takes a new reference
+            auto session = std::move(keepAlive);
+            (_session->*_callback)(result);
+        }
+
+        std::shared_ptr<IoUringSession> keepAlive;
+
+    private:
+        IoUringSession* const _session;
+        const Callback _callback;
+    };
+
+    std::shared_ptr<IoUringSession> _shared() {
+        return std::static_pointer_cast<IoUringSession>(shared_from_this());
+    }
+
+    char* _header() {
+        return _headerIndex >= 0 ? _tl->_headerBuffer(_headerIndex) : _headerStorage;
+    }
+
+    void _recvHeader() {
+        auto buffer = _header() + _inHeaderBytes;
+        const auto length = kHeaderSize - _inHeaderBytes;
+
+        _headerOp.keepAlive = _shared();
+        _tl->_enqueue(&_headerOp, [&](io_uring_sqe* sqe) {
+            // The registered header buffers save the kernel from mapping the user memory
+            if (_headerIndex >= 0) {
+                sqe->opcode = IORING_OP_READ_FIXED;
+                sqe->buf_index = 0;
+            } else {
+                sqe->opcode = IORING_OP_RECV;
+            }
+            sqe->fd = _fd;
+            sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+            sqe->len = length;
+        });
+    }
+
+    void _onHeaderReceived(int result) {
+        if (result <= 0) {
+            return _completeSource(result == 0 ? kConnectionClosedStatus
+                                               : socketErrorToStatus(-result));
+        }
+
+        _inHeaderBytes += result;
+        if (_inHeaderBytes < kHeaderSize) {
+            return _recvHeader();
+        }
+
+        const auto header = _header();
+        if (isHTTPRequest(header)) {
+            return _completeSource(_sendHTTPResponse());
+        }
+
+        auto swMsgLen = checkMessageLength(header);
+        if (!swMsgLen.isOK()) {
+            return _completeSource(swMsgLen.getStatus());
+        }
+
+        _inLength = swMsgLen.getValue();
+        _inBuffer = MessageBufferPool::get()->allocate(_inLength);
+        memcpy(_inBuffer.get(), header, kHeaderSize);
+        _inBytes = kHeaderSize;
+
+        if (_inBytes == _inLength) {
+            // This probably isn't a real case since all (current) messages have bodies.
+            networkCounter.hitPhysicalIn(_inLength);
+            return _completeSource(Message(std::move(_inBuffer)));
+        }
+
+        _recvBody();
+    }
+
+    void _recvBody() {
+        auto buffer = _inBuffer.get() + _inBytes;
+        const auto length = _inLength - _inBytes;
+
+        _bodyOp.keepAlive = _shared();
+        _tl->_enqueue(&_bodyOp, [&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = _fd;
+            sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+            sqe->len = length;
+        });
+    }
+
+    void _onBodyReceived(int result) {
+        if (result <= 0) {
+            _inBuffer = {};
+            return _completeSource(result == 0 ? kConnectionClosedStatus
+                                               : socketErrorToStatus(-result));
+        }
+
+        _inBytes += result;
+        if (_inBytes < _inLength) {
+            return _recvBody();
+        }
+
+        networkCounter.hitPhysicalIn(_inLength);
+        _completeSource(Message(std::move(_inBuffer)));
+    }
+
+    void _completeSource(StatusWith<Message> swMessage) {
+        // The continuation of the future may source the next message
+        auto promise = std::move(*_sourcePromise);
+        _sourcePromise.reset();
+
+        if (swMessage.isOK()) {
+            promise.emplaceValue(std::move(swMessage.getValue()));
+        } else {
+            promise.setError(swMessage.getStatus());
+        }
+    }
+
+    void _send() {
+        auto buffer = _outMessage.buf() + _outBytes;
+        const auto length = _outMessage.size() - _outBytes;
+
+        _sendOp.keepAlive = _shared();
+        _tl->_enqueue(&_sendOp, [&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_SEND;
+            sqe->fd = _fd;
+            sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+            sqe->len = length;
+            sqe->msg_flags = MSG_NOSIGNAL;
+        });
+    }
+
+    void _onSent(int result) {
+        if (result <= 0) {
+            _outMessage.reset();
+            return _completeSink(result == 0 ? kConnectionClosedStatus
+                                             : socketErrorToStatus(-result));
+        }
+
+        _outBytes += result;
+        if (_outBytes < size_t(_outMessage.size())) {
+            return _send();
+        }
+
+        networkCounter.hitPhysicalOut(_outMessage.size());
+        _outMessage.reset();
+        _completeSink(Status::OK());
+    }
+
+    void _completeSink(Status status) {
+        auto promise = std::move(*_sinkPromise);
+        _sinkPromise.reset();
+
+        if (status.isOK()) {
+            promise.emplaceValue();
+        } else {
+            promise.setError(std::move(status));
+        }
+    }
+
+    void _applyTimeout() {
+        if (_socketTimeout == _configuredTimeout) {
+            return;
+        }
+
+        // Change boost::none (which means no timeout) into a zero value for the socket option,
+        // which also means no timeout.
+        const auto timeout = _configuredTimeout.value_or(Milliseconds{0});
+        timeval tv;
+        tv.tv_sec = duration_cast<Seconds>(timeout).count();
+        tv.tv_usec = duration_cast<Microseconds>(timeout - Seconds{tv.tv_sec}).count();
+
+        for (auto option : {SO_SNDTIMEO, SO_RCVTIMEO}) {
+            if (::setsockopt(_fd, SOL_SOCKET, option, &tv, sizeof(tv)) != 0) {
+                uassertStatusOK(socketErrorToStatus(errno));
+            }
+        }
+
+        _socketTimeout = _configuredTimeout;
+    }
+
+    Status _recvAll(char* buffer, size_t length) {
+        while (length > 0) {
+            const auto size = ::recv(_fd, buffer, length, 0);
+            if (size < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return socketErrorToStatus(errno);
+            } else if (size == 0) {
+                return kConnectionClosedStatus;
+            }
+
+            buffer += size;
+            length -= size;
+        }
+        return Status::OK();
+    }
+
+    Status _sendAll(const char* buffer, size_t length) {
+        while (length > 0) {
+            const auto size = ::send(_fd, buffer, length, MSG_NOSIGNAL);
+            if (size < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return socketErrorToStatus(errno);
+            }
+
+            buffer += size;
+            length -= size;
+        }
+        return Status::OK();
+    }
+
+    // Sends an HTTP response back to a client that's trying to use HTTP over a native MongoDB
+    // port. The response is small enough to be sent synchronously.
+    StatusWith<Message> _sendHTTPResponse() {
+        constexpr auto userMsg =
+            "It looks like you are trying to access MongoDB over HTTP"
+            " on the native driver port.\r\n"_sd;
+
+        static const std::string httpResp = str::stream() << "HTTP/1.0 200 OK\r\n"
+                                                             "Connection: close\r\n"
+                                                             "Content-Type: text/plain\r\n"
+                                                             "Content-Length: "
+                                                          << userMsg.size() << "\r\n\r\n"
+                                                          << userMsg;
+
+        auto status = _sendAll(httpResp.data(), httpResp.size());
+        if (!status.isOK()) {
+            return {ErrorCodes::ProtocolError,
+                    str::stream()
+                        << "Client sent an HTTP request over a native MongoDB connection, "
+                           "but there was an error sending a response: "
+                        << status.toString()};
+        }
+
+        return {ErrorCodes::ProtocolError,
+                "Client sent an HTTP request over a native MongoDB connection"};
+    }
+
+    TransportLayerIoUring* const _tl;
+    const int _fd;
+
+    // Index of the registered header buffer of the session, or -1 if it uses _headerStorage
+    const int _headerIndex;
+    char _headerStorage[kHeaderSize];
+
+    HostAndPort _remote;
+    HostAndPort _local;
+
+    AtomicWord<bool> _ended{false};
+
+    boost::optional<Milliseconds> _configuredTimeout;
+    boost::optional<Milliseconds> _socketTimeout;
+
+    // State of the message being sourced asynchronously
+    SessionOperation _headerOp{this, &IoUringSession::_onHeaderReceived};
+    SessionOperation _bodyOp{this, &IoUringSession::_onBodyReceived};
+    boost::optional<Promise<Message>> _sourcePromise;
+    size_t _inHeaderBytes = 0;
+    SharedBuffer _inBuffer;
+    size_t _inLength = 0;
+    size_t _inBytes = 0;
+
+    // State of the message being sinked asynchronously
+    SessionOperation _sendOp{this, &IoUringSession::_onSent};
+    boost::optional<Promise<void>> _sinkPromise;
+    Message _outMessage;
+    size_t _outBytes = 0;
+};
+
+void TransportLayerIoUring::AcceptOperation::onCompletion(int result) {
+    if (!_tl->_running.load()) {
+        if (result >= 0) {
+            ::close(result);
+        }
+        return;
+    }
+
+    if (result < 0) {
+        log() << "Error accepting new connection on " << _addr.toString() << ": "
+              << errnoWithDescription(-result);
+        submit();
+        return;
+    }
+
+    _tl->_sep->startSession(std::make_shared<IoUringSession>(_tl, result));
+    submit();
+}
+
+TransportLayerIoUring::TransportLayerIoUring(const Options& opts, ServiceEntryPoint* sep)
+    : _ioContext(std::make_shared<asio::io_context>()), _sep(sep), _listenerOptions(opts) {}
+
+TransportLayerIoUring::~TransportLayerIoUring() = default;
+
+bool TransportLayerIoUring::isSupported() {
+    static const bool supported = [] {
+        Ring ring;
+        if (!ring.init(8, 16).isOK()) {
+            return false;
+        }
+
+        // Completions must not be dropped when more operations are in flight than fit in the
+        // completion queue
+        return (ring.features() & IORING_FEAT_NODROP) && ring.supportsOperations();
+    }();
+    return supported;
+}
+
+StatusWith<SessionHandle> TransportLayerIoUring::connect(HostAndPort peer,
+                                                         ConnectSSLMode sslMode,
+                                                         Milliseconds timeout) {
+    return {ErrorCodes::IllegalOperation, "The io_uring transport layer only supports ingress"};
+}
+
+void TransportLayerIoUring::asyncConnect(HostAndPort peer,
+                                         ConnectSSLMode sslMode,
+                                         Milliseconds timeout,
+                                         std::function<void(StatusWith<SessionHandle>)> callback) {
+    MONGO_UNREACHABLE;
+}
+
+Status TransportLayerIoUring::setup() {
+    invariant(_listenerOptions.isIngress() && !_listenerOptions.isEgress());
+
+    _ring = stdx::make_unique<Ring>();
+    auto status = _ring->init(kSubmissionQueueEntries, kCompletionQueueEntries);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    _eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_eventFd < 0) {
+        return errnoStatus("eventfd", errno);
+    }
+    // The descriptor takes ownership of the eventfd
+    _eventFdDescriptor = stdx::make_unique<asio::posix::stream_descriptor>(*_ioContext, _eventFd);
+
+    status = _ring->registerEventFd(_eventFd);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    // Registering the buffers may fail because of the locked memory limit, in which case the
+    // sessions receive their headers into their own buffers
+    _headerBuffers.reset(new char[kNumRegisteredHeaders * kHeaderSize]);
+    status = _ring->registerBuffer(_headerBuffers.get(), kNumRegisteredHeaders * kHeaderSize);
+    if (status.isOK()) {
+        _freeHeaderBuffers.reserve(kNumRegisteredHeaders);
+        for (int i = kNumRegisteredHeaders - 1; i >= 0; --i) {
+            _freeHeaderBuffers.push_back(i);
+        }
+    } else {
+        warning() << "Unable to register message header buffers with io_uring: " << status;
+        _headerBuffers.reset();
+    }
+
+    std::vector<std::string> listenAddrs;
+    if (_listenerOptions.ipList.empty()) {
+        listenAddrs = {"127.0.0.1"};
+        if (_listenerOptions.enableIPv6) {
+            listenAddrs.emplace_back("::1");
+        }
+    } else {
+        boost::split(
+            listenAddrs, _listenerOptions.ipList, boost::is_any_of(","), boost::token_compress_on);
+    }
+
+    if (_listenerOptions.useUnixSockets) {
+        listenAddrs.emplace_back(makeUnixSockPath(_listenerOptions.port));
+    }
+
+    _listenerPort = _listenerOptions.port;
+
+    for (auto& ip : listenAddrs) {
+        if (ip.empty()) {
+            warning() << "Skipping empty bind address";
+            continue;
+        }
+
+        const auto addrs = SockAddr::createAll(
+            ip, _listenerOptions.port, _listenerOptions.enableIPv6 ? AF_UNSPEC : AF_INET);
+        if (addrs.empty()) {
+            warning() << "Found no addresses for " << ip;
+            continue;
+        }
+
+        for (const auto& addr : addrs) {
+            if (addr.getType() == AF_UNIX) {
+                if (::unlink(ip.c_str()) == -1 && errno != ENOENT) {
+                    error() << "Failed to unlink socket file " << ip << " "
+                            << errnoWithDescription(errno);
+                    fassertFailedNoTrace(40486);
+                }
+            }
+
+            if (addr.getType() == AF_INET6 && !_listenerOptions.enableIPv6) {
+                error() << "Specified ipv6 bind address, but ipv6 is disabled";
+                fassertFailedNoTrace(40488);
+            }
+
+            const int fd = ::socket(addr.getType(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                return socketErrorToStatus(errno);
+            }
+            auto acceptor = stdx::make_unique<AcceptOperation>(this, addr, fd);
+
+            const int on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (addr.getType() == AF_INET6) {
+                ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on));
+            }
+
+            if (::bind(fd, addr.raw(), addr.addressSize) != 0) {
+                return socketErrorToStatus(errno);
+            }
+
+            if (addr.getType() == AF_UNIX) {
+                if (::chmod(ip.c_str(), serverGlobalParams.unixSocketPermissions) == -1) {
+                    error() << "Failed to chmod socket file " << ip << " "
+                            << errnoWithDescription(errno);
+                    fassertFailedNoTrace(40487);
+                }
+            }
+
+            if (_listenerOptions.port == 0 &&
+                (addr.getType() == AF_INET || addr.getType() == AF_INET6)) {
+                if (_listenerPort != _listenerOptions.port) {
+                    return Status(ErrorCodes::BadValue,
+                                  "Port 0 (ephemeral port) is not allowed when"
+                                  " listening on multiple IP interfaces");
+                }
+
+                sockaddr_storage boundAddr;
+                socklen_t boundAddrLen = sizeof(boundAddr);
+                if (::getsockname(fd, reinterpret_cast<sockaddr*>(&boundAddr), &boundAddrLen)) {
+                    return socketErrorToStatus(errno);
+                }
+                _listenerPort = SockAddr(boundAddr, boundAddrLen).getPort();
+            }
+
+            _acceptors.emplace_back(std::move(acceptor));
+        }
+    }
+
+    if (_acceptors.empty()) {
+        return Status(ErrorCodes::SocketException, "No available addresses/ports to bind to");
+    }
+
+    return Status::OK();
+}
+
+Status TransportLayerIoUring::start() {
+    _running.store(true);
+
+    for (auto& acceptor : _acceptors) {
+        if (::listen(acceptor->fd(), serverGlobalParams.listenBacklog) != 0) {
+            return socketErrorToStatus(errno);
+        }
+        acceptor->submit();
+    }
+
+    _waitForCompletions();
+    _submit();
+
+    log() << "waiting for connections on port " << _listenerPort << " using io_uring";
+    return Status::OK();
+}
+
+void TransportLayerIoUring::shutdown() {
+    _running.store(false);
+
+    // Shutting the listening sockets down fails their submitted accepts. This will prevent new
+    // connections from being opened.
+    for (auto& acceptor : _acceptors) {
+        ::shutdown(acceptor->fd(), SHUT_RDWR);
+
+        auto& addr = acceptor->addr();
+        if (addr.getType() == AF_UNIX && !addr.isAnonymousUNIXSocket()) {
+            auto path = addr.getAddr();
+            log() << "removing socket file: " << path;
+            if (::unlink(path.c_str()) != 0) {
+                const auto ewd = errnoWithDescription();
+                warning() << "Unable to remove UNIX socket " << path << ": " << ewd;
+            }
+        }
+    }
+}
+
+const std::shared_ptr<asio::io_context>& TransportLayerIoUring::getIOContext() {
+    return _ioContext;
+}
+
+template <typename PrepareFunc>
+void TransportLayerIoUring::_enqueue(Operation* op, PrepareFunc&& prepare) {
+    io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    prepare(&sqe);
+    sqe.user_data = reinterpret_cast<uintptr_t>(op);
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_submissionMutex);
+        _ring->push(sqe);
+    }
+
+    _scheduleSubmit();
+}
+
+void TransportLayerIoUring::_submit() {
+    stdx::lock_guard<stdx::mutex> lk(_submissionMutex);
+    auto status = _ring->submit();
+    if (!status.isOK()) {
+        severe() << "Failed to submit operations to io_uring: " << status;
+        fassertFailed(50743);
+    }
+}
+
+void TransportLayerIoUring::_scheduleSubmit() {
+    if (_submitScheduled.swap(true)) {
+        return;
+    }
+
+    asio::post(*_ioContext, [this] {
+        _submitScheduled.store(false);
+        _submit();
+    });
+}
+
+void TransportLayerIoUring::_waitForCompletions() {
+    auto waitCb = [this](const std::error_code& ec) {
+        if (ec == asio::error::operation_aborted) {
+            return;
+        } else if (ec) {
+            warning() << "Error waiting for io_uring completions: " << ec.message();
+        }
+
+        // Wait for the next signal before resetting the eventfd, so that no completion posted from
+        // now on is missed
+        _waitForCompletions();
+        _processCompletions();
+    };
+
+    _eventFdDescriptor->async_wait(asio::posix::stream_descriptor::wait_read, std::move(waitCb));
+}
+
+void TransportLayerIoUring::_processCompletions() {
+    uint64_t signals;
+    // Reset the eventfd, which fails if it was already reset by a concurrent call
+    MONGO_COMPILER_VARIABLE_UNUSED auto ignored = ::read(_eventFd, &signals, sizeof(signals));
+
+    std::vector<std::pair<Operation*, int>> completions;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_completionMutex);
+        _ring->reap([&](uint64_t userData, int result) {
+            completions.emplace_back(reinterpret_cast<Operation*>(userData), result);
+        });
+    }
+
+    // Run each completion as its own task rather than inline, so that the completions reaped
+    // together spread over the threads running the io_context and a slow command on one session
+    // doesn't hold up the others. Operations they submit are batched by _scheduleSubmit().
+    for (const auto& completion : completions) {
+        asio::post(*_ioContext, [ op = completion.first, result = completion.second ] {
+            op->onCompletion(result);
+        });
+    }
+}
+
+int TransportLayerIoUring::_acquireHeaderBuffer() {
+    stdx::lock_guard<stdx::mutex> lk(_headerBuffersMutex);
+    if (_freeHeaderBuffers.empty()) {
+        return -1;
+    }
+
+    const int index = _freeHeaderBuffers.back();
+    _freeHeaderBuffers.pop_back();
+    return index;
+}
+
+void TransportLayerIoUring::_releaseHeaderBuffer(int index) {
+    stdx::lock_guard<stdx::mutex> lk(_headerBuffersMutex);
+    _freeHeaderBuffers.push_back(index);
+}
+
+char* TransportLayerIoUring::_headerBuffer(int index) {
+    return _headerBuffers.get() + index * kHeaderSize;
+}
+
+#else  // MONGO_CONFIG_HAVE_LINUX_IO_URING
+
+class TransportLayerIoUring::Ring {};
+class TransportLayerIoUring::AcceptOperation {};
+
+TransportLayerIoUring::TransportLayerIoUring(const Options& opts, ServiceEntryPoint* sep)
+    : _ioContext(std::make_shared<asio::io_context>()), _sep(sep), _listenerOptions(opts) {}
+
+TransportLayerIoUring::~TransportLayerIoUring() = default;
+
+bool TransportLayerIoUring::isSupported() {
+    return false;
+}
+
+StatusWith<SessionHandle> TransportLayerIoUring::connect(HostAndPort peer,
+                                                         ConnectSSLMode sslMode,
+                                                         Milliseconds timeout) {
+    return {ErrorCodes::IllegalOperation, "The io_uring transport layer only supports ingress"};
+}
+
+void TransportLayerIoUring::asyncConnect(HostAndPort peer,
+                                         ConnectSSLMode sslMode,
+                                         Milliseconds timeout,
+                                         std::function<void(StatusWith<SessionHandle>)> callback) {
+    MONGO_UNREACHABLE;
+}
+
+Status TransportLayerIoUring::setup() {
+    return {ErrorCodes::InternalError, "This build does not support io_uring"};
+}
+
+Status TransportLayerIoUring::start() {
+    MONGO_UNREACHABLE;
+}
+
+void TransportLayerIoUring::shutdown() {}
+
+const std::shared_ptr<asio::io_context>& TransportLayerIoUring::getIOContext() {
+    return _ioContext;
+}
+
+#endif  // MONGO_CONFIG_HAVE_LINUX_IO_URING
+
+}  // namespace transport
+}  // namespace mongo
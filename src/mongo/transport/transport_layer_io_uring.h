@@ -0,0 +1,192 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/config.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/net/sockaddr.h"
+
+namespace asio {
+class io_context;
+
+namespace posix {
+class stream_descriptor;
+}  // namespace posix
+}  // namespace asio
+
+namespace mongo {
+
+class ServiceEntryPoint;
+
+namespace transport {
+
+/**
+ * An ingress-only TransportLayer implementation based on the Linux io_uring interface.
+ *
+ * Accepts, receives and sends of all sessions are queued as submissions on a single ring, which
+ * are handed to the kernel in batches with one io_uring_enter() call, instead of the readiness
+ * notification plus read/write system calls per message of TransportLayerASIO. The headers of
+ * incoming messages are received into buffers registered with the ring.
+ *
+ * Completions are signalled through an eventfd, which is waited on through an asio::io_context,
+ * so that they are processed by the threads of the ServiceExecutorAdaptive running it. SSL and
+ * egress networking are not supported, TransportLayerManager pairs this transport layer with an
+ * egress-only TransportLayerASIO and falls back to TransportLayerASIO entirely when the kernel
+ * does not support the required io_uring operations.
+ */
+class TransportLayerIoUring final : public TransportLayer {
+    MONGO_DISALLOW_COPYING(TransportLayerIoUring);
+
+public:
+    using Options = TransportLayerASIO::Options;
+
+    // The number of message header buffers registered with the ring. Sessions beyond this number
+    // receive the headers of their messages into buffers of their own.
+    static constexpr size_t kNumRegisteredHeaders = 1024;
+
+    TransportLayerIoUring(const Options& opts, ServiceEntryPoint* sep);
+
+    ~TransportLayerIoUring();
+
+    /**
+     * Returns whether the running kernel supports all the io_uring operations used by this
+     * transport layer.
+     */
+    static bool isSupported();
+
+    StatusWith<SessionHandle> connect(HostAndPort peer,
+                                      ConnectSSLMode sslMode,
+                                      Milliseconds timeout) final;
+    void asyncConnect(HostAndPort peer,
+                      ConnectSSLMode sslMode,
+                      Milliseconds timeout,
+                      std::function<void(StatusWith<SessionHandle>)> callback) final;
+
+    Status setup() final;
+    Status start() final;
+
+    void shutdown() final;
+
+    const std::shared_ptr<asio::io_context>& getIOContext();
+
+    int listenerPort() const {
+        return _listenerPort;
+    }
+
+private:
+    class Ring;
+    class IoUringSession;
+
+    /**
+     * An operation submitted to the ring. The address of the operation is the user data of its
+     * submission and completion queue entries.
+     */
+    class Operation {
+    public:
+        virtual ~Operation() = default;
+
+        /**
+         * Called with the result of the operation, which is a negated errno value on failure.
+         */
+        virtual void onCompletion(int result) = 0;
+    };
+
+    class AcceptOperation;
+
+    /**
+     * Queues a submission for 'op', which 'prepare' fills in, and schedules the submission of the
+     * queued entries to the kernel.
+     */
+    template <typename PrepareFunc>
+    void _enqueue(Operation* op, PrepareFunc&& prepare);
+
+    /**
+     * Hands all the queued submissions to the kernel with a single system call.
+     */
+    void _submit();
+
+    /**
+     * Schedules a call to _submit() on the io_context, unless one is already scheduled, so that
+     * submissions queued until it runs are batched.
+     */
+    void _scheduleSubmit();
+
+    /**
+     * Processes the completions signalled through the eventfd and waits for the next signal.
+     */
+    void _waitForCompletions();
+    void _processCompletions();
+
+    /**
+     * Returns the index of a free registered header buffer or -1 if there is none.
+     */
+    int _acquireHeaderBuffer();
+    void _releaseHeaderBuffer(int index);
+    char* _headerBuffer(int index);
+
+    std::shared_ptr<asio::io_context> _ioContext;
+
+    std::unique_ptr<Ring> _ring;
+
+    // Protects the submission queue of the ring
+    stdx::mutex _submissionMutex;
+
+    // Serializes the processing of the completion queue of the ring
+    stdx::mutex _completionMutex;
+
+    AtomicWord<bool> _submitScheduled{false};
+
+    // Signalled by the kernel whenever completions are posted to the ring
+    int _eventFd = -1;
+    std::unique_ptr<asio::posix::stream_descriptor> _eventFdDescriptor;
+
+    // Memory of the registered header buffers and the indexes of the free ones
+    std::unique_ptr<char[]> _headerBuffers;
+    stdx::mutex _headerBuffersMutex;
+    std::vector<int> _freeHeaderBuffers;
+
+    std::vector<std::unique_ptr<AcceptOperation>> _acceptors;
+
+    ServiceEntryPoint* const _sep = nullptr;
+    AtomicWord<bool> _running{false};
+    Options _listenerOptions;
+    // The real incoming port in case of _listenerOptions.port==0 (ephemeral).
+    int _listenerPort = 0;
+};
+
+}  // namespace transport
+}  // namespace mongo
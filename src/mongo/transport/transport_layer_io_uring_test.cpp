@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include "mongo/db/server_options.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/op_msg.h"
+
+#include "asio.hpp"
+
+namespace mongo {
+namespace {
+
+/**
+ * Sends every message received on a session back to the sender until the session fails.
+ */
+class EchoSEP : public ServiceEntryPoint {
+public:
+    void startSession(transport::SessionHandle session) override {
+        log() << "Accepted connection from " << session->remote();
+        _echo(std::move(session));
+    }
+
+    void endAllSessions(transport::Session::TagMask tags) override {
+        MONGO_UNREACHABLE;
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    Stats sessionStats() const override {
+        return {};
+    }
+
+    size_t numOpenSessions() const override {
+        return 0;
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    Status waitForSessionEnd() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cond.wait(lk, [this] { return _endStatus.is_initialized(); });
+        return *_endStatus;
+    }
+
+private:
+    void _echo(transport::SessionHandle session) {
+        session->asyncSourceMessage()
+            .then([session](Message message) { return session->asyncSinkMessage(message); })
+            .getAsync([ this, session ](Status status) {
+                if (status.isOK()) {
+                    return _echo(session);
+                }
+
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _endStatus = status;
+                _cond.notify_one();
+            });
+    }
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cond;
+    boost::optional<Status> _endStatus;
+};
+
+Message makeMessage(BSONObj body) {
+    OpMsgBuilder builder;
+    builder.setBody(body);
+    Message msg = builder.finish();
+    msg.header().setResponseToMsgId(0);
+    msg.header().setId(0);
+    return msg;
+}
+
+TEST(TransportLayerIoUring, EchoMessages) {
+    if (!transport::TransportLayerIoUring::isSupported()) {
+        log() << "Skipping test because io_uring is not supported";
+        return;
+    }
+
+    EchoSEP sep;
+
+    ServerGlobalParams params;
+    params.noUnixSocket = true;
+    transport::TransportLayerIoUring::Options options(&params);
+    options.mode = transport::TransportLayerIoUring::Options::kIngress;
+    options.port = 0;
+
+    transport::TransportLayerIoUring tl(options, &sep);
+    ASSERT_OK(tl.setup());
+    ASSERT_OK(tl.start());
+    ASSERT_GT(tl.listenerPort(), 0);
+
+    // Stands in for the threads of the ServiceExecutorAdaptive
+    auto ioContext = tl.getIOContext();
+    AtomicWord<bool> running{true};
+    stdx::thread ioThread([&] {
+        while (running.load()) {
+            ioContext->run_for(Milliseconds(10).toSystemDuration());
+        }
+    });
+
+    {
+        asio::io_context clientContext;
+        asio::ip::tcp::socket sock(clientContext);
+        std::error_code ec;
+        sock.connect(
+            asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), tl.listenerPort()), ec);
+        ASSERT_FALSE(ec);
+
+        // Send messages of different sizes, including one larger than a socket buffer
+        for (auto size : {1, 1000, 4 * 1024 * 1024}) {
+            const auto msg = makeMessage(BSON("echo" << std::string(size, 'x')));
+
+            asio::write(sock, asio::buffer(msg.buf(), msg.size()), ec);
+            ASSERT_FALSE(ec);
+
+            std::string reply(msg.size(), '\0');
+            asio::read(sock, asio::buffer(&reply[0], reply.size()), ec);
+            ASSERT_FALSE(ec);
+            ASSERT(reply == std::string(msg.buf(), msg.size()));
+        }
+    }
+
+    ASSERT_EQ(sep.waitForSessionEnd(), ErrorCodes::HostUnreachable);
+
+    tl.shutdown();
+    running.store(false);
+    ioThread.join();
+}
+
+}  // namespace
+}  // namespace mongo
@@ -26,6 +26,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/transport/transport_layer_manager.h"
@@ -35,9 +37,13 @@
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_per_core.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
+#include "mongo/transport/transport_layer_io_uring.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/ssl_options.h"
 #include "mongo/util/net/ssl_types.h"
 #include "mongo/util/time_support.h"
 #include <limits>
@@ -112,14 +118,81 @@ Status TransportLayerManager::addAndStartTransportLayer(std::unique_ptr<Transpor
     return ptr->start();
 }
 
+namespace {
+
+/**
+ * Returns why the io_uring transport layer cannot be used with 'config', or an empty string if it
+ * can be.
+ */
+std::string whyIoUringIsUnusable(const ServerGlobalParams* config) {
+    if (config->serviceExecutor != "adaptive") {
+        return "it requires the adaptive service executor";
+    }
+#ifdef MONGO_CONFIG_SSL
+    if (getSSLGlobalParams().sslMode.load() != SSLParams::SSLMode_disabled) {
+        return "it does not support SSL";
+    }
+#endif
+    if (!TransportLayerIoUring::isSupported()) {
+        return "the kernel does not support the required io_uring operations";
+    }
+    return "";
+}
+
+/**
+ * Creates an io_uring transport layer for ingress networking, whose completions are processed by
+ * an adaptive service executor, and an asio transport layer for egress networking.
+ */
+std::vector<std::unique_ptr<TransportLayer>> createIoUringTransportLayers(
+    const ServerGlobalParams* config, ServiceContext* ctx) {
+    auto sep = ctx->getServiceEntryPoint();
+
+    transport::TransportLayerIoUring::Options ingressOpts(config);
+    ingressOpts.mode = transport::TransportLayerIoUring::Options::kIngress;
+    ingressOpts.transportMode = transport::Mode::kAsynchronous;
+
+    auto transportLayerIoUring =
+        stdx::make_unique<transport::TransportLayerIoUring>(ingressOpts, sep);
+    ctx->setServiceExecutor(
+        stdx::make_unique<ServiceExecutorAdaptive>(ctx, transportLayerIoUring->getIOContext()));
+
+    transport::TransportLayerASIO::Options egressOpts;
+    egressOpts.mode = transport::TransportLayerASIO::Options::kEgress;
+    egressOpts.enableIPv6 = config->enableIPv6;
+
+    // The egress transport layer must come first, because the TransportLayerManager connects
+    // through the first transport layer
+    std::vector<std::unique_ptr<TransportLayer>> retVector;
+    retVector.emplace_back(stdx::make_unique<transport::TransportLayerASIO>(egressOpts, sep));
+    retVector.emplace_back(std::move(transportLayerIoUring));
+    return retVector;
+}
+
+}  // namespace
+
 std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     const ServerGlobalParams* config, ServiceContext* ctx) {
+    if (config->transportLayer == "io_uring") {
+        const auto reason = whyIoUringIsUnusable(config);
+        if (reason.empty()) {
+            return stdx::make_unique<TransportLayerManager>(
+                createIoUringTransportLayers(config, ctx));
+        }
+
+        warning() << "Falling back to the asio transport layer, the io_uring transport layer "
+                     "cannot be used because "
+                  << reason;
+    }
+
     std::unique_ptr<TransportLayer> transportLayer;
     auto sep = ctx->getServiceEntryPoint();
 
     transport::TransportLayerASIO::Options opts(config);
     if (config->serviceExecutor == "adaptive") {
         opts.transportMode = transport::Mode::kAsynchronous;
+    } else if (config->serviceExecutor == "perCore") {
+        opts.transportMode = transport::Mode::kAsynchronous;
+        opts.numWorkerIOContexts = ServiceExecutorPerCore::configuredNumReactors();
     } else if (config->serviceExecutor == "synchronous") {
         opts.transportMode = transport::Mode::kSynchronous;
     } else {
@@ -131,6 +204,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     if (config->serviceExecutor == "adaptive") {
         ctx->setServiceExecutor(
             stdx::make_unique<ServiceExecutorAdaptive>(ctx, transportLayerASIO->getIOContext()));
+    } else if (config->serviceExecutor == "perCore") {
+        ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorPerCore>(
+            ctx, transportLayerASIO->getWorkerIOContexts()));
     } else if (config->serviceExecutor == "synchronous") {
         ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorSynchronous>(ctx));
     }
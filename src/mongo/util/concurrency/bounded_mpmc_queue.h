@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/stdx/new.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * A bounded, lock-free queue for any number of producers and consumers.
+ *
+ * The queue is a ring of slots, each of which carries a sequence number telling producers and
+ * consumers whose turn it is to use the slot. Producers and consumers claim slots with a single
+ * compare-and-swap on the enqueue and dequeue positions respectively, so they only contend with
+ * each other when they race for the same slot.
+ *
+ * tryPush() fails rather than blocks when the queue is full, and tryPop() fails when it is empty.
+ */
+template <typename T>
+class BoundedMPMCQueue {
+    MONGO_DISALLOW_COPYING(BoundedMPMCQueue);
+
+public:
+    /**
+     * Constructs a queue which holds 'capacity' values, rounded up to a power of two.
+     */
+    explicit BoundedMPMCQueue(size_t capacity)
+        : _capacity(_roundUpToPowerOfTwo(capacity)),
+          _mask(_capacity - 1),
+          _slots(new Slot[_capacity]) {
+        for (size_t i = 0; i < _capacity; ++i) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    /**
+     * Moves 'value' into the queue and returns true, or returns false and leaves 'value' alone if
+     * the queue is full.
+     */
+    bool tryPush(T& value) {
+        auto pos = _enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = _slots[pos & _mask];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Moves the oldest value in the queue into 'value' and returns true, or returns false if the
+     * queue is empty.
+     */
+    bool tryPop(T* value) {
+        auto pos = _dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = _slots[pos & _mask];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    *value = std::move(slot.value);
+                    // Don't hold on to whatever the moved-from value still owns.
+                    slot.value = T();
+                    slot.sequence.store(pos + _capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    // Slots and positions are padded out to a cache line so that producers and consumers working
+    // on neighbouring slots don't invalidate each other's caches. They are padded rather than
+    // aligned because the queue and its slots live on the heap, and operator new does not honour
+    // extended alignments before C++17.
+    static constexpr size_t kCacheLineSize = stdx::hardware_destructive_interference_size;
+
+    struct Slot {
+        std::atomic<size_t> sequence;  // NOLINT
+        T value;
+        char padding[kCacheLineSize - (sizeof(std::atomic<size_t>) + sizeof(T)) % kCacheLineSize];
+    };
+
+    static size_t _roundUpToPowerOfTwo(size_t capacity) {
+        invariant(capacity > 0);
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    const size_t _capacity;
+    const size_t _mask;
+    const std::unique_ptr<Slot[]> _slots;
+
+    MONGO_COMPILER_VARIABLE_UNUSED char _padding0[kCacheLineSize];
+    std::atomic<size_t> _enqueuePos{0};  // NOLINT
+    MONGO_COMPILER_VARIABLE_UNUSED char _padding1[kCacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> _dequeuePos{0};  // NOLINT
+    MONGO_COMPILER_VARIABLE_UNUSED char _padding2[kCacheLineSize - sizeof(std::atomic<size_t>)];
+};
+
+}  // namespace mongo
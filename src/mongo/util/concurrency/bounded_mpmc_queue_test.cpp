@@ -0,0 +1,133 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <vector>
+
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/bounded_mpmc_queue.h"
+
+namespace mongo {
+namespace {
+
+TEST(BoundedMPMCQueueTest, CapacityIsRoundedUpToPowerOfTwo) {
+    ASSERT_EQ(1U, BoundedMPMCQueue<int>(1).capacity());
+    ASSERT_EQ(8U, BoundedMPMCQueue<int>(5).capacity());
+    ASSERT_EQ(1024U, BoundedMPMCQueue<int>(1024).capacity());
+}
+
+TEST(BoundedMPMCQueueTest, PushAndPopInOrder) {
+    BoundedMPMCQueue<int> queue(4);
+    int value;
+    ASSERT_FALSE(queue.tryPop(&value));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.tryPush(i));
+    }
+    int overflow = 4;
+    ASSERT_FALSE(queue.tryPush(overflow));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.tryPop(&value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(queue.tryPop(&value));
+}
+
+TEST(BoundedMPMCQueueTest, FailedPushLeavesValueAlone) {
+    BoundedMPMCQueue<std::unique_ptr<int>> queue(1);
+    auto first = stdx::make_unique<int>(1);
+    ASSERT_TRUE(queue.tryPush(first));
+    ASSERT_FALSE(first);
+    auto second = stdx::make_unique<int>(2);
+    ASSERT_FALSE(queue.tryPush(second));
+    ASSERT_TRUE(second);
+    ASSERT_EQ(2, *second);
+}
+
+TEST(BoundedMPMCQueueTest, PopReleasesSlotValue) {
+    BoundedMPMCQueue<std::shared_ptr<int>> queue(2);
+    auto value = std::make_shared<int>(1);
+    auto copy = value;
+    ASSERT_TRUE(queue.tryPush(copy));
+    std::shared_ptr<int> popped;
+    ASSERT_TRUE(queue.tryPop(&popped));
+    popped.reset();
+    ASSERT_EQ(1, value.use_count());
+}
+
+TEST(BoundedMPMCQueueTest, ConcurrentProducersAndConsumers) {
+    const int kNumThreads = 4;
+    const int kValuesPerThread = 100000;
+    BoundedMPMCQueue<int> queue(64);
+
+    std::vector<stdx::thread> producers;
+    for (int t = 0; t < kNumThreads; ++t) {
+        producers.emplace_back([&queue, t] {
+            for (int i = 0; i < kValuesPerThread; ++i) {
+                int value = t * kValuesPerThread + i;
+                while (!queue.tryPush(value)) {
+                    stdx::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<long long> sums(kNumThreads, 0);
+    std::vector<stdx::thread> consumers;
+    for (int t = 0; t < kNumThreads; ++t) {
+        consumers.emplace_back([&queue, &sums, t] {
+            for (int i = 0; i < kValuesPerThread; ++i) {
+                int value;
+                while (!queue.tryPop(&value)) {
+                    stdx::this_thread::yield();
+                }
+                sums[t] += value;
+            }
+        });
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    for (auto& thread : consumers) {
+        thread.join();
+    }
+
+    const long long numValues = kNumThreads * kValuesPerThread;
+    long long total = 0;
+    for (auto sum : sums) {
+        total += sum;
+    }
+    ASSERT_EQ(numValues * (numValues - 1) / 2, total);
+}
+
+}  // namespace
+}  // namespace mongo
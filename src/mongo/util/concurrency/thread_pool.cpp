@@ -32,13 +32,23 @@
 
 #include "mongo/util/concurrency/thread_pool.h"
 
+#include <climits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "mongo/base/status.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -75,7 +85,112 @@ ThreadPool::Options cleanUpOptions(ThreadPool::Options&& options) {
 
 }  // namespace
 
-ThreadPool::ThreadPool(Options options) : _options(cleanUpOptions(std::move(options))) {}
+/**
+ * Where the idle worker threads of a pool with a lock-free queue sleep until tasks are scheduled.
+ * On Linux, threads sleep on a futex, so waking up a thread takes a single system call, and none
+ * if no thread is sleeping.
+ *
+ * To not miss a wake up, a thread calls prepareToPark(), then checks for work one last time and
+ * then either calls park() with the returned ticket, or cancelPark() if it found work.
+ */
+class ThreadPool::ParkingLot {
+    MONGO_DISALLOW_COPYING(ParkingLot);
+
+public:
+    ParkingLot() = default;
+
+    uint32_t prepareToPark() {
+        _numParked.fetchAndAdd(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _epoch.load();
+    }
+
+    void cancelPark() {
+        _numParked.subtractAndFetch(1);
+    }
+
+    /**
+     * Blocks until unparked or until "timeout" elapses. Returns false if it timed out.
+     */
+    bool park(uint32_t ticket, Milliseconds timeout) {
+        const auto guard = MakeGuard([this] { _numParked.subtractAndFetch(1); });
+#ifdef __linux__
+        struct timespec ts;
+        ts.tv_sec = durationCount<Seconds>(timeout);
+        ts.tv_nsec = (durationCount<Milliseconds>(timeout) % 1000) * 1000 * 1000;
+        while (_epoch.load() == ticket) {
+            // Wakes up early if _epoch no longer holds the ticket.
+            if (syscall(SYS_futex, _futexWord(), FUTEX_WAIT_PRIVATE, ticket, &ts, nullptr, 0) ==
+                    -1 &&
+                errno == ETIMEDOUT) {
+                return _epoch.load() != ticket;
+            }
+        }
+        return true;
+#else
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        return _condition.wait_for(
+            lk, timeout.toSystemDuration(), [&] { return _epoch.load() != ticket; });
+#endif
+    }
+
+    /**
+     * Wakes up one parked thread. Returns false if there was none.
+     */
+    bool unparkOne() {
+        return _unpark(1);
+    }
+
+    void unparkAll() {
+        _unpark(INT_MAX);
+    }
+
+private:
+    bool _unpark(int count) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_numParked.load() == 0) {
+            return false;
+        }
+
+#ifdef __linux__
+        _epoch.fetch_add(1);
+        syscall(SYS_futex, _futexWord(), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _epoch.fetch_add(1);
+        }
+        if (count == 1) {
+            _condition.notify_one();
+        } else {
+            _condition.notify_all();
+        }
+#endif
+        return true;
+    }
+
+#ifdef __linux__
+    uint32_t* _futexWord() {
+        MONGO_STATIC_ASSERT(sizeof(_epoch) == sizeof(uint32_t));
+        return reinterpret_cast<uint32_t*>(&_epoch);
+    }
+#else
+    stdx::mutex _mutex;
+    stdx::condition_variable _condition;
+#endif
+
+    // Changes whenever threads are unparked. On Linux this is the futex word.
+    std::atomic<uint32_t> _epoch{0};  // NOLINT
+
+    AtomicWord<int> _numParked{0};
+};
+
+ThreadPool::ThreadPool(Options options) : _options(cleanUpOptions(std::move(options))) {
+    if (_options.lockFreeQueueCapacity) {
+        _lockFreeTasks = stdx::make_unique<BoundedMPMCQueue<Task>>(_options.lockFreeQueueCapacity);
+        _parkingLot = stdx::make_unique<ParkingLot>();
+    }
+}
 
 ThreadPool::~ThreadPool() {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
@@ -90,6 +205,7 @@ ThreadPool::~ThreadPool() {
     }
     invariant(_threads.empty());
     invariant(_pendingTasks.empty());
+    invariant(_numQueuedTasks.load() == 0);
 }
 
 void ThreadPool::startup() {
@@ -119,6 +235,9 @@ void ThreadPool::_shutdown_inlock() {
         case running:
             _setState_inlock(joinRequired);
             _workAvailable.notify_all();
+            if (_parkingLot) {
+                _parkingLot->unparkAll();
+            }
             return;
         case joinRequired:
         case joining:
@@ -157,7 +276,16 @@ void ThreadPool::_join_inlock(stdx::unique_lock<stdx::mutex>* lk) {
     });
     _setState_inlock(joining);
     ++_numIdleThreads;
-    if (!_pendingTasks.empty()) {
+    if (_lockFreeTasks) {
+        // Let the schedule() calls which saw the pool running finish queueing their tasks, so that
+        // they get drained below.
+        while (_numSchedulesInProgress.load() > 0) {
+            lk->unlock();
+            stdx::this_thread::yield();
+            lk->lock();
+        }
+    }
+    if (!_pendingTasks.empty() || _numQueuedTasks.load() > 0) {
         lk->unlock();
         _drainPendingTasks();
         lk->lock();
@@ -165,6 +293,7 @@ void ThreadPool::_join_inlock(stdx::unique_lock<stdx::mutex>* lk) {
     --_numIdleThreads;
     ThreadList threadsToJoin;
     swap(threadsToJoin, _threads);
+    _numThreads.store(0);
     lk->unlock();
     for (auto& t : threadsToJoin) {
         t.join();
@@ -182,6 +311,13 @@ void ThreadPool::_drainPendingTasks() {
                                                      << _nextThreadId++;
         setThreadName(threadName);
         _options.onCreateThread(threadName);
+        if (_lockFreeTasks) {
+            Task task;
+            while (_tryPopTaskLockFree(&task)) {
+                _runTaskLockFree(&task);
+            }
+            return;
+        }
         stdx::unique_lock<stdx::mutex> lock(_mutex);
         while (!_pendingTasks.empty()) {
             _doOneTask(&lock);
@@ -191,6 +327,10 @@ void ThreadPool::_drainPendingTasks() {
 }
 
 Status ThreadPool::schedule(Task task) {
+    if (_lockFreeTasks && _tryScheduleLockFree(task)) {
+        return Status::OK();
+    }
+
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     switch (_state) {
         case joinRequired:
@@ -206,6 +346,14 @@ Status ThreadPool::schedule(Task task) {
             MONGO_UNREACHABLE;
     }
     _pendingTasks.emplace_back(std::move(task));
+    if (_lockFreeTasks) {
+        _numQueuedTasks.fetchAndAdd(1);
+        if (_state == running) {
+            _startWorkerThreadIfNeeded_inlock();
+            _parkingLot->unparkOne();
+        }
+        return Status::OK();
+    }
     if (_state == preStart) {
         return Status::OK();
     }
@@ -220,6 +368,16 @@ Status ThreadPool::schedule(Task task) {
 }
 
 void ThreadPool::waitForIdle() {
+    if (_lockFreeTasks) {
+        _numIdleWaiters.fetchAndAdd(1);
+        const auto guard = MakeGuard([this] { _numIdleWaiters.subtractAndFetch(1); });
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _poolIsIdle.wait(lk, [this] {
+            return _numQueuedTasks.load() == 0 && _numRunningTasks.load() == 0;
+        });
+        return;
+    }
+
     stdx::unique_lock<stdx::mutex> lk(_mutex);
     // If there are any pending tasks, or non-idle threads, the pool is not idle.
     while (!_pendingTasks.empty() || _numIdleThreads < _threads.size()) {
@@ -235,6 +393,12 @@ ThreadPool::Stats ThreadPool::getStats() const {
     result.numIdleThreads = _numIdleThreads;
     result.numPendingTasks = _pendingTasks.size();
     result.lastFullUtilizationDate = _lastFullUtilizationDate;
+    if (_lockFreeTasks) {
+        const auto numRunningTasks = static_cast<size_t>(_numRunningTasks.load());
+        result.numIdleThreads =
+            _threads.size() > numRunningTasks ? _threads.size() - numRunningTasks : 0;
+        result.numPendingTasks = _numQueuedTasks.load();
+    }
     return result;
 }
 
@@ -244,7 +408,11 @@ void ThreadPool::_workerThreadBody(ThreadPool* pool, const std::string& threadNa
     const auto poolName = pool->_options.poolName;
     LOG(1) << "starting thread in pool " << poolName;
     try {
-        pool->_consumeTasks();
+        if (pool->_lockFreeTasks) {
+            pool->_consumeTasksLockFree();
+        } else {
+            pool->_consumeTasks();
+        }
     } catch (...) {
         severe() << "Exception reached top of stack in thread pool " << poolName << ": "
                  << exceptionToStatus();
@@ -319,8 +487,12 @@ void ThreadPool::_consumeTasks() {
         fassertFailedNoTrace(28701);
     }
 
-    // This thread is ending because it was idle for too long.  Find self in _threads, remove self
-    // from _threads, detach self.
+    // This thread is ending because it was idle for too long.
+    _detachCurrentThread_inlock();
+}
+
+void ThreadPool::_detachCurrentThread_inlock() {
+    // Find self in _threads, remove self from _threads, detach self.
     for (size_t i = 0; i < _threads.size(); ++i) {
         auto& t = _threads[i];
         if (t.get_id() != stdx::this_thread::get_id()) {
@@ -329,6 +501,7 @@ void ThreadPool::_consumeTasks() {
         t.detach();
         t.swap(_threads.back());
         _threads.pop_back();
+        _numThreads.store(_threads.size());
         return;
     }
     severe().stream() << "Could not find this thread, with id " << stdx::this_thread::get_id()
@@ -383,6 +556,7 @@ void ThreadPool::_startWorkerThread_inlock() {
     const std::string threadName = str::stream() << _options.threadNamePrefix << _nextThreadId++;
     try {
         _threads.emplace_back([this, threadName] { _workerThreadBody(this, threadName); });
+        _numThreads.store(_threads.size());
         ++_numIdleThreads;
     } catch (const std::exception& ex) {
         error() << "Failed to start " << threadName << "; " << _threads.size()
@@ -396,7 +570,135 @@ void ThreadPool::_setState_inlock(const LifecycleState newState) {
         return;
     }
     _state = newState;
+    _lockFreeState.store(newState);
     _stateChange.notify_all();
 }
 
+bool ThreadPool::_tryScheduleLockFree(Task& task) {
+    {
+        _numSchedulesInProgress.fetchAndAdd(1);
+        const auto guard = MakeGuard([this] { _numSchedulesInProgress.subtractAndFetch(1); });
+        if (_lockFreeState.load() != running) {
+            return false;
+        }
+
+        _numQueuedTasks.fetchAndAdd(1);
+        if (!_lockFreeTasks->tryPush(task)) {
+            _numQueuedTasks.subtractAndFetch(1);
+            return false;
+        }
+    }
+
+    // Prefer waking up an idle thread over starting a new one.
+    if (!_parkingLot->unparkOne() &&
+        _numThreads.load() < static_cast<long long>(_options.maxThreads) &&
+        _numRunningTasks.load() + _numQueuedTasks.load() > _numThreads.load()) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _startWorkerThreadIfNeeded_inlock();
+    }
+    return true;
+}
+
+void ThreadPool::_startWorkerThreadIfNeeded_inlock() {
+    if (_numRunningTasks.load() + _numQueuedTasks.load() >
+        static_cast<long long>(_threads.size())) {
+        _lastFullUtilizationDate = Date_t::now();
+        _startWorkerThread_inlock();
+    }
+}
+
+void ThreadPool::_consumeTasksLockFree() {
+    Task task;
+    while (_lockFreeState.load() == running) {
+        if (_tryPopTaskLockFree(&task)) {
+            _runTaskLockFree(&task);
+            continue;
+        }
+
+        const auto ticket = _parkingLot->prepareToPark();
+        if (_numQueuedTasks.load() > 0 || _lockFreeState.load() != running) {
+            _parkingLot->cancelPark();
+            continue;
+        }
+
+        bool unparked;
+        {
+            MONGO_IDLE_THREAD_BLOCK;
+            unparked = _parkingLot->park(ticket, _options.maxIdleThreadAge);
+        }
+        if (!unparked && _retireIdleThreadLockFree()) {
+            return;
+        }
+    }
+
+    // The pool is shutting down, so this thread lends a hand in draining the queued tasks and
+    // returns so it can be joined.
+    while (_tryPopTaskLockFree(&task)) {
+        _runTaskLockFree(&task);
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    --_numIdleThreads;
+}
+
+bool ThreadPool::_tryPopTaskLockFree(Task* task) {
+    if (!_lockFreeTasks->tryPop(task)) {
+        if (_numQueuedTasks.load() == 0) {
+            return false;
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_pendingTasks.empty()) {
+            return false;
+        }
+        *task = std::move(_pendingTasks.front());
+        _pendingTasks.pop_front();
+    }
+
+    // Count the task as running before it stops counting as queued, so that the pool never looks
+    // idle to waitForIdle() while it still has work.
+    _numRunningTasks.fetchAndAdd(1);
+    _numQueuedTasks.subtractAndFetch(1);
+    return true;
+}
+
+void ThreadPool::_runTaskLockFree(Task* task) {
+    try {
+        LOG(3) << "Executing a task on behalf of pool " << _options.poolName;
+        (*task)();
+        *task = nullptr;
+    } catch (...) {
+        severe() << "Exception escaped task in thread pool " << _options.poolName << ": "
+                 << exceptionToStatus();
+        std::terminate();
+    }
+
+    if (_numRunningTasks.subtractAndFetch(1) == 0 && _numQueuedTasks.load() == 0 &&
+        _numIdleWaiters.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _poolIsIdle.notify_all();
+    }
+}
+
+bool ThreadPool::_retireIdleThreadLockFree() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_state != running || _threads.size() <= _options.minThreads) {
+        return false;
+    }
+
+    // Stop counting this thread before checking for queued tasks, so that a concurrent schedule()
+    // either sees fewer threads and starts a new one, or has its task seen here.
+    _numThreads.subtractAndFetch(1);
+    if (_numQueuedTasks.load() > 0) {
+        _numThreads.addAndFetch(1);
+        return false;
+    }
+
+    LOG(1) << "Reaping this thread of pool " << _options.poolName << " after being idle for "
+           << _options.maxIdleThreadAge;
+    --_numIdleThreads;
+    _detachCurrentThread_inlock();
+    return true;
+}
+
 }  // namespace mongo
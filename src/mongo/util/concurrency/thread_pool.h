@@ -33,10 +33,12 @@
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/bounded_mpmc_queue.h"
 #include "mongo/util/concurrency/thread_pool_interface.h"
 #include "mongo/util/time_support.h"
 
@@ -85,6 +87,16 @@ public:
         // This function is run before each worker thread begins consuming tasks.
         using OnCreateThreadFn = stdx::function<void(const std::string& threadName)>;
         OnCreateThreadFn onCreateThread = [](const std::string&) {};
+
+        // If non-zero, tasks scheduled on the running pool are handed to the worker threads
+        // through a lock-free ring of this many slots (rounded up to a power of two), and idle
+        // worker threads park on a futex rather than wait on a condition variable. Tasks
+        // scheduled before startup() or while the ring is full still go through the mutex
+        // protected queue.
+        //
+        // With the lock-free queue, every worker thread above minThreads which has been idle for
+        // maxIdleThreadAge retires, rather than one such thread every maxIdleThreadAge.
+        size_t lockFreeQueueCapacity = 0;
     };
 
     /**
@@ -137,6 +149,8 @@ public:
     Stats getStats() const;
 
 private:
+    class ParkingLot;
+
     using TaskList = std::deque<Task>;
     using ThreadList = std::vector<stdx::thread>;
 
@@ -197,12 +211,52 @@ private:
      */
     void _doOneTask(stdx::unique_lock<stdx::mutex>* lk);
 
+    /**
+     * Removes the calling worker thread from _threads and detaches it.
+     */
+    void _detachCurrentThread_inlock();
+
     /**
      * Changes the lifecycle state (_state) of the pool and wakes up any threads waiting for a state
      * change. Has no effect if _state == newState.
      */
     void _setState_inlock(LifecycleState newState);
 
+    /**
+     * Schedules "task" on the lock-free queue without taking _mutex. Returns false and leaves
+     * "task" alone if the pool isn't running or the queue is full.
+     */
+    bool _tryScheduleLockFree(Task& task);
+
+    /**
+     * Starts a worker thread if there are more queued and running tasks than worker threads.
+     * Only used with the lock-free queue.
+     */
+    void _startWorkerThreadIfNeeded_inlock();
+
+    /**
+     * Run loop of a worker thread when the pool uses the lock-free queue.
+     */
+    void _consumeTasksLockFree();
+
+    /**
+     * Takes the next task from the lock-free queue, or failing that from _pendingTasks, and counts
+     * it as running. Returns false if there is no task to take.
+     */
+    bool _tryPopTaskLockFree(Task* task);
+
+    /**
+     * Runs a task taken by _tryPopTaskLockFree() and wakes up waitForIdle() callers if the pool
+     * has become idle.
+     */
+    void _runTaskLockFree(Task* task);
+
+    /**
+     * Retires the calling worker thread if the pool may shrink and has no queued tasks. Returns
+     * true if the thread has been detached and must exit.
+     */
+    bool _retireIdleThreadLockFree();
+
     // These are the options with which the pool was configured at construction time.
     const Options _options;
 
@@ -239,6 +293,34 @@ private:
 
     // The last time that _pendingTasks.size() grew to be at least _threads.size().
     Date_t _lastFullUtilizationDate;
+
+    // The members below are only used if the pool was configured with a lock-free queue.
+
+    // Queue of tasks scheduled while the pool is running, unless it is full. It is only accessed
+    // while _numSchedulesInProgress is non-zero or by worker threads, so join() can wait for all
+    // the tasks to be queued before draining it.
+    std::unique_ptr<BoundedMPMCQueue<Task>> _lockFreeTasks;
+
+    // Where idle worker threads wait for tasks.
+    std::unique_ptr<ParkingLot> _parkingLot;
+
+    // Copy of _state, which can be read without holding _mutex.
+    AtomicWord<int> _lockFreeState{preStart};
+
+    // Number of calls to schedule() which are about to queue a task on _lockFreeTasks.
+    AtomicWord<long long> _numSchedulesInProgress{0};
+
+    // Number of tasks queued on either _lockFreeTasks or _pendingTasks.
+    AtomicWord<long long> _numQueuedTasks{0};
+
+    // Number of tasks being run by worker threads.
+    AtomicWord<long long> _numRunningTasks{0};
+
+    // Copy of _threads.size(), which can be read without holding _mutex.
+    AtomicWord<long long> _numThreads{0};
+
+    // Number of callers of waitForIdle(), which need to be woken up when the pool becomes idle.
+    AtomicWord<long long> _numIdleWaiters{0};
 };
 
 }  // namespace mongo
@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Benchmark scheduling tasks which do nothing on a thread pool, so that the cost measured is that
+ * of handing tasks over to the worker threads. With an argument of 0, tasks go through the
+ * mutex-protected queue, and with larger values, through a lock-free queue of that capacity.
+ *
+ * All threads executing the benchmark schedule onto the same pool, to allow benchmarking to
+ * identify the contention on the pool's queue.
+ */
+void BM_ScheduleAndRun(benchmark::State& state) {
+    static std::unique_ptr<ThreadPool> pool;
+    if (state.thread_index == 0) {
+        ThreadPool::Options options;
+        options.poolName = "BM_ScheduleAndRun";
+        options.maxThreads = 4;
+        options.lockFreeQueueCapacity = static_cast<size_t>(state.range(0));
+        pool = stdx::make_unique<ThreadPool>(options);
+        pool->startup();
+    }
+
+    for (auto keepRunning : state) {
+        invariantOK(pool->schedule([] {}));
+    }
+
+    if (state.thread_index == 0) {
+        pool->waitForIdle();
+        pool->shutdown();
+        pool->join();
+        pool.reset();
+    }
+}
+
+BENCHMARK(BM_ScheduleAndRun)
+    ->ThreadRange(1,
+                  [] {
+                      ProcessInfo::initializeSystemInfo();
+                      ProcessInfo pi;
+                      return static_cast<int>(pi.getNumAvailableCores().value_or(pi.getNumCores()));
+                  }())
+    ->ArgName("lock-free queue capacity")
+    ->Arg(0)
+    ->Arg(4096);
+
+}  // namespace
+}  // namespace mongo
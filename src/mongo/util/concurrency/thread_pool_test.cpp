@@ -33,6 +33,7 @@
 #include <boost/optional.hpp>
 
 #include "mongo/base/init.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
@@ -52,6 +53,11 @@ using namespace mongo;
 MONGO_INITIALIZER(ThreadPoolCommonTests)(InitializerContext*) {
     addTestsForThreadPool("ThreadPoolCommon",
                           []() { return stdx::make_unique<ThreadPool>(ThreadPool::Options()); });
+    addTestsForThreadPool("ThreadPoolLockFreeCommon", []() {
+        ThreadPool::Options options;
+        options.lockFreeQueueCapacity = 1024;
+        return stdx::make_unique<ThreadPool>(options);
+    });
     return Status::OK();
 }
 
@@ -141,6 +147,62 @@ TEST_F(ThreadPoolTest, MinPoolSize0) {
     lk.unlock();
 }
 
+TEST_F(ThreadPoolTest, LockFreeQueueOverflowsIntoPendingTasks) {
+    ThreadPool::Options options;
+    options.maxThreads = 1;
+    options.lockFreeQueueCapacity = 4;
+    auto& pool = makePool(options);
+    pool.startup();
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(pool.schedule([this] { blockingWork(); }));
+    while (count1 != 1U) {
+        cv1.wait(lk);
+    }
+    AtomicWord<int> numRun{0};
+    for (size_t i = 0; i < 10U; ++i) {
+        ASSERT_OK(pool.schedule([&numRun] { numRun.fetchAndAdd(1); }));
+    }
+    auto stats = pool.getStats();
+    ASSERT_EQUALS(1U, stats.numThreads);
+    ASSERT_EQUALS(0U, stats.numIdleThreads);
+    ASSERT_EQUALS(10U, stats.numPendingTasks);
+    flag2 = true;
+    cv2.notify_all();
+    lk.unlock();
+    pool.waitForIdle();
+    ASSERT_EQUALS(10, numRun.load());
+    ASSERT_EQUALS(0U, pool.getStats().numPendingTasks);
+}
+
+TEST_F(ThreadPoolTest, LockFreeQueueReapsIdleThreads) {
+    ThreadPool::Options options;
+    options.minThreads = 1;
+    options.maxThreads = 4;
+    options.maxIdleThreadAge = Milliseconds(100);
+    options.lockFreeQueueCapacity = 16;
+    auto& pool = makePool(options);
+    pool.startup();
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    for (size_t i = 0U; i < 4U; ++i) {
+        ASSERT_OK(pool.schedule([this] { blockingWork(); })) << i;
+    }
+    while (count1 < 4U) {
+        cv1.wait(lk);
+    }
+    ASSERT_EQ(4U, pool.getStats().numThreads);
+    flag2 = true;
+    cv2.notify_all();
+    lk.unlock();
+    ThreadPool::Stats stats;
+    Timer reapTimer;
+    for (size_t i = 0; i < 100 && (stats = pool.getStats()).numThreads > options.minThreads; ++i) {
+        sleepmillis(50);
+    }
+    const Microseconds reapTime(reapTimer.micros());
+    ASSERT_EQ(options.minThreads, stats.numThreads)
+        << "Failed to reap excess threads after " << durationCount<Milliseconds>(reapTime) << "ms";
+}
+
 TEST_F(ThreadPoolTest, MaxPoolSize20MinPoolSize15) {
     ThreadPool::Options options;
     options.minThreads = 15;
@@ -31,59 +31,88 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
+#include <algorithm>
 
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
-#if defined(__linux__)
 namespace {
 
-/**
- * Accepts an errno code, prints its error message, and exits.
- */
-void failWithErrno(int err) {
-    severe() << "error in Ticketholder: " << errnoWithDescription(err);
-    fassertFailed(28604);
+// The share of tickets each operation class gets when several of them wait for tickets.
+MONGO_EXPORT_SERVER_PARAMETER(ticketAdmissionWeightInternal, int, 4);
+MONGO_EXPORT_SERVER_PARAMETER(ticketAdmissionWeightPointOperation, int, 4);
+MONGO_EXPORT_SERVER_PARAMETER(ticketAdmissionWeightDefault, int, 1);
+
+const auto getOperationClassDecoration =
+    OperationContext::declareDecoration<boost::optional<TicketHolder::OperationClass>>();
+
+const char* operationClassName(int opClass) {
+    switch (static_cast<TicketHolder::OperationClass>(opClass)) {
+        case TicketHolder::OperationClass::kInternal:
+            return "internal";
+        case TicketHolder::OperationClass::kPointOperation:
+            return "pointOperation";
+        case TicketHolder::OperationClass::kDefault:
+            return "default";
+    }
+    MONGO_UNREACHABLE;
 }
 
-/*
- * Checks the return value from a Linux semaphore function call, and fails with the set errno if the
- * call was unsucessful.
- */
-void check(int ret) {
-    if (ret == 0)
-        return;
-    failWithErrno(errno);
+int operationClassWeight(int opClass) {
+    int weight = 1;
+    switch (static_cast<TicketHolder::OperationClass>(opClass)) {
+        case TicketHolder::OperationClass::kInternal:
+            weight = ticketAdmissionWeightInternal.load();
+            break;
+        case TicketHolder::OperationClass::kPointOperation:
+            weight = ticketAdmissionWeightPointOperation.load();
+            break;
+        case TicketHolder::OperationClass::kDefault:
+            weight = ticketAdmissionWeightDefault.load();
+            break;
+    }
+    return std::max(weight, 1);
 }
 
-/**
- * Takes a Date_t deadline and sets the appropriate values in a timespec structure.
- */
-void tsFromDate(const Date_t& deadline, struct timespec& ts) {
-    ts.tv_sec = deadline.toTimeT();
-    ts.tv_nsec = (deadline.toMillisSinceEpoch() % 1000) * 1'000'000;
-}
 }  // namespace
 
-TicketHolder::TicketHolder(int num) : _outof(num) {
-    check(sem_init(&_sem, 0, num));
+constexpr int TicketHolder::kNumOperationClasses;
+constexpr std::array<long long, 5> TicketHolder::kWaitHistogramBoundsMicros;
+
+void TicketHolder::setOperationClass(OperationContext* opCtx, OperationClass opClass) {
+    getOperationClassDecoration(opCtx) = opClass;
 }
 
-TicketHolder::~TicketHolder() {
-    check(sem_destroy(&_sem));
+TicketHolder::OperationClass TicketHolder::getOperationClass(OperationContext* opCtx) {
+    if (!opCtx) {
+        return OperationClass::kDefault;
+    }
+    if (const auto& opClass = getOperationClassDecoration(opCtx)) {
+        return *opClass;
+    }
+    if (opCtx->getClient() && !opCtx->getClient()->isFromUserConnection()) {
+        return OperationClass::kInternal;
+    }
+    return OperationClass::kDefault;
 }
 
+TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
+
+TicketHolder::~TicketHolder() = default;
+
 bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        if (errno == EAGAIN)
-            return false;
-        if (errno != EINTR)
-            failWithErrno(errno);
+    // Leave the tickets to the operations queued for them, if any.
+    if (_numWaiters.load() == 0 && _tryAcquireAvailable()) {
+        return true;
     }
-    return true;
+    _queuedInInterval.store(true);
+    return false;
 }
 
 void TicketHolder::waitForTicket(OperationContext* opCtx) {
@@ -91,165 +120,254 @@ void TicketHolder::waitForTicket(OperationContext* opCtx) {
 }
 
 bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    const Milliseconds intervalMs(500);
-    struct timespec ts;
-
-    // To support interrupting ticket acquisition while still benefiting from semaphores, we do a
-    // timed wait on an interval to periodically check for interrupts.
-    // The wait period interval is the smaller of the default interval and the provided
-    // deadline.
-    Date_t deadline = std::min(until, Date_t::now() + intervalMs);
-    tsFromDate(deadline, ts);
-
-    while (0 != sem_timedwait(&_sem, &ts)) {
-        if (errno == ETIMEDOUT) {
-            // If we reached the deadline without being interrupted, we have completely timed out.
-            if (deadline == until)
-                return false;
-
-            deadline = std::min(until, Date_t::now() + intervalMs);
-            tsFromDate(deadline, ts);
-        } else if (errno != EINTR) {
-            failWithErrno(errno);
-        }
+    return waitForTicketUntil(opCtx, getOperationClass(opCtx), until);
+}
+
+bool TicketHolder::waitForTicketUntil(OperationContext* opCtx,
+                                      OperationClass opClass,
+                                      Date_t until) {
+    auto queue = &_queues[static_cast<int>(opClass)];
+
+    // While nobody is queued, there is nobody to go after, so take a ticket without the mutex.
+    if (_numWaiters.load() == 0 && _tryAcquireAvailable()) {
+        queue->numAdmittedWithoutWaiting.fetchAndAdd(1);
+        return true;
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
 
-        // To correctly handle errors from sem_timedwait, we should check for interrupts last.
-        // It is possible to unset 'errno' after a call to checkForInterrupt().
-        if (opCtx)
-            opCtx->checkForInterrupt();
+    // Count ourselves before looking for a ticket again, so that a concurrent release either
+    // leaves its ticket for us to find or sees us and grants it under the mutex. Operations already
+    // queued are served first.
+    _numWaiters.fetchAndAdd(1);
+    _grantTickets_inlock();
+    if (_tryAcquireAvailable()) {
+        _numWaiters.subtractAndFetch(1);
+        _recordAdmission_inlock(queue, Microseconds(0));
+        return true;
     }
+
+    Waiter waiter;
+    if (queue->waiters.empty()) {
+        queue->pass = std::max(queue->pass, _virtualTime);
+    }
+    const auto it = queue->waiters.insert(queue->waiters.end(), &waiter);
+    _queuedInInterval.store(true);
+    const auto start = Date_t::now();
+
+    // If the wait times out or is interrupted, leave the queue, or pass the ticket on if it was
+    // granted in the meantime.
+    auto abandonGuard = MakeGuard([&] {
+        if (waiter.isGranted) {
+            _num.fetchAndAdd(1);
+            _grantTickets_inlock();
+        } else {
+            queue->waiters.erase(it);
+            _numWaiters.subtractAndFetch(1);
+        }
+        queue->numAbandoned++;
+    });
+
+    const bool granted = opCtx
+        ? opCtx->waitForConditionOrInterruptUntil(
+              waiter.granted, lk, until, [&waiter] { return waiter.isGranted; })
+        : waiter.granted.wait_until(
+              lk, until.toSystemTimePoint(), [&waiter] { return waiter.isGranted; });
+    if (!granted) {
+        return false;
+    }
+
+    abandonGuard.Dismiss();
+    _recordAdmission_inlock(queue, Date_t::now() - start);
     return true;
 }
 
 void TicketHolder::release() {
-    check(sem_post(&_sem));
-}
-
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_resizeMutex);
+    _num.fetchAndAdd(1);
 
-    if (newSize < 5)
-        return Status(ErrorCodes::BadValue,
-                      str::stream() << "Minimum value for semaphore is 5; given " << newSize);
+    bool adaptSize = false;
+    if (_adaptiveSizing.load()) {
+        _numReleasedInInterval.fetchAndAdd(1);
+        adaptSize = Date_t::now().toMillisSinceEpoch() >= _intervalEndMillis.load();
+    }
 
-    if (newSize > SEM_VALUE_MAX)
-        return Status(ErrorCodes::BadValue,
-                      str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
-                                    << "; given "
-                                    << newSize);
+    // Nobody is queued, so the ticket just stays available.
+    if (!adaptSize && _numWaiters.load() == 0) {
+        return;
+    }
 
-    while (_outof.load() < newSize) {
-        release();
-        _outof.fetchAndAdd(1);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (adaptSize) {
+        _adaptSize_inlock();
     }
+    _grantTickets_inlock();
+}
 
-    while (_outof.load() > newSize) {
-        waitForTicket();
-        _outof.subtractAndFetch(1);
+Status TicketHolder::resize(int newSize) {
+    if (newSize <= 0) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "Number of tickets must be positive; given " << newSize);
     }
 
-    invariant(_outof.load() == newSize);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _resize_inlock(newSize);
     return Status::OK();
 }
 
+void TicketHolder::enableAdaptiveSizing(int minTickets, int maxTickets, Milliseconds interval) {
+    invariant(0 < minTickets && minTickets <= maxTickets);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _minTickets = minTickets;
+    _maxTickets = maxTickets;
+    _adaptiveSizingInterval = interval;
+    _startSizingInterval_inlock(Date_t::now());
+    _lastThroughput = 0;
+    _sizingDirection = 1;
+    _resize_inlock(std::min(std::max(_outof.load(), minTickets), maxTickets));
+    _adaptiveSizing.store(true);
+}
+
 int TicketHolder::available() const {
-    int val = 0;
-    check(sem_getvalue(&_sem, &val));
-    return val;
+    return std::max(_num.load(), 0);
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    return _outof.load() - _num.load();
 }
 
 int TicketHolder::outof() const {
     return _outof.load();
 }
 
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
-
-TicketHolder::~TicketHolder() = default;
-
-bool TicketHolder::tryAcquire() {
+int TicketHolder::queued(OperationClass opClass) const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return _tryAcquire();
+    return _queues[static_cast<int>(opClass)].waiters.size();
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        opCtx->waitForConditionOrInterrupt(_newTicket, lk, [this] { return _tryAcquire(); });
-    } else {
-        _newTicket.wait(lk, [this] { return _tryAcquire(); });
+void TicketHolder::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    BSONObjBuilder queuesBuilder(builder->subobjStart("queues"));
+    for (int i = 0; i < kNumOperationClasses; ++i) {
+        const auto& queue = _queues[i];
+        BSONObjBuilder queueBuilder(queuesBuilder.subobjStart(operationClassName(i)));
+        queueBuilder.append("queued", static_cast<int>(queue.waiters.size()));
+        const auto numAdmittedWithoutWaiting = queue.numAdmittedWithoutWaiting.load();
+        queueBuilder.append("admitted", queue.numAdmitted + numAdmittedWithoutWaiting);
+        queueBuilder.append("abandoned", queue.numAbandoned);
+        queueBuilder.append("totalWaitMicros", queue.totalWaitMicros);
+
+        BSONObjBuilder histogramBuilder(queueBuilder.subobjStart("waitMicros"));
+        for (size_t bucket = 0; bucket < queue.waitHistogram.size(); ++bucket) {
+            const std::string name = bucket < kWaitHistogramBoundsMicros.size()
+                ? str::stream() << "lt" << kWaitHistogramBoundsMicros[bucket]
+                : str::stream() << "ge" << kWaitHistogramBoundsMicros.back();
+            histogramBuilder.append(
+                name, queue.waitHistogram[bucket] + (bucket == 0 ? numAdmittedWithoutWaiting : 0));
+        }
     }
 }
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        return opCtx->waitForConditionOrInterruptUntil(
-            _newTicket, lk, until, [this] { return _tryAcquire(); });
-    } else {
-        return _newTicket.wait_until(
-            lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
+bool TicketHolder::_tryAcquireAvailable() {
+    auto num = _num.load();
+    while (num > 0) {
+        const auto previous = _num.compareAndSwap(num, num - 1);
+        if (previous == num) {
+            return true;
+        }
+        num = previous;
     }
+    return false;
 }
 
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
-    }
-    _newTicket.notify_one();
-}
+void TicketHolder::_grantTickets_inlock() {
+    while (true) {
+        int next = -1;
+        for (int i = 0; i < kNumOperationClasses; ++i) {
+            if (!_queues[i].waiters.empty() &&
+                (next == -1 || _queues[i].pass < _queues[next].pass)) {
+                next = i;
+            }
+        }
+        if (next == -1 || !_tryAcquireAvailable()) {
+            return;
+        }
 
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto& queue = _queues[next];
+        auto waiter = queue.waiters.front();
+        queue.waiters.pop_front();
+        _numWaiters.subtractAndFetch(1);
 
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
+        _virtualTime = queue.pass;
+        queue.pass += 1.0 / operationClassWeight(next);
 
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+        waiter->isGranted = true;
+        waiter->granted.notify_one();
     }
+}
 
-    _outof.store(newSize);
-    _num = _outof.load() - used;
+void TicketHolder::_recordAdmission_inlock(OperationClassQueue* queue, Microseconds waitTime) {
+    const auto waitMicros = durationCount<Microseconds>(waitTime);
+    queue->numAdmitted++;
+    queue->totalWaitMicros += waitMicros;
 
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
-    return Status::OK();
+    size_t bucket = 0;
+    while (bucket < kWaitHistogramBoundsMicros.size() &&
+           waitMicros >= kWaitHistogramBoundsMicros[bucket]) {
+        ++bucket;
+    }
+    queue->waitHistogram[bucket]++;
 }
 
-int TicketHolder::available() const {
-    return _num;
+void TicketHolder::_startSizingInterval_inlock(Date_t now) {
+    _intervalStart = now;
+    _intervalEndMillis.store((now + _adaptiveSizingInterval).toMillisSinceEpoch());
+    _numReleasedInInterval.store(0);
+    _queuedInInterval.store(false);
 }
 
-int TicketHolder::used() const {
-    return outof() - _num;
-}
+void TicketHolder::_adaptSize_inlock() {
+    // Another release may have closed the interval while we waited for the mutex.
+    const auto now = Date_t::now();
+    const auto elapsed = now - _intervalStart;
+    if (elapsed < _adaptiveSizingInterval) {
+        return;
+    }
 
-int TicketHolder::outof() const {
-    return _outof.load();
-}
+    const double throughput = _numReleasedInInterval.load() /
+        static_cast<double>(std::max(durationCount<Microseconds>(elapsed), 1LL));
+    const bool queued = _queuedInInterval.load();
+    _startSizingInterval_inlock(now);
+
+    if (!queued) {
+        // The tickets weren't what held operations back, so there is nothing to learn from this
+        // interval.
+        _lastThroughput = 0;
+        return;
+    }
 
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
+    if (_lastThroughput > 0) {
+        if (throughput < _lastThroughput * 0.95) {
+            _sizingDirection = -_sizingDirection;
+        } else if (throughput <= _lastThroughput * 1.05) {
+            _sizingDirection = -1;
         }
-        return false;
     }
-    _num--;
-    return true;
+    _lastThroughput = throughput;
+
+    const int step = std::max(_outof.load() / 16, 1);
+    const int newSize =
+        std::min(std::max(_outof.load() + _sizingDirection * step, _minTickets), _maxTickets);
+    if (newSize != _outof.load()) {
+        LOG(1) << "Adapting the number of tickets from " << _outof.load() << " to " << newSize;
+        _resize_inlock(newSize);
+    }
 }
-#endif
+
+void TicketHolder::_resize_inlock(int newSize) {
+    _num.fetchAndAdd(newSize - _outof.load());
+    _outof.store(newSize);
+    _grantTickets_inlock();
 }
+
+}  // namespace mongo
@@ -26,12 +26,12 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <array>
+#include <list>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -39,10 +39,42 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * A pool of tickets which limits how many operations do something at once.
+ *
+ * Operations waiting for a ticket queue up by operation class, and released tickets are handed to
+ * the queues in proportion to their weights (see the ticketAdmissionWeight* server parameters), so
+ * that a burst of operations of one class can't starve the others. Within a class, tickets are
+ * handed out in the order they were asked for.
+ */
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
 public:
+    /**
+     * The classes of operations which queue separately for tickets.
+     */
+    enum class OperationClass {
+        kInternal,        // Replication and other work not on behalf of a user connection.
+        kPointOperation,  // Operations on a single document, such as lookups by _id.
+        kDefault,         // Everything else, including collection and index scans.
+    };
+    static constexpr int kNumOperationClasses = 3;
+
+    /**
+     * Sets the class under which the operation 'opCtx' waits for tickets from now on.
+     */
+    static void setOperationClass(OperationContext* opCtx, OperationClass opClass);
+
+    /**
+     * Returns the class set for the operation 'opCtx' with setOperationClass(). Operations which
+     * don't have one are kInternal if they don't come from a user connection, and kDefault
+     * otherwise, as are waits without an operation.
+     */
+    static OperationClass getOperationClass(OperationContext* opCtx);
+
     explicit TicketHolder(int num);
     ~TicketHolder();
 
@@ -69,31 +101,123 @@ public:
     bool waitForTicketUntil(Date_t until) {
         return waitForTicketUntil(nullptr, until);
     }
+
+    /**
+     * Like waitForTicketUntil() above, but queues under 'opClass' rather than under the class of
+     * 'opCtx'.
+     */
+    bool waitForTicketUntil(OperationContext* opCtx, OperationClass opClass, Date_t until);
+
     void release();
 
+    /**
+     * Changes the number of tickets to 'newSize'. When shrinking below the number of tickets in
+     * use, the excess tickets are retired as they are released.
+     */
     Status resize(int newSize);
 
+    /**
+     * Lets the holder resize itself, between 'minTickets' and 'maxTickets', to the number of
+     * tickets which gets the most operations through. Every 'interval' in which operations had to
+     * queue, the holder compares the number of tickets released with that of the previous
+     * interval: it keeps growing or shrinking as long as that throughput rises, turns around when
+     * it falls, and shrinks when it stays flat, since more tickets then only mean longer waits
+     * inside the storage engine.
+     */
+    void enableAdaptiveSizing(int minTickets, int maxTickets, Milliseconds interval);
+
     int available() const;
 
     int used() const;
 
     int outof() const;
 
+    /**
+     * Returns the number of operations of class 'opClass' waiting for a ticket.
+     */
+    int queued(OperationClass opClass) const;
+
+    /**
+     * Appends, for each operation class, the number of operations waiting and admitted, and a
+     * histogram of the time they waited for their tickets.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
 private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    // Upper bounds of the buckets of the wait time histograms, in microseconds. The last bucket
+    // counts the longer waits.
+    static constexpr std::array<long long, 5> kWaitHistogramBoundsMicros{
+        {100, 1000, 10 * 1000, 100 * 1000, 1000 * 1000}};
 
-    // You can read _outof without a lock, but have to hold _resizeMutex to change.
-    AtomicInt32 _outof;
-    stdx::mutex _resizeMutex;
-#else
-    bool _tryAcquire();
+    struct Waiter {
+        stdx::condition_variable granted;
+        bool isGranted = false;
+    };
+
+    struct OperationClassQueue {
+        std::list<Waiter*> waiters;
+
+        // The virtual time at which this queue is next served. Serving a queue advances it by
+        // the inverse of the queue's weight, and the queue with the smallest one goes first.
+        double pass = 0;
+
+        long long numAdmitted = 0;
+        long long numAbandoned = 0;
+        long long totalWaitMicros = 0;
+        std::array<long long, kWaitHistogramBoundsMicros.size() + 1> waitHistogram{};
+
+        // Admissions which took a ticket without the mutex. They count as admitted without a wait.
+        AtomicWord<long long> numAdmittedWithoutWaiting{0};
+    };
+
+    /**
+     * Takes an available ticket, if there is one, without the mutex.
+     */
+    bool _tryAcquireAvailable();
+
+    /**
+     * Hands the available tickets to the waiters, in weighted fair order among the queues.
+     */
+    void _grantTickets_inlock();
+
+    void _recordAdmission_inlock(OperationClassQueue* queue, Microseconds waitTime);
+
+    void _startSizingInterval_inlock(Date_t now);
+
+    void _adaptSize_inlock();
+
+    void _resize_inlock(int newSize);
 
+    // You can read _outof without a lock, but have to hold _mutex to change.
     AtomicInt32 _outof;
-    int _num;
-    stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
-#endif
+
+    // The number of tickets not in use. It is negative after shrinking below the number of
+    // tickets in use. Tickets are taken from it with a compare-and-swap, without the mutex, and
+    // only stay positive for long while no operation is queued.
+    AtomicInt32 _num;
+
+    // The number of operations queued, or about to queue, for a ticket. Releases only take the
+    // mutex to grant their tickets while it is not zero.
+    AtomicInt32 _numWaiters{0};
+
+    mutable stdx::mutex _mutex;
+
+    std::array<OperationClassQueue, kNumOperationClasses> _queues;
+
+    // The pass of the queue served last, which a queue that becomes non-empty starts from, so
+    // that an idle class can't save up a claim on the tickets.
+    double _virtualTime = 0;
+
+    AtomicBool _adaptiveSizing{false};
+    int _minTickets = 0;
+    int _maxTickets = 0;
+    Milliseconds _adaptiveSizingInterval;
+    Date_t _intervalStart;
+    AtomicInt64 _intervalEndMillis{0};  // Checked by releases without the mutex.
+    AtomicInt32 _numReleasedInInterval{0};
+    AtomicBool _queuedInInterval{false};
+    double _lastThroughput = 0;
+    int _sizingDirection = 1;
 };
 
 class ScopedTicket {
@@ -31,8 +31,14 @@
 
 #include "mongo/platform/basic.h"
 
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
 
 namespace {
 using namespace mongo;
@@ -71,4 +77,132 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, ShrinkRetiresTicketsAsTheyAreReleased) {
+    TicketHolder holder(4);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    ASSERT_OK(holder.resize(2));
+    ASSERT_EQ(holder.outof(), 2);
+    ASSERT_EQ(holder.used(), 4);
+    ASSERT_EQ(holder.available(), 0);
+
+    holder.release();
+    holder.release();
+    ASSERT_FALSE(holder.tryAcquire());
+
+    holder.release();
+    ASSERT_EQ(holder.used(), 1);
+    ASSERT_EQ(holder.available(), 1);
+    ASSERT_NOT_OK(holder.resize(0));
+}
+
+TEST(TicketholderTest, QueuesAreServedInProportionToTheirWeights) {
+    using OperationClass = TicketHolder::OperationClass;
+
+    TicketHolder holder(1);
+    ASSERT(holder.tryAcquire());
+
+    stdx::mutex mutex;
+    std::vector<OperationClass> admissionOrder;
+    std::vector<stdx::thread> threads;
+    auto queueUp = [&](OperationClass opClass) {
+        threads.emplace_back([&, opClass] {
+            ASSERT(holder.waitForTicketUntil(nullptr, opClass, Date_t::max()));
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                admissionOrder.push_back(opClass);
+            }
+            holder.release();
+        });
+    };
+
+    // Scans queue up first, then point operations, which are weighted 4 to 1 over them.
+    for (int i = 0; i < 5; ++i) {
+        queueUp(OperationClass::kDefault);
+    }
+    while (holder.queued(OperationClass::kDefault) != 5) {
+        sleepmillis(1);
+    }
+    for (int i = 0; i < 5; ++i) {
+        queueUp(OperationClass::kPointOperation);
+    }
+    while (holder.queued(OperationClass::kPointOperation) != 5) {
+        sleepmillis(1);
+    }
+
+    holder.release();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(admissionOrder.size(), 10U);
+    int numPointOperations = 0;
+    for (size_t i = 0; i < 5; ++i) {
+        if (admissionOrder[i] == OperationClass::kPointOperation) {
+            ++numPointOperations;
+        }
+    }
+    ASSERT_GTE(numPointOperations, 4);
+    ASSERT_EQ(holder.used(), 0);
+}
+
+TEST(TicketholderTest, AppendsWaitStatisticsByOperationClass) {
+    TicketHolder holder(1);
+    ASSERT(holder.waitForTicketUntil(
+        nullptr, TicketHolder::OperationClass::kInternal, Date_t::now()));
+    ASSERT_FALSE(holder.waitForTicketUntil(
+        nullptr, TicketHolder::OperationClass::kInternal, Date_t::now() + Milliseconds(1)));
+    holder.release();
+
+    BSONObjBuilder builder;
+    holder.appendStats(&builder);
+    const auto stats = builder.obj();
+    const auto internal = stats["queues"]["internal"].Obj();
+    ASSERT_EQ(internal["queued"].numberInt(), 0);
+    ASSERT_EQ(internal["admitted"].numberLong(), 1);
+    ASSERT_EQ(internal["abandoned"].numberLong(), 1);
+    ASSERT_EQ(internal["waitMicros"]["lt100"].numberLong(), 1);
+    ASSERT_EQ(stats["queues"]["default"]["admitted"].numberLong(), 0);
+    ASSERT_EQ(stats["queues"]["pointOperation"]["waitMicros"].Obj().nFields(), 6);
+}
+
+TEST(TicketholderTest, NeverGrantsMoreTicketsThanItHas) {
+    const int kNumTickets = 4;
+    TicketHolder holder(kNumTickets);
+
+    AtomicInt32 numHolding;
+    AtomicInt32 maxHolding;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < 16; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 1000; ++j) {
+                if (j % 2 == 0) {
+                    holder.waitForTicket();
+                } else if (!holder.tryAcquire()) {
+                    continue;
+                }
+
+                const int holding = numHolding.addAndFetch(1);
+                for (int max = maxHolding.load(); holding > max;) {
+                    max = maxHolding.compareAndSwap(max, holding);
+                }
+                numHolding.subtractAndFetch(1);
+                holder.release();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_LTE(maxHolding.load(), kNumTickets);
+    ASSERT_EQ(holder.used(), 0);
+    ASSERT_EQ(holder.available(), kNumTickets);
+    for (int i = 0; i < TicketHolder::kNumOperationClasses; ++i) {
+        ASSERT_EQ(holder.queued(static_cast<TicketHolder::OperationClass>(i)), 0);
+    }
+}
 }  // namespace
@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_buffer_pool.h"
+
+#include <array>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+constexpr size_t MessageBufferPool::kMinSizeClass;
+constexpr size_t MessageBufferPool::kMaxSizeClass;
+constexpr size_t MessageBufferPool::kMaxBuffersPerSizeClass;
+constexpr size_t MessageBufferPool::kMaxRetainedBytes;
+constexpr size_t MessageBufferPool::kNumSizeClasses;
+
+/**
+ * The buffers handed out by one thread, by size class. Only the owning thread touches it.
+ */
+class MessageBufferPool::ThreadCache {
+public:
+    ~ThreadCache() {
+        MessageBufferPool::get()->_retainedBytes.subtractAndFetch(retainedBytes);
+    }
+
+    std::array<std::vector<SharedBuffer>, kNumSizeClasses> sizeClasses;
+    size_t retainedBytes = 0;
+};
+
+MessageBufferPool* MessageBufferPool::get() {
+    static MessageBufferPool pool;
+    return &pool;
+}
+
+MessageBufferPool::ThreadCache& MessageBufferPool::_threadCache() {
+    static thread_local ThreadCache cache;
+    return cache;
+}
+
+size_t MessageBufferPool::sizeClassFor(size_t bytes) {
+    size_t sizeClass = kMinSizeClass;
+    while (sizeClass < bytes) {
+        sizeClass <<= 1;
+    }
+    return sizeClass;
+}
+
+SharedBuffer MessageBufferPool::allocate(size_t bytes) {
+    if (bytes > kMaxSizeClass) {
+        return SharedBuffer::allocate(bytes);
+    }
+
+    const auto sizeClassBytes = sizeClassFor(bytes);
+    size_t index = 0;
+    while ((kMinSizeClass << index) < sizeClassBytes) {
+        ++index;
+    }
+    invariant(index < kNumSizeClasses);
+
+    auto& cache = _threadCache();
+    auto& buffers = cache.sizeClasses[index];
+
+    // Only this thread can hand out references to the buffers of its cache, so a buffer the cache
+    // holds the only reference to stays free until it is returned.
+    for (const auto& buffer : buffers) {
+        if (!buffer.isShared()) {
+            return buffer;
+        }
+    }
+
+    // A buffer which won't be kept for reuse only needs to fit this message.
+    if (buffers.size() >= kMaxBuffersPerSizeClass) {
+        return SharedBuffer::allocate(bytes);
+    }
+
+    if (_retainedBytes.addAndFetch(sizeClassBytes) > kMaxRetainedBytes) {
+        _retainedBytes.subtractAndFetch(sizeClassBytes);
+        return SharedBuffer::allocate(bytes);
+    }
+
+    auto buffer = SharedBuffer::allocate(sizeClassBytes);
+    cache.retainedBytes += sizeClassBytes;
+    buffers.push_back(buffer);
+    return buffer;
+}
+
+size_t MessageBufferPool::retainedBytes() const {
+    return _retainedBytes.load();
+}
+
+}  // namespace mongo
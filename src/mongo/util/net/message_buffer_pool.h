@@ -0,0 +1,99 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+
+/**
+ * A pool of the buffers network messages are received into.
+ *
+ * Buffers are handed out with their capacity rounded up to a power of two size class. Each thread
+ * keeps the buffers it hands out in a cache of its own, and reuses a buffer once the cache holds
+ * the only remaining reference to it, that is once the Message received into it and every BSONObj
+ * sharing it have been destroyed. Since messages are parsed in place, this recycles the memory of
+ * large receives, such as insert batches of several megabytes, instead of returning it to the
+ * allocator after every message.
+ *
+ * Allocating takes no lock: a thread only looks at its own cache, and the memory retained by all
+ * the caches is counted atomically. A cache is released when its thread exits.
+ */
+class MessageBufferPool {
+    MONGO_DISALLOW_COPYING(MessageBufferPool);
+
+public:
+    // The smallest and largest size classes. Larger requests are served by the allocator.
+    static constexpr size_t kMinSizeClass = 4 * 1024;
+    static constexpr size_t kMaxSizeClass = 64 * 1024 * 1024;
+
+    // The most buffers the cache of each thread keeps in each size class.
+    static constexpr size_t kMaxBuffersPerSizeClass = 4;
+
+    // The most memory kept by the pool across all the threads and size classes.
+    static constexpr size_t kMaxRetainedBytes = 128 * 1024 * 1024;
+
+    /**
+     * Returns the pool used by the transport layers.
+     */
+    static MessageBufferPool* get();
+
+    /**
+     * Returns a buffer with a capacity of at least 'bytes', which may hold the contents of a
+     * message received before by the calling thread.
+     */
+    SharedBuffer allocate(size_t bytes);
+
+    /**
+     * Returns the size class of the buffers allocate() hands out for requests of 'bytes'.
+     */
+    static size_t sizeClassFor(size_t bytes);
+
+    /**
+     * Returns the memory held by the buffers in the pool, whether or not they are in use.
+     */
+    size_t retainedBytes() const;
+
+private:
+    static constexpr size_t kNumSizeClasses = 15;  // 4KB to 64MB
+
+    class ThreadCache;
+
+    MessageBufferPool() = default;
+
+    static ThreadCache& _threadCache();
+
+    AtomicWord<unsigned long long> _retainedBytes{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message_buffer_pool.h"
+
+namespace mongo {
+namespace {
+
+// Runs 'func' on a new thread, which starts with an empty cache and releases it on exit.
+template <typename Func>
+void runOnNewThread(Func&& func) {
+    stdx::thread thread(std::forward<Func>(func));
+    thread.join();
+}
+
+TEST(MessageBufferPoolTest, RoundsUpToSizeClasses) {
+    ASSERT_EQ(MessageBufferPool::sizeClassFor(1), MessageBufferPool::kMinSizeClass);
+    ASSERT_EQ(MessageBufferPool::sizeClassFor(4096), 4096UL);
+    ASSERT_EQ(MessageBufferPool::sizeClassFor(4097), 8192UL);
+    ASSERT_EQ(MessageBufferPool::sizeClassFor(48 * 1024 * 1024), 64UL * 1024 * 1024);
+
+    ASSERT_EQ(MessageBufferPool::get()->allocate(5000).capacity(), 8192UL);
+}
+
+TEST(MessageBufferPoolTest, ReusesReleasedBuffers) {
+    auto pool = MessageBufferPool::get();
+    const auto retainedBefore = pool->retainedBytes();
+
+    runOnNewThread([&] {
+        const char* data;
+        {
+            auto buffer = pool->allocate(100);
+            data = buffer.get();
+        }
+        ASSERT_EQ(pool->allocate(100).get(), data);
+        ASSERT_EQ(pool->retainedBytes(), retainedBefore + MessageBufferPool::kMinSizeClass);
+    });
+
+    // The cache of the thread was released when it exited.
+    ASSERT_EQ(pool->retainedBytes(), retainedBefore);
+}
+
+TEST(MessageBufferPoolTest, DoesNotReuseBuffersInUse) {
+    runOnNewThread([] {
+        auto pool = MessageBufferPool::get();
+        auto first = pool->allocate(100);
+        auto second = pool->allocate(100);
+        ASSERT_NOT_EQUALS(first.get(), second.get());
+
+        // A copy of the buffer, such as the one held by a BSONObj parsed from it, keeps it in use.
+        ConstSharedBuffer view = first;
+        first = SharedBuffer();
+        ASSERT_NOT_EQUALS(pool->allocate(100).get(), view.get());
+    });
+}
+
+TEST(MessageBufferPoolTest, DoesNotShareBuffersBetweenThreads) {
+    runOnNewThread([] {
+        auto pool = MessageBufferPool::get();
+        auto buffer = pool->allocate(100);
+
+        // Once the other thread drops the buffer, only the cache of this thread may reuse it.
+        const char* data = buffer.get();
+        runOnNewThread([&] {
+            buffer = SharedBuffer();
+            auto other = pool->allocate(100);
+            ASSERT_NOT_EQUALS(other.get(), data);
+        });
+        ASSERT_EQ(pool->allocate(100).get(), data);
+    });
+}
+
+TEST(MessageBufferPoolTest, DoesNotRoundUpBuffersItWillNotKeep) {
+    runOnNewThread([] {
+        auto pool = MessageBufferPool::get();
+
+        // Fill the cache for the size class, keeping every buffer in use.
+        std::vector<SharedBuffer> inUse;
+        for (size_t i = 0; i < MessageBufferPool::kMaxBuffersPerSizeClass; ++i) {
+            inUse.push_back(pool->allocate(5000));
+            ASSERT_EQ(inUse.back().capacity(), 8192UL);
+        }
+
+        const auto retainedBefore = pool->retainedBytes();
+        auto buffer = pool->allocate(5000);
+        ASSERT_EQ(buffer.capacity(), 5000UL);
+        ASSERT_EQ(pool->retainedBytes(), retainedBefore);
+    });
+}
+
+TEST(MessageBufferPoolTest, DoesNotPoolOversizeBuffers) {
+    runOnNewThread([] {
+        auto pool = MessageBufferPool::get();
+        const auto retainedBefore = pool->retainedBytes();
+
+        auto buffer = pool->allocate(MessageBufferPool::kMaxSizeClass + 1);
+        ASSERT_EQ(buffer.capacity(), MessageBufferPool::kMaxSizeClass + 1);
+        ASSERT_EQ(pool->retainedBytes(), retainedBefore);
+    });
+}
+
+}  // namespace
+}  // namespace mongo
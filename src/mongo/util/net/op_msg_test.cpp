@@ -205,6 +205,33 @@ TEST_F(OpMsgParser, SucceedsWithBodyThenSequence) {
     ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[1], fromjson("{a: 2}"));
 }
 
+TEST_F(OpMsgParser, ParsesSequencesInPlace) {
+    const auto message = OpMsgBytes{
+        kNoFlags,  //
+        kBodySection,
+        fromjson("{insert: 'coll'}"),
+
+        kDocSequenceSection,
+        Sized{
+            "documents",  //
+            fromjson("{a: 1}"),
+            fromjson("{a: 2}"),
+        },
+    }.done();
+    const auto msg = OpMsg::parse(message);
+
+    // The body and the documents must be views into the message rather than copies of it.
+    const auto isInMessage = [&](const BSONObj& obj) {
+        return obj.objdata() >= message.buf() &&
+            obj.objdata() + obj.objsize() <= message.buf() + message.size();
+    };
+    ASSERT_TRUE(isInMessage(msg.body));
+    ASSERT_EQ(msg.sequences[0].objs.size(), 2u);
+    for (const auto& obj : msg.sequences[0].objs) {
+        ASSERT_TRUE(isInMessage(obj));
+    }
+}
+
 TEST_F(OpMsgParser, SucceedsWithSequenceThenBody) {
     auto msg = OpMsgBytes{
         kNoFlags,  //
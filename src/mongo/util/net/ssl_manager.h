@@ -139,6 +139,13 @@ public:
      */
     virtual SSLConnectionInterface* accept(Socket* socket, const char* initialBytes, int len) = 0;
 
+    /**
+     * Called before the handshake of an outgoing connection to 'remoteHost'. If an earlier
+     * connection to the same host through the same context negotiated a session, it is offered to
+     * the server so that the handshake can resume it instead of running in full.
+     */
+    virtual void resumeSession(SSLConnectionType ssl, const std::string& remoteHost) = 0;
+
     /**
      * Fetches a peer certificate and validates it if it exists
      * Throws NetworkException on failure
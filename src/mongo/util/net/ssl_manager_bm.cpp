@@ -0,0 +1,175 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/config.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/net/ssl_options.h"
+
+#if defined(MONGO_CONFIG_SSL) && MONGO_CONFIG_SSL_PROVIDER == SSL_PROVIDER_OPENSSL
+
+namespace mongo {
+namespace {
+
+using Direction = SSLManagerInterface::ConnectionDirection;
+using UniqueContext = std::unique_ptr<SSL_CTX, decltype(&::SSL_CTX_free)>;
+using UniqueConnection = std::unique_ptr<SSL, decltype(&::SSL_free)>;
+
+// Large enough to hold every record of the biggest write below.
+const size_t kBioBufferSize = 1024 * 1024;
+
+/**
+ * A client and a server context of one SSLManager, connected over in-memory BIO pairs so that only
+ * the cost of TLS itself is measured.
+ */
+class LoopbackContexts {
+public:
+    LoopbackContexts() {
+        _params.sslMode.store(SSLParams::SSLMode_requireSSL);
+        _params.sslPEMKeyFile = "jstests/libs/server.pem";
+        _params.sslCAFile = "jstests/libs/ca.pem";
+        _params.sslAllowInvalidCertificates = true;
+        _params.sslAllowInvalidHostnames = true;
+
+        _manager = SSLManagerInterface::create(_params, false);
+        _serverContext = _makeContext(Direction::kIncoming);
+        _clientContext = _makeContext(Direction::kOutgoing);
+    }
+
+    /**
+     * Handshakes a new connection. If 'remoteHost' is not empty, the session cached for it, if
+     * any, is offered for resumption.
+     */
+    std::pair<UniqueConnection, UniqueConnection> connect(const std::string& remoteHost) {
+        UniqueConnection client(::SSL_new(_clientContext.get()), &::SSL_free);
+        UniqueConnection server(::SSL_new(_serverContext.get()), &::SSL_free);
+
+        BIO* clientBio;
+        BIO* serverBio;
+        invariant(::BIO_new_bio_pair(&clientBio, kBioBufferSize, &serverBio, kBioBufferSize) == 1);
+        ::SSL_set_bio(client.get(), clientBio, clientBio);
+        ::SSL_set_bio(server.get(), serverBio, serverBio);
+        ::SSL_set_connect_state(client.get());
+        ::SSL_set_accept_state(server.get());
+
+        if (!remoteHost.empty()) {
+            _manager->resumeSession(client.get(), remoteHost);
+        }
+
+        bool clientDone = false;
+        bool serverDone = false;
+        while (!clientDone || !serverDone) {
+            clientDone = clientDone || _step(client.get());
+            serverDone = serverDone || _step(server.get());
+        }
+
+        // Let the client take in the session tickets that TLS 1.3 servers send after the handshake.
+        char byte = 'x';
+        invariant(::SSL_write(server.get(), &byte, 1) == 1);
+        invariant(::SSL_read(client.get(), &byte, 1) == 1);
+
+        return {std::move(client), std::move(server)};
+    }
+
+private:
+    UniqueContext _makeContext(Direction direction) {
+        UniqueContext context(::SSL_CTX_new(::SSLv23_method()), &::SSL_CTX_free);
+        invariant(context);
+        invariantOK(_manager->initSSLContext(context.get(), _params, direction));
+        return context;
+    }
+
+    static bool _step(SSL* conn) {
+        const int ret = ::SSL_do_handshake(conn);
+        invariant(ret == 1 || ::SSL_get_error(conn, ret) == SSL_ERROR_WANT_READ);
+        return ret == 1;
+    }
+
+    SSLParams _params;
+    std::unique_ptr<SSLManagerInterface> _manager;
+    UniqueContext _serverContext{nullptr, &::SSL_CTX_free};
+    UniqueContext _clientContext{nullptr, &::SSL_CTX_free};
+};
+
+void BM_FullHandshake(benchmark::State& state) {
+    LoopbackContexts contexts;
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(contexts.connect(""));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ResumedHandshake(benchmark::State& state) {
+    LoopbackContexts contexts;
+    contexts.connect("localhost:27017");
+    for (auto keepRunning : state) {
+        auto conns = contexts.connect("localhost:27017");
+        if (!::SSL_session_reused(conns.first.get())) {
+            state.SkipWithError("session was not resumed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Sends state.range(0) bytes per iteration from the client to the server of one connection.
+ */
+void BM_Throughput(benchmark::State& state) {
+    LoopbackContexts contexts;
+    auto conns = contexts.connect("");
+    const int size = state.range(0);
+    std::vector<char> sent(size, 'x');
+    std::vector<char> received(size);
+
+    for (auto keepRunning : state) {
+        invariant(::SSL_write(conns.first.get(), sent.data(), size) == size);
+        for (int read = 0; read < size;) {
+            const int ret = ::SSL_read(conns.second.get(), received.data() + read, size - read);
+            invariant(ret > 0);
+            read += ret;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_FullHandshake);
+BENCHMARK(BM_ResumedHandshake);
+BENCHMARK(BM_Throughput)->Arg(1024)->Arg(16 * 1024)->Arg(256 * 1024);
+
+}  // namespace
+}  // namespace mongo
+
+#endif
@@ -36,6 +36,7 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <fstream>
 #include <iostream>
+#include <list>
 #include <sstream>
 #include <stack>
 #include <string>
@@ -48,6 +49,8 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/transport/session.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/debug_util.h"
@@ -146,6 +149,130 @@ UniqueBIO makeUniqueMemBio(std::vector<std::uint8_t>& v) {
     return rv;
 }
 
+// The number of sessions an incoming context keeps for resumption by reconnecting clients, and
+// how long they stay resumable. A size of 0 disables both the session cache and session tickets.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(opensslSessionCacheSize, int, 20 * 1024);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(opensslSessionTimeoutSecs, int, 300);
+
+// The number of remote hosts an outgoing context remembers a session for, so that new connections
+// to them can resume it instead of running a full handshake. 0 disables client-side resumption.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(opensslClientSessionCacheSize, int, 1024);
+
+struct SSLSessionFree {
+    void operator()(SSL_SESSION* const p) noexcept {
+        if (p) {
+            ::SSL_SESSION_free(p);
+        }
+    }
+};
+using UniqueSSLSession = std::unique_ptr<SSL_SESSION, SSLSessionFree>;
+
+/**
+ * The most recent session negotiated with each remote host through one outgoing SSL_CTX. It is
+ * attached to the context as ex_data, so it lives exactly as long as the context does.
+ *
+ * Sessions are kept in their serialized form, and each connection resumes from a fresh copy. When
+ * a connection is freed without having sent a close_notify, which is how pooled egress
+ * connections end, OpenSSL marks the session it holds as not resumable.
+ */
+class ClientSessionCache {
+public:
+    static ClientSessionCache* get(SSL_CTX* context) {
+        return static_cast<ClientSessionCache*>(::SSL_CTX_get_ex_data(context, _contextIndex()));
+    }
+
+    static void attach(SSL_CTX* context) {
+        ::SSL_CTX_set_ex_data(context, _contextIndex(), new ClientSessionCache());
+        ::SSL_CTX_set_session_cache_mode(context,
+                                         SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        ::SSL_CTX_sess_set_new_cb(context, &ClientSessionCache::_onNewSession);
+    }
+
+    /**
+     * Offers the session last negotiated with 'remoteHost', if any, for resumption by 'conn', and
+     * files whatever session 'conn' negotiates under 'remoteHost'. When the cache is full, the
+     * session of the least recently connected host is evicted.
+     */
+    void resume(SSL* conn, const std::string& remoteHost) {
+        ::SSL_set_ex_data(conn, _connectionIndex(), new std::string(remoteHost));
+
+        std::string encoded;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto it = _index.find(remoteHost);
+            if (it == _index.end()) {
+                return;
+            }
+            _sessions.splice(_sessions.begin(), _sessions, it->second);
+            encoded = it->second->second;
+        }
+
+        auto data = reinterpret_cast<const unsigned char*>(encoded.data());
+        UniqueSSLSession session(::d2i_SSL_SESSION(nullptr, &data, encoded.size()));
+        if (session) {
+            ::SSL_set_session(conn, session.get());
+        }
+    }
+
+private:
+    // Files a copy of 'session' and returns 0, so that OpenSSL keeps ownership of it.
+    static int _onNewSession(SSL* conn, SSL_SESSION* session) {
+        auto remoteHost = static_cast<std::string*>(::SSL_get_ex_data(conn, _connectionIndex()));
+        auto cache = get(::SSL_get_SSL_CTX(conn));
+        const int length = ::i2d_SSL_SESSION(session, nullptr);
+        if (!remoteHost || !cache || length <= 0) {
+            return 0;
+        }
+
+        std::string encoded(length, '\0');
+        auto out = reinterpret_cast<unsigned char*>(&encoded[0]);
+        ::i2d_SSL_SESSION(session, &out);
+
+        stdx::lock_guard<stdx::mutex> lk(cache->_mutex);
+        auto& sessions = cache->_sessions;
+        auto it = cache->_index.find(*remoteHost);
+        if (it != cache->_index.end()) {
+            sessions.splice(sessions.begin(), sessions, it->second);
+            it->second->second = std::move(encoded);
+            return 0;
+        }
+
+        sessions.emplace_front(*remoteHost, std::move(encoded));
+        cache->_index.emplace(*remoteHost, sessions.begin());
+        while (sessions.size() > static_cast<size_t>(std::max(opensslClientSessionCacheSize, 1))) {
+            cache->_index.erase(sessions.back().first);
+            sessions.pop_back();
+        }
+        return 0;
+    }
+
+    static void _freeCache(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) {
+        delete static_cast<ClientSessionCache*>(ptr);
+    }
+
+    static void _freeRemoteHost(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) {
+        delete static_cast<std::string*>(ptr);
+    }
+
+    static int _contextIndex() {
+        static const int index =
+            ::SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, &_freeCache);
+        return index;
+    }
+
+    static int _connectionIndex() {
+        static const int index =
+            ::SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &_freeRemoteHost);
+        return index;
+    }
+
+    using SessionList = std::list<std::pair<std::string, std::string>>;
+
+    stdx::mutex _mutex;
+    SessionList _sessions;  // Most recently used first.
+    stdx::unordered_map<std::string, SessionList::iterator> _index;
+};
+
 // Old copies of OpenSSL will not have constants to disable protocols they don't support.
 // Define them to values we can OR together safely to generically disable these protocols across
 // all versions of OpenSSL.
@@ -338,6 +465,8 @@ public:
 
     SSLConnectionInterface* accept(Socket* socket, const char* initialBytes, int len) final;
 
+    void resumeSession(SSL* conn, const std::string& remoteHost) final;
+
     SSLPeerInfo parseAndValidatePeerCertificateDeprecated(const SSLConnectionInterface* conn,
                                                           const std::string& remoteHost) final;
 
@@ -757,6 +886,19 @@ Status SSLManagerOpenSSL::initSSLContext(SSL_CTX* context,
     // We always set ECDH mode anyhow, if available.
     setECDHModeAuto(context);
 
+    if (direction == ConnectionDirection::kIncoming) {
+        if (opensslSessionCacheSize > 0) {
+            ::SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+            ::SSL_CTX_sess_set_cache_size(context, opensslSessionCacheSize);
+            ::SSL_CTX_set_timeout(context, opensslSessionTimeoutSecs);
+        } else {
+            ::SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_OFF);
+            ::SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+        }
+    } else if (opensslClientSessionCacheSize > 0) {
+        ClientSessionCache::attach(context);
+    }
+
     return Status::OK();
 }
 
@@ -1192,6 +1334,8 @@ SSLConnectionInterface* SSLManagerOpenSSL::connect(Socket* socket) {
     if (ret != 1)
         _handleSSLError(SSL_get_error(sslConn.get()->ssl, ret), ret);
 
+    resumeSession(sslConn->ssl, socket->remoteAddr().toString());
+
     do {
         ret = ::SSL_connect(sslConn->ssl);
     } while (!_doneWithSSLOp(sslConn.get(), ret));
@@ -1219,6 +1363,12 @@ SSLConnectionInterface* SSLManagerOpenSSL::accept(Socket* socket,
     return sslConn.release();
 }
 
+void SSLManagerOpenSSL::resumeSession(SSL* conn, const std::string& remoteHost) {
+    if (auto cache = ClientSessionCache::get(::SSL_get_SSL_CTX(conn))) {
+        cache->resume(conn, remoteHost);
+    }
+}
+
 StatusWith<boost::optional<SSLPeerInfo>> SSLManagerOpenSSL::parseAndValidatePeerCertificate(
     SSL* conn, const std::string& remoteHost) {
     if (!_sslConfiguration.hasCA && isSSLServer)
@@ -33,8 +33,10 @@
 #include "mongo/util/net/ssl_manager.h"
 
 #include "mongo/config.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/ssl_options.h"
 
 
 namespace mongo {
@@ -247,5 +249,139 @@ TEST(SSLManager, MongoDBRolesParser) {
 }
 #endif
 
+#if defined(MONGO_CONFIG_SSL) && MONGO_CONFIG_SSL_PROVIDER == SSL_PROVIDER_OPENSSL
+
+class ScopedServerParameter {
+public:
+    ScopedServerParameter(StringData name, StringData value) : _parameter(_find(name)) {
+        BSONObjBuilder builder;
+        _parameter->append(nullptr, builder, "value");
+        _original = builder.obj();
+        ASSERT_OK(_parameter->setFromString(value.toString()));
+    }
+
+    ~ScopedServerParameter() {
+        _parameter->set(_original["value"]).transitional_ignore();
+    }
+
+private:
+    static ServerParameter* _find(StringData name) {
+        const auto& parameters = ServerParameterSet::getGlobal()->getMap();
+        auto it = parameters.find(name.toString());
+        invariant(it != parameters.end());
+        return it->second;
+    }
+
+    ServerParameter* _parameter;
+    BSONObj _original;
+};
+
+/**
+ * Runs TLS handshakes between a client and a server context of the same SSLManager over in-memory
+ * BIO pairs, so that session resumption can be observed without any sockets.
+ */
+class SSLSessionResumptionTest : public unittest::Test {
+protected:
+    using Direction = SSLManagerInterface::ConnectionDirection;
+    using UniqueContext = std::unique_ptr<SSL_CTX, decltype(&::SSL_CTX_free)>;
+    using UniqueConnection = std::unique_ptr<SSL, decltype(&::SSL_free)>;
+
+    void setUp() override {
+        _params.sslMode.store(SSLParams::SSLMode_requireSSL);
+        _params.sslPEMKeyFile = "jstests/libs/server.pem";
+        _params.sslCAFile = "jstests/libs/ca.pem";
+        _params.sslAllowInvalidCertificates = true;
+        _params.sslAllowInvalidHostnames = true;
+
+        _manager = SSLManagerInterface::create(_params, false);
+        _serverContext = _makeContext(Direction::kIncoming);
+        _clientContext = _makeContext(Direction::kOutgoing);
+    }
+
+    /**
+     * Connects to 'remoteHost' and returns whether the handshake resumed an earlier session.
+     */
+    bool connect(const std::string& remoteHost) {
+        UniqueConnection client(::SSL_new(_clientContext.get()), &::SSL_free);
+        UniqueConnection server(::SSL_new(_serverContext.get()), &::SSL_free);
+        ASSERT(client && server);
+
+        BIO* clientBio;
+        BIO* serverBio;
+        ASSERT_EQ(1, ::BIO_new_bio_pair(&clientBio, 0, &serverBio, 0));
+        ::SSL_set_bio(client.get(), clientBio, clientBio);
+        ::SSL_set_bio(server.get(), serverBio, serverBio);
+        ::SSL_set_connect_state(client.get());
+        ::SSL_set_accept_state(server.get());
+
+        _manager->resumeSession(client.get(), remoteHost);
+
+        bool clientDone = false;
+        bool serverDone = false;
+        for (int round = 0; !clientDone || !serverDone; ++round) {
+            ASSERT_LT(round, 100);
+            clientDone = clientDone || _step(client.get());
+            serverDone = serverDone || _step(server.get());
+        }
+
+        // TLS 1.3 servers issue session tickets after the handshake, so the client only files its
+        // session once it reads application data.
+        char byte = 'x';
+        ASSERT_EQ(1, ::SSL_write(server.get(), &byte, 1));
+        ASSERT_EQ(1, ::SSL_read(client.get(), &byte, 1));
+
+        return ::SSL_session_reused(client.get());
+    }
+
+private:
+    UniqueContext _makeContext(Direction direction) {
+        UniqueContext context(::SSL_CTX_new(::SSLv23_method()), &::SSL_CTX_free);
+        ASSERT(context);
+        ASSERT_OK(_manager->initSSLContext(context.get(), _params, direction));
+        return context;
+    }
+
+    static bool _step(SSL* conn) {
+        const int ret = ::SSL_do_handshake(conn);
+        if (ret == 1) {
+            return true;
+        }
+        ASSERT_EQ(SSL_ERROR_WANT_READ, ::SSL_get_error(conn, ret));
+        return false;
+    }
+
+    SSLParams _params;
+    std::unique_ptr<SSLManagerInterface> _manager;
+    UniqueContext _serverContext{nullptr, &::SSL_CTX_free};
+    UniqueContext _clientContext{nullptr, &::SSL_CTX_free};
+};
+
+TEST_F(SSLSessionResumptionTest, ReconnectToSameHostResumesSession) {
+    ASSERT_FALSE(connect("host1:27017"));
+    ASSERT_TRUE(connect("host1:27017"));
+    ASSERT_TRUE(connect("host1:27017"));
+
+    // Sessions are kept per host.
+    ASSERT_FALSE(connect("host2:27017"));
+    ASSERT_TRUE(connect("host1:27017"));
+}
+
+TEST_F(SSLSessionResumptionTest, EvictsLeastRecentlyUsedHost) {
+    ScopedServerParameter cacheSize{"opensslClientSessionCacheSize", "2"};
+
+    ASSERT_FALSE(connect("b:27017"));
+    ASSERT_FALSE(connect("a:27017"));
+
+    // Touching "b" makes "a" the least recently used host, although it sorts first.
+    ASSERT_TRUE(connect("b:27017"));
+    ASSERT_FALSE(connect("c:27017"));
+
+    ASSERT_TRUE(connect("b:27017"));
+    ASSERT_TRUE(connect("c:27017"));
+    ASSERT_FALSE(connect("a:27017"));
+}
+
+#endif
+
 //  // namespace
 }  // namespace mongo
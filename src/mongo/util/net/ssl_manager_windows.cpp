@@ -199,6 +199,10 @@ public:
 
     SSLConnectionInterface* accept(Socket* socket, const char* initialBytes, int len) final;
 
+    void resumeSession(PCtxtHandle ssl, const std::string& remoteHost) final {
+        // SChannel keeps its own cache of client sessions.
+    }
+
     SSLPeerInfo parseAndValidatePeerCertificateDeprecated(const SSLConnectionInterface* conn,
                                                           const std::string& remoteHost) final;
 
@@ -0,0 +1,36 @@
+#!/bin/bash
+set -o verbose
+set -o errexit
+
+# This script fetches and creates a copy of sources for zstd
+# zstd needs no configure step, so only the library sources and headers are kept
+# The x86_64 assembly decoder is dropped, the build defines ZSTD_DISABLE_ASM instead
+
+VERSION=1.5.7
+NAME=zstd
+TARBALL=$NAME-$VERSION.tar.gz
+TARBALL_DIR=$NAME-$VERSION
+TEMP_DIR=/tmp/temp-$NAME-$VERSION
+DEST_DIR=`git rev-parse --show-toplevel`/src/third_party/$NAME-$VERSION
+
+if [ ! -f $TARBALL ]; then
+    echo "Get tarball"
+    wget https://github.com/facebook/$NAME/releases/download/v$VERSION/$NAME-$VERSION.tar.gz
+fi
+
+echo $TARBALL
+tar -zxvf $TARBALL
+
+rm -rf $TEMP_DIR
+mv $TARBALL_DIR $TEMP_DIR
+mkdir -p $DEST_DIR/lib
+
+cp $TEMP_DIR/LICENSE $TEMP_DIR/COPYING $DEST_DIR
+cp $TEMP_DIR/lib/zstd.h $TEMP_DIR/lib/zstd_errors.h $TEMP_DIR/lib/zdict.h $DEST_DIR/lib
+for dir in common compress decompress; do
+    rm -rf $DEST_DIR/lib/$dir
+    cp -r $TEMP_DIR/lib/$dir $DEST_DIR/lib
+done
+rm -f $DEST_DIR/lib/decompress/*.S
+
+echo "Done"